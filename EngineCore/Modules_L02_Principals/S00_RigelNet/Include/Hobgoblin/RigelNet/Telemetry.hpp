@@ -22,13 +22,41 @@ struct RN_Telemetry {
     //! Note that this does NOT count bytes exchanged between
     //! locally connected nodes.
     hobgoblin::PZInteger downloadByteCount = 0;
+
+    //! Number of datagrams sent through the node's socket.
+    hobgoblin::PZInteger sentDatagramCount = 0;
+    //! Number of send operations (system calls, with the default
+    //! networking stack) which the node's socket made to send them.
+    hobgoblin::PZInteger sendCallCount = 0;
+    //! Number of datagrams received through the node's socket.
+    hobgoblin::PZInteger receivedDatagramCount = 0;
+    //! Number of receive operations (system calls, with the default
+    //! networking stack) which the node's socket made to receive them
+    //! (including the final one which found no more data).
+    hobgoblin::PZInteger recvCallCount = 0;
+
+    //! Average number of datagrams sent per send operation (0 if none).
+    //! Can be greater than 1 only if the socket supports batched I/O.
+    double getDatagramsPerSendCall() const {
+        return (sendCallCount > 0) ? static_cast<double>(sentDatagramCount) / sendCallCount : 0.0;
+    }
+
+    //! Average number of datagrams received per receive operation (0 if none).
+    //! Can be greater than 1 only if the socket supports batched I/O.
+    double getDatagramsPerRecvCall() const {
+        return (recvCallCount > 0) ? static_cast<double>(receivedDatagramCount) / recvCallCount : 0.0;
+    }
 };
 
 inline
 RN_Telemetry operator+(const RN_Telemetry& aLhs, const RN_Telemetry& aRhs) {
     return RN_Telemetry{
-        aLhs.uploadByteCount   + aRhs.uploadByteCount,
-        aLhs.downloadByteCount + aRhs.downloadByteCount
+        aLhs.uploadByteCount       + aRhs.uploadByteCount,
+        aLhs.downloadByteCount     + aRhs.downloadByteCount,
+        aLhs.sentDatagramCount     + aRhs.sentDatagramCount,
+        aLhs.sendCallCount         + aRhs.sendCallCount,
+        aLhs.receivedDatagramCount + aRhs.receivedDatagramCount,
+        aLhs.recvCallCount         + aRhs.recvCallCount
     };
 }
 
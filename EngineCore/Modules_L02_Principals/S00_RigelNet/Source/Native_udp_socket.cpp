@@ -0,0 +1,292 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include "Native_udp_socket.hpp"
+
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <Hobgoblin/Private/Pmacro_define.hpp>
+
+HOBGOBLIN_NAMESPACE_BEGIN
+namespace rn {
+
+namespace {
+//! Maps `errno` values to statuses the same way SFML does for its sockets.
+//! Throws TracedRuntimeError for errors from which the socket can't recover.
+RN_NativeUdpSocket::Status StatusFromErrno(int aErrno) {
+    switch (aErrno) {
+    case EAGAIN:
+    case EINPROGRESS:
+        return RN_NativeUdpSocket::Status::NotReady;
+
+    case ECONNABORTED:
+    case ECONNRESET:
+    case ETIMEDOUT:
+    case ENETRESET:
+    case ENOTCONN:
+    case EPIPE:
+        return RN_NativeUdpSocket::Status::Disconnected;
+
+    default:
+        HG_THROW_TRACED(TracedRuntimeError,
+                        aErrno,
+                        "Socket reached an unrecoverable error state ({}).",
+                        std::strerror(aErrno));
+    }
+}
+
+sockaddr_in MakeSocketAddress(std::uint32_t aIpAddress, std::uint16_t aPort) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(aIpAddress);
+    address.sin_port        = htons(aPort);
+    return address;
+}
+
+void PrepareHeaders(PZInteger                 aMaxDatagramSize,
+                    std::vector<char>&        aData,
+                    std::vector<iovec>&       aIovecs,
+                    std::vector<sockaddr_in>& aAddresses,
+                    std::vector<mmsghdr>&     aHeaders) {
+    const auto count = pztos(RN_NativeUdpSocket::BATCH_SIZE);
+
+    aData.resize(count * pztos(aMaxDatagramSize));
+    aIovecs.resize(count);
+    aAddresses.resize(count);
+    aHeaders.resize(count);
+
+    for (std::size_t i = 0; i < count; i += 1) {
+        aIovecs[i].iov_base = aData.data() + i * pztos(aMaxDatagramSize);
+        aIovecs[i].iov_len  = pztos(aMaxDatagramSize);
+
+        std::memset(&aHeaders[i], 0, sizeof(mmsghdr));
+        aHeaders[i].msg_hdr.msg_name    = &aAddresses[i];
+        aHeaders[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        aHeaders[i].msg_hdr.msg_iov     = &aIovecs[i];
+        aHeaders[i].msg_hdr.msg_iovlen  = 1;
+    }
+}
+} // namespace
+
+RN_NativeUdpSocket::~RN_NativeUdpSocket() {
+    close();
+}
+
+void RN_NativeUdpSocket::init(PZInteger aMaxDatagramSize) {
+    _maxDatagramSize = aMaxDatagramSize;
+    PrepareHeaders(_maxDatagramSize, _recvData, _recvIovecs, _recvAddresses, _recvHeaders);
+    PrepareHeaders(_maxDatagramSize, _sendData, _sendIovecs, _sendAddresses, _sendHeaders);
+    _recvCount = _recvNext = 0;
+    _sendCount             = 0;
+}
+
+void RN_NativeUdpSocket::bind(std::uint32_t aIpAddress, std::uint16_t aLocalPort) {
+    close();
+
+    _fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_fd < 0) {
+        HG_THROW_TRACED(TracedRuntimeError, errno, "Failed to create socket.");
+    }
+
+    // Same as SFML does for its UDP sockets
+    const int enable = 1;
+    ::setsockopt(_fd, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+
+    const auto address = MakeSocketAddress(aIpAddress, aLocalPort);
+    if (::bind(_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        const int error = errno;
+        close();
+        HG_THROW_TRACED(TracedRuntimeError, error, "Failed to bind port.");
+    }
+}
+
+RN_NativeUdpSocket::Status RN_NativeUdpSocket::send(const void*   aData,
+                                                    PZInteger     aByteCount,
+                                                    std::uint32_t aIpAddress,
+                                                    std::uint16_t aPort) {
+    if (_holdingSends && aByteCount <= _maxDatagramSize) {
+        const auto i = pztos(_sendCount);
+        std::memcpy(_sendIovecs[i].iov_base, aData, pztos(aByteCount));
+        _sendIovecs[i].iov_len = pztos(aByteCount);
+        _sendAddresses[i]      = MakeSocketAddress(aIpAddress, aPort);
+        _sendCount += 1;
+
+        if (_sendCount == BATCH_SIZE) {
+            return _sendBatch();
+        }
+        return Status::OK;
+    }
+
+    // Datagrams collected so far must go out first to keep the order
+    if (_sendCount > 0) {
+        _sendBatch();
+    }
+
+    const auto address = MakeSocketAddress(aIpAddress, aPort);
+    while (true) {
+        _telemetry.sendCallCount += 1;
+        const auto res = ::sendto(_fd,
+                                  aData,
+                                  pztos(aByteCount),
+                                  0,
+                                  reinterpret_cast<const sockaddr*>(&address),
+                                  sizeof(address));
+        if (res >= 0) {
+            _telemetry.sentDatagramCount += 1;
+            return Status::OK;
+        }
+        if (errno != EINTR) {
+            return StatusFromErrno(errno);
+        }
+    }
+}
+
+RN_NativeUdpSocket::Status RN_NativeUdpSocket::recv(util::Packet&  aPacket,
+                                                    std::uint32_t& aIpAddress,
+                                                    std::uint16_t& aPort) {
+    if (_recvNext == _recvCount) {
+        const auto status = _receiveBatch();
+        if (status != Status::OK) {
+            return status;
+        }
+    }
+
+    const auto i = pztos(_recvNext);
+    _recvNext += 1;
+
+    // The length can't exceed the buffer size (longer datagrams are truncated)
+    const auto byteCount = static_cast<std::int64_t>(_recvHeaders[i].msg_len);
+
+    aPacket.clear();
+    const auto bytesWritten = aPacket.write(_recvIovecs[i].iov_base, byteCount);
+    HG_ASSERT(bytesWritten == byteCount);
+
+    aIpAddress = ntohl(_recvAddresses[i].sin_addr.s_addr);
+    aPort      = ntohs(_recvAddresses[i].sin_port);
+
+    return Status::OK;
+}
+
+void RN_NativeUdpSocket::holdSends() {
+    _holdingSends = true;
+}
+
+RN_NativeUdpSocket::Status RN_NativeUdpSocket::flush() {
+    _holdingSends = false;
+    if (_sendCount == 0) {
+        return Status::OK;
+    }
+    return _sendBatch();
+}
+
+void RN_NativeUdpSocket::close() {
+    if (_fd >= 0) {
+        try {
+            flush();
+        } catch (...) {
+            // Swallow errors as we don't expect to use the socket afterwards
+        }
+        ::close(_fd);
+        _fd = -1;
+    }
+    _recvCount = _recvNext = 0;
+    _sendCount             = 0;
+    _holdingSends          = false;
+}
+
+std::uint16_t RN_NativeUdpSocket::getLocalPort() const {
+    if (_fd < 0) {
+        return 0;
+    }
+
+    sockaddr_in address;
+    socklen_t   addressSize = sizeof(address);
+    if (::getsockname(_fd, reinterpret_cast<sockaddr*>(&address), &addressSize) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
+
+RN_Telemetry RN_NativeUdpSocket::collectTelemetry() {
+    return std::exchange(_telemetry, RN_Telemetry{});
+}
+
+RN_NativeUdpSocket::Status RN_NativeUdpSocket::_receiveBatch() {
+    _recvCount = _recvNext = 0;
+
+    // The OS overwrites these on every call
+    for (auto& header : _recvHeaders) {
+        header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        header.msg_hdr.msg_flags   = 0;
+    }
+
+    while (true) {
+        _telemetry.recvCallCount += 1;
+        const int res = ::recvmmsg(_fd,
+                                   _recvHeaders.data(),
+                                   static_cast<unsigned>(_recvHeaders.size()),
+                                   MSG_DONTWAIT,
+                                   nullptr);
+        if (res > 0) {
+            _recvCount = res;
+            _telemetry.receivedDatagramCount += res;
+            return Status::OK;
+        }
+        if (res == 0) {
+            return Status::NotReady;
+        }
+        if (errno != EINTR) {
+            return StatusFromErrno(errno);
+        }
+    }
+}
+
+RN_NativeUdpSocket::Status RN_NativeUdpSocket::_sendBatch() {
+    // Reset the count first so that the batch is discarded even if an exception is thrown
+    const auto count = std::exchange(_sendCount, 0);
+
+    Status    result = Status::OK;
+    PZInteger offset = 0;
+    while (offset < count) {
+        _telemetry.sendCallCount += 1;
+        const int res = ::sendmmsg(_fd,
+                                   &_sendHeaders[pztos(offset)],
+                                   static_cast<unsigned>(count - offset),
+                                   0);
+        if (res > 0) {
+            _telemetry.sentDatagramCount += res;
+            offset += res;
+            continue;
+        }
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // sendmmsg only fails when it can't send the first datagram of those passed to it
+        result = (res < 0) ? StatusFromErrno(errno) : Status::NotReady;
+        if (result == Status::NotReady) {
+            // The OS's buffer is full; drop the rest, like individual sends would be dropped
+            break;
+        }
+        offset += 1; // Skip the datagram which couldn't be sent
+    }
+    return result;
+}
+
+} // namespace rn
+HOBGOBLIN_NAMESPACE_END
+
+#include <Hobgoblin/Private/Pmacro_undef.hpp>
+
+#endif // HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
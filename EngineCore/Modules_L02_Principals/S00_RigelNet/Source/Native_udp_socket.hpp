@@ -0,0 +1,119 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#ifndef UHOBGOBLIN_RN_NATIVE_UDP_SOCKET_HPP
+#define UHOBGOBLIN_RN_NATIVE_UDP_SOCKET_HPP
+
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/RigelNet/Telemetry.hpp>
+#include <Hobgoblin/Utility/Packet.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <Hobgoblin/Private/Pmacro_define.hpp>
+
+HOBGOBLIN_NAMESPACE_BEGIN
+namespace rn {
+
+//! Non-blocking IPv4 UDP socket which uses the sockets API of the OS directly (Linux only), so
+//! that it can move many datagrams with a single system call: received datagrams are read in
+//! batches with `recvmmsg` into preallocated buffers and then handed out one by one, and while
+//! sends are being held back (see `holdSends()`), outgoing datagrams are collected and sent in
+//! batches with `sendmmsg`.
+//!
+//! IP addresses are passed around as integers in host byte order.
+class RN_NativeUdpSocket {
+public:
+    enum class Status {
+        OK,          //!< Operation completed successfully
+        NotReady,    //!< Operation could not be completed (it would block)
+        Disconnected //!< Should not happen with UDP, but reported by the OS in some cases
+    };
+
+    //! Maximum number of datagrams received or sent with a single system call.
+    static constexpr PZInteger BATCH_SIZE = 32;
+
+    RN_NativeUdpSocket() = default;
+
+    RN_NativeUdpSocket(const RN_NativeUdpSocket&)            = delete;
+    RN_NativeUdpSocket& operator=(const RN_NativeUdpSocket&) = delete;
+    RN_NativeUdpSocket(RN_NativeUdpSocket&&)                 = delete;
+    RN_NativeUdpSocket& operator=(RN_NativeUdpSocket&&)      = delete;
+
+    ~RN_NativeUdpSocket();
+
+    //! Allocates the buffers for datagrams of up to `aMaxDatagramSize` bytes (longer datagrams
+    //! are truncated when received, and are not batched when sent).
+    void init(PZInteger aMaxDatagramSize);
+
+    //! Opens the socket (closing it first if it's already open) and binds it to a local address
+    //! and port.
+    //! Throws TracedRuntimeError on failure.
+    void bind(std::uint32_t aIpAddress, std::uint16_t aLocalPort);
+
+    //! Sends a datagram, or adds it to the current batch if sends are being held back (in which
+    //! case OK is returned unless the batch becomes full and fails to send).
+    //! Throws TracedRuntimeError on unrecoverable error.
+    Status send(const void* aData, PZInteger aByteCount, std::uint32_t aIpAddress, std::uint16_t aPort);
+
+    //! Receives the next datagram, reading a new batch from the OS if needed.
+    //! Throws TracedRuntimeError on unrecoverable error.
+    Status recv(util::Packet& aPacket, std::uint32_t& aIpAddress, std::uint16_t& aPort);
+
+    //! Until `flush()` is called, datagrams passed to `send()` are collected into batches.
+    void holdSends();
+
+    //! Sends all the datagrams collected since `holdSends()` and stops holding back sends.
+    //! Datagrams which the OS can't accept at the moment are dropped (as with `send()` returning
+    //! NotReady).
+    //! Throws TracedRuntimeError on unrecoverable error.
+    Status flush();
+
+    //! Flushes and closes the socket. Safe to call multiple times; doesn't throw.
+    void close();
+
+    //! Returns the local port the socket is bound to (0 if it's not).
+    std::uint16_t getLocalPort() const;
+
+    //! Returns the datagram and system call counts (only those fields are set) accumulated since
+    //! the last call, and resets them.
+    RN_Telemetry collectTelemetry();
+
+private:
+    int       _fd              = -1;
+    PZInteger _maxDatagramSize = 0;
+
+    std::vector<char>        _recvData;
+    std::vector<iovec>       _recvIovecs;
+    std::vector<sockaddr_in> _recvAddresses;
+    std::vector<mmsghdr>     _recvHeaders;
+    PZInteger                _recvCount = 0; //!< Number of datagrams in the current batch
+    PZInteger                _recvNext  = 0; //!< Index of the next datagram to hand out
+
+    std::vector<char>        _sendData;
+    std::vector<iovec>       _sendIovecs;
+    std::vector<sockaddr_in> _sendAddresses;
+    std::vector<mmsghdr>     _sendHeaders;
+    PZInteger                _sendCount    = 0; //!< Number of datagrams in the current batch
+    bool                     _holdingSends = false;
+
+    RN_Telemetry _telemetry;
+
+    Status _receiveBatch();
+    Status _sendBatch();
+};
+
+} // namespace rn
+HOBGOBLIN_NAMESPACE_END
+
+#include <Hobgoblin/Private/Pmacro_undef.hpp>
+
+#endif // HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+
+#endif // !UHOBGOBLIN_RN_NATIVE_UDP_SOCKET_HPP
@@ -5,6 +5,9 @@
 
 #include <Hobgoblin/HGExcept.hpp>
 
+#include <exception>
+#include <utility>
+
 #include <Hobgoblin/Private/Pmacro_define.hpp>
 
 HOBGOBLIN_NAMESPACE_BEGIN
@@ -12,9 +15,35 @@ namespace rn {
 
 namespace {
 
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+inline bool UseNativeSocket(RN_Protocol protocol, RN_NetworkingStack networkingStack) {
+    return (networkingStack == RN_NetworkingStack::Default);
+}
+
+inline bool UseSfSocket(RN_Protocol protocol, RN_NetworkingStack networkingStack) {
+    return false;
+}
+
+RN_SocketAdapter::Status ConvertStatus(RN_NativeUdpSocket::Status aStatus) {
+    switch (aStatus) {
+    case RN_NativeUdpSocket::Status::OK:
+        return RN_SocketAdapter::Status::OK;
+
+    case RN_NativeUdpSocket::Status::NotReady:
+        return RN_SocketAdapter::Status::NotReady;
+
+    case RN_NativeUdpSocket::Status::Disconnected:
+        return RN_SocketAdapter::Status::Disconnected;
+
+    default:
+        HG_UNREACHABLE("Invalid value for RN_NativeUdpSocket::Status ({}).", (int)aStatus);
+    }
+}
+#else
 inline bool UseSfSocket(RN_Protocol protocol, RN_NetworkingStack networkingStack) {
     return (networkingStack == RN_NetworkingStack::Default);
 }
+#endif
 
 #ifdef HOBGOBLIN_RN_ZEROTIER_SUPPORT
 inline bool UseZtSocket(RN_Protocol protocol, RN_NetworkingStack networkingStack) {
@@ -27,6 +56,12 @@ RN_SocketAdapter::RN_SocketAdapter(RN_Protocol aProtocol, RN_NetworkingStack aNe
     : _protocol{aProtocol}
     , _networkingStack{aNetworkingStack}
     , _socket{0} {
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        _socket.emplace<RN_NativeUdpSocket>();
+    }
+    else
+#endif
     if (UseSfSocket(_protocol, _networkingStack)) {
         _socket.emplace<sf::UdpSocket>();
     }
@@ -42,6 +77,13 @@ RN_SocketAdapter::RN_SocketAdapter(RN_Protocol aProtocol, RN_NetworkingStack aNe
 }
 
 void RN_SocketAdapter::init(PZInteger aRecvBufferSize) {
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        socket.init(aRecvBufferSize);
+    }
+    else
+#endif
     if (UseSfSocket(_protocol, _networkingStack)) {
         auto& socket = std::get<sf::UdpSocket>(_socket);
         socket.setBlocking(false);
@@ -61,6 +103,13 @@ void RN_SocketAdapter::init(PZInteger aRecvBufferSize) {
 }
 
 void RN_SocketAdapter::bind(sf::IpAddress aIpAddress, std::uint16_t aLocalPort) {
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        socket.bind(aIpAddress.toInteger(), aLocalPort);
+    }
+    else
+#endif
     if (UseSfSocket(_protocol, _networkingStack)) {
         auto& socket = std::get<sf::UdpSocket>(_socket);
         if (socket.bind(aLocalPort, aIpAddress) != sf::Socket::Done) {
@@ -84,12 +133,24 @@ RN_SocketAdapter::Status RN_SocketAdapter::send(util::Packet&        aPacket,
     if (aPacket.getDataSize() == 0u)
         return Status::OK;
 
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        return ConvertStatus(socket.send(aPacket.getData(),
+                                         static_cast<PZInteger>(aPacket.getDataSize()),
+                                         aTargetAddress.toInteger(),
+                                         aTargetPort));
+    }
+    else
+#endif
     if (UseSfSocket(_protocol, _networkingStack)) {
         auto& socket = std::get<sf::UdpSocket>(_socket);
 
+        _telemetry.sendCallCount += 1;
         switch (
             socket.send(aPacket.getData(), pztos(aPacket.getDataSize()), aTargetAddress, aTargetPort)) {
         case sf::Socket::Done:
+            _telemetry.sentDatagramCount += 1;
             return Status::OK;
 
         case sf::Socket::NotReady:
@@ -125,6 +186,7 @@ RN_SocketAdapter::Status RN_SocketAdapter::send(util::Packet&        aPacket,
             return Status::NotReady;
         }
 
+        _telemetry.sendCallCount += 1;
         const auto res = socket.sendTo(aPacket.getData(),
                                        aPacket.getDataSize(),
                                        zt::IpAddress::ipv4FromString(aTargetAddress.toString()),
@@ -133,6 +195,7 @@ RN_SocketAdapter::Status RN_SocketAdapter::send(util::Packet&        aPacket,
             HG_THROW_TRACED(TracedRuntimeError, res.getError().errorCode, res.getError().message);
         }
 
+        _telemetry.sentDatagramCount += 1;
         return Status::OK;
     }
 #endif
@@ -145,9 +208,23 @@ RN_SocketAdapter::Status RN_SocketAdapter::send(util::Packet&        aPacket,
 RN_SocketAdapter::Status RN_SocketAdapter::recv(util::Packet&  aPacket,
                                                 sf::IpAddress& aRemoteAddress,
                                                 std::uint16_t& aRemotePort) {
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+
+        std::uint32_t remoteAddress = 0;
+        const auto    status        = socket.recv(aPacket, remoteAddress, aRemotePort);
+        if (status == RN_NativeUdpSocket::Status::OK) {
+            aRemoteAddress = sf::IpAddress{remoteAddress};
+        }
+        return ConvertStatus(status);
+    }
+    else
+#endif
     if (UseSfSocket(_protocol, _networkingStack)) {
         auto& socket = std::get<sf::UdpSocket>(_socket);
 
+        _telemetry.recvCallCount += 1;
         std::size_t receivedByteCount = 0;
         const auto  status            = socket.receive(_recvBuffer.data(),
                                            _recvBuffer.size(),
@@ -160,6 +237,7 @@ RN_SocketAdapter::Status RN_SocketAdapter::recv(util::Packet&  aPacket,
 
         switch (status) {
         case sf::Socket::Done:
+            _telemetry.receivedDatagramCount += 1;
             return Status::OK;
 
         case sf::Socket::NotReady:
@@ -192,6 +270,7 @@ RN_SocketAdapter::Status RN_SocketAdapter::recv(util::Packet&  aPacket,
             return Status::NotReady;
         }
 
+        _telemetry.recvCallCount += 1;
         zt::IpAddress senderIp;
         const auto    res =
             socket.receiveFrom(_recvBuffer.data(), _recvBuffer.size(), senderIp, aRemotePort);
@@ -209,6 +288,7 @@ RN_SocketAdapter::Status RN_SocketAdapter::recv(util::Packet&  aPacket,
 
         aRemoteAddress = sf::IpAddress(senderIp.toString());
 
+        _telemetry.receivedDatagramCount += 1;
         return Status::OK;
     }
 #endif
@@ -218,9 +298,48 @@ RN_SocketAdapter::Status RN_SocketAdapter::recv(util::Packet&  aPacket,
     }
 }
 
+void RN_SocketAdapter::holdSends() {
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        socket.holdSends();
+    }
+#endif
+    // Other implementations send each datagram immediately
+}
+
+RN_SocketAdapter::Status RN_SocketAdapter::flush() {
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        return ConvertStatus(socket.flush());
+    }
+#endif
+    // Other implementations send each datagram immediately
+    return Status::OK;
+}
+
+RN_Telemetry RN_SocketAdapter::collectTelemetry() {
+    RN_Telemetry telemetry = std::exchange(_telemetry, RN_Telemetry{});
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        telemetry += socket.collectTelemetry();
+    }
+#endif
+    return telemetry;
+}
+
 void RN_SocketAdapter::close() {
     // Note: This method swallows all errors as we don't expect to use the socket afterwards
 
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        socket.close();
+    }
+    else
+#endif
     if (UseSfSocket(_protocol, _networkingStack)) {
         auto& socket = std::get<sf::UdpSocket>(_socket);
         socket.unbind();
@@ -238,6 +357,13 @@ void RN_SocketAdapter::close() {
 }
 
 std::uint16_t RN_SocketAdapter::getLocalPort() const {
+#ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+    if (UseNativeSocket(_protocol, _networkingStack)) {
+        auto& socket = std::get<RN_NativeUdpSocket>(_socket);
+        return socket.getLocalPort();
+    }
+    else
+#endif
     if (UseSfSocket(_protocol, _networkingStack)) {
         auto& socket = std::get<sf::UdpSocket>(_socket);
         return socket.getLocalPort();
@@ -262,6 +388,28 @@ RN_NetworkingStack RN_SocketAdapter::getNetworkingStack() const noexcept {
     return _networkingStack;
 }
 
+///////////////////////////////////////////////////////////////////////////
+// HELD SENDS GUARD                                                      //
+///////////////////////////////////////////////////////////////////////////
+
+RN_HeldSendsGuard::RN_HeldSendsGuard(RN_SocketAdapter& aSocket)
+    : _socket{aSocket}
+    , _uncaughtExceptionCount{std::uncaught_exceptions()}
+{
+    _socket.holdSends();
+}
+
+RN_HeldSendsGuard::~RN_HeldSendsGuard() noexcept(false) {
+    if (std::uncaught_exceptions() == _uncaughtExceptionCount) {
+        _socket.flush();
+        return;
+    }
+    // Another exception is already propagating, so throwing now would terminate the program
+    try {
+        _socket.flush();
+    } catch (...) {}
+}
+
 } // namespace rn
 HOBGOBLIN_NAMESPACE_END
 
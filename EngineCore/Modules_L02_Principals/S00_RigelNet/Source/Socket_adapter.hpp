@@ -8,9 +8,12 @@
 
 #include <Hobgoblin/Common.hpp>
 #include <Hobgoblin/RigelNet/Configuration.hpp>
+#include <Hobgoblin/RigelNet/Telemetry.hpp>
 #include <Hobgoblin/Utility/Packet.hpp>
 #include <SFML/Network.hpp>
 
+#include "Native_udp_socket.hpp"
+
 #ifdef HOBGOBLIN_RN_ZEROTIER_SUPPORT
 #include <ZTCpp.hpp>
 namespace zt = jbatnozic::ztcpp;
@@ -30,6 +33,8 @@ namespace rn {
 //! For now, always constructs an UDP socket, regardless of specified protocol (TODO)
 //! All function calls throw only on errors from which RigelNet cannot recover. Otherwise
 //! they return an appropriate status code.
+//! With the default networking stack, RN_NativeUdpSocket (which can receive and send many
+//! datagrams per system call) is used where it's supported (Linux), and SFML's socket otherwise.
 class RN_SocketAdapter {
 public:
     enum class Status {
@@ -64,6 +69,19 @@ public:
                 sf::IpAddress& aRemoteAddress, 
                 std::uint16_t& aRemotePort);
 
+    //! Until flush() is called, datagrams passed to send() may be held back so that they can be
+    //! sent together, in fewer system calls (does nothing if the implementation doesn't support it).
+    void holdSends();
+
+    //! Send all the datagrams held back since holdSends() was called, and stop holding them back.
+    //! Datagrams which can't be sent at the moment are dropped (see send()).
+    //! Throws TracedRuntimeError or TracedLogicError on unrecoverable error.
+    Status flush();
+
+    //! Returns the datagram and system call counts (only those fields of RN_Telemetry are set)
+    //! accumulated since the last call, and resets them.
+    RN_Telemetry collectTelemetry();
+
     //! Close the socket and destroy the underlying implementation.
     //! Does nothing if the socket isn't initialized.
     //! DON'T call any methods (except init() or getters) after close() is called!
@@ -85,6 +103,9 @@ private:
 
     std::variant<
         int, // Dummy
+    #ifdef HOBGOBLIN_RN_NATIVE_UDP_SUPPORT
+        RN_NativeUdpSocket,
+    #endif
         sf::UdpSocket,
     #ifdef HOBGOBLIN_RN_ZEROTIER_SUPPORT
         zt::Socket
@@ -93,6 +114,27 @@ private:
 
     //! Used to 'catch' data received by sockets
     std::vector<std::uint8_t> _recvBuffer;
+
+    //! Datagram and system call counts (for implementations which don't count them themselves)
+    RN_Telemetry _telemetry;
+};
+
+//! Calls holdSends() on the socket when constructed and flush() when destroyed, so that the
+//! datagrams held back are sent however the scope is left.
+class RN_HeldSendsGuard {
+public:
+    explicit RN_HeldSendsGuard(RN_SocketAdapter& aSocket);
+
+    //! Throws what flush() throws, unless the scope is being left because of another exception
+    //! (in which case errors from flush() are ignored).
+    ~RN_HeldSendsGuard() noexcept(false);
+
+    RN_HeldSendsGuard(const RN_HeldSendsGuard&) = delete;
+    RN_HeldSendsGuard& operator=(const RN_HeldSendsGuard&) = delete;
+
+private:
+    RN_SocketAdapter& _socket;
+    int _uncaughtExceptionCount;
 };
 
 } // namespace rn
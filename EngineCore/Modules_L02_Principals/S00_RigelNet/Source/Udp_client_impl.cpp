@@ -159,52 +159,62 @@ RN_Telemetry RN_UdpClientImpl::_updateReceive() {
     // socket so we must not try to use it
     bool keepReceiving = !_connector.isConnectedLocally();
 
-    _connector.prepToReceive();
-    while (keepReceiving) {
-        switch (_socket.recv(packet, senderIp, senderPort)) {
-        case decltype(_socket)::Status::OK:
-            telemetry.downloadByteCount += stopz(packet.getDataSize() + UDP_HEADER_BYTE_COUNT);
-            if (senderIp == _connector.getRemoteInfo().ipAddress &&
-                senderPort == _connector.getRemoteInfo().port) {
-                _connector.receivedPacket(packet);
-            } else {
-                // handlePacketFromUnknownSender(senderIp, senderPort, packet); TODO
+    {
+        RN_HeldSendsGuard heldSends{_socket};
+        _connector.prepToReceive();
+        while (keepReceiving) {
+            switch (_socket.recv(packet, senderIp, senderPort)) {
+            case decltype(_socket)::Status::OK:
+                telemetry.downloadByteCount += stopz(packet.getDataSize() + UDP_HEADER_BYTE_COUNT);
+                if (senderIp == _connector.getRemoteInfo().ipAddress &&
+                    senderPort == _connector.getRemoteInfo().port) {
+                    _connector.receivedPacket(packet);
+                } else {
+                    // handlePacketFromUnknownSender(senderIp, senderPort, packet); TODO
+                }
+                packet.clear();
+                break;
+
+            case decltype(_socket)::Status::NotReady:
+                // Nothing left to receive for now
+                keepReceiving = false;
+                break;
+
+            case decltype(_socket)::Status::Disconnected:
+                // Normally we wouldn't expect to get this status from UDP sockets. However,
+                // in case it does somehow occur, it should be safe to ignore.
+                break;
+
+            default:
+                // Realistically these won't ever happen
+                HG_UNREACHABLE();
             }
-            packet.clear();
-            break;
-
-        case decltype(_socket)::Status::NotReady:
-            // Nothing left to receive for now
-            keepReceiving = false;
-            break;
-
-        case decltype(_socket)::Status::Disconnected:
-            // Normally we wouldn't expect to get this status from UDP sockets. However,
-            // in case it does somehow occur, it should be safe to ignore.
-            break;
-
-        default:
-            // Realistically these won't ever happen
-            HG_UNREACHABLE();
         }
-    }
 
-    if (_connector.getStatus() == RN_ConnectorStatus::Connected) {
-        _connector.receivingFinished();
-        telemetry += _connector.sendWeakAcks();
-    }
-    if (_connector.getStatus() != RN_ConnectorStatus::Disconnected) {
-        _connector.handleDataMessages(SELF, &_currentPacket);
-    }
-    if (_connector.getStatus() != RN_ConnectorStatus::Disconnected) {
-        _connector.checkForTimeout();
+        if (_connector.getStatus() == RN_ConnectorStatus::Connected) {
+            _connector.receivingFinished();
+            telemetry += _connector.sendWeakAcks();
+        }
+        if (_connector.getStatus() != RN_ConnectorStatus::Disconnected) {
+            _connector.handleDataMessages(SELF, &_currentPacket);
+        }
+        if (_connector.getStatus() != RN_ConnectorStatus::Disconnected) {
+            _connector.checkForTimeout();
+        }
     }
+    telemetry += _socket.collectTelemetry();
 
     return telemetry;
 }
 
 RN_Telemetry RN_UdpClientImpl::_updateSend() {
-    return _connector.sendData();
+    RN_Telemetry telemetry;
+    {
+        RN_HeldSendsGuard heldSends{_socket};
+        telemetry = _connector.sendData();
+    }
+    telemetry += _socket.collectTelemetry();
+    return telemetry;
 }
 
 void RN_UdpClientImpl::_compose(int receiver, const void* data, std::size_t sizeInBytes) {
@@ -9,6 +9,7 @@
 #include <Hobgoblin/Common.hpp>
 #include <Hobgoblin/HGExcept.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
@@ -19,6 +20,14 @@ namespace rn {
 
 namespace {
 constexpr auto UDP_HEADER_BYTE_COUNT = 8u;
+
+//! Used in RN_UdpServerImpl::_connectorKeys for connectors which are not indexed
+//! (keys made by MakeRemoteKey never have any of the upper 16 bits set).
+constexpr auto NO_REMOTE_KEY = ~std::uint64_t{0};
+
+std::uint64_t MakeRemoteKey(sf::IpAddress addr, std::uint16_t port) {
+    return (static_cast<std::uint64_t>(addr.toInteger()) << 16) | port;
+}
 } // namespace
 
 RN_UdpServerImpl::RN_UdpServerImpl(std::string passphrase,
@@ -33,6 +42,7 @@ RN_UdpServerImpl::RN_UdpServerImpl(std::string passphrase,
     _socket.init(_maxPacketSize);
 
     _clients.reserve(static_cast<std::size_t>(size));
+    _connectorKeys.resize(static_cast<std::size_t>(size), NO_REMOTE_KEY);
     for (PZInteger i = 0; i < size; i += 1) {
         auto connector = std::make_unique<RN_UdpConnectorImpl>(
             _socket,
@@ -68,6 +78,8 @@ void RN_UdpServerImpl::stop(bool aNotifyClients) {
             client->disconnect(aNotifyClients, "Server shutting down.");
         }
     }
+    _connectorIndex.clear();
+    std::fill(_connectorKeys.begin(), _connectorKeys.end(), NO_REMOTE_KEY);
 
     // Safe to call multiple times
     _socket.close();
@@ -93,6 +105,7 @@ void RN_UdpServerImpl::resize(PZInteger newSize) {
             _maxPacketSize);
 
         _clients.push_back(std::move(connector));
+        _connectorKeys.push_back(NO_REMOTE_KEY);
         i += 1;
     }
 }
@@ -147,6 +160,7 @@ void RN_UdpServerImpl::kickClient(PZInteger          aClientIndex,
                                   bool               aNotifyRemote,
                                   const std::string& aMessage) {
     getClientConnector(aClientIndex).disconnect(aNotifyRemote, aMessage);
+    _unindexConnectorIfDisconnected(aClientIndex);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -218,88 +232,136 @@ RN_Telemetry RN_UdpServerImpl::_updateReceive() {
     sf::IpAddress senderIp;
     std::uint16_t senderPort;
 
-    for (auto& client : _clients) {
-        client->prepToReceive();
-    }
+    {
+        // Weak acks (see below) are sent together when the socket is flushed
+        RN_HeldSendsGuard heldSends{_socket};
 
-    bool keepReceiving = true;
-    while (keepReceiving) {
-        switch (_socket.recv(packet, senderIp, senderPort)) {
-        case decltype(_socket)::Status::OK:
-            {
-                telemetry.downloadByteCount += stopz(packet.getDataSize() + UDP_HEADER_BYTE_COUNT);
-                const int senderConnectorIndex = _findConnector(senderIp, senderPort);
-
-                if (senderConnectorIndex != -1) {
-                    _senderIndex = senderConnectorIndex;
-                    _clients[senderConnectorIndex]->receivedPacket(packet);
-                }
-                else {
-                    _handlePacketFromUnknownSender(senderIp, senderPort, packet);
-                }
+        for (auto& client : _clients) {
+            client->prepToReceive();
+        }
 
-                packet.clear();
+        bool keepReceiving = true;
+        while (keepReceiving) {
+            switch (_socket.recv(packet, senderIp, senderPort)) {
+            case decltype(_socket)::Status::OK:
+                {
+                    telemetry.downloadByteCount += stopz(packet.getDataSize() + UDP_HEADER_BYTE_COUNT);
+                    const int senderConnectorIndex = _findConnector(senderIp, senderPort);
+
+                    if (senderConnectorIndex != -1) {
+                        _senderIndex = senderConnectorIndex;
+                        _clients[senderConnectorIndex]->receivedPacket(packet);
+                        _unindexConnectorIfDisconnected(senderConnectorIndex);
+                    }
+                    else {
+                        _handlePacketFromUnknownSender(senderIp, senderPort, packet);
+                    }
+
+                    packet.clear();
+                }
+                break;
+
+            case decltype(_socket)::Status::NotReady:
+                // Nothing left to receive for now
+                keepReceiving = false;
+                break;
+
+            case decltype(_socket)::Status::Disconnected:
+                // Normally we wouldn't expect to get this status from UDP sockets. However,
+                // in case it does somehow occur, it should be safe to ignore.
+                NO_OP();
+                break;
+
+            default:
+                // Realistically these won't ever happen
+                HG_UNREACHABLE();
             }
-            break;
-
-        case decltype(_socket)::Status::NotReady:
-            // Nothing left to receive for now
-            keepReceiving = false;
-            break;
-
-        case decltype(_socket)::Status::Disconnected:
-            // Normally we wouldn't expect to get this status from UDP sockets. However,
-            // in case it does somehow occur, it should be safe to ignore.
-            NO_OP();
-            break;
-
-        default:
-            // Realistically these won't ever happen
-            HG_UNREACHABLE();
         }
-    }
 
-    for (PZInteger i = 0; i < getSize(); i += 1) {
-        auto& client = _clients[i];
+        for (PZInteger i = 0; i < getSize(); i += 1) {
+            auto& client = _clients[i];
         
-        if (client->getStatus() == RN_ConnectorStatus::Connected) {
-            client->receivingFinished();
-            telemetry += client->sendWeakAcks();
-        }
-        if (client->getStatus() != RN_ConnectorStatus::Disconnected) {
-            _senderIndex = i;
-            client->handleDataMessages(SELF, &_currentPacket);
-        }
-        if (client->getStatus() != RN_ConnectorStatus::Disconnected) {
-            client->checkForTimeout();
+            if (client->getStatus() == RN_ConnectorStatus::Connected) {
+                client->receivingFinished();
+                telemetry += client->sendWeakAcks();
+            }
+            if (client->getStatus() != RN_ConnectorStatus::Disconnected) {
+                _senderIndex = i;
+                client->handleDataMessages(SELF, &_currentPacket);
+            }
+            if (client->getStatus() != RN_ConnectorStatus::Disconnected) {
+                client->checkForTimeout();
+            }
+            // Also catches connectors disconnected through getClientConnector() since the last update
+            _unindexConnectorIfDisconnected(i);
         }
+        _senderIndex = -1;
     }
-    _senderIndex = -1;
+    telemetry += _socket.collectTelemetry();
 
     return telemetry;
 }
 
 RN_Telemetry RN_UdpServerImpl::_updateSend() {
     RN_Telemetry telemetry;
-    for (auto& client : _clients) {
-        if (client->getStatus() == RN_ConnectorStatus::Disconnected) {
-            continue;
+    {
+        RN_HeldSendsGuard heldSends{_socket};
+        for (auto& client : _clients) {
+            if (client->getStatus() == RN_ConnectorStatus::Disconnected) {
+                continue;
+            }
+            telemetry += client->sendData();
         }
-        telemetry += client->sendData();
     }
+    telemetry += _socket.collectTelemetry();
     return telemetry;
 }
 
 int RN_UdpServerImpl::_findConnector(sf::IpAddress addr, std::uint16_t port) const {
-    for (int i = 0; i < getSize(); i += 1) {
-        const auto& remote = getClientConnector(i).getRemoteInfo();
-        if (remote.port == port && remote.ipAddress == addr) {
-            return i;
-        }
+    const auto iter = _connectorIndex.find(MakeRemoteKey(addr, port));
+    if (iter == _connectorIndex.end()) {
+        return -1;
+    }
+
+    // The connector could have been disconnected (and its remote info reset) since it was indexed,
+    // without the index being updated yet
+    const auto& remote = getClientConnector(iter->second).getRemoteInfo();
+    if (remote.port == port && remote.ipAddress == addr) {
+        return iter->second;
     }
     return -1;
 }
 
+void RN_UdpServerImpl::_indexConnector(PZInteger clientIndex) {
+    _unindexConnector(clientIndex);
+
+    const auto& remote = getClientConnector(clientIndex).getRemoteInfo();
+    const auto  key    = MakeRemoteKey(remote.ipAddress, remote.port);
+
+    _connectorIndex[key]        = clientIndex;
+    _connectorKeys[clientIndex] = key;
+}
+
+void RN_UdpServerImpl::_unindexConnector(PZInteger clientIndex) {
+    const auto key = _connectorKeys[clientIndex];
+    if (key == NO_REMOTE_KEY) {
+        return;
+    }
+
+    // The key could have been taken over by another connector in the meantime
+    const auto iter = _connectorIndex.find(key);
+    if (iter != _connectorIndex.end() && iter->second == clientIndex) {
+        _connectorIndex.erase(iter);
+    }
+    _connectorKeys[clientIndex] = NO_REMOTE_KEY;
+}
+
+void RN_UdpServerImpl::_unindexConnectorIfDisconnected(PZInteger clientIndex) {
+    if (_clients[clientIndex]->getStatus() == RN_ConnectorStatus::Disconnected) {
+        _unindexConnector(clientIndex);
+    }
+}
+
 void RN_UdpServerImpl::_handlePacketFromUnknownSender(sf::IpAddress senderIp, 
                                                       std::uint16_t senderPort, 
                                                       util::Packet& packet) {
@@ -307,7 +369,10 @@ void RN_UdpServerImpl::_handlePacketFromUnknownSender(sf::IpAddress senderIp,
         auto& connector = _clients[i];
         if (connector->getStatus() == RN_ConnectorStatus::Disconnected) {
             connector->setClientIndex(i);
-            if (!connector->tryAccept(senderIp, senderPort, packet)) {
+            if (connector->tryAccept(senderIp, senderPort, packet)) {
+                _indexConnector(i);
+            }
+            else {
                 // TODO Notify of error
             }
             return;
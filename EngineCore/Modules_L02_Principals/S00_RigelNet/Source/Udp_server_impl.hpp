@@ -14,8 +14,10 @@
 #include "Udp_connector_impl.hpp"
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <Hobgoblin/Private/Pmacro_define.hpp>
@@ -106,6 +108,13 @@ private:
 
     std::vector<std::unique_ptr<RN_UdpConnectorImpl>> _clients;
 
+    //! Maps remotes (IP address and port, see `_findConnector`) to the indices of their
+    //! connectors, so that the sender of a received packet can be found without going through
+    //! all the connectors. Local connections are not indexed as they don't use the socket.
+    std::unordered_map<std::uint64_t, PZInteger> _connectorIndex;
+    //! Key under which each connector is indexed in `_connectorIndex` (if it is).
+    std::vector<std::uint64_t>                   _connectorKeys;
+
     std::string               _passphrase;
     std::chrono::microseconds _timeoutLimit = std::chrono::microseconds{0};
     RN_RetransmitPredicate    _retransmitPredicate;
@@ -117,6 +126,9 @@ private:
     RN_Telemetry _updateReceive();
     RN_Telemetry _updateSend();
     int          _findConnector(sf::IpAddress addr, std::uint16_t port) const;
+    void         _indexConnector(PZInteger clientIndex);
+    void         _unindexConnector(PZInteger clientIndex);
+    void         _unindexConnectorIfDisconnected(PZInteger clientIndex);
     void         _handlePacketFromUnknownSender(sf::IpAddress senderIp,
                                                 std::uint16_t senderPort,
                                                 util::Packet& packet);
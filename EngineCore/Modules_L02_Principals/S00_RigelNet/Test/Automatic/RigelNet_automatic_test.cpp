@@ -170,6 +170,46 @@ TEST_F(RigelNetTest, ClientConnectsAndDisconnects) {
     }
 }
 
+TEST_F(RigelNetTest, ClientCanReconnectAfterBeingKicked) {
+    const auto updateUntil = [this](const auto& aCondition) {
+        for (int i = 0; i < 20 && !aCondition(); i += 1) {
+            _server->update(RN_UpdateMode::Receive);
+            _client->update(RN_UpdateMode::Receive);
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{25});
+
+            _server->update(RN_UpdateMode::Send);
+            _client->update(RN_UpdateMode::Send);
+        }
+        return aCondition();
+    };
+    const auto bothConnected = [this]() {
+        return _server->getClientConnector(0).getStatus() == RN_ConnectorStatus::Connected &&
+               _client->getServerConnector().getStatus() == RN_ConnectorStatus::Connected;
+    };
+
+    _server->start(0);
+    _client->connect(0, sf::IpAddress::LocalHost, _server->getLocalPort());
+    ASSERT_TRUE(updateUntil(bothConnected));
+
+    _server->kickClient(0, true, "Kicked.");
+    EXPECT_EQ(_server->getClientConnector(0).getStatus(), RN_ConnectorStatus::Disconnected);
+    ASSERT_TRUE(updateUntil([this]() {
+        return _client->getServerConnector().getStatus() == RN_ConnectorStatus::Disconnected;
+    }));
+
+    // The server must find the connector of the client again once it has reconnected
+    _client->disconnect(false);
+    _client->connect(0, sf::IpAddress::LocalHost, _server->getLocalPort());
+    ASSERT_TRUE(updateUntil(bothConnected));
+
+    {
+        auto cnt = _getEventCount(*_server);
+        EXPECT_EQ(cnt.connected, 2);
+        EXPECT_EQ(cnt.disconnected, 1);
+    }
+}
+
 TEST_F(RigelNetTest, CanStopANodeMultipleTimesSafely) {
     // When not even started:
     _server->stop();
@@ -0,0 +1,126 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#define HOBGOBLIN_SHORT_NAMESPACE
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/RigelNet.hpp>
+#include <Hobgoblin/RigelNet_macros.hpp>
+using namespace hg::rn;
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr auto LOG_ID = "RigelNet.PerformanceTest";
+
+const std::string       PASS            = "beetlejuice";
+constexpr hg::PZInteger MAX_PACKET_SIZE = 200;
+constexpr hg::PZInteger ROUND_COUNT     = 200;
+
+} // namespace
+
+RN_DEFINE_RPC(BenchmarkPing, RN_ARGS(int, aValue)) {
+    (void)aValue;
+}
+
+namespace {
+
+void UpdateAll(RN_ServerInterface&                                     aServer,
+               const std::vector<std::unique_ptr<RN_ClientInterface>>& aClients,
+               RN_UpdateMode                                           aMode) {
+    aServer.update(aMode);
+    for (auto& client : aClients) {
+        client->update(aMode);
+    }
+}
+
+bool AllConnected(const RN_ServerInterface&                               aServer,
+                  const std::vector<std::unique_ptr<RN_ClientInterface>>& aClients) {
+    for (hg::PZInteger i = 0; i < aServer.getSize(); i += 1) {
+        if (aServer.getClientConnector(i).getStatus() != RN_ConnectorStatus::Connected) {
+            return false;
+        }
+    }
+    for (const auto& client : aClients) {
+        if (client->getServerConnector().getStatus() != RN_ConnectorStatus::Connected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ReceiveStats {
+    double costPerPacket;  //!< Average receive time per packet, in microseconds
+    double packetsPerCall; //!< Average number of datagrams per receive system call
+};
+
+//! Fills a server of the given size with clients (over the loopback interface), then measures
+//! how long it takes the server to receive and dispatch a round of packets in which each of
+//! the clients sends one.
+ReceiveStats MeasureReceive(hg::PZInteger aServerSize) {
+    auto server = RN_ServerFactory::createServer(RN_Protocol::UDP, PASS, aServerSize, MAX_PACKET_SIZE);
+    server->start(0);
+
+    std::vector<std::unique_ptr<RN_ClientInterface>> clients;
+    for (hg::PZInteger i = 0; i < aServerSize; i += 1) {
+        clients.push_back(RN_ClientFactory::createClient(RN_Protocol::UDP, PASS, MAX_PACKET_SIZE));
+        clients.back()->connect(0, sf::IpAddress::LocalHost, server->getLocalPort());
+    }
+
+    for (int attempt = 0; attempt < 200 && !AllConnected(*server, clients); attempt += 1) {
+        UpdateAll(*server, clients, RN_UpdateMode::Receive);
+        UpdateAll(*server, clients, RN_UpdateMode::Send);
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    HG_HARD_ASSERT(AllConnected(*server, clients));
+
+    std::chrono::steady_clock::duration totalTime{0};
+    RN_Telemetry                        telemetry;
+    for (hg::PZInteger round = 0; round < ROUND_COUNT; round += 1) {
+        for (auto& client : clients) {
+            Compose_BenchmarkPing(*client, RN_COMPOSE_FOR_ALL, round);
+            client->update(RN_UpdateMode::Send);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        telemetry += server->update(RN_UpdateMode::Receive);
+        totalTime += std::chrono::steady_clock::now() - start;
+
+        // Acknowledge the packets so that the clients don't retransmit them
+        server->update(RN_UpdateMode::Send);
+        for (auto& client : clients) {
+            client->update(RN_UpdateMode::Receive);
+        }
+    }
+
+    server->stop();
+
+    const auto us = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(totalTime);
+    return {us.count() / (static_cast<double>(ROUND_COUNT) * aServerSize),
+            telemetry.getDatagramsPerRecvCall()};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    hg::log::SetMinimalLogSeverity(hg::log::Severity::Info);
+
+    RN_IndexHandlers();
+
+    for (hg::PZInteger serverSize : {8, 32, 128, 256}) {
+        const auto stats = MeasureReceive(serverSize);
+        HG_LOG_INFO(LOG_ID,
+                    "Server size {:>3}: receiving took {:.3f}us per packet ({:.1f} packets per call).",
+                    serverSize,
+                    stats.costPerPacket,
+                    stats.packetsPerCall);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -11,6 +11,9 @@
 #include <GridGoblin/Model/Shape.hpp>
 #include <GridGoblin/Model/Sprites.hpp>
 
+#include <GridGoblin/Navigation/Hierarchical_pathfinder.hpp>
+#include <GridGoblin/Navigation/World_cost_provider.hpp>
+
 #include <GridGoblin/Rendering/Dimetric_renderer.hpp>
 #include <GridGoblin/Rendering/Drawing_order.hpp>
 #include <GridGoblin/Rendering/Rendered_object.hpp>
@@ -26,5 +29,7 @@
 
 #include <GridGoblin/World/Active_area.hpp>
 #include <GridGoblin/World/Binder.hpp>
+#include <GridGoblin/World/Chunk_network_codec.hpp>
+#include <GridGoblin/World/Raycast.hpp>
 #include <GridGoblin/World/World.hpp>
 #include <GridGoblin/World/World_config.hpp>
@@ -7,12 +7,15 @@
 #include <GridGoblin/Private/Cell_grid.hpp>
 #include <GridGoblin/Private/Cell_model_ext.hpp>
 
+#include <cstddef>
+
 namespace jbatnozic {
 namespace gridgoblin {
 
 namespace hg = jbatnozic::hobgoblin;
 
 namespace detail {
+class ChunkSnapshot;
 class ChunkStorageHandler;
 } // namespace detail
 
@@ -80,7 +83,19 @@ public:
     //! `nullptr` if no extension).
     std::unique_ptr<ChunkExtensionInterface> releaseExtension();
 
+    ///////////////////////////////////////////////////////////////////////////
+    // MEMORY                                                                //
+    ///////////////////////////////////////////////////////////////////////////
+
+    //! Returns the number of bytes of memory that the chunk takes up: its cells, plus its extension
+    //! as reported by `ChunkExtensionInterface::getResidentSize()` (if any). Returns 0 for an empty
+    //! chunk.
+    //!
+    //! \note cells which are shared with a snapshot are counted in full.
+    std::size_t getResidentSize() const;
+
 private:
+    friend class detail::ChunkSnapshot;
     friend class detail::ChunkStorageHandler;
 
     detail::CellGrid _cells;
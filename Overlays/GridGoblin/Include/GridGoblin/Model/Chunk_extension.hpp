@@ -8,6 +8,7 @@
 #include <Hobgoblin/HGExcept.hpp>
 #include <Hobgoblin/Utility/Stream.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <typeinfo>
 
@@ -66,6 +67,20 @@ public:
         HG_NOT_IMPLEMENTED();
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: MEMORY                                                          //
+    ///////////////////////////////////////////////////////////////////////////
+
+    //! Returns the number of bytes of memory that the extension instance takes up, including
+    //! whatever it allocated dynamically. It doesn't have to be exact, but it's used to decide
+    //! when chunks should be unloaded (see `WorldConfig::loadedChunkByteBudget`), so it should be
+    //! in the right ballpark. The default implementation returns 0.
+    //!
+    //! \note this is called from the thread which owns the World, every time the world is pruned.
+    virtual std::size_t getResidentSize() const {
+        return 0;
+    }
+
     ///////////////////////////////////////////////////////////////////////////
     // MARK: IDENTIFICATION                                                  //
     ///////////////////////////////////////////////////////////////////////////
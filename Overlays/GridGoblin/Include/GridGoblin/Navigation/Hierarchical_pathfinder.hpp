@@ -0,0 +1,219 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <GridGoblin/Model/Chunk_id.hpp>
+#include <GridGoblin/Private/Worker_group.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/Math.hpp>
+#include <Hobgoblin/Utility/Stream.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+struct HierarchicalPathfinderConfig {
+    //! Paths can be requested for objects of sizes between 1 and this value (inclusive). An object
+    //! of size N can pass through a cell if the cell's openness is at least N (see
+    //! `CellModel::getOpenness()`), so there is no point in making this larger than
+    //! `WorldConfig::maxCellOpenness`. Each size has its own graph, so it also shouldn't be larger
+    //! than needed.
+    hg::PZInteger maxObjectSize = 1;
+
+    //! Number of background threads which help with building the chunk graphs and answering
+    //! the requests in `update()`. If 0, all the work is done on the thread calling `update()`.
+    hg::PZInteger workerThreadCount = 0;
+
+    //! Maximal number of graphs of unloaded chunks which are kept in memory until they are saved
+    //! with `saveChunkGraph()` (after that, the oldest ones are dropped).
+    hg::PZInteger maxUnsavedGraphCount = 256;
+};
+
+//! Finds paths through a World using hierarchical pathfinding (HPA*): for each loaded chunk and
+//! object size, it maintains a small graph of the chunk's portals (runs of passable cells along
+//! its edges) with the costs of moving between them within the chunk. Paths are first found in
+//! the graph of portals, and then refined into cells one chunk (or pair of chunks) at a time, so
+//! the cost of a request depends on the number of chunks along the path rather than on the
+//! number of cells in the world.
+//!
+//! The graphs are kept up to date incrementally: only the graphs of the chunks whose cells
+//! changed (see `World::forEachCellChangeSince()`) are rebuilt.
+class HierarchicalPathfinder {
+public:
+    using RequestId = std::int64_t;
+
+    //! \throws hg::InvalidArgumentError if any of the config values is invalid.
+    HierarchicalPathfinder(const World& aWorld, const HierarchicalPathfinderConfig& aConfig = {});
+
+    //! Requests a path from cell `aStart` to cell `aEnd` for an object of size `aObjectSize`
+    //! (see `HierarchicalPathfinderConfig::maxObjectSize`). The request is answered by the next
+    //! call to `update()`.
+    //!
+    //! \throws hg::InvalidArgumentError if either of the cells is outside of the world or if the
+    //!                                  object size is not supported.
+    RequestId requestPath(hg::math::Vector2pz aStart,
+                          hg::math::Vector2pz aEnd,
+                          hg::PZInteger       aObjectSize);
+
+    //! Brings the graphs up to date with the World (rebuilding the graphs of the chunks which
+    //! changed and building the graphs of newly loaded chunks), and then answers all requests made
+    //! since the previous call. The work is spread across the worker threads, but this method
+    //! blocks until all of it is done.
+    //!
+    //! \warning must be called from the thread which owns the World, and not while it's being
+    //!          edited (the worker threads read the cells without any synchronization).
+    void update();
+
+    //! Returns `true` if the request was answered (by `update()`) and its result hasn't been taken
+    //! with `takePath()` yet.
+    bool isAnswered(RequestId aRequestId) const;
+
+    //! Takes the result of an answered request.
+    //!
+    //! \returns the cells of the path (including both the start and the end cell), or
+    //!          `std::nullopt` if there is no path through the loaded chunks.
+    //!
+    //! \throws hg::InvalidArgumentError if the request wasn't answered yet (or its result was
+    //!                                  already taken).
+    std::optional<std::vector<hg::math::Vector2pz>> takePath(RequestId aRequestId);
+
+    //! Shorthand for `requestPath()` + `update()` + `takePath()`.
+    std::optional<std::vector<hg::math::Vector2pz>> findPath(hg::math::Vector2pz aStart,
+                                                             hg::math::Vector2pz aEnd,
+                                                             hg::PZInteger       aObjectSize);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: PERSISTENCE                                                     //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Building the graph of a chunk is much more expensive than checking if a previously built
+    // one still matches the chunk's cells, so the graphs can be persisted alongside the chunks:
+    // call `saveChunkGraph()` from `ChunkExtensionInterface::serialize()` and `loadChunkGraph()`
+    // from `ChunkExtensionInterface::deserialize()`. Both are safe to call from any thread (which
+    // is needed because chunks are serialized by the I/O threads of the chunk spooler).
+
+    //! Writes the graph of the chunk (if there is an up to date one, including for a chunk which
+    //! was recently unloaded) to `aOStream`.
+    void saveChunkGraph(ChunkId aChunkId, hg::util::OutputStream& aOStream);
+
+    //! Reads a graph written by `saveChunkGraph()`. It will be used instead of building a new one
+    //! when the chunk is loaded, unless the chunk's cells don't match it anymore.
+    //!
+    //! \throws hg::util::StreamReadError if the data in the stream is not valid (including if it
+    //!                                   was written by a different format version).
+    void loadChunkGraph(ChunkId aChunkId, hg::util::InputStream& aIStream);
+
+    struct Stats {
+        //! Number of chunk graphs which were built from scratch.
+        std::int64_t builtGraphCount = 0;
+        //! Number of chunk graphs which were taken from persisted data (see `loadChunkGraph()`).
+        std::int64_t reusedGraphCount = 0;
+        //! Number of chunk graphs which were dropped because the cells of their chunks changed.
+        std::int64_t invalidatedGraphCount = 0;
+        //! Number of answered requests.
+        std::int64_t answeredRequestCount = 0;
+    };
+
+    //! Returns the statistics accumulated over all calls to `update()` so far.
+    Stats getStats() const;
+
+private:
+    // ===== Graphs =====
+
+    //! A run of consecutive passable cells along one edge of a chunk, which is connected to the
+    //! run(s) on the other side of that edge (if any) that it overlaps with.
+    struct Portal {
+        hg::math::Vector2pz cell;     //!< Cell in the middle of the run
+        std::uint8_t        side;     //!< Edge of the chunk (see `Side` in the .cpp file)
+        std::int32_t        runStart; //!< First cell of the run (X for top/bottom, Y for left/right)
+        std::int32_t        runEnd;   //!< Last cell of the run (X for top/bottom, Y for left/right)
+    };
+
+    struct SizeClassGraph {
+        std::vector<Portal> portals;
+        //! Cost of moving from portal `i` to portal `j` within the chunk is at index
+        //! `i * portals.size() + j` (negative if it isn't possible).
+        std::vector<float> costs;
+    };
+
+    struct ChunkGraph {
+        //! Hash of the openness values of the chunk's cells which the graph was built from.
+        std::uint64_t               fingerprint;
+        std::vector<SizeClassGraph> sizeClasses; //!< Index = object size - 1
+    };
+
+    using ChunkGraphPtr = std::shared_ptr<const ChunkGraph>;
+
+    // ===== Requests =====
+
+    struct Request {
+        hg::math::Vector2pz start;
+        hg::math::Vector2pz end;
+        hg::PZInteger       objectSize;
+        bool                answered = false;
+
+        std::optional<std::vector<hg::math::Vector2pz>> path;
+    };
+
+    // ===== Data =====
+
+    const World&                 _world;
+    HierarchicalPathfinderConfig _config;
+    hg::PZInteger                _cellsPerChunkX;
+    hg::PZInteger                _cellsPerChunkY;
+
+    //! Graphs of loaded chunks. Only modified by `update()` (while holding `_mutex`), and read by
+    //! the workers without locking while `update()` waits for them.
+    std::unordered_map<ChunkId, ChunkGraphPtr> _chunkGraphs;
+
+    //! Cell generation of the world at which `_chunkGraphs` was last brought up to date.
+    std::uint64_t _cellGeneration = 0;
+
+    //! Protects `_chunkGraphs` (from modifications while `saveChunkGraph()` reads it),
+    //! `_unsavedGraphs` and `_loadedGraphs`.
+    mutable std::mutex _mutex;
+
+    //! Graphs of unloaded chunks which may still be saved (oldest first).
+    std::vector<std::pair<ChunkId, ChunkGraphPtr>> _unsavedGraphs;
+
+    //! Graphs read by `loadChunkGraph()`, waiting for their chunks to be integrated into the World.
+    std::unordered_map<ChunkId, ChunkGraphPtr> _loadedGraphs;
+
+    std::unordered_map<RequestId, Request> _requests;
+    std::vector<RequestId>                 _pendingRequests;
+    RequestId                              _nextRequestId = 0;
+
+    detail::WorkerGroup _workers;
+
+    Stats _stats;
+
+    // ===== Methods =====
+
+    void _invalidateChangedGraphs();
+    void _buildMissingGraphs();
+
+    std::uint64_t _calcFingerprint(ChunkId aChunkId) const;
+    ChunkGraph    _buildChunkGraph(ChunkId aChunkId, std::uint64_t aFingerprint) const;
+
+    //! \returns the cells of the path, or `std::nullopt` if there is none.
+    std::optional<std::vector<hg::math::Vector2pz>> _findPath(const Request& aRequest) const;
+
+    hg::math::Rectangle<hg::PZInteger> _getChunkBounds(ChunkId aChunkId) const;
+
+    //! Checks whether a portal read by `loadChunkGraph()` could belong to the chunk.
+    bool _isValidPortal(ChunkId aChunkId, const Portal& aPortal) const;
+};
+
+} // namespace gridgoblin
+} // namespace jbatnozic
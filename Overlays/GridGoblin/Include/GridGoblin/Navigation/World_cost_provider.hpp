@@ -0,0 +1,135 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <GridGoblin/Model/Chunk_id.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/Math.hpp>
+#include <Hobgoblin/Utility/Flow_field_calculator.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+struct WorldCostProviderConfig {
+    //! Cells with openness (see `CellModel::getOpenness()`) lower than this are impassable.
+    hg::PZInteger objectSize = 1;
+
+    //! Cost of passing through a passable cell. Must be between 1 and 254 (inclusive).
+    hg::PZInteger baseCost = 1;
+
+    //! Added to the cost of a passable cell for each of its edges which is obstructed (see
+    //! `CellModel::RIGHT_EDGE_OBSTRUCTED` and the rest), which makes flow fields keep away from
+    //! the walls when they can. The total cost is capped at 254.
+    hg::PZInteger obstructedEdgeCost = 0;
+};
+
+//! Cost provider for `hg::util::FlowFieldCalculator` and `hg::util::FlowFieldSpooler` which
+//! takes the costs from a World: cells are passable or impassable based on their openness, and
+//! cells in chunks which are not loaded are impassable.
+//!
+//! The costs are not calculated on the fly; instead, a plane of costs is kept for every loaded
+//! chunk (built by reading the cells straight from the chunk), so `getCostAt()` does no more than
+//! find the right plane and index into it. The planes are brought up to date with the World by
+//! `refresh()`.
+//!
+//! Example:
+//!     WorldCostProvider provider{world};
+//!     hg::util::FlowFieldSpooler<WorldCostProvider> spooler{{{0, &provider}}};
+//!     ...
+//!     spooler.pause();
+//!     <edit the world, load/unload chunks>
+//!     provider.refresh([&](const auto& aRect) {
+//!         <cancel and re-add the requests whose fields overlap aRect>
+//!     });
+//!     spooler.unpause();
+class WorldCostProvider {
+public:
+    //! \throws hg::InvalidArgumentError if any of the config values is invalid.
+    WorldCostProvider(const World& aWorld, const WorldCostProviderConfig& aConfig = {});
+
+    //! Returns the cost of passing through the cell at `aCell`, or `hg::util::COST_IMPASSABLE` if
+    //! it's impassable (which includes cells outside of the world and cells in unloaded chunks).
+    //!
+    //! \note the costs are as they were when `refresh()` was last called.
+    std::uint8_t getCostAt(hg::math::Vector2pz aCell) const;
+
+    using CellRect = hg::math::Rectangle<hg::PZInteger>;
+
+    //! Rebuilds the cost planes of the chunks whose cells changed since the previous call (or since
+    //! construction), and drops the planes of chunks which were unloaded. `aOnCellsChanged` (if
+    //! provided) is then called with every area of the World whose costs may have changed, so the
+    //! flow fields over them can be recalculated.
+    //!
+    //! \note if the World no longer remembers all the changes since the previous call (see
+    //!       `World::forEachCellChangeSince()`), all the planes are rebuilt and `aOnCellsChanged`
+    //!       is called only once, with a rectangle covering the whole World. A caller which
+    //!       forwards the rectangles to a `FlowFieldSpooler` will thus recalculate every field.
+    //!
+    //! \warning all readers of the costs (such as the workers of a `FlowFieldSpooler`) must be
+    //!          stopped (paused) while this is executing. It must also not be called while the
+    //!          World is being edited.
+    //!
+    //! \returns the number of rebuilt planes.
+    hg::PZInteger refresh(const std::function<void(const CellRect&)>& aOnCellsChanged = {});
+
+private:
+    const World&            _world;
+    WorldCostProviderConfig _config;
+
+    // The dimensions of the World never change, so they're cached to keep `getCostAt()` from
+    // having to go through the World for them on every call
+    hg::PZInteger _cellCountX;
+    hg::PZInteger _cellCountY;
+    hg::PZInteger _chunkCountX;
+    hg::PZInteger _chunkCountY;
+    hg::PZInteger _cellsPerChunkX;
+    hg::PZInteger _cellsPerChunkY;
+
+    //! Cost planes of chunks (row-major, index = chunk Y * chunk count X + chunk X), each being the
+    //! costs of the chunk's cells (row-major); empty for chunks which are not loaded.
+    std::vector<std::vector<std::uint8_t>> _costPlanes;
+
+    //! Cell generation of the World at which the planes were last brought up to date.
+    std::uint64_t _cellGeneration;
+
+    //! Intermediate results of `refresh()`; kept between calls so they aren't allocated each time.
+    std::vector<CellRect> _changedRectsBuffer;
+    std::vector<ChunkId>  _changedChunksBuffer;
+
+    void _rebuildCostPlane(ChunkId aChunkId);
+};
+
+///////////////////////////////////////////////////////////////////////////
+// MARK: INLINE DEFINITIONS                                              //
+///////////////////////////////////////////////////////////////////////////
+
+// This one is on the hot path of flow field calculations, so it's defined here so it can be
+// inlined into the calculator.
+inline std::uint8_t WorldCostProvider::getCostAt(hg::math::Vector2pz aCell) const {
+    if (aCell.x < 0 || aCell.x >= _cellCountX || aCell.y < 0 || aCell.y >= _cellCountY) {
+        return hg::util::COST_IMPASSABLE;
+    }
+
+    const auto chunkX = aCell.x / _cellsPerChunkX;
+    const auto chunkY = aCell.y / _cellsPerChunkY;
+    const auto& plane = _costPlanes[hg::pztos(chunkY * _chunkCountX + chunkX)];
+    if (plane.empty()) {
+        return hg::util::COST_IMPASSABLE;
+    }
+
+    const auto localX = aCell.x - chunkX * _cellsPerChunkX;
+    const auto localY = aCell.y - chunkY * _cellsPerChunkY;
+    return plane[hg::pztos(localY * _cellsPerChunkX + localX)];
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -9,6 +9,7 @@
 #include <Hobgoblin/Common.hpp>
 #include <Hobgoblin/HGExcept.hpp>
 
+#include <algorithm>
 #include <memory>
 
 namespace jbatnozic {
@@ -20,6 +21,10 @@ namespace hg = ::jbatnozic::hobgoblin;
 //! A specialized form of a row-majow grid, made specifically to hold GridGoblin Cells.
 //! When not empty, it holds one additional cell (over width*height) - this last cell is not
 //! used in the usual way, but instead it stores a pointer to a chunk extension (if any).
+//!
+//! The cells can be shared with other grids (see `share()`), which makes it possible to take
+//! cheap snapshots of chunks: when the owner of the grid needs to modify a shared grid, it has to
+//! call `unshare()` first, which copies the cells into a buffer of its own (copy-on-write).
 class CellGrid {
 public:
     CellGrid();
@@ -43,16 +48,29 @@ public:
     CellModelExt&       getExtensionCell();
     const CellModelExt& getExtensionCell() const;
 
+    //! Returns a new grid which shares the cells with this one. Neither grid may be modified
+    //! while the cells are shared, unless `unshare()` is called on it first.
+    CellGrid share() const;
+
+    //! Returns `true` if the cells of this grid are shared with at least one other grid.
+    //! \note it's OK to call this while another thread is destroying one of the other grids; the
+    //!       worst that can happen is a false positive.
+    bool isShared() const noexcept;
+
+    //! If the cells of this grid are shared with any other grid, copies them into a new buffer
+    //! owned only by this grid. Otherwise, does nothing.
+    void unshare();
+
 private:
-    std::unique_ptr<CellModelExt[]> _data   = nullptr;
+    std::shared_ptr<CellModelExt[]> _data   = nullptr;
     hg::PZInteger                   _width  = 0;
     hg::PZInteger                   _height = 0;
 
-    static std::unique_ptr<CellModelExt[]> _makeDataPtr(hg::PZInteger width, hg::PZInteger height) {
+    static std::shared_ptr<CellModelExt[]> _makeDataPtr(hg::PZInteger width, hg::PZInteger height) {
         if (width == 0 || height == 0) {
             return nullptr;
         }
-        return std::make_unique<CellModelExt[]>(hg::ToSz(width * height + 1));
+        return std::shared_ptr<CellModelExt[]>{new CellModelExt[hg::ToSz(width * height + 1)]()};
     }
 };
 
@@ -111,6 +129,27 @@ inline const CellModelExt& CellGrid::getExtensionCell() const {
     return const_cast<CellGrid*>(this)->getExtensionCell();
 }
 
+inline CellGrid CellGrid::share() const {
+    CellGrid result;
+    result._data   = _data;
+    result._width  = _width;
+    result._height = _height;
+    return result;
+}
+
+inline bool CellGrid::isShared() const noexcept {
+    return _data.use_count() > 1;
+}
+
+inline void CellGrid::unshare() {
+    if (!isShared()) {
+        return;
+    }
+    auto newData = _makeDataPtr(_width, _height);
+    std::copy_n(_data.get(), hg::ToSz(_width * _height + 1), newData.get());
+    _data = std::move(newData);
+}
+
 } // namespace detail
 } // namespace gridgoblin
 } // namespace jbatnozic
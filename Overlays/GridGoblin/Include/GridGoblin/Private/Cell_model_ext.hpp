@@ -59,6 +59,11 @@ public:
                                    PositionInWorld aCellTopLeft,
                                    PositionInWorld aPointOfView) const;
 
+        //! Returns `true` if `getDrawingData()` suggests `DrawingData::NONE` no matter the point of
+        //! view (until the next refresh).
+        //! \warning caling this is UB when `hasChunkExtensionPointer()` returns `true`.
+        bool isNeverDrawn() const;
+
     private:
         using DrawingDataPredicate = DrawingData (*)(float           aCellResolution,
                                                      PositionInWorld aCellTopLeft,
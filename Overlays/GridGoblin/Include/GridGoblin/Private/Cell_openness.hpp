@@ -0,0 +1,199 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <GridGoblin/Private/Cell_planes.hpp>
+
+#include <Hobgoblin/Common.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+struct RingAssessment {
+    bool hasOccupiedCells = false;
+    bool extend           = false;
+};
+
+//! Checks the cells in the ring number `aRing` around the cell at (aX, aY): ring 0 is just the
+//! cell at (aX, aY), ring 1 is the 8 cells around ring 0, ring 2 is the 16 cells around ring 1,
+//! and so on.
+//!
+//! `aIsCellSolid` must be callable as `bool(hg::PZInteger aX, hg::PZInteger aY)`, and it must
+//! handle coordinates which are outside of the world.
+template <class taIsCellSolid>
+RingAssessment AssessRing(hg::PZInteger   aX,
+                          hg::PZInteger   aY,
+                          hg::PZInteger   aRing,
+                          taIsCellSolid&& aIsCellSolid) {
+    RingAssessment result;
+
+    bool hasTopSide    = false;
+    bool hasLeftSide   = false;
+    bool hasRightSide  = false;
+    bool hasBottomSide = false;
+
+    if (aRing == 0) {
+        const bool solid = aIsCellSolid(aX, aY);
+        if (solid) {
+            result.hasOccupiedCells = true;
+        }
+        return result;
+    }
+
+    // Check top row (except corners)
+    {
+        const int y = aY - aRing;
+
+        for (int x = aX - aRing + 1; x <= aX + aRing - 1; x += 1) {
+            const bool solid = aIsCellSolid(x, y);
+            if (solid) {
+                result.hasOccupiedCells = true;
+                hasTopSide              = true;
+            }
+        }
+    }
+    // Check bottom row (except corners)
+    {
+        const int y = aY + aRing;
+
+        for (int x = aX - aRing + 1; x <= aX + aRing - 1; x += 1) {
+            const bool solid = aIsCellSolid(x, y);
+            if (solid) {
+                result.hasOccupiedCells = true;
+                hasBottomSide           = true;
+
+                // Possible early exit
+                if (hasTopSide) {
+                    return result;
+                }
+            }
+        }
+    }
+    // Check middle rows (only extremes)
+    {
+        for (int y = aY - aRing + 1; y <= aY + aRing - 1; y += 1) {
+            {
+                const int  x     = aX - aRing;
+                const bool solid = aIsCellSolid(x, y);
+                if (solid) {
+                    result.hasOccupiedCells = true;
+                    hasLeftSide             = true;
+
+                    // Possible early exit
+                    if (hasRightSide) {
+                        return result;
+                    }
+                }
+            }
+            {
+                const int  x     = aX + aRing;
+                const bool solid = aIsCellSolid(x, y);
+                if (solid) {
+                    result.hasOccupiedCells = true;
+                    hasRightSide            = true;
+
+                    // Possible early exit
+                    if (hasLeftSide) {
+                        return result;
+                    }
+                }
+            }
+        }
+    }
+    // Check corners
+    {
+        // TopLeft, TopRight, BottomLeft, BottomRight
+        const bool tl = aIsCellSolid(aX - aRing, aY - aRing);
+        const bool tr = aIsCellSolid(aX + aRing, aY - aRing);
+        const bool bl = aIsCellSolid(aX - aRing, aY + aRing);
+        const bool br = aIsCellSolid(aX + aRing, aY + aRing);
+
+        const hg::PZInteger delta = hg::ToPz(tl) + hg::ToPz(tr) + hg::ToPz(bl) + hg::ToPz(br);
+        result.hasOccupiedCells |= (delta > 0);
+
+        if (delta == 4) {
+            return result;
+        }
+
+        // clang-format off
+        if ((!tl && !hasTopSide    && !hasLeftSide)  ||
+            (!tr && !hasTopSide    && !hasRightSide) ||
+            (!bl && !hasBottomSide && !hasLeftSide)  ||
+            (!br && !hasBottomSide && !hasRightSide))
+        {
+            result.extend = true;
+            return result;
+        }
+        // clang-format on
+    }
+
+    return result;
+}
+
+//! Calculates the openness of the cell at (aX, aY) by checking successively larger rings of
+//! cells around it (see `AssessRing()`), up to `aMaxCellOpenness`. The cost of this grows with
+//! the square of `aMaxCellOpenness`.
+//!
+//! \see WorldConfig::maxCellOpenness for the definition of openness.
+template <class taIsCellSolid>
+std::uint8_t CalcOpennessByRings(hg::PZInteger   aX,
+                                 hg::PZInteger   aY,
+                                 std::uint8_t    aMaxCellOpenness,
+                                 taIsCellSolid&& aIsCellSolid) {
+    if (aMaxCellOpenness == 0) {
+        return 0;
+    }
+
+    const auto maxRing = static_cast<hg::PZInteger>((aMaxCellOpenness + 1) / 2);
+
+    for (hg::PZInteger ring = 0; ring < maxRing; ring += 1) {
+        const auto ras = AssessRing(aX, aY, ring, aIsCellSolid);
+
+        if (!ras.hasOccupiedCells) {
+            continue;
+        }
+
+        if (ring == 0) {
+            return 0; // Ring 0 - special case
+        }
+
+        return static_cast<std::uint8_t>((ring * 2) - 1 + hg::ToPz(ras.extend));
+    }
+
+    return static_cast<std::uint8_t>((maxRing * 2) - 1);
+}
+
+//! Calculates the openness of all cells in `aPlanes` which are at least `aMargin` cells away from
+//! its edges, based on its flags plane (cells with the `WALL_INITIALIZED` flag are solid), and
+//! writes it into its openness plane. The openness of the cells in the margin is set to 0. The
+//! results are identical to those of `CalcOpennessByRings()`, provided that all cells outside of
+//! the world are represented as solid in the planes.
+//!
+//! Instead of checking the rings around each cell, this goes over the planes in two linear
+//! passes: the first one calculates, for each cell, the size of the largest square with no solid
+//! cells which has that cell as its bottom-right corner (capped to `aMaxCellOpenness`), and the
+//! second one derives each cell's openness by comparing the square sizes of the cells to its
+//! bottom-right against each possible openness value (an N x N square around the cell is free
+//! exactly when the square ending at the corner of that square is at least N wide). Both passes
+//! consist of simple branch-free loops over whole rows, which the compiler can vectorize.
+//!
+//! \param aPlanes planes with both the flags and the openness plane selected.
+//! \param aMargin number of cells around the edges of the planes whose openness isn't needed;
+//!                must be at least `aMaxCellOpenness / 2`.
+//! \param aMaxCellOpenness \see WorldConfig::maxCellOpenness.
+//! \param aScratch buffer to reuse for intermediate results.
+void CalcOpennessInPlanes(CellPlanes&                aPlanes,
+                          hg::PZInteger              aMargin,
+                          std::uint8_t               aMaxCellOpenness,
+                          std::vector<std::uint8_t>& aScratch);
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,175 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <GridGoblin/Model/Cell_model.hpp>
+#include <GridGoblin/Private/Cell_model_ext.hpp>
+
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+//! Structure-of-arrays (SoA) representation of a rectangular block of cells: the flags, openness
+//! values, floors and walls of the cells are each kept in a separate contiguous plane, in row-major
+//! order. Passes which only need one or two of these (for example, calculating openness only
+//! needs the flags) can go through many more cells per cache line this way than they could by
+//! going through the cells themselves, which are about 40 bytes each.
+//!
+//! Only the planes selected when calling `reset()` are allocated and filled; accessing the others
+//! is not allowed.
+class CellPlanes {
+public:
+    enum PlaneMask : std::uint8_t {
+        FLAGS    = 0x01,
+        OPENNESS = 0x02,
+        FLOOR    = 0x04,
+        WALL     = 0x08,
+
+        ALL = FLAGS | OPENNESS | FLOOR | WALL
+    };
+
+    //! Constructs empty planes (0x0 cells, nothing selected).
+    CellPlanes() = default;
+
+    //! Resizes the planes to hold `aWidth` x `aHeight` cells and selects which of them are to be
+    //! used. Memory which is already allocated is reused whenever possible, so it's cheap to call
+    //! this repeatedly on the same object. The contents of the planes are unspecified afterwards.
+    void reset(hg::PZInteger aWidth, hg::PZInteger aHeight, std::uint8_t aPlaneMask);
+
+    hg::PZInteger getWidth() const noexcept;
+    hg::PZInteger getHeight() const noexcept;
+
+    std::uint8_t getPlaneMask() const noexcept;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: ROW ACCESS                                                      //
+    ///////////////////////////////////////////////////////////////////////////
+
+    std::uint16_t*       getFlagsRow(hg::PZInteger aY);
+    const std::uint16_t* getFlagsRow(hg::PZInteger aY) const;
+
+    std::uint8_t*       getOpennessRow(hg::PZInteger aY);
+    const std::uint8_t* getOpennessRow(hg::PZInteger aY) const;
+
+    CellModel::Floor*       getFloorRow(hg::PZInteger aY);
+    const CellModel::Floor* getFloorRow(hg::PZInteger aY) const;
+
+    CellModel::Wall*       getWallRow(hg::PZInteger aY);
+    const CellModel::Wall* getWallRow(hg::PZInteger aY) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: PLANE ACCESS                                                    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Each of the following returns a pointer to the beginning of a whole plane (width * height
+    // values, with row Y beginning at index Y * width).
+
+    const std::uint16_t*    getFlagsPlane() const;
+    const std::uint8_t*     getOpennessPlane() const;
+    const CellModel::Floor* getFloorPlane() const;
+    const CellModel::Wall*  getWallPlane() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: BULK LOADING                                                    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    //! Copies `aCount` consecutive cells, starting at `aCells`, into the selected planes, starting
+    //! at column `aX` of row `aY`.
+    void loadRow(hg::PZInteger aX, hg::PZInteger aY, const CellModelExt* aCells, hg::PZInteger aCount);
+
+    //! Fills `aCount` consecutive positions in the selected planes, starting at column `aX` of row
+    //! `aY`, as if they held cells with the given flags (and openness 0, and default-constructed
+    //! floors and walls).
+    void fillRow(hg::PZInteger aX, hg::PZInteger aY, hg::PZInteger aCount, std::uint16_t aFlags);
+
+private:
+    std::vector<std::uint16_t>    _flags;
+    std::vector<std::uint8_t>     _openness;
+    std::vector<CellModel::Floor> _floors;
+    std::vector<CellModel::Wall>  _walls;
+
+    hg::PZInteger _width     = 0;
+    hg::PZInteger _height    = 0;
+    std::uint8_t  _planeMask = 0;
+};
+
+inline hg::PZInteger CellPlanes::getWidth() const noexcept {
+    return _width;
+}
+
+inline hg::PZInteger CellPlanes::getHeight() const noexcept {
+    return _height;
+}
+
+inline std::uint8_t CellPlanes::getPlaneMask() const noexcept {
+    return _planeMask;
+}
+
+// Row access
+
+inline std::uint16_t* CellPlanes::getFlagsRow(hg::PZInteger aY) {
+    HG_ASSERT((_planeMask & FLAGS) != 0);
+    return _flags.data() + (aY * _width);
+}
+
+inline const std::uint16_t* CellPlanes::getFlagsRow(hg::PZInteger aY) const {
+    return const_cast<CellPlanes*>(this)->getFlagsRow(aY);
+}
+
+inline std::uint8_t* CellPlanes::getOpennessRow(hg::PZInteger aY) {
+    HG_ASSERT((_planeMask & OPENNESS) != 0);
+    return _openness.data() + (aY * _width);
+}
+
+inline const std::uint8_t* CellPlanes::getOpennessRow(hg::PZInteger aY) const {
+    return const_cast<CellPlanes*>(this)->getOpennessRow(aY);
+}
+
+inline CellModel::Floor* CellPlanes::getFloorRow(hg::PZInteger aY) {
+    HG_ASSERT((_planeMask & FLOOR) != 0);
+    return _floors.data() + (aY * _width);
+}
+
+inline const CellModel::Floor* CellPlanes::getFloorRow(hg::PZInteger aY) const {
+    return const_cast<CellPlanes*>(this)->getFloorRow(aY);
+}
+
+inline CellModel::Wall* CellPlanes::getWallRow(hg::PZInteger aY) {
+    HG_ASSERT((_planeMask & WALL) != 0);
+    return _walls.data() + (aY * _width);
+}
+
+inline const CellModel::Wall* CellPlanes::getWallRow(hg::PZInteger aY) const {
+    return const_cast<CellPlanes*>(this)->getWallRow(aY);
+}
+
+// Plane access
+
+inline const std::uint16_t* CellPlanes::getFlagsPlane() const {
+    return getFlagsRow(0);
+}
+
+inline const std::uint8_t* CellPlanes::getOpennessPlane() const {
+    return getOpennessRow(0);
+}
+
+inline const CellModel::Floor* CellPlanes::getFloorPlane() const {
+    return getFloorRow(0);
+}
+
+inline const CellModel::Wall* CellPlanes::getWallPlane() const {
+    return getWallRow(0);
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -7,11 +7,21 @@
 
 #include <GridGoblin/Model/Chunk.hpp>
 #include <GridGoblin/Model/Chunk_id.hpp>
+#include <GridGoblin/Private/Chunk_runtime_cache.hpp>
 #include <GridGoblin/Private/Model_conversions.hpp>
+#include <GridGoblin/Private/Region_file.hpp>
 #include <GridGoblin/World/World_config.hpp>
 
+#include <Hobgoblin/Utility/Stream.hpp>
+
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -21,7 +31,17 @@ class Binder;
 
 namespace detail {
 
-//! Default disk I/O handles for chunks which stores each chunk as a single textual file.
+//! Default disk I/O handles for chunks which stores each chunk as a single file (in the binary
+//! chunk format by default, or as JSON if `WorldConfig::storeChunksAsJson` is set), or packs
+//! them into region files (see `WorldConfig::chunksPerRegionX`).
+//!
+//! Chunks stored in the runtime cache are kept in memory, in serialized form, in a LRU cache
+//! limited by `WorldConfig::runtimeCacheByteLimit`. They are written to disk only when they are
+//! evicted from it, when `dumpRuntimeCache()` is called, or when the handler is destroyed.
+//!
+//! All methods are thread-safe. Serialization and parsing of chunks are done outside of the
+//! internal lock, so several threads (for example, multiple chunk spooler workers) can load or
+//! store chunks concurrently; only the accesses to the cache and to the files are serialized.
 class DefaultChunkDiskIoHandler : public ChunkDiskIoHandlerInterface {
 public:
     DefaultChunkDiskIoHandler(const WorldConfig& aConfig);
@@ -30,7 +50,7 @@ public:
 
     void setBinder(Binder* aBinder) override;
 
-    std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId) override;
+    std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId, bool& aIsUnsaved) override;
 
     void storeChunkInRuntimeCache(const Chunk& aChunk, ChunkId aChunkId) override;
 
@@ -40,16 +60,63 @@ public:
 
     void dumpRuntimeCache() override;
 
-    // TODO: delete runtime cache
+    //! Returns the statistics of the runtime cache (hit rate, current size, etc.).
+    ChunkRuntimeCache::Stats getRuntimeCacheStats() const;
 
 private:
+    mutable std::mutex _mutex;
+
     Binder* _binder = nullptr;
 
-    ReusableConversionBuffers* _reusableConversionBuffers = nullptr;
+    //! Conversion buffers which are currently not in use by any thread.
+    std::vector<ReusableConversionBuffers*> _conversionBufferPool;
+
+    ChunkRuntimeCache _runtimeCache;
 
     std::filesystem::path _basePath;
 
+    bool _storeChunksAsJson;
+
+    // ===== Region files
+
+    struct OpenRegionFile {
+        std::unique_ptr<RegionFile> file;
+        std::int64_t                lastUseTick;
+    };
+
+    //! Maps region coordinates -> open region file.
+    std::unordered_map<ChunkId, OpenRegionFile> _regionFiles;
+
+    std::int64_t _regionFileUseTick = 0;
+
+    hg::PZInteger _chunksPerRegionX;
+    hg::PZInteger _chunksPerRegionY;
+
+    bool _usesRegionFiles() const {
+        return _chunksPerRegionX > 0;
+    }
+
+    //! Returns the region file holding the given chunk, opening it if needed (which might
+    //! close some other region file if too many are open).
+    RegionFile& _getRegionFile(ChunkId aChunkId);
+
+    // ===== Methods
+
     std::filesystem::path _buildPathToChunk(ChunkId aChunkId) const;
+    std::filesystem::path _buildPathToRegion(ChunkId aRegionId) const;
+
+    //! Takes a set of conversion buffers from the pool (or creates a new one if the pool is
+    //! empty) and returns it to the pool when destroyed. Locks the mutex internally.
+    class ConversionBuffersLease;
+
+    //! Serializes the chunk into `aOutputBuffer` in the format that is used on disk.
+    //! \note doesn't lock the mutex.
+    void _serializeChunk(const Chunk& aChunk, hg::util::BufferStream& aOutputBuffer);
+
+    //! \note doesn't lock the mutex.
+    Chunk _deserializeChunk(ChunkId aChunkId, const void* aData, std::int64_t aByteCount);
+
+    void _writeChunkFile(ChunkId aChunkId, const void* aData, std::int64_t aByteCount);
 };
 
 } // namespace detail
@@ -16,13 +16,23 @@ class Binder;
 
 namespace detail {
 
+//! Interface for a class which reads chunks from and writes them to the runtime and persistent
+//! caches on behalf of the chunk spooler.
+//!
+//! \warning implementations must be thread-safe: with `WorldConfig::chunkSpoolerWorkerCount`
+//!          greater than 1, the spooler's workers call these methods concurrently. The methods
+//!          which take a chunk ID are never called for the same chunk at the same time, but
+//!          `dumpRuntimeCache()` can be called while any of them is in progress.
 class ChunkDiskIoHandlerInterface {
 public:
     virtual ~ChunkDiskIoHandlerInterface() = default;
 
     virtual void setBinder(Binder* aBinder) = 0;
 
-    virtual std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId) = 0;
+    //! Loads the chunk from the runtime cache, if it's there. `aIsUnsaved` is set to `true` if the
+    //! cached state of the chunk wasn't yet written to the persistent cache, and to `false`
+    //! otherwise (it's left unchanged if the chunk isn't found).
+    virtual std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId, bool& aIsUnsaved) = 0;
 
     virtual void storeChunkInRuntimeCache(const Chunk& aChunk, ChunkId aChunkId) = 0;
 
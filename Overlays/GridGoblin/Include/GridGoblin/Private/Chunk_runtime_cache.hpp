@@ -0,0 +1,119 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <GridGoblin/Model/Chunk_id.hpp>
+
+#include <Hobgoblin/Common.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+//! Bounded in-memory cache of serialized chunks, with least-recently-used eviction.
+//!
+//! The cache holds chunks which were unloaded from the World but weren't yet written to disk.
+//! Each entry is the exact sequence of bytes that would be written to the chunk's file (optionally
+//! compressed while it's held in the cache), so writing an entry out never requires the chunk to
+//! be deserialized.
+//!
+//! \warning this class is not thread-safe; the owner must synchronize access to it.
+class ChunkRuntimeCache {
+public:
+    struct Stats {
+        std::int64_t  hitCount      = 0; //!< Number of successful calls to `take()`.
+        std::int64_t  missCount     = 0; //!< Number of unsuccessful calls to `take()`.
+        std::int64_t  storeCount    = 0; //!< Number of calls to `store()`.
+        std::int64_t  evictionCount = 0; //!< Number of entries evicted to make room for others.
+        std::int64_t  writeCount    = 0; //!< Number of entries passed to the write handler.
+        std::int64_t  byteCount     = 0; //!< Number of bytes currently held (after compression).
+        std::int64_t  rawByteCount  = 0; //!< Number of bytes currently held (before compression).
+        hg::PZInteger entryCount    = 0; //!< Number of entries currently held.
+
+        //! Returns the ratio of hits to the total number of calls to `take()`, or 0.0 if there
+        //! were no such calls yet.
+        double getHitRate() const {
+            const auto total = hitCount + missCount;
+            return (total > 0) ? (static_cast<double>(hitCount) / static_cast<double>(total)) : 0.0;
+        }
+    };
+
+    //! Function that will be called with the (uncompressed) bytes of an entry that needs
+    //! to be written to the persistent storage.
+    using WriteHandler = std::function<void(ChunkId, const void*, std::int64_t)>;
+
+    //! \param aByteLimit maximum total size of all the entries in the cache. If 0, nothing will
+    //!                   ever be kept in the cache and every stored entry will be forwarded to
+    //!                   the write handler immediately.
+    //! \param aCompress  whether to keep the entries compressed while they are in the cache.
+    //!
+    //! \throws hg::InvalidArgumentError if `aByteLimit` is negative.
+    ChunkRuntimeCache(std::int64_t aByteLimit, bool aCompress);
+
+    //! Put a serialized chunk into the cache, replacing any previous entry for the same chunk.
+    //! If this makes the cache exceed its byte limit, least recently stored entries will be
+    //! evicted, and those of them that weren't yet written out will be passed to `aWriteHandler`.
+    void store(ChunkId             aChunkId,
+               const void*         aData,
+               std::int64_t        aByteCount,
+               const WriteHandler& aWriteHandler);
+
+    //! Write the (uncompressed) bytes of the entry for the given chunk into `aBytes`. If the entry
+    //! was already written out, it's removed from the cache. Otherwise, it remains in the cache
+    //! until it's replaced, erased, or written out and evicted, so that the chunk's data can't be
+    //! lost before it's persisted.
+    //!
+    //! \param aIsUnwritten if not `nullptr` and an entry is found, set to `true` if the entry
+    //!                     wasn't yet written out, and to `false` otherwise.
+    //!
+    //! \returns `true` if an entry was found, `false` otherwise (`aBytes` is unchanged then).
+    bool take(ChunkId aChunkId, std::string& aBytes, bool* aIsUnwritten = nullptr);
+
+    //! Discard the entry for the given chunk, if any, without writing it out.
+    void erase(ChunkId aChunkId);
+
+    //! Pass all entries which weren't yet written out to `aWriteHandler`. The entries remain
+    //! in the cache, but they won't be written out again on eviction unless they are replaced.
+    void flush(const WriteHandler& aWriteHandler);
+
+    Stats getStats() const {
+        return _stats;
+    }
+
+private:
+    struct Entry {
+        ChunkId      chunkId;
+        std::string  data;
+        std::int64_t rawByteCount;
+        bool         isWritten;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    //! Most recently stored entries are at the front.
+    EntryList _entries;
+
+    std::unordered_map<ChunkId, EntryList::iterator> _index;
+
+    std::string _decompressionBuffer;
+
+    Stats _stats;
+
+    std::int64_t _byteLimit;
+    bool         _compress;
+
+    void _eraseEntry(EntryList::iterator aIter);
+    void _writeEntry(Entry& aEntry, const WriteHandler& aWriteHandler);
+    void _evictUntilWithinLimit(const WriteHandler& aWriteHandler);
+};
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
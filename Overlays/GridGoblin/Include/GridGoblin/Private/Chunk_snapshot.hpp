@@ -0,0 +1,54 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <GridGoblin/Model/Chunk.hpp>
+#include <GridGoblin/Model/Chunk_extension.hpp>
+#include <GridGoblin/Model/Chunk_id.hpp>
+#include <GridGoblin/Private/Cell_grid.hpp>
+
+#include <string>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+//! An immutable copy of the persistent contents of a chunk at some point in time, which can be
+//! stored (serialized) on another thread while the chunk itself continues to be modified.
+//!
+//! Taking a snapshot is cheap because the cells aren't copied - they are shared with the chunk
+//! until the chunk is next modified (copy-on-write, see `CellGrid::share()`). The chunk's
+//! extension, on the other hand, is serialized right away, as there's no way to share it safely.
+class ChunkSnapshot {
+public:
+    //! Takes a snapshot of a chunk.
+    //!
+    //! \warning the cells of the chunk must be unshared (see `CellGrid::unshare()`) before the chunk
+    //!          is next modified, for as long as the snapshot exists.
+    ChunkSnapshot(ChunkId aChunkId, const Chunk& aChunk);
+
+    ChunkId getChunkId() const {
+        return _chunkId;
+    }
+
+    //! Creates a new chunk with the same cells that the original chunk had when the snapshot was
+    //! taken. If the original chunk had an extension, the new chunk gets a stand-in extension
+    //! which reproduces its serialized data (so the result is only good for being stored).
+    //!
+    //! \note can be called from any thread.
+    Chunk toChunk() const;
+
+private:
+    ChunkId  _chunkId;
+    CellGrid _cells;
+
+    bool                                         _hasExtension = false;
+    ChunkExtensionInterface::SerializationMethod _extensionSerializationMethod =
+        ChunkExtensionInterface::SerializationMethod::NONE;
+    std::string _extensionData;
+};
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
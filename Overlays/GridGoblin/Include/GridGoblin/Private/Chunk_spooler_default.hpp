@@ -9,11 +9,19 @@
 
 #include <Hobgoblin/Common.hpp>
 
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
 #include <mutex>
+#include <queue>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
+#include <vector>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -23,10 +31,26 @@ namespace hg = ::jbatnozic::hobgoblin;
 
 class RequestHandleImpl;
 
+//! Default implementation of `ChunkSpoolerInterface`, which processes requests using a pool of
+//! worker threads.
+//!
+//! Load requests are processed in order of their priorities (which can be changed while the
+//! requests are pending), and unload requests are interleaved with them so that they don't pile
+//! up. At most one request per chunk is processed at any time, so an unload of a chunk is always
+//! fully finished before a subsequent load of the same chunk starts.
+//!
+//! Snapshots given to `saveChunks()` are queued together with unload requests. Each call to
+//! `saveChunks()` is finished off by a runtime cache dump, which the workers perform ahead of
+//! all other requests once all of the call's snapshots have been written.
 class DefaultChunkSpooler final : public ChunkSpoolerInterface {
 public:
-    //! Default constructor. The spooler starts unpaused.
-    DefaultChunkSpooler();
+    //! Constructor. The spooler starts unpaused.
+    //!
+    //! \param aWorkerCount number of worker threads to use for processing requests (at least 1).
+    //!
+    //! \throws hg::InvalidArgumentError if `aWorkerCount` is less than 1.
+    explicit DefaultChunkSpooler(hg::PZInteger aWorkerCount = 1);
+
     ~DefaultChunkSpooler() override;
 
     void setDiskIoHandler(ChunkDiskIoHandlerInterface* aDiskIoHandler) override;
@@ -40,8 +64,41 @@ public:
 
     hg::PZInteger unloadChunk(ChunkId aChunkId, Chunk&& aChunk) override;
 
+    std::shared_future<void> saveChunks(std::vector<ChunkSnapshot> aSnapshots) override;
+
     void dumpRuntimeCache() override;
 
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: DIAGNOSTICS                                                     //
+    ///////////////////////////////////////////////////////////////////////////
+
+    struct WorkerStats {
+        std::int64_t              loadCount   = 0; //!< Number of processed load requests.
+        std::int64_t              unloadCount = 0; //!< Number of processed unload requests.
+        std::int64_t              saveCount   = 0; //!< Number of written chunk snapshots.
+        std::chrono::microseconds busyTime{0};     //!< Total time spent processing requests.
+        std::chrono::microseconds lifetime{0};     //!< Time since the worker was started.
+
+        //! Returns the fraction of its lifetime that the worker spent processing requests.
+        double getUtilisation() const {
+            return (lifetime.count() > 0)
+                       ? (static_cast<double>(busyTime.count()) / static_cast<double>(lifetime.count()))
+                       : 0.0;
+        }
+    };
+
+    //! Returns the statistics of each of the worker threads.
+    std::vector<WorkerStats> getWorkerStats() const;
+
+    struct QueueStats {
+        hg::PZInteger loadCount   = 0; //!< Number of load requests waiting to be processed.
+        hg::PZInteger unloadCount = 0; //!< Number of unload and save requests waiting to be processed.
+    };
+
+    //! Returns the numbers of requests which are waiting to be picked up by the workers (requests
+    //! which are currently being processed are not counted).
+    QueueStats getQueueStats() const;
+
 private:
     friend class RequestHandleImpl;
 
@@ -54,43 +111,108 @@ private:
     bool _stopped = false;
 
     std::condition_variable _cv_workerSync;
+    std::condition_variable _cv_idle;
+
+    //! Progress of a single call to `saveChunks()`.
+    struct SaveJob {
+        hg::PZInteger      remainingWriteCount = 0;
+        std::exception_ptr firstError;
+        std::promise<void> promise;
+    };
+
+    using SaveJobList = std::vector<std::shared_ptr<SaveJob>>;
 
     struct UnloadRequest {
-        Chunk   chunk;
-        ChunkId id;
+        Chunk       chunk;
+        ChunkId     id;
+        SaveJobList saveJobs; //!< If not empty, the chunk goes straight to the persistent cache.
+    };
+
+    struct SaveRequest {
+        ChunkSnapshot snapshot;
+        SaveJobList   saveJobs;
     };
 
     static constexpr int UNLOAD_REQUEST_DEFAULT_PRIORITY = 10;
     static constexpr int UNLOAD_REQUEST_THRESHOLD        = 32;
     static constexpr int LOADS_PER_UNLOAD                = 2;
 
-    using RequestVariant = std::variant<std::monostate, LoadRequest, UnloadRequest>;
+    using RequestVariant = std::variant<std::monostate, LoadRequest, UnloadRequest, SaveRequest>;
 
     struct RequestControlBlock {
         RequestVariant                     request;
         std::shared_ptr<RequestHandleImpl> handle;
+        std::uint64_t                      sequence = 0; //!< Matches the latest queue entry.
     };
 
     std::unordered_map<ChunkId, RequestControlBlock> _requests;
     using RequestIter = decltype(_requests)::iterator;
 
+    // Load requests are ordered using a heap, and unload requests using a FIFO queue. Entries in
+    // them are never updated in place; instead, when a request is cancelled, processed, or its
+    // priority is changed, its entries simply become stale (their sequence numbers no longer
+    // match that of the request), and they're discarded once they're encountered.
+
+    struct QueueEntry {
+        hg::PZInteger priority;
+        std::uint64_t sequence;
+        ChunkId       chunkId;
+    };
+
+    struct LowerLoadPrecedence {
+        bool operator()(const QueueEntry& aLhs, const QueueEntry& aRhs) const {
+            return (aLhs.priority > aRhs.priority) ||
+                   (aLhs.priority == aRhs.priority && aLhs.sequence > aRhs.sequence);
+        }
+    };
+
+    // Save requests are kept in the unload queue (and counted as unload requests) as well.
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, LowerLoadPrecedence> _loadQueue;
+    std::deque<QueueEntry>                                                        _unloadQueue;
+
+    std::uint64_t _sequenceCounter = 0;
+
+    //! Chunks for which a request is currently being processed by one of the workers.
+    std::unordered_set<ChunkId> _chunksInProgress;
+
+    //! Chunks which are currently being unloaded to the runtime cache by one of the workers, with
+    //! the save jobs which were started in the meantime. Those jobs must not dump the runtime cache
+    //! before the chunks get there.
+    std::unordered_map<ChunkId, SaveJobList> _unloadsInProgress;
+
+    //! Save jobs whose chunks have all been written, but the runtime cache dump is still pending.
+    std::deque<std::shared_ptr<SaveJob>> _saveJobsAwaitingDump;
+    hg::PZInteger                        _dumpsInProgress = 0;
+
     hg::PZInteger _loadRequestCount   = 0;
     hg::PZInteger _unloadRequestCount = 0;
     int           _unloadPriority     = 0;
 
-    std::thread _worker;
+    std::vector<WorkerStats>              _workerStats;
+    std::chrono::steady_clock::time_point _startTime;
+
+    std::vector<std::thread> _workers;
 
-    void _workerBody();
+    void _workerBody(hg::PZInteger aWorkerIndex);
+    void _finishSaveJob(SaveJob& aSaveJob);
 
     std::shared_ptr<RequestHandleInterface> _onNewLoadRequest(LoadRequest aLoadRequest,
                                                               const std::unique_lock<Mutex>&);
+    void _enqueueLoadRequest(RequestControlBlock& aControlBlock, const std::unique_lock<Mutex>&);
     hg::PZInteger       _countAvailableRequests(const std::unique_lock<Mutex>&) const;
-    RequestIter         _findLoadRequestWithBestPriority(const std::unique_lock<Mutex>&);
-    RequestIter         _findAnyUnloadRequest(const std::unique_lock<Mutex>&);
+    RequestIter         _findEligibleLoadRequest(const std::unique_lock<Mutex>&);
+    RequestIter         _findEligibleUnloadRequest(const std::unique_lock<Mutex>&);
     RequestIter         _findRequestWithBestPriority(const std::unique_lock<Mutex>&);
     RequestControlBlock _eraseRequest(RequestIter aRequestIter, const std::unique_lock<Mutex>&);
+    bool                _isIdle(const std::unique_lock<Mutex>&) const;
+
+    //! Records that a chunk which was a part of the given save jobs was written (successfully
+    //! if `aError` is null). Returns `true` if any of the jobs is now awaiting a dump.
+    bool _onChunkSaved(const SaveJobList&        aSaveJobs,
+                       const std::exception_ptr& aError,
+                       const std::unique_lock<Mutex>&);
 
-    void                         _cancelLoadRequest(ChunkId aChunkId);
+    void                         _cancelLoadRequest(ChunkId aChunkId, const RequestHandleImpl* aHandle);
     std::optional<hg::PZInteger> _swapLoadRequestPriority(ChunkId aChunkId, hg::PZInteger aNewPriority);
     std::optional<hg::PZInteger> _boostLoadRequestPriority(ChunkId aChunkId, hg::PZInteger aNewPriority);
 
@@ -5,8 +5,11 @@
 
 #include <GridGoblin/Model/Chunk.hpp>
 #include <GridGoblin/Model/Chunk_id.hpp>
+#include <GridGoblin/Private/Chunk_snapshot.hpp>
 
+#include <chrono>
 #include <functional>
+#include <future>
 #include <optional>
 #include <vector>
 
@@ -73,6 +76,18 @@ public:
         //! and `false` otherwise.
         virtual bool isFinished() const = 0;
 
+        //! Blocks the calling thread until the request is finished, or until `aTimeout` elapses,
+        //! whichever comes first. Returns immediately if the request was cancelled.
+        //!
+        //! \returns `true` if the request is finished (same as `isFinished()`), `false` otherwise.
+        virtual bool waitUntilFinished(std::chrono::microseconds aTimeout) const = 0;
+
+        //! Returns `true` if the loaded chunk was restored from a state which wasn't yet written
+        //! to the persistent cache (meaning that it still has to be saved), and `false` otherwise.
+        //!
+        //! \note only meaningful once the request is finished.
+        virtual bool isChunkUnsaved() const = 0;
+
         //! Take the loaded chunk if the request was finished.
         //!
         //! \note the return value can be std::nullopt if the chunk wasn't found in
@@ -101,6 +116,23 @@ public:
     //!                                     this chunk.
     virtual hg::PZInteger unloadChunk(ChunkId aChunkId, Chunk&& aChunk) = 0;
 
+    //! Give a batch of chunk snapshots to the spooler for them to be written to the persistent
+    //! cache (eventually, depending on the spooler's internal scheduling of tasks). Once all of
+    //! them have been written, the runtime cache is dumped to the persistent cache as well.
+    //!
+    //! If a chunk is unloaded while its snapshot is still waiting to be written, the snapshot is
+    //! discarded and the unloaded chunk is written to the persistent cache in its place.
+    //!
+    //! Chunks which were unloaded, but are still waiting to be written, are written straight to
+    //! the persistent cache as a part of the save as well. Chunks which are being written to the
+    //! runtime cache at the time of the call are included through the runtime cache dump (which
+    //! waits for them).
+    //!
+    //! \returns a future which becomes ready once everything has been written. If writing any
+    //!          of the chunks or dumping the runtime cache fails, the future will hold the first
+    //!          exception that was thrown.
+    virtual std::shared_future<void> saveChunks(std::vector<ChunkSnapshot> aSnapshots) = 0;
+
     //! Save all data in the runtime cache to the persistent cache.
     //!
     //! The spooler must be paused when this is called.
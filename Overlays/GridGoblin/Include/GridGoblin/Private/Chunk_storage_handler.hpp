@@ -8,7 +8,10 @@
 #include <GridGoblin/Model/Chunk.hpp>
 #include <GridGoblin/Model/Chunk_id.hpp>
 #include <GridGoblin/Private/Cell_model_ext.hpp>
+#include <GridGoblin/Private/Cell_planes.hpp>
+#include <GridGoblin/Private/Chunk_snapshot.hpp>
 #include <GridGoblin/Private/Chunk_spooler_interface.hpp>
+#include <GridGoblin/Private/Mpsc_queue.hpp>
 #include <GridGoblin/World/Active_area.hpp>
 #include <GridGoblin/World/Binder.hpp>
 #include <GridGoblin/World/World_config.hpp>
@@ -17,8 +20,10 @@
 #include <Hobgoblin/Utility/Value_sorted_map.hpp>
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -58,9 +63,13 @@ public:
     ///////////////////////////////////////////////////////////////////////////
 
     //! Collects all chunks that were loaded since the last call to `update()`
-    //! and makes them available.
+    //! and makes them available. Only the chunks whose loading finished are looked at, so the
+    //! cost doesn't depend on how many chunks are loaded or still being loaded.
     void update();
 
+    //! Unloads chunks which aren't in any active area, least recently used first, for as long as
+    //! there are more than `WorldConfig::maxLoadedNonessentialChunks` of them, or the loaded chunks
+    //! take up more than `WorldConfig::loadedChunkByteBudget` bytes.
     void prune();
 
     ///////////////////////////////////////////////////////////////////////////
@@ -177,6 +186,102 @@ public:
         return const_cast<Self*>(this)->getCellAtUnchecked(aX, aY);
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: BULK CELL ACCESS                                                //
+    ///////////////////////////////////////////////////////////////////////////
+
+    //! Copies the cells in the rectangle with the top-left corner at (aX, aY) and the same size
+    //! as `aPlanes` into the planes selected in `aPlanes`. The rectangle may extend outside of the
+    //! world; cells which are outside of it, or which belong to chunks which aren't loaded, are
+    //! written into the planes as if they had `aMissingCellFlags` for flags (see
+    //! `CellPlanes::fillRow()`). No chunks are loaded by this method.
+    //!
+    //! \note the cells are copied one row segment (the part of a row that's in a single chunk)
+    //!       at a time, so this is much faster than getting each cell individually.
+    void copyCellsToPlanes(hg::PZInteger aX,
+                           hg::PZInteger aY,
+                           CellPlanes&   aPlanes,
+                           std::uint16_t aMissingCellFlags) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: CELL MODIFICATION                                               //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Cells must only ever be modified through the following methods, and not through the
+    // getters above, so that the cells of chunks which are shared with snapshots don't change.
+
+    //! Returns a mutable reference to the cell at (aX, aY) WITHOUT CHECKING BOUNDS, for the purpose
+    //! of editing it. The containing chunk will be loaded if it isn't already, and will be marked
+    //! as modified (see `snapshotModifiedChunks()`).
+    CellModelExt& getCellForEditingAtUnchecked(hg::PZInteger aX, hg::PZInteger aY, LOAD_IF_MISSING_Tag) {
+        const auto chunkX = aX / _chunkWidth;
+        const auto chunkY = aY / _chunkHeight;
+
+        auto& chunk = _chunks[chunkY][chunkX];
+        if (HG_UNLIKELY_CONDITION(chunk.isEmpty())) {
+            HG_UNLIKELY_BRANCH;
+            _loadChunkImmediately({chunkX, chunkY});
+        }
+        _prepareChunkForModification(chunk);
+
+        auto& isModified = _chunkModifiedFlags[chunkY][chunkX];
+        if (!isModified) {
+            isModified = true;
+            _modifiedChunks.push_back({chunkX, chunkY});
+        }
+
+        return chunk._getCellExtAtUnchecked(aX % _chunkWidth, aY % _chunkHeight);
+    }
+
+    //! Returns a mutable pointer to the cell at (aX, aY) WITHOUT CHECKING BOUNDS, for the purpose
+    //! of refreshing the values derived from its surroundings (openness, obstruction flags). If the
+    //! containing chunk isn't loaded, `nullptr` will be returned. The chunk is not marked as
+    //! modified, as these values are recalculated whenever it's loaded anyway.
+    CellModelExt* getCellForRefreshingAtUnchecked(hg::PZInteger aX, hg::PZInteger aY) {
+        const auto chunkX = aX / _chunkWidth;
+        const auto chunkY = aY / _chunkHeight;
+
+        auto& chunk = _chunks[chunkY][chunkX];
+        if (HG_UNLIKELY_CONDITION(chunk.isEmpty())) {
+            HG_UNLIKELY_BRANCH;
+            return nullptr;
+        }
+        _prepareChunkForModification(chunk);
+
+        return &(chunk._getCellExtAtUnchecked(aX % _chunkWidth, aY % _chunkHeight));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: SNAPSHOTS                                                       //
+    ///////////////////////////////////////////////////////////////////////////
+
+    //! Takes snapshots of all loaded chunks which were modified since they were loaded (or since
+    //! the last call to this method), and marks them as not modified.
+    std::vector<ChunkSnapshot> snapshotModifiedChunks();
+
+    //! Returns the number of chunks which would be returned by `snapshotModifiedChunks()`.
+    hg::PZInteger getModifiedChunkCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // MARK: DIAGNOSTICS                                                     //
+    ///////////////////////////////////////////////////////////////////////////
+
+    struct ImmediateLoadStats {
+        std::int64_t              loadCount = 0;     //!< Number of chunks loaded immediately.
+        std::chrono::microseconds blockedTime{0};    //!< Total time spent waiting for them.
+        std::chrono::microseconds maxBlockedTime{0}; //!< Longest time spent waiting for one.
+    };
+
+    //! Returns the statistics of chunks which had to be loaded immediately (because they were
+    //! accessed before they were loaded by the spooler in the background).
+    ImmediateLoadStats getImmediateLoadStats() const {
+        return _immediateLoadStats;
+    }
+
+    //! Returns the total number of bytes taken up by all loaded chunks (see
+    //! `Chunk::getResidentSize()`).
+    std::int64_t getResidentChunkByteCount() const;
+
 private:
     friend class ::jbatnozic::gridgoblin::ActiveArea;
 
@@ -190,6 +295,15 @@ private:
 
     hg::PZInteger _chunksInGridCount = 0;
 
+    // ===== Modified Chunks
+
+    //! Tells whether the chunk at the same position in `_chunks` was modified since it was loaded
+    //! or since it was last included in a snapshot.
+    hg::util::RowMajorGrid<std::uint8_t> _chunkModifiedFlags;
+
+    //! IDs of modified chunks; can contain stale entries (for which the flag is no longer set).
+    std::vector<ChunkId> _modifiedChunks;
+
     // ===== Active Chunks
 
     struct ChunkControlBlock {
@@ -203,6 +317,11 @@ private:
 
     mutable std::unordered_map<ChunkId, ChunkControlBlock> _chunkControlBlocks;
 
+    //! IDs of chunks whose load requests were finished, pushed by the spooler's threads and taken
+    //! by `update()`; can contain stale entries (for requests which were cancelled or already
+    //! taken care of).
+    MpscQueue<ChunkId> _readyChunks;
+
     // ===== Free Chunks
 
     using Timestamp = std::chrono::steady_clock::time_point;
@@ -220,16 +339,33 @@ private:
     hg::PZInteger _chunkHeight;
 
     hg::PZInteger _freeChunkLimit;
+    std::int64_t  _chunkByteBudget;
+
+    std::chrono::microseconds _immediateLoadTimeout;
+    ImmediateLoadStats        _immediateLoadStats;
 
     // ===== Methods
 
     void _loadChunkImmediately(ChunkId aChunkId);
 
-    void _onChunkLoaded(ChunkId aChunkId, Chunk&& aChunk);
+    static void _prepareChunkForModification(Chunk& aChunk) {
+        if (HG_UNLIKELY_CONDITION(aChunk._cells.isShared())) {
+            HG_UNLIKELY_BRANCH;
+            aChunk._cells.unshare();
+        }
+    }
+
+    //! `aIsUnsaved` tells whether the chunk was loaded from a state which wasn't yet written to
+    //! disk, in which case it's marked as modified.
+    void _onChunkLoaded(ChunkId aChunkId, Chunk&& aChunk, bool aIsUnsaved);
     void _createDefaultChunk(ChunkId aChunkId);
 
     void _updateChunkUsage(const std::vector<detail::ChunkUsageChange>& aChunkUsageChanges);
 
+    //! Changes the load priority of the chunk with the given ID, if it's in an active area and
+    //! still waiting to be loaded (otherwise, does nothing).
+    void _setChunkLoadPriority(ChunkId aChunkId, hg::PZInteger aLoadPriority);
+
 public:
     ///////////////////////////////////////////////////////////////////////////
     // MARK: ITERATOR                                                        //
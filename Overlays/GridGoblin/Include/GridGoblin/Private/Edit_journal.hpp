@@ -0,0 +1,164 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <GridGoblin/Model/Shape.hpp>
+#include <GridGoblin/Model/Sprites.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+//! Thrown when an edit journal can't be opened or written.
+class EditJournalError : public hg::TracedRuntimeError {
+public:
+    using hg::TracedRuntimeError::TracedRuntimeError;
+};
+
+//! Append-only log of the changes made to the cells of a World, which makes it possible to recover
+//! edits which were not saved yet (for example, if the program crashes) by replaying them.
+//!
+//! Entries are submitted from the thread which owns the World (one call per edit), and written to
+//! the file by a background thread. Whatever was submitted while the previous batch was being
+//! written, or within the commit interval after the first submission, is written together as a
+//! single batch with a single flush (group commit). Each batch carries a checksum, so a batch which
+//! was only partially written when the program was interrupted is recognized and discarded.
+//!
+//! The journal is split into segments (files). Starting a new segment marks a point up to which
+//! the journaled edits can be made redundant by saving the World; once such a save is done, the
+//! older segments can be discarded (see `startNewSegment()` and `discardSegmentsBefore()`).
+//!
+//! If writing to the journal ever fails, the journal can no longer be relied upon to hold all the
+//! edits, so from then on `flush()` throws and no segments are discarded anymore.
+//!
+//! \warning except where noted otherwise, the methods must be called from a single thread.
+class EditJournal {
+public:
+    struct Entry {
+        enum Kind : std::uint8_t {
+            SET_FLOOR,
+            RESET_FLOOR,
+            SET_WALL,
+            RESET_WALL
+        };
+
+        Kind          kind;
+        hg::PZInteger x;
+        hg::PZInteger y;
+        SpriteId      spriteId         = 0;            //!< For SET_FLOOR and SET_WALL
+        SpriteId      spriteId_reduced = 0;            //!< For SET_WALL
+        Shape         shape            = Shape::EMPTY; //!< For SET_WALL
+    };
+
+    //! Opens the journal in the given directory (creating the directory if needed), reads the
+    //! entries of all the segments which are already there (see `takeRecoveredEntries()`), and
+    //! starts a new segment for the entries which will be submitted from now on.
+    //!
+    //! \param aDirectory      directory holding the segment files.
+    //! \param aCommitInterval how long to wait for more submissions before writing a batch.
+    //!
+    //! \throws EditJournalError if the directory or the new segment can't be created.
+    EditJournal(std::filesystem::path aDirectory, std::chrono::milliseconds aCommitInterval);
+
+    //! Writes all the entries submitted so far before returning.
+    ~EditJournal();
+
+    EditJournal(const EditJournal&)            = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+    EditJournal(EditJournal&&)                 = delete;
+    EditJournal& operator=(EditJournal&&)      = delete;
+
+    //! Returns (and forgets) the entries read from the segments which existed when the journal was
+    //! opened, in the order in which they were originally submitted.
+    std::vector<Entry> takeRecoveredEntries();
+
+    //! Queues the given entries to be written by the background thread. They will be written
+    //! together (in the same batch), after all the entries submitted previously.
+    void submit(const Entry* aEntries, hg::PZInteger aEntryCount);
+
+    //! Blocks until all the submitted entries are written.
+    //!
+    //! \throws EditJournalError if writing any of the entries (now or earlier) failed.
+    void flush();
+
+    //! Writes all the submitted entries, and then starts a new segment, which will begin with
+    //! `aCarriedOverEntries` followed by the entries submitted from now on. Pass as carried over
+    //! entries those entries from the older segments which the World has not applied yet (they
+    //! would otherwise be lost when the older segments are discarded).
+    //!
+    //! \returns the index of the new segment.
+    //!
+    //! \throws EditJournalError if the new segment can't be created or written, or if writing any
+    //!                          of the entries failed earlier.
+    std::uint64_t startNewSegment(const std::vector<Entry>& aCarriedOverEntries);
+
+    //! Deletes the files of all the segments which come before the segment `aSegmentIndex`.
+    //! Does nothing if writing to the journal has failed (see `hasFailed()`).
+    void discardSegmentsBefore(std::uint64_t aSegmentIndex);
+
+    //! Returns `true` if writing to the journal has failed (can be called from any thread).
+    bool hasFailed() const {
+        return _failed.load();
+    }
+
+    //! Returns the number of bytes written to the current segment (can be called from any thread).
+    std::int64_t getCurrentSegmentByteCount() const {
+        return _currentSegmentByteCount.load();
+    }
+
+    //! Returns the number of segment files currently in the journal's directory.
+    hg::PZInteger getSegmentCount() const {
+        return static_cast<hg::PZInteger>(_segmentIndices.size());
+    }
+
+private:
+    std::filesystem::path     _directory;
+    std::chrono::milliseconds _commitInterval;
+
+    std::deque<std::uint64_t> _segmentIndices; //!< Ascending; the last one is the current one.
+    std::ofstream             _file;           //!< Current segment.
+    std::atomic<std::int64_t> _currentSegmentByteCount{0};
+    std::atomic<bool>         _failed{false};
+
+    std::vector<Entry> _recoveredEntries;
+
+    std::mutex              _mutex;
+    std::condition_variable _cv_writer;
+    std::condition_variable _cv_written;
+
+    std::vector<Entry> _pendingEntries;
+    std::uint64_t      _submittedBatchCount = 0; //!< Number of calls to `submit()`.
+    std::uint64_t      _writtenBatchCount   = 0; //!< Number of submits which were written.
+    bool               _flushRequested      = false;
+    bool               _stopped             = false;
+
+    std::thread _writer;
+
+    void _writerBody();
+
+    std::filesystem::path _getSegmentPath(std::uint64_t aSegmentIndex) const;
+    void                  _readSegment(const std::filesystem::path& aPath);
+    void                  _openSegment(std::uint64_t aSegmentIndex);
+    void                  _writeBatch(const std::vector<Entry>& aEntries);
+};
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -11,9 +11,11 @@
 
 #include <Hobgoblin/HGExcept.hpp>
 #include <Hobgoblin/Utility/Packet.hpp>
+#include <Hobgoblin/Utility/Stream.hpp>
 
 #include <rapidjson/document.h>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -23,7 +25,7 @@ namespace gridgoblin {
 namespace detail {
 
 ///////////////////////////////////////////////////////////////////////////
-// JSON CONVERSIONS (FOR PERSISTENT STORAGE)                             //
+// JSON CONVERSIONS (FOR DEBUGGING AND EXPORT)                           //
 ///////////////////////////////////////////////////////////////////////////
 
 namespace json = rapidjson;
@@ -53,7 +55,8 @@ CellModel JsonToCell(const json::Value& aJsonValue);
 
 //! Creates a JSON Document from the passed Chunk.
 //!
-//! \note Any data the chunk's cells might be extended with will NOT be included.
+//! \note The chunk's extension (if it has one) is included, unless its preferred
+//!       serialization method is `NONE`.
 json::Document ChunkToJson(const Chunk&               aChunk,
                            ReusableConversionBuffers* aReusableConversionBuffers = nullptr);
 
@@ -67,7 +70,8 @@ Chunk JsonToChunk(const json::Document&        aJsonDocument,
 //! Creates a JSON-encoded string (without whitespaces, newlines or any pretty
 //! formatting) from the passed Chunk.
 //!
-//! \note Any data the chunk's cells might be extended with will NOT be included.
+//! \note The chunk's extension (if it has one) is included, unless its preferred
+//!       serialization method is `NONE`.
 std::string ChunkToJsonString(const Chunk&               aChunk,
                               ReusableConversionBuffers* aReusableConversionBuffers = nullptr);
 
@@ -78,6 +82,41 @@ Chunk JsonStringToChunk(std::string                  aJsonString,
                         const ChunkExtensionFactory& aChunkExtensionFactory     = nullptr,
                         ReusableConversionBuffers*   aReusableConversionBuffers = nullptr);
 
+///////////////////////////////////////////////////////////////////////////
+// BINARY CONVERSIONS (FOR PERSISTENT STORAGE)                           //
+///////////////////////////////////////////////////////////////////////////
+
+class BinaryParseError : public jbatnozic::hobgoblin::TracedRuntimeError {
+public:
+    using jbatnozic::hobgoblin::TracedRuntimeError::TracedRuntimeError;
+};
+
+//! Version of the binary chunk format written by `ChunkToBinary`. Only data written in this
+//! exact version of the format can be read by `BinaryToChunk`.
+constexpr std::uint16_t BINARY_CHUNK_FORMAT_VERSION = 1;
+
+//! Returns `true` if the provided data begins with the signature of the binary chunk format
+//! (meaning it was most likely produced by `ChunkToBinary`), and `false` otherwise.
+bool IsBinaryChunkData(const void* aData, std::int64_t aByteCount);
+
+//! Writes the passed Chunk to the output stream in a compact binary format. Unlike the JSON
+//! conversions, this format preserves all cell flags and cell openness values.
+//!
+//! \note The chunk's extension (if it has one) is included, unless its preferred
+//!       serialization method is `NONE`.
+//!
+//! \throws hg::util::StreamWriteError if writing to the stream fails.
+void ChunkToBinary(const Chunk&               aChunk,
+                   hg::util::OutputStream&    aOStream,
+                   ReusableConversionBuffers* aReusableConversionBuffers = nullptr);
+
+//! Creates a Chunk by reading data in the binary chunk format from the input stream.
+//!
+//! \throws BinaryParseError if the data does not correspond to the expected format.
+Chunk BinaryToChunk(hg::util::InputStream&       aIStream,
+                    const ChunkExtensionFactory& aChunkExtensionFactory     = nullptr,
+                    ReusableConversionBuffers*   aReusableConversionBuffers = nullptr);
+
 } // namespace detail
 } // namespace gridgoblin
 } // namespace jbatnozic
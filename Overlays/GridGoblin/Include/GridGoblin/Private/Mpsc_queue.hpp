@@ -0,0 +1,118 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+//! Unbounded lock-free queue with any number of producers and a single consumer.
+//!
+//! Producers push their values onto an atomic singly-linked list (so a push is a single
+//! compare-and-swap in the common case), and the consumer takes the whole list at once with a
+//! single exchange, then reverses it so that values pushed by the same thread come out in the
+//! order in which they were pushed. Thus the cost of draining the queue depends only on the
+//! number of values in it, and producers are never blocked by the consumer.
+template <class T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+
+    MpscQueue(const MpscQueue&)            = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    MpscQueue(MpscQueue&&)                 = delete;
+    MpscQueue& operator=(MpscQueue&&)      = delete;
+
+    ~MpscQueue() {
+        _deleteList(_head.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    //! Adds a value to the queue. Can be called from any thread.
+    void push(T aValue) {
+        _pushNode(new Node{std::move(aValue), nullptr});
+    }
+
+    //! Returns `true` if the queue currently holds no values. Can be called from any thread, but
+    //! the result might be out of date by the time it's returned.
+    bool isEmpty() const {
+        return _head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    //! Removes all the values from the queue and calls `aCallback` with each of them. Values are
+    //! passed in the order in which they were pushed, as far as that order is defined (that is,
+    //! for values pushed by the same thread). Values pushed while this is executing are left for
+    //! the next call.
+    //!
+    //! If `aCallback` throws, the values which were not yet passed to it are put back into the
+    //! queue (and the exception is propagated).
+    //!
+    //! \returns the number of values which were passed to `aCallback`.
+    //!
+    //! \warning must only be called from one thread at a time (the consumer thread).
+    template <class taCallback>
+    std::size_t drain(taCallback&& aCallback) {
+        Node* list = _head.exchange(nullptr, std::memory_order_acquire);
+
+        // Reverse the list (it's ordered from the most recently pushed value)
+        Node* reversed = nullptr;
+        while (list != nullptr) {
+            Node* next = list->next;
+            list->next = reversed;
+            reversed   = list;
+            list       = next;
+        }
+
+        std::size_t count = 0;
+        while (reversed != nullptr) {
+            Node* next = reversed->next;
+            try {
+                aCallback(std::move(reversed->value));
+            } catch (...) {
+                delete reversed;
+                while (next != nullptr) {
+                    Node* node = next;
+                    next       = next->next;
+                    _pushNode(node);
+                }
+                throw;
+            }
+            delete reversed;
+            reversed = next;
+            count += 1;
+        }
+        return count;
+    }
+
+private:
+    struct Node {
+        T     value;
+        Node* next;
+    };
+
+    std::atomic<Node*> _head{nullptr}; //!< Most recently pushed node
+
+    void _pushNode(Node* aNode) {
+        aNode->next = _head.load(std::memory_order_relaxed);
+        while (!_head.compare_exchange_weak(aNode->next,
+                                            aNode,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {}
+    }
+
+    static void _deleteList(Node* aNode) {
+        while (aNode != nullptr) {
+            Node* next = aNode->next;
+            delete aNode;
+            aNode = next;
+        }
+    }
+};
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
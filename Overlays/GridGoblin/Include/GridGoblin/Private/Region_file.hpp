@@ -0,0 +1,120 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+//! Thrown when a region file can't be opened, or is found to be corrupted.
+class RegionFileError : public hg::TracedRuntimeError {
+public:
+    using hg::TracedRuntimeError::TracedRuntimeError;
+};
+
+//! A single file which holds the serialized data of a rectangular block (region) of chunks.
+//!
+//! The file starts with a header, followed by a table holding the offset and size of every chunk's
+//! data within the file. Chunk data is only ever appended to the end of the file (and then the
+//! corresponding table entry is overwritten), so data that was written earlier is never modified.
+//! This makes it possible to read directly from a memory mapping of the file. Space taken up by
+//! outdated data is reclaimed by compacting the file once there's more outdated than live data.
+//!
+//! \warning this class is not thread-safe; the owner must synchronize access to it.
+class RegionFile {
+public:
+    //! Opens the region file at the given path, or creates a new empty one if it doesn't exist.
+    //!
+    //! \param aPath         path to the file.
+    //! \param aChunkCountX  number of chunks in the region in the horizontal direction (1..256).
+    //! \param aChunkCountY  number of chunks in the region in the vertical direction (1..256).
+    //!
+    //! \throws RegionFileError if the file can't be opened or created, or if it exists but isn't
+    //!                         a valid region file with the same dimensions.
+    RegionFile(std::filesystem::path aPath, hg::PZInteger aChunkCountX, hg::PZInteger aChunkCountY);
+
+    ~RegionFile();
+
+    RegionFile(const RegionFile&)            = delete;
+    RegionFile& operator=(const RegionFile&) = delete;
+    RegionFile(RegionFile&&)                 = delete;
+    RegionFile& operator=(RegionFile&&)      = delete;
+
+    struct ChunkData {
+        const void*  data      = nullptr;
+        std::int64_t byteCount = 0;
+    };
+
+    //! Returns a view of the data of the chunk at position (aX, aY) relative to the region's origin,
+    //! or `{nullptr, 0}` if there is no data stored for this chunk.
+    //!
+    //! \warning the returned view is valid only until the next call to a non-const method.
+    ChunkData readChunk(hg::PZInteger aX, hg::PZInteger aY);
+
+    //! Stores the data of the chunk at position (aX, aY) relative to the region's origin,
+    //! replacing any previous data of this chunk. May compact the file.
+    //!
+    //! \note the data is synced to the disk before the table entry pointing to it is written, so
+    //!       after a crash the chunk holds either its previous or its new data (though the new
+    //!       table entry itself may be lost).
+    void writeChunk(hg::PZInteger aX, hg::PZInteger aY, const void* aData, std::int64_t aByteCount);
+
+    //! Rewrites the file so that it contains only the current data of every chunk.
+    void compact();
+
+    //! Returns the total size of the file, in bytes.
+    std::int64_t getFileSize() const {
+        return _fileSize;
+    }
+
+    //! Returns the number of bytes in the file taken up by outdated chunk data.
+    std::int64_t getGarbageByteCount() const {
+        return _fileSize - _headerSize - _liveByteCount;
+    }
+
+private:
+    struct TableEntry {
+        std::uint64_t offset    = 0;
+        std::uint32_t byteCount = 0;
+    };
+
+    std::filesystem::path   _path;
+    std::fstream            _file;
+    std::vector<TableEntry> _table;
+
+    hg::PZInteger _chunkCountX;
+    hg::PZInteger _chunkCountY;
+
+    std::int64_t _headerSize;
+    std::int64_t _fileSize      = 0;
+    std::int64_t _liveByteCount = 0;
+
+    // Read-only mapping of the file (might not cover its full length if it was appended to since,
+    // or might extend past its end to leave room for it to grow)
+    const char*  _mappedData = nullptr;
+    std::int64_t _mappedSize = 0;
+
+    void _open();
+    void _createNew();
+    void _encodeHeader(const std::vector<TableEntry>& aTable, std::vector<char>& aBuffer) const;
+    void _loadHeader();
+    void _writeTableEntry(hg::PZInteger aIndex);
+
+    void _map();
+    void _unmap();
+};
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
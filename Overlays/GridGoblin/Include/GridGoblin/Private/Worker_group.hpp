@@ -0,0 +1,79 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <Hobgoblin/Common.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+//! A fixed group of background threads which help the calling thread go through a batch of
+//! independent tasks (such as refreshing the cells of several chunks). The threads are started
+//! once, in the constructor, and sleep between batches.
+class WorkerGroup {
+public:
+    //! Task to be executed by `run()`. `aTaskIndex` is the index of the task in the batch, and
+    //! `aWorkerIndex` (between 0 and `getWorkerCount() - 1`) identifies the thread executing it,
+    //! so that tasks can use per-worker scratch space without synchronization (no two tasks with
+    //! the same worker index are ever executed at the same time).
+    using Task = std::function<void(hg::PZInteger aTaskIndex, hg::PZInteger aWorkerIndex)>;
+
+    //! Constructor.
+    //!
+    //! \param aBackgroundThreadCount number of threads to start. If 0, all tasks are executed on
+    //!                               the thread calling `run()`.
+    //!
+    //! \throws hg::InvalidArgumentError if `aBackgroundThreadCount` is negative.
+    explicit WorkerGroup(hg::PZInteger aBackgroundThreadCount);
+
+    ~WorkerGroup();
+
+    //! Returns the number of threads which can execute tasks (background threads + the thread
+    //! calling `run()`).
+    hg::PZInteger getWorkerCount() const;
+
+    //! Executes `aTask` for every task index between 0 and `aTaskCount - 1`, distributing the
+    //! tasks between the background threads and the calling thread, and blocks until all of them
+    //! are finished. If any of the tasks throw, the first exception is rethrown from here (after
+    //! all other tasks have finished).
+    //!
+    //! \warning must not be called from multiple threads at the same time, nor from a task.
+    void run(hg::PZInteger aTaskCount, const Task& aTask);
+
+private:
+    std::vector<std::thread> _threads;
+
+    mutable std::mutex      _mutex;
+    std::condition_variable _cv_batchStarted;
+    std::condition_variable _cv_batchFinished;
+
+    // All protected by _mutex:
+    const Task*        _task           = nullptr;
+    hg::PZInteger      _taskCount      = 0;
+    hg::PZInteger      _nextTaskIndex  = 0;
+    hg::PZInteger      _busyCount      = 0;
+    std::uint64_t      _batchId        = 0;
+    std::exception_ptr _firstException = nullptr;
+    bool               _stopped        = false;
+
+    void _threadBody(hg::PZInteger aWorkerIndex);
+
+    //! Executes tasks from the current batch until there are none left to start.
+    void _executeTasks(std::unique_lock<std::mutex>& aLock, hg::PZInteger aWorkerIndex);
+};
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <GridGoblin/Rendering/Drawing_order.hpp>
 #include <GridGoblin/Rendering/Rendered_object.hpp>
 #include <GridGoblin/Rendering/Renderer.hpp>
 #include <GridGoblin/Rendering/Visibility_provider.hpp>
@@ -12,6 +13,8 @@
 
 #include <Hobgoblin/Graphics.hpp>
 
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace jbatnozic {
@@ -33,6 +36,12 @@ struct WallReductionConfig {
 
 struct DimetricRendererConfig {
     WallReductionConfig wallReductionConfig;
+
+    //! If `true`, the floors of each visible chunk are converted to vertices once and then drawn
+    //! from that cache (in one draw call per texture) until the cells of the chunk change, instead
+    //! of being sorted and drawn one by one every frame. Walls are always prepared every frame
+    //! because they can be reduced depending on the point of view.
+    bool cacheChunkGeometry = true;
 };
 
 class DimetricRenderer : public Renderer {
@@ -53,6 +62,31 @@ public:
 
     void render(hg::gr::Canvas& aCanvas) override;
 
+    struct FrameStats {
+        //! Number of cells which were prepared as individual objects (to be sorted and drawn one
+        //! by one).
+        hg::PZInteger cellObjectCount = 0;
+
+        //! Number of vertices generated for the floors of the cells, whether they are drawn as
+        //! individual objects or put into the geometry of a chunk which is (re)built. Each floor
+        //! is counted as 4 vertices (its corners), even though the cached geometry stores it as
+        //! two triangles (6 vertices).
+        hg::PZInteger generatedVertexCount = 0;
+
+        //! Number of vertices which were taken from the cached geometry of the chunks (counted the
+        //! same way as `generatedVertexCount`).
+        hg::PZInteger cachedVertexCount = 0;
+
+        //! Number of chunks whose geometry had to be (re)built.
+        hg::PZInteger rebuiltChunkCount = 0;
+
+        //! Number of chunks within the view (with the overdraw).
+        hg::PZInteger visibleChunkCount = 0;
+    };
+
+    //! Returns the statistics of the latest call to `startPrepareToRender()`.
+    const FrameStats& getFrameStats() const;
+
 private:
     // ===== Dependencies =====
 
@@ -113,8 +147,36 @@ private:
 
     // ===== Rendered objects =====
 
+    //! Cells (already sorted by `startPrepareToRender()`) followed by the objects added through
+    //! `addObject()` (which are merged in among them by `endPrepareToRender()` - see
+    //! `dimetric::MergeObjectsIntoSortedCells()`).
     std::vector<const RenderedObject*> _objectsToRender;
 
+    dimetric::CellSortBuffer<const RenderedObject*> _cellSortBuffer;
+
+    // ===== Chunk geometry cache =====
+
+    //! Vertices (as triangles) of consecutive floors which use the same texture.
+    struct FloorBatch {
+        const hg::gr::Texture*      texture;
+        std::vector<hg::gr::Vertex> vertices;
+    };
+
+    struct ChunkGeometry {
+        std::vector<FloorBatch> floorBatches;
+        std::int64_t            lastUsedCycle;
+    };
+
+    std::unordered_map<ChunkId, ChunkGeometry> _chunkGeometry;
+
+    //! Cell generation of the world at which `_chunkGeometry` was last brought up to date.
+    std::uint64_t _chunkGeometryCellGeneration = 0;
+
+    //! Geometry of the chunks within the view, in the order in which it should be drawn.
+    std::vector<const ChunkGeometry*> _visibleChunkGeometry;
+
+    FrameStats _frameStats;
+
     // ===== Sprite cache =====
 
     mutable std::unordered_map<SpriteId, hg::gr::Sprite> _spriteCache;
@@ -132,6 +194,12 @@ private:
 
     void _prepareCells(std::int32_t aRenderFlags, const VisibilityProvider* aVisProv);
 
+    //! Drops the cached geometry of the chunks whose cells changed since it was built, and
+    //! collects (building it if needed) the geometry of the chunks within the view.
+    void _prepareChunkGeometry();
+
+    void _buildChunkGeometry(ChunkId aChunkId, ChunkGeometry& aGeometry);
+
     std::uint16_t _updateFlagsOfCellRendererMask(const CellModel& aCell);
     std::uint16_t _updateFadeValueOfCellRendererMask(const CellInfo&            aCellInfo,
                                                      const detail::DrawingData& aDrawingData,
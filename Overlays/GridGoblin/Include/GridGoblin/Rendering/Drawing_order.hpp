@@ -5,6 +5,13 @@
 
 #include <GridGoblin/Spatial/Spatial_info.hpp>
 
+#include <Hobgoblin/Common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
 namespace jbatnozic {
 namespace gridgoblin {
 namespace dimetric {
@@ -27,6 +34,277 @@ enum CheckDrawingOrderResult {
 //!       check is done to see which centre is lower on the screen.
 int CheckDrawingOrder(const SpatialInfo& aLhs, const SpatialInfo& aRhs);
 
+//! Intermediate results of `SortCellsForDrawing()` and `MergeObjectsIntoSortedCells()`; keeping
+//! them between calls means that they don't have to be allocated each time.
+template <class T>
+struct CellSortBuffer {
+    struct KeyedElement {
+        int                layer;
+        float              diagonal;
+        float              slack; //!< Half the difference between the width and the height
+        const SpatialInfo* spatialInfo;
+        T                  element;
+    };
+
+    std::vector<T>                                   cells;
+    std::vector<hg::PZInteger>                       bucketOffsets;
+    std::vector<KeyedElement>                        keyedElements;
+    std::vector<std::pair<std::size_t, std::size_t>> clusters;
+    std::vector<KeyedElement>                        clusterElements;
+    std::vector<KeyedElement>                        movedElements;
+};
+
+//! Sorts `aCells` in the order in which they should be drawn, in linear time (bucket sort). Every
+//! element must occupy exactly one cell of a grid with cells of size `aCellResolution` (like the
+//! cells of a `World` do).
+//!
+//! Elements are ordered by layer first, and then by the diagonal of the grid which they're on
+//! (`y - x`, ascending). This satisfies `CheckDrawingOrder()` for every pair of elements for which
+//! it doesn't return DOES_NOT_MATTER, and elements on the same diagonal and in the same layer (for
+//! which it always does) keep their relative order.
+//!
+//! \param aGetSpatialInfo callable which returns the `SpatialInfo` of an element of `aCells`.
+template <class T, class taGetSpatialInfo>
+void SortCellsForDrawing(std::vector<T>&    aCells,
+                         float              aCellResolution,
+                         taGetSpatialInfo&& aGetSpatialInfo,
+                         CellSortBuffer<T>& aBuffer) {
+    if (aCells.size() < 2) {
+        return;
+    }
+
+    const auto getLayerAndDiagonal = [&aGetSpatialInfo, aCellResolution](const T& aCell) {
+        const SpatialInfo& spatialInfo = aGetSpatialInfo(aCell);
+
+        const auto center = spatialInfo.getCenter();
+        const auto x      = static_cast<int>(std::floor(center->x / aCellResolution));
+        const auto y      = static_cast<int>(std::floor(center->y / aCellResolution));
+        return std::make_pair(static_cast<int>(spatialInfo.getLayer()), y - x);
+    };
+
+    auto [minLayer, minDiagonal] = getLayerAndDiagonal(aCells[0]);
+    auto maxLayer                = minLayer;
+    auto maxDiagonal             = minDiagonal;
+    for (const auto& cell : aCells) {
+        const auto [layer, diagonal] = getLayerAndDiagonal(cell);
+        minLayer                     = std::min(minLayer, layer);
+        maxLayer                     = std::max(maxLayer, layer);
+        minDiagonal                  = std::min(minDiagonal, diagonal);
+        maxDiagonal                  = std::max(maxDiagonal, diagonal);
+    }
+
+    const auto diagonalCount = maxDiagonal - minDiagonal + 1;
+    const auto bucketCount   = (maxLayer - minLayer + 1) * diagonalCount;
+    const auto getBucket     = [&](const T& aCell) {
+        const auto [layer, diagonal] = getLayerAndDiagonal(aCell);
+        return hg::pztos((layer - minLayer) * diagonalCount + (diagonal - minDiagonal));
+    };
+
+    auto& offsets = aBuffer.bucketOffsets;
+    offsets.assign(hg::pztos(bucketCount) + 1, 0);
+    for (const auto& cell : aCells) {
+        offsets[getBucket(cell) + 1] += 1;
+    }
+    for (std::size_t i = 1; i < offsets.size(); i += 1) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    aBuffer.cells.resize(aCells.size());
+    for (const auto& cell : aCells) {
+        aBuffer.cells[hg::pztos(offsets[getBucket(cell)]++)] = cell;
+    }
+
+    std::swap(aCells, aBuffer.cells);
+}
+
+namespace detail {
+//! Inserts `aObject` into `aSequence` (which must already be in a valid drawing order) so that
+//! `CheckDrawingOrder()` is satisfied for every pair involving `aObject`. If needed, the elements
+//! which have to be drawn after it (and those which have to be drawn after them) are moved past
+//! it. Unless the drawing order has a cycle, the sequence remains in a valid drawing order.
+template <class taKeyedElement>
+void InsertIntoDrawingOrder(std::vector<taKeyedElement>& aSequence,
+                            const taKeyedElement&        aObject,
+                            std::vector<taKeyedElement>& aMovedElements) {
+    const SpatialInfo& object = *aObject.spatialInfo;
+
+    // One past the last element which has to be drawn before the object, and the first element
+    // which has to be drawn after it
+    std::size_t afterLastBefore = 0;
+    std::size_t firstAfter      = aSequence.size();
+    for (std::size_t i = 0; i < aSequence.size(); i += 1) {
+        const SpatialInfo& other = *aSequence[i].spatialInfo;
+        if (CheckDrawingOrder(other, object) == DRAW_LHS_FIRST) {
+            afterLastBefore = i + 1;
+        } else if (firstAfter == aSequence.size() &&
+                   CheckDrawingOrder(object, other) == DRAW_LHS_FIRST) {
+            firstAfter = i;
+        }
+    }
+
+    if (firstAfter >= afterLastBefore) {
+        // Anywhere in between will do; stay as close as possible to where the key puts the object
+        auto position = afterLastBefore;
+        while (position < firstAfter && aSequence[position].diagonal <= aObject.diagonal) {
+            position += 1;
+        }
+        aSequence.insert(aSequence.begin() + static_cast<std::ptrdiff_t>(position), aObject);
+        return;
+    }
+
+    // The elements in [firstAfter, afterLastBefore) are rearranged into: those which can stay
+    // before the object, the object, and those which have to be moved past it (in the same
+    // relative order as before)
+    aMovedElements.clear();
+    auto keptCount = firstAfter;
+    for (auto i = firstAfter; i < afterLastBefore; i += 1) {
+        const SpatialInfo& other = *aSequence[i].spatialInfo;
+
+        bool mustMove = (CheckDrawingOrder(object, other) == DRAW_LHS_FIRST);
+        for (std::size_t t = 0; t < aMovedElements.size() && !mustMove; t += 1) {
+            mustMove = (CheckDrawingOrder(*aMovedElements[t].spatialInfo, other) == DRAW_LHS_FIRST);
+        }
+
+        if (mustMove) {
+            aMovedElements.push_back(aSequence[i]);
+        } else {
+            aSequence[keptCount] = aSequence[i];
+            keptCount += 1;
+        }
+    }
+    const auto objectIter =
+        aSequence.insert(aSequence.begin() + static_cast<std::ptrdiff_t>(keptCount), aObject);
+    std::copy(aMovedElements.begin(), aMovedElements.end(), objectIter + 1);
+}
+} // namespace detail
+
+//! Sorts the elements of `aElements` from index `aCellCount` onwards (the objects), which don't
+//! have to be aligned to the grid, and merges them in among the first `aCellCount` elements (the
+//! cells), which must already be sorted by `SortCellsForDrawing()`. The result satisfies
+//! `CheckDrawingOrder()` for every pair of elements (unless the drawing order has a cycle).
+//!
+//! Everything is ordered by layer first, and then by `y - x` of the centre (for the cells, this is
+//! the same order that `SortCellsForDrawing()` puts them in). Cells come before objects with the
+//! same key. For two elements whose keys differ by at least the sum of their 'slacks' (half the
+//! difference between the width and the height of the bounding box), `CheckDrawingOrder()` never
+//! disagrees with this order, so it's exact for square objects (like the cells). Around objects
+//! which aren't square, the elements whose keys are too close are ordered by checking
+//! `CheckDrawingOrder()` directly instead (see `detail::InsertIntoDrawingOrder()`).
+//!
+//! \param aGetSpatialInfo callable which returns the `SpatialInfo` of an element of `aElements`
+//!                        (the returned reference must remain valid during the call).
+template <class T, class taGetSpatialInfo>
+void MergeObjectsIntoSortedCells(std::vector<T>&    aElements,
+                                 std::size_t        aCellCount,
+                                 float              aCellResolution,
+                                 taGetSpatialInfo&& aGetSpatialInfo,
+                                 CellSortBuffer<T>& aBuffer) {
+    if (aElements.size() <= aCellCount) {
+        return;
+    }
+
+    using KeyedElement = typename CellSortBuffer<T>::KeyedElement;
+
+    auto& keyedElements = aBuffer.keyedElements;
+    keyedElements.clear();
+    keyedElements.reserve(aElements.size());
+    float maxSlack = 0.f;
+    for (std::size_t i = 0; i < aElements.size(); i += 1) {
+        const SpatialInfo& spatialInfo = aGetSpatialInfo(aElements[i]);
+
+        const auto center = spatialInfo.getCenter();
+        float      diagonal;
+        float      slack = 0.f;
+        if (i < aCellCount) {
+            // Calculated from the position in the grid, so that it's exactly the same for all cells
+            // on the same diagonal (otherwise rounding could leave them not quite sorted)
+            const auto x = std::floor(center->x / aCellResolution);
+            const auto y = std::floor(center->y / aCellResolution);
+            diagonal     = (y - x) * aCellResolution;
+        } else {
+            const auto& bbox = spatialInfo.getBoundingBox();
+            diagonal         = center->y - center->x;
+            slack            = std::abs(bbox.w - bbox.h) / 2.f;
+            maxSlack         = std::max(maxSlack, slack);
+        }
+        keyedElements.push_back(
+            {static_cast<int>(spatialInfo.getLayer()), diagonal, slack, &spatialInfo, aElements[i]});
+    }
+
+    // (Unlike `CheckDrawingOrder()`, this is a strict weak ordering, as sorting and merging require)
+    const auto comesBefore = [](const KeyedElement& aLhs, const KeyedElement& aRhs) {
+        return (aLhs.layer < aRhs.layer) || (aLhs.layer == aRhs.layer && aLhs.diagonal < aRhs.diagonal);
+    };
+
+    const auto cellsEnd = keyedElements.begin() + static_cast<std::ptrdiff_t>(aCellCount);
+    std::sort(cellsEnd, keyedElements.end(), comesBefore);
+    std::inplace_merge(keyedElements.begin(), cellsEnd, keyedElements.end(), comesBefore);
+
+    if (maxSlack > 0.f) {
+        // Find the ranges of elements whose keys might be too close to those of the objects which
+        // aren't square, and merge them into clusters which can be reordered independently
+        auto& clusters = aBuffer.clusters;
+        clusters.clear();
+        for (std::size_t i = 0; i < keyedElements.size(); i += 1) {
+            const auto& object = keyedElements[i];
+            if (object.slack == 0.f) {
+                continue;
+            }
+            const auto reach = object.slack + maxSlack;
+            const auto first = std::lower_bound(
+                keyedElements.begin(),
+                keyedElements.end(),
+                KeyedElement{object.layer, object.diagonal - reach, 0.f, nullptr, object.element},
+                comesBefore);
+            const auto last = std::upper_bound(
+                keyedElements.begin(),
+                keyedElements.end(),
+                KeyedElement{object.layer, object.diagonal + reach, 0.f, nullptr, object.element},
+                comesBefore);
+            clusters.emplace_back(static_cast<std::size_t>(first - keyedElements.begin()),
+                                  static_cast<std::size_t>(last - keyedElements.begin()));
+        }
+        std::sort(clusters.begin(), clusters.end());
+
+        std::size_t merged = 0;
+        for (std::size_t i = 1; i < clusters.size(); i += 1) {
+            if (clusters[i].first < clusters[merged].second) {
+                clusters[merged].second = std::max(clusters[merged].second, clusters[i].second);
+            } else {
+                merged += 1;
+                clusters[merged] = clusters[i];
+            }
+        }
+        clusters.resize(merged + 1);
+
+        // Within a cluster, the square elements (already in a valid order) are kept, and the other
+        // objects are inserted among them one by one
+        auto& clusterElements = aBuffer.clusterElements;
+        for (const auto& [first, last] : clusters) {
+            clusterElements.clear();
+            for (auto i = first; i < last; i += 1) {
+                if (keyedElements[i].slack == 0.f) {
+                    clusterElements.push_back(keyedElements[i]);
+                }
+            }
+            for (auto i = first; i < last; i += 1) {
+                if (keyedElements[i].slack != 0.f) {
+                    detail::InsertIntoDrawingOrder(clusterElements,
+                                                   keyedElements[i],
+                                                   aBuffer.movedElements);
+                }
+            }
+            std::copy(clusterElements.begin(),
+                      clusterElements.end(),
+                      keyedElements.begin() + static_cast<std::ptrdiff_t>(first));
+        }
+    }
+
+    for (std::size_t i = 0; i < aElements.size(); i += 1) {
+        aElements[i] = keyedElements[i].element;
+    }
+}
+
 } // namespace dimetric
 } // namespace gridgoblin
 } // namespace jbatnozic
@@ -0,0 +1,78 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <Hobgoblin/Math.hpp>
+
+#include <GridGoblin/Rendering/Visibility_provider.hpp>
+#include <GridGoblin/Spatial/Position_in_world.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace hg = jbatnozic::hobgoblin;
+
+//! CPU-only counterpart of `TopDownLineOfSightRenderer`: it takes the same inputs and rasterizes
+//! the same shadow polygons, but into a 1-bit-per-pixel bitmap in RAM instead of a render texture.
+//! This means that it doesn't need a graphics context (so it can be used on a headless server),
+//! and that `testVisibilityAt()` reflects the latest call to `render()` rather than the one before.
+class TopDownLineOfSightCpuRenderer : public VisibilityProvider {
+public:
+    enum Purpose {
+        FOR_TOPDOWN,
+        FOR_DIMETRIC
+    };
+
+    //! \param aBitmapSize width and height of the bitmap (it's always a square).
+    //!
+    //! \throws hg::InvalidArgumentError if `aBitmapSize` is not positive.
+    TopDownLineOfSightCpuRenderer(const World& aWorld, hg::PZInteger aBitmapSize, Purpose aPurpose);
+
+    void start(PositionInWorld    aPosInView,
+               hg::math::Vector2f aViewSize,
+               PositionInWorld    aLineOfSightOrigin,
+               float              aPadding);
+
+    void render();
+
+    std::optional<bool> testVisibilityAt(PositionInWorld aPos) const override;
+
+private:
+    const World& _world;
+
+    float           _sizeMultiplier;
+    PositionInWorld _losOrigin;
+
+    //! Top-left corner of the area covered by the bitmap, in the world.
+    hg::math::Vector2f _bitmapOrigin;
+
+    //! Size of the area covered by a single pixel of the bitmap, in the world.
+    float _pixelSize = 1.f;
+
+    //! Width and height of the bitmap.
+    hg::PZInteger _bitmapSize;
+
+    //! Number of 64-bit words per row of the bitmap.
+    hg::PZInteger _wordsPerRow;
+
+    //! Occlusion bitmap, row by row; a set bit means that the pixel is occluded.
+    std::vector<std::uint64_t> _bitmap;
+
+    void _renderOcclusion();
+
+    //! Fills the pixels whose centers are inside the convex polygon `aVertices` (in world
+    //! coordinates, in either winding order).
+    void _fillConvexPolygon(const hg::math::Vector2f* aVertices, std::size_t aVertexCount);
+
+    //! Sets the bits between columns `aFirst` and `aLast` (inclusive) of row `aRow`.
+    void _fillRun(hg::PZInteger aRow, hg::PZInteger aFirst, hg::PZInteger aLast);
+};
+
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -3,12 +3,15 @@
 
 #pragma once
 
+#include <GridGoblin/Private/Worker_group.hpp>
 #include <GridGoblin/Rendering/Visibility_provider.hpp>
 #include <GridGoblin/Spatial/Position_in_world.hpp>
 #include <GridGoblin/World/World.hpp>
 
 #include <Hobgoblin/Math.hpp>
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
 namespace jbatnozic {
@@ -33,6 +36,20 @@ struct VisibilityCalculatorConfig {
 
     //! TODO(description)
     hg::PZInteger rayPointsPerCell = 6;
+
+    //! Number of background threads which help the thread calling `calc()` cast the rays (the
+    //! rays are independent of each other, so they are split into batches which are cast in
+    //! parallel). If 0, all rays are cast on the calling thread.
+    hg::PZInteger rayWorkerCount = 0;
+
+    //! If true, the calculator remembers the occluders (cells with walls, along with their
+    //! unobstructed vertices) it found in each ring around the point of view, and reuses them in
+    //! subsequent calls to `calc()` for as long as the point of view stays in the same cell, the
+    //! visible cells stay the same, and none of the cells in the ring change (see
+    //! `World::getCellGeneration()`). Only the triangles have to be rebuilt for the rings which
+    //! are reused (as they depend on the exact point of view), and if nothing changed at all, the
+    //! previous result is kept as it is.
+    bool incremental = false;
 };
 
 //! Implements the `VisibilityProvider` using math/geometry formulas fully calculated on the CPU.
@@ -51,6 +68,17 @@ public:
 
         //! Number of checks that were performed to see if a point is inside a triangle.
         hg::PZInteger triangleCheckCount;
+
+        //! Number of rings whose occluders were reused from a previous calculation instead of
+        //! being looked up in the world (only in incremental mode).
+        hg::PZInteger reusedRingCount;
+
+        //! Number of occluders in the reused rings.
+        hg::PZInteger reusedOccluderCount;
+
+        //! True if nothing changed since the previous calculation, so its result was kept as it
+        //! is (only in incremental mode).
+        bool reusedPreviousResult;
     };
 
     //! Get some stats from the latest calc() call.
@@ -75,6 +103,7 @@ private:
     hg::PZInteger _minTrianglesBeforeRaycasting;
     hg::PZInteger _rayCount;
     hg::PZInteger _rayPointsPerCell;
+    bool          _incremental;
 
     // ===== Calculation context =====
 
@@ -107,8 +136,43 @@ private:
 
     std::vector<Triangle> _triangles;
 
+    //! Rays are kept as a structure of arrays, indexed by ray: the components of the direction
+    //! of each ray (unit vectors, fixed for the lifetime of the calculator), and the distance from
+    //! the point of view at which it's blocked (INFINITY if it's not blocked or wasn't cast).
+    std::vector<float> _rayDirectionsX;
+    std::vector<float> _rayDirectionsY;
     std::vector<float> _rays;
 
+    detail::WorkerGroup _rayWorkers;
+
+    // ===== Incremental mode =====
+
+    //! Cell with a wall in one of the rings around the point of view, which can obstruct the
+    //! view if any of its vertices are visible.
+    struct Occluder {
+        std::array<hg::math::Vector2f, 8> vertices;
+        std::uint16_t                     vertCount;
+        std::uint16_t                     edgesOfInterest;
+    };
+
+    struct RingCache {
+        std::vector<Occluder> occluders;
+        bool                  valid = false;
+    };
+
+    //! Indexed by ring; only valid for the following key:
+    std::vector<RingCache> _ringCaches;
+    hg::math::Vector2pz    _cacheOriginCell;
+    hg::math::Vector2pz    _cacheViewTopLeftCell;
+    hg::math::Vector2pz    _cacheViewBottomRightCell;
+    std::uint64_t          _cacheCellGeneration = 0;
+
+    //! Inputs of the previous calculation.
+    bool               _hasPreviousResult = false;
+    hg::math::Vector2f _prevViewCenter;
+    hg::math::Vector2f _prevViewSize;
+    hg::math::Vector2f _prevLineOfSightOrigin;
+
     // ===== Statistics =====
 
     bool _calcOngoing = false;
@@ -119,6 +183,17 @@ private:
 
     void _resetData();
 
+    //! Checks whether the previous result can be kept as it is (in incremental mode).
+    bool _canReusePreviousResult(PositionInWorld    aViewCenter,
+                                 hg::math::Vector2f aViewSize,
+                                 PositionInWorld    aLineOfSightOrigin) const;
+
+    //! Invalidates the ring caches which aren't valid for the current calculation context.
+    void _updateRingCaches();
+
+    //! Invalidates the ring caches of all rings which contain any cells in `aRect`.
+    void _invalidateRingCaches(const hg::math::Rectangle<hg::PZInteger>& aRect);
+
     void _setInitialCalculationContext(PositionInWorld    aViewCenter,
                                        hg::math::Vector2f aViewSize,
                                        PositionInWorld    aLineOfSightOrigin);
@@ -131,7 +206,12 @@ private:
 
     void _processRing(hg::PZInteger aRingIndex);
 
-    void _processCell(hg::math::Vector2pz aCell, hg::PZInteger aRingIndex);
+    void _setProcessedRingsBbox(hg::PZInteger aRingIndex);
+
+    //! \param aCache if not null, the cell is added to it if it's an occluder.
+    void _processCell(hg::math::Vector2pz aCell, hg::PZInteger aRingIndex, RingCache* aCache);
+
+    void _processOccluder(const Occluder& aOccluder);
 
     void _setRaysFromTriangles(hg::math::AngleF aAngle1, hg::math::AngleF aAngle2);
 
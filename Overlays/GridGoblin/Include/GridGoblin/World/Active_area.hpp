@@ -7,6 +7,7 @@
 
 #include <GridGoblin/Model/Chunk_id.hpp>
 
+#include <cstdint>
 #include <functional>
 #include <vector>
 
@@ -67,6 +68,29 @@ public:
                               hg::PZInteger                                aRingCount,
                               const std::function<hg::PZInteger(ChunkId)>& aGetLoadPriority = nullptr);
 
+    //! Same as `setToChunkRingSquare()`, but additionally includes, as a speculative part of the
+    //! area, the chunks of a square with the same number of rings around `aPredictedCentralChunk`
+    //! (which are not already in the square around `aCentralChunk`). Use this for areas whose owners
+    //! move quickly: pass the chunk where the owner is expected to be shortly, based on its velocity,
+    //! so that the chunks in the direction of travel start loading before they're needed.
+    //!
+    //! Speculative chunks are loaded with lower priority than all of the others (their priorities
+    //! start right after the largest default priority of the main square and grow with the distance
+    //! from `aPredictedCentralChunk`). When the prediction changes, speculative chunks which are no
+    //! longer predicted are dropped from the area (if they're still loading, their loads are
+    //! cancelled), and those which end up in the main part of the area have their load priority
+    //! raised if they're still loading (or lowered, in the opposite case).
+    //!
+    //! \param aGetLoadPriority used only for the main (non-speculative) part of the area; \see
+    //!                         `setToChunkRingSquare()`.
+    //!
+    //! \see getPrefetchStats
+    void setToChunkRingSquareWithPrefetch(
+        ChunkId                                      aCentralChunk,
+        hg::PZInteger                                aRingCount,
+        ChunkId                                      aPredictedCentralChunk,
+        const std::function<hg::PZInteger(ChunkId)>& aGetLoadPriority = nullptr);
+
     //! Sets the active area to an area defined by a central chunk and a diamond shape around it
     //! comprised of a number of rings. The 1st ring is the 4 chunks around the central chunk, the 2nd
     //! ring is the 8 chunks around the 1st right, and so on (the ASCII art below serves as an
@@ -98,9 +122,28 @@ public:
     void setToChunkList(std::vector<ChunkId>                         aChunkList,
                         const std::function<hg::PZInteger(ChunkId)>& aGetLoadPriority = nullptr);
 
-    //! Returns a list of IDs of chunks that are contained in this active area.
+    //! Returns a list of IDs of chunks that are contained in this active area (including the
+    //! speculative part, if any).
     const std::vector<ChunkId>& getChunkList() const;
 
+    struct PrefetchStats {
+        //! Number of chunks requested speculatively which weren't already loaded.
+        std::int64_t requestCount = 0;
+        //! Number of chunks requested speculatively which were already loaded when they became
+        //! part of the main area (that is, loads which were served from the prefetch).
+        std::int64_t hitCount = 0;
+        //! Number of chunks requested speculatively which were still loading when they became part
+        //! of the main area (their loads were still sped up by the prefetch).
+        std::int64_t lateCount = 0;
+        //! Number of speculative chunks dropped from the area without becoming part of the main
+        //! area (because the prediction changed).
+        std::int64_t discardedCount = 0;
+    };
+
+    //! Returns the accumulated statistics of the speculative part of this active area (see
+    //! `setToChunkRingSquareWithPrefetch()`).
+    PrefetchStats getPrefetchStats() const;
+
 private:
     friend class detail::ChunkStorageHandler;
     explicit ActiveArea(hg::NeverNull<detail::ChunkStorageHandler*> aStorageHandler)
@@ -108,6 +151,18 @@ private:
 
     hg::NeverNull<detail::ChunkStorageHandler*> _storageHandler;
     std::vector<ChunkId>                        _chunkList;
+    std::vector<ChunkId>                        _prefetchList; //!< Sorted; subset of _chunkList
+
+    //! Sorted; the chunks from `_prefetchList` which weren't loaded (or loading) before they were
+    //! requested speculatively. Only these count towards `PrefetchStats::hitCount`.
+    std::vector<ChunkId> _prefetchRequestedList;
+    PrefetchStats        _prefetchStats;
+
+    //! Sets the area to contain the chunks from both lists (which must not overlap), treating the
+    //! ones from `aPrefetchList` as speculative. `aGetLoadPriority` must handle chunks from both.
+    void _setChunkLists(std::vector<ChunkId>                         aMainList,
+                        std::vector<ChunkId>                         aPrefetchList,
+                        const std::function<hg::PZInteger(ChunkId)>& aGetLoadPriority);
 };
 
 namespace detail {
@@ -54,12 +54,22 @@ public:
     //!       - the chunk was loaded on-demand, triggered by one of the World's getters.
     //!       In all three cases, `onChunkLoaded` is called from the same thread which triggered any of
     //!       the above conditions.
+    //!
+    //! \note this (along with `onChunkCreated`) is the place to send the chunk to the clients which
+    //!       need it, if the world is streamed over the network (see `ChunkNetworkEncoder`).
     virtual void onChunkLoaded(ChunkId aChunkId, const Chunk& aChunk) {}
 
     //! TODO(description)
     //! [called when World::prune]
     virtual void onChunkUnloaded(ChunkId aChunkId) {}
 
+    //! Called when a save started by `World::saveAsync()` is finished.
+    //!
+    //! \param aSucceeded `true` if all the chunks were written successfully, `false` otherwise.
+    //!
+    //! \note this method is only ever called from `World::update()`.
+    virtual void onSaveFinished(bool aSucceeded) {}
+
     //! TODO(description)
     virtual std::unique_ptr<ChunkExtensionInterface> createChunkExtension() {
         return nullptr;
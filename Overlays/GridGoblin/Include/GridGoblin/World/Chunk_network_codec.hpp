@@ -0,0 +1,160 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <GridGoblin/Model/Cell_model.hpp>
+#include <GridGoblin/Model/Chunk.hpp>
+#include <GridGoblin/Model/Chunk_id.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/Common.hpp>
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Math.hpp>
+#include <Hobgoblin/Utility/Packet.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+//! Version of a chunk, as sent to (and acknowledged by) a client: the cell generation of the
+//! World (see `World::getCellGeneration()`) at the time when the chunk was encoded.
+using ChunkVersion = std::uint64_t;
+
+//! Thrown when decoding data which was not produced by `ChunkNetworkEncoder` (or was damaged).
+class ChunkCodecError : public hg::TracedRuntimeError {
+public:
+    using hg::TracedRuntimeError::TracedRuntimeError;
+};
+
+//! Encodes the floors and walls of chunks into packets, compactly enough to stream large worlds
+//! to clients (cell flags other than `FLOOR_INITIALIZED` and `WALL_INITIALIZED`, as well as cell
+//! openness, are not sent; the receiving World calculates them itself).
+//!
+//! Floors and walls are encoded separately, each as a palette of the distinct values which occur
+//! in the chunk followed by runs of palette indices (cells are visited in row-major order). Large
+//! areas of uniform terrain thus take up only a couple of bytes.
+//!
+//! A chunk can also be encoded as a delta against a version which the client has acknowledged,
+//! in which case only the cells that changed since that version (according to the World's cell
+//! change records) are included.
+//!
+//! Typical use on the server:
+//!     - in `Binder::onChunkCreated()` and `Binder::onChunkLoaded()`, forget the versions which
+//!       the clients acknowledged for the chunk (its cells might have been replaced without the
+//!       World recording a change), and use `encodeFull()` to send it to the interested clients;
+//!     - afterwards, periodically use `encode()` with the latest acknowledged version of each
+//!       client to send them the changes.
+//!
+//! \note the encoder keeps its working buffers between calls, so it's best to reuse it.
+class ChunkNetworkEncoder {
+public:
+    enum class Encoding : std::uint8_t {
+        FULL,  //!< All the cells of the chunk are included
+        DELTA, //!< Only the cells changed since the base version are included
+    };
+
+    //! Appends all the cells of `aChunk` (which is the chunk `aChunkId` of a World) to `aPacket`.
+    //!
+    //! \throws hg::InvalidArgumentError if `aChunk` is empty.
+    void encodeFull(ChunkId           aChunkId,
+                    const Chunk&      aChunk,
+                    ChunkVersion      aVersion,
+                    hg::util::Packet& aPacket);
+
+    //! Appends the chunk `aChunkId` of `aWorld`, at version `aWorld.getCellGeneration()`, to
+    //! `aPacket`. If `aAcknowledgedVersion` is provided and the World still remembers all the cell
+    //! changes which happened since that version, the chunk is encoded as a delta against it;
+    //! otherwise, it's encoded in full.
+    //!
+    //! \throws hg::InvalidArgumentError if the chunk is not loaded.
+    //!
+    //! \returns the encoding which was used.
+    Encoding encode(const World&                aWorld,
+                    ChunkId                     aChunkId,
+                    std::optional<ChunkVersion> aAcknowledgedVersion,
+                    hg::util::Packet&           aPacket);
+
+private:
+    struct WallKey {
+        std::optional<CellModel::Wall> wallOpt;
+
+        bool operator==(const WallKey& aOther) const {
+            return wallOpt == aOther.wallOpt;
+        }
+    };
+
+    struct WallKeyHasher {
+        std::size_t operator()(const WallKey& aKey) const;
+    };
+
+    //! Sprite ID of the floor, or no value if the floor isn't initialized.
+    using FloorKey = std::optional<SpriteId>;
+
+    using FloorPalette = std::unordered_map<FloorKey, std::uint32_t>;
+    using WallPalette  = std::unordered_map<WallKey, std::uint32_t, WallKeyHasher>;
+
+    std::vector<char>          _buffer;
+    std::vector<std::uint8_t>  _changedCells;
+    std::vector<std::uint32_t> _cellIndices;    //!< Indices (row-major) of the cells to encode
+    std::vector<std::uint32_t> _paletteIndices; //!< Palette index for each of `_cellIndices`
+    std::vector<std::uint32_t> _paletteCells;   //!< Index of a cell holding each palette value
+    FloorPalette               _floorPalette;
+    WallPalette                _wallPalette;
+
+    void _encode(ChunkId      aChunkId,
+                 const Chunk& aChunk,
+                 Encoding     aEncoding,
+                 ChunkVersion aVersion,
+                 ChunkVersion aBaseVersion);
+    void _encodeCellSelection(hg::PZInteger aTotalCellCount);
+    void _encodeFloors(const Chunk& aChunk);
+    void _encodeWalls(const Chunk& aChunk);
+    void _encodeRuns();
+};
+
+//! Decodes chunks encoded by `ChunkNetworkEncoder`.
+//!
+//! \note the decoder keeps its working buffers between calls, so it's best to reuse it.
+class ChunkNetworkDecoder {
+public:
+    struct Result {
+        ChunkId                       chunkId;
+        ChunkNetworkEncoder::Encoding encoding;
+        ChunkVersion                  version;     //!< Version of the chunk after decoding
+        ChunkVersion                  baseVersion; //!< For `DELTA`; same as `version` for `FULL`
+        hg::PZInteger                 cellCount;   //!< Number of cells which were decoded
+    };
+
+    //! Reads an encoded chunk from `aPacket` and writes the decoded cells into `aChunk`, which
+    //! must have the same dimensions as the encoded chunk. A delta can be applied to any version
+    //! of the chunk which is not older than its base version (the decoded cells hold their final
+    //! values, not differences).
+    //!
+    //! \note only the floors and walls of the cells are changed (see `ChunkNetworkEncoder`).
+    //!
+    //! \throws ChunkCodecError if the data is invalid or the dimensions don't match.
+    Result decode(hg::util::Packet& aPacket, Chunk& aChunk);
+
+    //! Same as the other overload, but the decoded cells are written into `aWorld` through
+    //! `aEditor` (which must be an editor of `aWorld`), so that the World refreshes everything that
+    //! depends on them. The encoded chunk must have the same dimensions as the chunks of the World.
+    Result decode(hg::util::Packet& aPacket, const World& aWorld, World::Editor& aEditor);
+
+private:
+    std::vector<std::uint32_t>                   _cellIndices;
+    std::vector<std::optional<CellModel::Floor>> _floors;
+    std::vector<std::optional<CellModel::Wall>>  _walls;
+
+    //! Reads the encoded chunk into `_cellIndices`, `_floors` and `_walls`.
+    Result _decode(hg::util::Packet& aPacket, hg::math::Vector2pz aExpectedChunkSize);
+};
+
+} // namespace gridgoblin
+} // namespace jbatnozic
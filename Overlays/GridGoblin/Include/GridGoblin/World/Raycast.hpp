@@ -0,0 +1,63 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+#include <Hobgoblin/Math/Vector.hpp>
+
+#include <GridGoblin/Spatial/Position_in_world.hpp>
+
+#include <cstdint>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace hg = ::jbatnozic::hobgoblin;
+
+//! Line segment along which a ray is cast (see `World::castRay()`).
+struct Ray {
+    PositionInWorld from;
+    PositionInWorld to;
+};
+
+//! Result of casting a `Ray` through the cells of a World.
+struct RaycastResult {
+    enum Outcome : std::uint8_t {
+        REACHED_TARGET,     //!< Nothing was in the way between `from` and `to`
+        HIT_WALL,           //!< The ray hit a cell with a wall
+        HIT_UNLOADED_CHUNK, //!< The ray reached a cell in a chunk which is not loaded
+        LEFT_WORLD          //!< The ray went out of the world (or started outside of it)
+    };
+
+    enum Edge : std::uint8_t {
+        NO_EDGE, //!< The ray started in the cell
+        LEFT_EDGE,
+        RIGHT_EDGE,
+        TOP_EDGE,
+        BOTTOM_EDGE
+    };
+
+    Outcome outcome = REACHED_TARGET;
+
+    //! Edge of `cell` through which the ray entered it, except when the outcome is `LEFT_WORLD`,
+    //! in which case it's the edge through which the ray left the world.
+    Edge edge = NO_EDGE;
+
+    //! The last cell that the ray went through: the cell that was hit (`HIT_WALL` and
+    //! `HIT_UNLOADED_CHUNK`), the cell containing `to` (`REACHED_TARGET`), or the last cell before
+    //! the ray left the world (`LEFT_WORLD`; undefined if the ray started outside of the world).
+    hg::math::Vector2pz cell;
+
+    //! Point where the ray entered `cell` (or `from` if it started in it), except when the outcome
+    //! is `REACHED_TARGET`, in which case it's `to`, or `LEFT_WORLD`, in which case it's the point
+    //! where the ray left the world.
+    PositionInWorld position;
+
+    //! Returns `true` if the ray was stopped by something before it reached its target.
+    bool isBlocked() const {
+        return outcome == HIT_WALL || outcome == HIT_UNLOADED_CHUNK;
+    }
+};
+
+} // namespace gridgoblin
+} // namespace jbatnozic
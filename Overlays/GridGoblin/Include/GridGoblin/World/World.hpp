@@ -17,12 +17,23 @@
 
 #include <GridGoblin/World/Active_area.hpp>
 #include <GridGoblin/World/Binder.hpp>
+#include <GridGoblin/World/Raycast.hpp>
 #include <GridGoblin/World/World_config.hpp>
 
+#include <GridGoblin/Private/Cell_planes.hpp>
+#include <GridGoblin/Private/Chunk_runtime_cache.hpp>
+#include <GridGoblin/Private/Chunk_spooler_default.hpp>
 #include <GridGoblin/Private/Chunk_storage_handler.hpp>
+#include <GridGoblin/Private/Edit_journal.hpp>
+#include <GridGoblin/Private/Worker_group.hpp>
 
+#include <deque>
+#include <functional>
+#include <future>
 #include <memory>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -89,9 +100,87 @@ public:
     void detachBinder(hg::NeverNull<Binder*> aBinder);
 
     void update();
+
+    //! Unloads chunks which are not in any of the active areas, least recently used first, until
+    //! both `WorldConfig::maxLoadedNonessentialChunks` and `WorldConfig::loadedChunkByteBudget`
+    //! are satisfied (or there are no more such chunks).
     void prune();
+
+    //! Writes all chunks which were unloaded from the World, but are still held in the runtime
+    //! cache of the disk I/O handler, to persistent storage.
+    //!
+    //! \note this blocks until all the writing is done, and does not include chunks which are
+    //!       still loaded. See `saveAsync()` for an alternative.
     void save();
 
+    //! Starts writing all loaded chunks which were edited since they were loaded (or since the last
+    //! call to this method), as well as all chunks which were unloaded from the World, to persistent
+    //! storage. The writing is done in the background, so the World can continue to be used (and
+    //! edited) in the meantime; what gets saved is the state of the chunks at the time of this call.
+    //!
+    //! \returns a future which becomes ready once everything has been written (or holds an
+    //!          exception if something couldn't be written). The attached binders are notified
+    //!          via `Binder::onSaveFinished()` as well, from `update()`.
+    std::shared_future<void> saveAsync();
+
+    //! Blocks until all the edits made so far are written to the edit journal (see
+    //! `WorldConfig::editJournalPath`). Does nothing if the World doesn't use a journal.
+    //!
+    //! \throws detail::EditJournalError if writing any of the edits to the journal failed.
+    void flushEditJournal();
+
+    //! Returns the statistics of the runtime chunk cache (hit rate, size, etc.), or `std::nullopt`
+    //! if the World was constructed with a custom disk I/O handler.
+    std::optional<detail::ChunkRuntimeCache::Stats> getRuntimeCacheStats() const;
+
+    //! Returns the statistics (number of processed requests, utilisation) of each of the worker
+    //! threads of the chunk spooler (see `WorldConfig::chunkSpoolerWorkerCount`).
+    std::vector<detail::DefaultChunkSpooler::WorkerStats> getSpoolerWorkerStats() const;
+
+    //! Returns the numbers of requests waiting in the queues of the chunk spooler, or zeroes if the
+    //! World was constructed with a custom chunk spooler.
+    detail::DefaultChunkSpooler::QueueStats getSpoolerQueueStats() const;
+
+    //! Returns the statistics of chunks which had to be loaded immediately, blocking the calling
+    //! thread, because they were accessed before they were loaded in the background (see
+    //! `WorldConfig::immediateChunkLoadTimeout`).
+    detail::ChunkStorageHandler::ImmediateLoadStats getImmediateLoadStats() const;
+
+    struct EditStats {
+        //! Number of calls to `edit()`.
+        std::int64_t editCount = 0;
+        //! Number of cells whose floors or walls were set through an `Editor`.
+        std::int64_t cellsEdited = 0;
+        //! Number of cells whose openness and obstruction flags were recalculated because of the
+        //! edits (this includes the cells around the edited ones).
+        std::int64_t cellsRefreshed = 0;
+    };
+
+    //! Returns the accumulated statistics of all edits made to the world so far (see `edit()`).
+    EditStats getEditStats() const;
+
+    //! Returns the total number of bytes taken up by all loaded chunks, including their extensions
+    //! (see `Chunk::getResidentSize()`). This has to go through all loaded chunks, so it's not
+    //! free to call.
+    std::int64_t getResidentChunkByteCount() const;
+
+    //! Returns the current cell generation: a counter which is incremented every time any cells
+    //! may have changed (because their floors or walls were edited, their openness and obstruction
+    //! flags were refreshed, or because chunks were loaded or unloaded). Results derived from the
+    //! cells (such as visibility or render geometry) which were calculated at the same generation
+    //! are still up to date.
+    std::uint64_t getCellGeneration() const;
+
+    //! Calls `aCallback` with the bounding rectangle (in cells) of every change which happened after
+    //! cell generation `aGeneration` (see `getCellGeneration()`). Rectangles can overlap.
+    //!
+    //! \returns `false` if some of these changes are not remembered anymore (only a limited number
+    //!          of the most recent ones is kept), in which case `aCallback` is not called at all and
+    //!          all cells should be treated as changed.
+    bool forEachCellChangeSince(
+        std::uint64_t                                                         aGeneration,
+        const std::function<void(const hg::math::Rectangle<hg::PZInteger>&)>& aCallback) const;
+
     ///////////////////////////////////////////////////////////////////////////
     // CONVERSIONS                                                           //
     ///////////////////////////////////////////////////////////////////////////
@@ -215,6 +304,10 @@ public:
         World& _world;
     };
 
+    //! Calls `aCallable` with an `Editor` through which cells can be changed. Once it returns, the
+    //! openness and obstruction flags of all the cells affected by the changes are recalculated.
+    //! Changed cells are tracked per chunk, so that only the parts of the world around them are
+    //! recalculated, no matter how far apart they are (see `getEditStats()`).
     // TODO: how to solve cache overflow in very large edits?
     template <class taCallable>
     void edit(const EditPermission&, taCallable&& aCallable) {
@@ -315,6 +408,30 @@ public:
         return {_chunkStorage.availableChunksEnd()};
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    // RAYCASTING                                                            //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Rays are walked through the cells they cross one by one (with the Amanatides-Woo DDA
+    // algorithm) and stop at the first cell which has a wall or is in a chunk which isn't loaded.
+    // The cells are read directly from the chunks (the chunk is looked up only when a ray crosses
+    // into a new one), so this is much cheaper than checking the cells along a line with
+    // `getCellAt()`. Chunks are never loaded by raycasting.
+
+    //! Casts a single ray.
+    RaycastResult castRay(const Ray& aRay) const;
+
+    //! Casts `aRayCount` rays from `aRays` and writes their results to the same indices of
+    //! `aResults`. The rays are spread across the raycast workers (see
+    //! `WorldConfig::raycastWorkerCount`) and the call blocks until all of them are done.
+    //!
+    //! \warning must not be called from multiple threads at the same time, nor while the world is
+    //!          being edited.
+    void castRays(const Ray* aRays, hg::PZInteger aRayCount, RaycastResult* aResults) const;
+
+    //! Same as above, but resizes `aResults` to fit the results.
+    void castRays(const std::vector<Ray>& aRays, std::vector<RaycastResult>& aResults) const;
+
     ///////////////////////////////////////////////////////////////////////////
     // ACTIVE AREAS                                                          //
     ///////////////////////////////////////////////////////////////////////////
@@ -355,6 +472,40 @@ private:
     void _connectSubcomponents();
     void _disconnectSubcomponents();
 
+    // ===== Saving =====
+
+    struct PendingSave {
+        std::shared_future<void> future;
+        std::uint64_t            journalSegment; //!< First segment not covered by the save.
+    };
+
+    std::vector<PendingSave> _pendingSaves;
+
+    //! Highest `journalSegment` of the saves which have succeeded. Segments before it are
+    //! discarded once no save which was started earlier is still pending.
+    std::uint64_t _savedJournalSegment = 0;
+
+    void _checkPendingSaves();
+
+    // ===== Edit journal =====
+
+    std::unique_ptr<detail::EditJournal> _editJournal;
+
+    //! Journal entries of the current edit.
+    std::vector<detail::EditJournal::Entry> _journalEntries;
+
+    //! Edits recovered from the journal which weren't applied yet, because their chunks were not
+    //! loaded since the World was created.
+    std::unordered_map<ChunkId, std::vector<detail::EditJournal::Entry>> _recoveredEdits;
+
+    //! Set if a save fails (or a new journal segment can't be started for it); from then on,
+    //! journal segments are no longer discarded (and automatic compaction stops), as they might
+    //! hold the only copy of some of the edits.
+    bool _journalCompactionBlocked = false;
+
+    void _openEditJournal();
+    void _applyRecoveredEdits(ChunkId aChunkId);
+
     // ===== Callbacks =====
 
     void _refreshCellsInAndAroundChunk(ChunkId aChunkId);
@@ -363,31 +514,74 @@ private:
     void onChunkLoaded(ChunkId aChunkId, const Chunk& aChunk) override;
     void onChunkCreated(ChunkId aChunkId, const Chunk& aChunk) override;
     void onChunkUnloaded(ChunkId aChunkId) override;
+    void onSaveFinished(bool aSucceeded) override;
     std::unique_ptr<ChunkExtensionInterface> createChunkExtension() override;
 
     // ===== Editing cells =====
 
-    int _editMinX = -1;
-    int _editMinY = -1;
-    int _editMaxX = -1;
-    int _editMaxY = -1;
+    struct CellRect {
+        hg::PZInteger startX, startY, endX, endY; // Inclusive
+    };
 
-    void _startEdit();
-    void _endEdit();
+    //! Bounding rectangles of the cells which need to be refreshed because of the current edit,
+    //! one per chunk containing such cells.
+    std::unordered_map<ChunkId, CellRect> _editDirtyRects;
+
+    //! Bounding rectangles of all cells changed by the current edit (including the ones which
+    //! don't need to be refreshed), one per chunk containing such cells.
+    std::unordered_map<ChunkId, CellRect> _editChangedRects;
+
+    EditStats _editStats;
 
-    struct RingAssessment {
-        bool hasOccupiedCells = false;
-        bool extend           = false;
+    struct CellChange {
+        std::uint64_t generation;
+        CellRect      rect;
     };
 
-    template <bool taAllowedToLoadAdjacent>
-    RingAssessment _assessRing(hg::PZInteger aX, hg::PZInteger aY, hg::PZInteger aRing);
+    std::uint64_t          _cellGeneration = 0;
+    std::deque<CellChange> _cellChanges; //!< Most recent last.
 
-    // TODO: since we determine openness at chunk load, this will lead into endless chunk load loop
-    template <bool taAllowedToLoadAdjacent>
-    hg::PZInteger _calcOpennessAt(hg::PZInteger aX, hg::PZInteger aY);
+    //! Records that the cells in `aRect` were changed, as part of the current cell generation.
+    void _recordCellChange(const CellRect& aRect);
+
+    void _startEdit();
+    void _endEdit();
 
-    void _refreshCellAtUnchecked(hg::PZInteger aX, hg::PZInteger aY);
+    //! Extends the rectangle in `aRects` for the chunk containing the cell at (aX, aY) so that it
+    //! contains that cell.
+    void _addCellToEditRects(std::unordered_map<ChunkId, CellRect>& aRects,
+                             hg::PZInteger                          aX,
+                             hg::PZInteger                          aY);
+
+    //! Part of the cells queued for refreshing which are within a single loaded chunk.
+    struct RefreshTask {
+        CellRect           rect;
+        detail::CellPlanes planes;
+    };
+
+    detail::WorkerGroup _refreshWorkers;
+
+    //! Tasks are only ever added to the end of `_refreshTasks` (the first `_refreshTaskCount` of
+    //! them are the queued ones), so that their planes can be reused; scratch buffers are per
+    //! worker.
+    std::vector<RefreshTask>                   _refreshTasks;
+    hg::PZInteger                              _refreshTaskCount = 0;
+    std::unordered_map<ChunkId, hg::PZInteger> _refreshTaskIndices;
+    std::vector<std::vector<std::uint8_t>>     _refreshScratch;
+
+    //! Queues the openness and obstruction flags of all loaded cells in the rectangle
+    //! [aStartX, aEndX] x [aStartY, aEndY] (inclusive, clamped to the world) to be recalculated by
+    //! the next call to `_refreshQueuedCells()`. Rectangles are split along chunk boundaries and
+    //! merged with the ones already queued for the same chunk.
+    void _queueCellsForRefresh(hg::PZInteger aStartX,
+                               hg::PZInteger aStartY,
+                               hg::PZInteger aEndX,
+                               hg::PZInteger aEndY);
+
+    //! Recalculates the openness and obstruction flags of all queued cells, spreading the work
+    //! over the refresh workers (see `WorldConfig::cellRefreshWorkerCount`).
+    //! \returns the number of cells which were recalculated.
+    hg::PZInteger _refreshQueuedCells();
 
     void _setFloorAt(hg::PZInteger                          aX,
                      hg::PZInteger                          aY,
@@ -411,6 +605,10 @@ private:
                              const std::optional<CellModel::Wall>& aWallOpt);
 
     void _setWallAtUnchecked(hg::math::Vector2pz aCell, const std::optional<CellModel::Wall>& aWallOpt);
+
+    // ===== Raycasting =====
+
+    mutable detail::WorkerGroup _raycastWorkers;
 };
 
 ///////////////////////////////////////////////////////////////////////////
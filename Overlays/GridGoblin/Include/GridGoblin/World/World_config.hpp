@@ -9,6 +9,8 @@
 #include <Hobgoblin/HGExcept.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 
 namespace jbatnozic {
@@ -59,11 +61,9 @@ struct WorldConfig {
     //!       cells whose openness is 2 or greater, and so on.
     //!
     //! This field, `maxCellOpenness`, lets the openness algorithm know at which point to stop.
-    //! Determining whether openness is 0 or 1 needs checking only a single cell, but checking
-    //! whether it's 2 usually needs checking 8 more cells, then checking whether it's 3
-    //! needs checking 16 more cells and so on. Because this gets increasingly more expensive
-    //! for larger values, make sure to set `maxCellOpenness` to no more than the largest object
-    //! you expect to have in your game world.
+    //! The cost of calculating openness, and the number of cells around each loaded chunk or edited
+    //! cell which have to be recalculated, both grow with this value, so make sure to set
+    //! `maxCellOpenness` to no more than the largest object you expect to have in your game world.
     //!
     //! \warning `maxCellOpenness` must be either 0, or an odd number (because the first step of
     //! the openness algorithm checks whether openness is 0 or 1, then the second step checks
@@ -76,14 +76,104 @@ struct WorldConfig {
     //! The maximum number of chunks that can stay loaded and available after pruning a World instance
     //! even when they are not in any of the active areas. Note that a chunk takes up up to 40 bytes
     //! per cell, more if you give it an extension, so take this into consideration when setting this
-    //! value. The minimum is 0, though it is not recommended.
+    //! value (or use `loadedChunkByteBudget` instead). The minimum is 0, though it is not recommended.
     //!
     //! \see World, ActiveArea
     hg::PZInteger maxLoadedNonessentialChunks = 0;
 
+    //! If greater than 0, pruning a World instance also unloads chunks which are not in any of the
+    //! active areas (least recently used first) for as long as all of the loaded chunks together
+    //! take up more than this many bytes (see `Chunk::getResidentSize()`). This applies in addition
+    //! to `maxLoadedNonessentialChunks`, so set that one high to rely only on this budget. Chunks in
+    //! active areas are never unloaded by pruning, so they can still push the total above it. Must
+    //! not be negative.
+    //!
+    //! \see World::prune, World::getResidentChunkByteCount
+    std::int64_t loadedChunkByteBudget = 0;
+
     //! Directory from which to load chuks and to which to save them.
     std::filesystem::path chunkDirectoryPath = "";
 
+    //! If `true`, the chunks will be stored on disk as human-readable JSON documents instead of
+    //! in the (default) compact binary format. This is much slower and takes up a lot more space,
+    //! so it's meant only for debugging and inspecting the world's data. Chunks stored in either
+    //! format can always be loaded, regardless of this setting.
+    bool storeChunksAsJson = false;
+
+    //! Maximum number of bytes that can be used to keep unloaded chunks in memory (in serialized
+    //! form) before they are written to disk. Unloaded chunks are written to disk only when they are
+    //! evicted from this cache (least recently unloaded first) or when the world is saved, so if a
+    //! chunk is loaded again soon after it was unloaded, it doesn't have to be read from the disk.
+    //! If 0, every unloaded chunk is written to disk immediately. Must not be negative.
+    //!
+    //! \note only applies to the default chunk disk I/O handler.
+    std::int64_t runtimeCacheByteLimit = 64 * 1024 * 1024;
+
+    //! If `true`, the chunks held in the runtime cache (see `runtimeCacheByteLimit`) are compressed,
+    //! which means that more of them can fit into the same number of bytes, but unloading and loading
+    //! them is a bit slower.
+    //!
+    //! \note only applies to the default chunk disk I/O handler.
+    bool compressRuntimeCache = false;
+
+    //! If both `chunksPerRegionX` and `chunksPerRegionY` are greater than 0, the chunks will be
+    //! packed into region files, each holding a block of `chunksPerRegionX` x `chunksPerRegionY`
+    //! chunks, instead of each chunk being stored in a separate file. This greatly reduces the number
+    //! of files for large worlds, and the number of system calls needed to load a chunk. Both must be
+    //! either 0 or between 1 and 256.
+    //!
+    //! \note only applies to the default chunk disk I/O handler.
+    //! \warning region files written with one region size can't be read with a different one.
+    hg::PZInteger chunksPerRegionX = 0;
+    //! \see chunksPerRegionX
+    hg::PZInteger chunksPerRegionY = 0;
+
+    //! If not empty, every change made to the cells through `World::Editor` is also appended to a
+    //! journal in this directory, which is written in the background. When a World is created with
+    //! a directory which already holds a journal, the edits from it are applied to the chunks as
+    //! they are loaded, so edits which were not saved (for example, because the program crashed)
+    //! are not lost. Journal files which are no longer needed are deleted after each successful
+    //! `World::saveAsync()`.
+    //!
+    //! \note the journal is independent of the chunk disk I/O handler, so it doesn't have to be in
+    //!       `chunkDirectoryPath` (though that's the most sensible place for it).
+    //! \warning a journal must not be used with different world dimensions than it was made with.
+    std::filesystem::path editJournalPath = "";
+
+    //! How long the edit journal waits for further edits before it writes the ones it has, so that
+    //! edits made in quick succession are written (and flushed) together. This is also roughly how
+    //! long an edit can go unwritten. Must not be negative.
+    std::chrono::milliseconds editJournalCommitInterval{20};
+
+    //! If greater than 0, `World::update()` starts a save (see `World::saveAsync()`) whenever more
+    //! than this many bytes were written to the edit journal since the last save, so that the
+    //! journal doesn't grow without bounds. Must not be negative.
+    std::int64_t editJournalCompactionThreshold = 4 * 1024 * 1024;
+
+    //! Number of background threads which load and unload chunks. Must be at least 1.
+    //!
+    //! \note with more than 1 thread, `Binder::createChunkExtension` may be called from several
+    //!       threads at the same time.
+    hg::PZInteger chunkSpoolerWorkerCount = 1;
+
+    //! When a chunk which isn't loaded is accessed in a way that requires it to be loaded, the
+    //! calling thread is blocked until the chunk spooler loads it. If this takes longer than
+    //! `immediateChunkLoadTimeout`, a `hg::TracedRuntimeError` is thrown. If 0, the thread waits
+    //! for as long as it takes. Must not be negative.
+    //!
+    //! \see World::getImmediateLoadStats
+    std::chrono::milliseconds immediateChunkLoadTimeout{0};
+
+    //! Number of background threads which help the thread that owns the world recalculate the
+    //! openness and obstruction flags of cells after chunks are loaded or cells are edited (the
+    //! work is split between them chunk by chunk). If 0, all of it is done on the owning thread.
+    //! Must not be negative.
+    hg::PZInteger cellRefreshWorkerCount = 0;
+
+    //! Number of background threads which help the calling thread cast the rays passed to
+    //! `World::castRays()`. If 0, all rays are cast on the calling thread. Must not be negative.
+    hg::PZInteger raycastWorkerCount = 0;
+
     //! Method to check if a configuration object is valid.
     //! \throws hg::InvalidArgumentError if the object is not valid.
     //! \returns the same configuration object that was passed in.
@@ -103,6 +193,26 @@ struct WorldConfig {
         HG_VALIDATE_ARGUMENT(aConfig.maxCellOpenness <=
                              std::min(15, std::min(aConfig.cellsPerChunkX, aConfig.cellsPerChunkY)));
 
+        HG_VALIDATE_ARGUMENT(aConfig.runtimeCacheByteLimit >= 0);
+
+        HG_VALIDATE_ARGUMENT((aConfig.chunksPerRegionX == 0 && aConfig.chunksPerRegionY == 0) ||
+                             (aConfig.chunksPerRegionX >= 1 && aConfig.chunksPerRegionX <= 256 &&
+                              aConfig.chunksPerRegionY >= 1 && aConfig.chunksPerRegionY <= 256));
+
+        HG_VALIDATE_ARGUMENT(aConfig.editJournalCommitInterval.count() >= 0);
+
+        HG_VALIDATE_ARGUMENT(aConfig.editJournalCompactionThreshold >= 0);
+
+        HG_VALIDATE_ARGUMENT(aConfig.chunkSpoolerWorkerCount >= 1);
+
+        HG_VALIDATE_ARGUMENT(aConfig.immediateChunkLoadTimeout.count() >= 0);
+
+        HG_VALIDATE_ARGUMENT(aConfig.cellRefreshWorkerCount >= 0);
+
+        HG_VALIDATE_ARGUMENT(aConfig.raycastWorkerCount >= 0);
+
+        HG_VALIDATE_ARGUMENT(aConfig.loadedChunkByteBudget >= 0);
+
         return aConfig;
     }
 
@@ -56,6 +56,24 @@ std::unique_ptr<ChunkExtensionInterface> Chunk::releaseExtension() {
     return result;
 }
 
+///////////////////////////////////////////////////////////////////////////
+// MEMORY                                                                //
+///////////////////////////////////////////////////////////////////////////
+
+std::size_t Chunk::getResidentSize() const {
+    if (isEmpty()) {
+        return 0;
+    }
+
+    // +1 for the extension cell
+    std::size_t result = sizeof(Chunk) + (hg::pztos(getCellCountX() * getCellCountY()) + 1) *
+                                             sizeof(detail::CellModelExt);
+    if (const auto* extension = getExtension()) {
+        result += extension->getResidentSize();
+    }
+    return result;
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // PRIVATE                                                               //
 ///////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,873 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Navigation/Hierarchical_pathfinder.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Utility/Stream_errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+using hg::math::Vector2pz;
+using CellRect = hg::math::Rectangle<hg::PZInteger>;
+
+enum Side : std::uint8_t {
+    TOP,
+    BOTTOM,
+    LEFT,
+    RIGHT
+};
+
+constexpr float DIAGONAL_COST = 1.41421356237f;
+
+// Persisted chunk graphs start with these (see `saveChunkGraph()`)
+constexpr std::uint32_t CHUNK_GRAPH_MAGIC          = 0x48504741; // "HPGA"
+constexpr std::uint16_t CHUNK_GRAPH_FORMAT_VERSION = 1;
+
+//! Passability of the cells of a rectangle of the world for a single object size.
+struct PassabilityGrid {
+    CellRect                  bounds;
+    std::vector<std::uint8_t> passable; //!< Row-major
+
+    bool isPassable(hg::PZInteger aLocalX, hg::PZInteger aLocalY) const {
+        if (aLocalX < 0 || aLocalX >= bounds.w || aLocalY < 0 || aLocalY >= bounds.h) {
+            return false;
+        }
+        return passable[hg::pztos(aLocalY * bounds.w + aLocalX)] != 0;
+    }
+
+    hg::PZInteger toIndex(Vector2pz aCell) const {
+        return (aCell.y - bounds.y) * bounds.w + (aCell.x - bounds.x);
+    }
+
+    Vector2pz toCell(hg::PZInteger aIndex) const {
+        return {bounds.x + aIndex % bounds.w, bounds.y + aIndex / bounds.w};
+    }
+};
+
+void FillPassabilityGrid(const World&     aWorld,
+                         const CellRect&  aBounds,
+                         hg::PZInteger    aObjectSize,
+                         PassabilityGrid& aGrid) {
+    aGrid.bounds = aBounds;
+    aGrid.passable.resize(hg::pztos(aBounds.w * aBounds.h));
+    for (hg::PZInteger y = 0; y < aBounds.h; y += 1) {
+        for (hg::PZInteger x = 0; x < aBounds.w; x += 1) {
+            const auto* cell = aWorld.getCellAtUnchecked(aBounds.x + x, aBounds.y + y);
+            aGrid.passable[hg::pztos(y * aBounds.w + x)] =
+                (cell != nullptr && cell->getOpenness() >= aObjectSize);
+        }
+    }
+}
+
+float OctileDistance(Vector2pz aFrom, Vector2pz aTo) {
+    const auto dx = std::abs(aFrom.x - aTo.x);
+    const auto dy = std::abs(aFrom.y - aTo.y);
+    return static_cast<float>(std::max(dx, dy)) + (DIAGONAL_COST - 1.f) * std::min(dx, dy);
+}
+
+//! Calls `aFunc(neighbourIndex, stepCost)` for every passable neighbour of the cell at `aIndex`.
+//! Diagonal steps are allowed only when both cells next to the step are passable too (so that
+//! objects don't cut corners).
+template <class taCallable>
+void ForEachNeighbour(const PassabilityGrid& aGrid, hg::PZInteger aIndex, taCallable&& aFunc) {
+    const auto x = aIndex % aGrid.bounds.w;
+    const auto y = aIndex / aGrid.bounds.w;
+
+    for (int dy = -1; dy <= 1; dy += 1) {
+        for (int dx = -1; dx <= 1; dx += 1) {
+            if ((dx == 0 && dy == 0) || !aGrid.isPassable(x + dx, y + dy)) {
+                continue;
+            }
+            if (dx != 0 && dy != 0) {
+                if (!aGrid.isPassable(x + dx, y) || !aGrid.isPassable(x, y + dy)) {
+                    continue;
+                }
+                aFunc((y + dy) * aGrid.bounds.w + (x + dx), DIAGONAL_COST);
+            } else {
+                aFunc((y + dy) * aGrid.bounds.w + (x + dx), 1.f);
+            }
+        }
+    }
+}
+
+using OpenListEntry = std::pair<float, hg::PZInteger>;
+using OpenList =
+    std::priority_queue<OpenListEntry, std::vector<OpenListEntry>, std::greater<OpenListEntry>>;
+
+//! Calculates the costs of the cheapest paths from `aStart` to all cells of the grid (with
+//! Dijkstra's algorithm). Unreachable cells get a negative cost.
+void CalcCosts(const PassabilityGrid& aGrid, Vector2pz aStart, std::vector<float>& aCosts) {
+    aCosts.assign(aGrid.passable.size(), -1.f);
+
+    OpenList open;
+    aCosts[hg::pztos(aGrid.toIndex(aStart))] = 0.f;
+    open.push({0.f, aGrid.toIndex(aStart)});
+
+    while (!open.empty()) {
+        const auto [cost, index] = open.top();
+        open.pop();
+        if (cost > aCosts[hg::pztos(index)]) {
+            continue; // Stale entry
+        }
+        ForEachNeighbour(aGrid, index, [&](hg::PZInteger aNeighbour, float aStepCost) {
+            auto& neighbourCost = aCosts[hg::pztos(aNeighbour)];
+            if (neighbourCost < 0.f || cost + aStepCost < neighbourCost) {
+                neighbourCost = cost + aStepCost;
+                open.push({neighbourCost, aNeighbour});
+            }
+        });
+    }
+}
+
+//! Finds the cheapest path from `aStart` to `aEnd` within the grid (with A*).
+//!
+//! \returns `false` if there is no such path, otherwise appends the path to `aPath` (without
+//!          `aStart` itself).
+bool FindPathInGrid(const PassabilityGrid&  aGrid,
+                    Vector2pz               aStart,
+                    Vector2pz               aEnd,
+                    std::vector<Vector2pz>& aPath) {
+    std::vector<float>         costs(aGrid.passable.size(), -1.f);
+    std::vector<hg::PZInteger> parents(aGrid.passable.size(), -1);
+
+    const auto startIndex = aGrid.toIndex(aStart);
+    const auto endIndex   = aGrid.toIndex(aEnd);
+
+    OpenList open;
+    costs[hg::pztos(startIndex)] = 0.f;
+    open.push({OctileDistance(aStart, aEnd), startIndex});
+
+    while (!open.empty()) {
+        const auto [estimate, index] = open.top();
+        open.pop();
+        if (index == endIndex) {
+            break;
+        }
+
+        const auto cost = costs[hg::pztos(index)];
+        if (estimate > cost + OctileDistance(aGrid.toCell(index), aEnd) + 0.001f) {
+            continue; // Stale entry
+        }
+        ForEachNeighbour(aGrid, index, [&](hg::PZInteger aNeighbour, float aStepCost) {
+            auto& neighbourCost = costs[hg::pztos(aNeighbour)];
+            if (neighbourCost < 0.f || cost + aStepCost < neighbourCost) {
+                neighbourCost                  = cost + aStepCost;
+                parents[hg::pztos(aNeighbour)] = index;
+                open.push({neighbourCost + OctileDistance(aGrid.toCell(aNeighbour), aEnd), aNeighbour});
+            }
+        });
+    }
+
+    if (costs[hg::pztos(endIndex)] < 0.f) {
+        return false;
+    }
+
+    const auto oldSize = aPath.size();
+    for (auto index = endIndex; index != startIndex; index = parents[hg::pztos(index)]) {
+        aPath.push_back(aGrid.toCell(index));
+    }
+    std::reverse(aPath.begin() + static_cast<std::ptrdiff_t>(oldSize), aPath.end());
+    return true;
+}
+
+CellRect GetBoundingRect(const CellRect& aLhs, const CellRect& aRhs) {
+    const auto x = std::min(aLhs.x, aRhs.x);
+    const auto y = std::min(aLhs.y, aRhs.y);
+    return {x,
+            y,
+            std::max(aLhs.x + aLhs.w, aRhs.x + aRhs.w) - x,
+            std::max(aLhs.y + aLhs.h, aRhs.y + aRhs.h) - y};
+}
+
+std::uint8_t GetOppositeSide(std::uint8_t aSide) {
+    switch (aSide) {
+    case TOP:
+        return BOTTOM;
+    case BOTTOM:
+        return TOP;
+    case LEFT:
+        return RIGHT;
+    case RIGHT:
+        return LEFT;
+    default:
+        HG_UNREACHABLE("Invalid value for Side ({}).", (int)aSide);
+    }
+}
+} // namespace
+
+HierarchicalPathfinder::HierarchicalPathfinder(const World&                        aWorld,
+                                               const HierarchicalPathfinderConfig& aConfig)
+    : _world{aWorld}
+    , _config{aConfig}
+    , _cellsPerChunkX{aWorld.getCellCountX() / aWorld.getChunkCountX()}
+    , _cellsPerChunkY{aWorld.getCellCountY() / aWorld.getChunkCountY()}
+    , _workers{aConfig.workerThreadCount} //
+{
+    HG_VALIDATE_ARGUMENT(aConfig.maxObjectSize >= 1 && aConfig.maxObjectSize <= 255);
+    HG_VALIDATE_ARGUMENT(aConfig.maxUnsavedGraphCount >= 0);
+}
+
+HierarchicalPathfinder::RequestId HierarchicalPathfinder::requestPath(Vector2pz     aStart,
+                                                                      Vector2pz     aEnd,
+                                                                      hg::PZInteger aObjectSize) {
+    HG_VALIDATE_ARGUMENT(aStart.x >= 0 && aStart.x < _world.getCellCountX() && aStart.y >= 0 &&
+                         aStart.y < _world.getCellCountY());
+    HG_VALIDATE_ARGUMENT(aEnd.x >= 0 && aEnd.x < _world.getCellCountX() && aEnd.y >= 0 &&
+                         aEnd.y < _world.getCellCountY());
+    HG_VALIDATE_ARGUMENT(aObjectSize >= 1 && aObjectSize <= _config.maxObjectSize);
+
+    const auto id = _nextRequestId;
+    _nextRequestId += 1;
+
+    _requests[id] = Request{aStart, aEnd, aObjectSize};
+    _pendingRequests.push_back(id);
+    return id;
+}
+
+void HierarchicalPathfinder::update() {
+    _invalidateChangedGraphs();
+
+    if (_pendingRequests.empty()) {
+        return;
+    }
+
+    std::vector<Request*> requests;
+    requests.reserve(_pendingRequests.size());
+    for (const auto id : _pendingRequests) {
+        requests.push_back(&_requests.at(id));
+    }
+    _pendingRequests.clear();
+
+    _workers.run(hg::stopz(requests.size()), [&](hg::PZInteger aTaskIndex, hg::PZInteger) {
+        auto& request = *requests[hg::pztos(aTaskIndex)];
+        request.path  = _findPath(request);
+    });
+
+    for (auto* request : requests) {
+        request->answered = true;
+    }
+    _stats.answeredRequestCount += hg::stopz(requests.size());
+}
+
+bool HierarchicalPathfinder::isAnswered(RequestId aRequestId) const {
+    const auto iter = _requests.find(aRequestId);
+    return (iter != _requests.end() && iter->second.answered);
+}
+
+std::optional<std::vector<Vector2pz>> HierarchicalPathfinder::takePath(RequestId aRequestId) {
+    const auto iter = _requests.find(aRequestId);
+    HG_VALIDATE_ARGUMENT(iter != _requests.end() && iter->second.answered,
+                         "Request {} was not answered (or its result was already taken).",
+                         aRequestId);
+
+    auto path = std::move(iter->second.path);
+    _requests.erase(iter);
+    return path;
+}
+
+std::optional<std::vector<Vector2pz>> HierarchicalPathfinder::findPath(Vector2pz     aStart,
+                                                                       Vector2pz     aEnd,
+                                                                       hg::PZInteger aObjectSize) {
+    const auto id = requestPath(aStart, aEnd, aObjectSize);
+    update();
+    return takePath(id);
+}
+
+// MARK: Persistence
+
+void HierarchicalPathfinder::saveChunkGraph(ChunkId aChunkId, hg::util::OutputStream& aOStream) {
+    ChunkGraphPtr graph;
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+
+        const auto iter = _chunkGraphs.find(aChunkId);
+        if (iter != _chunkGraphs.end()) {
+            graph = iter->second;
+        } else {
+            const auto unsavedIter = std::find_if(_unsavedGraphs.begin(),
+                                                  _unsavedGraphs.end(),
+                                                  [aChunkId](const auto& aPair) {
+                                                      return aPair.first == aChunkId;
+                                                  });
+            if (unsavedIter != _unsavedGraphs.end()) {
+                graph = std::move(unsavedIter->second);
+                _unsavedGraphs.erase(unsavedIter);
+            }
+        }
+    }
+
+    aOStream << CHUNK_GRAPH_MAGIC << CHUNK_GRAPH_FORMAT_VERSION;
+    if (!graph) {
+        aOStream << false;
+        return;
+    }
+
+    aOStream << true << graph->fingerprint << static_cast<std::uint16_t>(graph->sizeClasses.size());
+    for (const auto& sizeClass : graph->sizeClasses) {
+        aOStream << static_cast<std::uint16_t>(sizeClass.portals.size());
+        for (const auto& portal : sizeClass.portals) {
+            aOStream << static_cast<std::int32_t>(portal.cell.x)
+                     << static_cast<std::int32_t>(portal.cell.y) << portal.side << portal.runStart
+                     << portal.runEnd;
+        }
+        for (const auto cost : sizeClass.costs) {
+            aOStream << cost;
+        }
+    }
+}
+
+void HierarchicalPathfinder::loadChunkGraph(ChunkId aChunkId, hg::util::InputStream& aIStream) {
+    const auto magic   = aIStream.extract<std::uint32_t>();
+    const auto version = aIStream.extract<std::uint16_t>();
+    if (magic != CHUNK_GRAPH_MAGIC || version != CHUNK_GRAPH_FORMAT_VERSION) {
+        HG_THROW_TRACED(hg::util::StreamReadError,
+                        0,
+                        "Data of the graph of chunk {} is not a chunk graph of a supported format "
+                        "version (magic: {:#x}, version: {}).",
+                        aChunkId,
+                        magic,
+                        version);
+    }
+
+    if (!aIStream.extract<bool>()) {
+        return;
+    }
+
+    auto graph         = std::make_shared<ChunkGraph>();
+    graph->fingerprint = aIStream.extract<std::uint64_t>();
+    graph->sizeClasses.resize(aIStream.extract<std::uint16_t>());
+    for (auto& sizeClass : graph->sizeClasses) {
+        sizeClass.portals.resize(aIStream.extract<std::uint16_t>());
+        for (auto& portal : sizeClass.portals) {
+            portal.cell.x   = aIStream.extract<std::int32_t>();
+            portal.cell.y   = aIStream.extract<std::int32_t>();
+            portal.side     = aIStream.extract<std::uint8_t>();
+            portal.runStart = aIStream.extract<std::int32_t>();
+            portal.runEnd   = aIStream.extract<std::int32_t>();
+            if (!_isValidPortal(aChunkId, portal)) {
+                HG_THROW_TRACED(hg::util::StreamReadError,
+                                0,
+                                "Graph of chunk {} holds an invalid portal (cell: {}, {}; side: {}; "
+                                "run: {}..{}).",
+                                aChunkId,
+                                portal.cell.x,
+                                portal.cell.y,
+                                static_cast<int>(portal.side),
+                                portal.runStart,
+                                portal.runEnd);
+            }
+        }
+        sizeClass.costs.resize(sizeClass.portals.size() * sizeClass.portals.size());
+        for (auto& cost : sizeClass.costs) {
+            cost = aIStream.extract<float>();
+        }
+    }
+
+    if (graph->sizeClasses.size() != hg::pztos(_config.maxObjectSize)) {
+        return; // Saved with a different config
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    _loadedGraphs[aChunkId] = std::move(graph);
+}
+
+HierarchicalPathfinder::Stats HierarchicalPathfinder::getStats() const {
+    return _stats;
+}
+
+// MARK: Private
+
+void HierarchicalPathfinder::_invalidateChangedGraphs() {
+    const auto cellGeneration = _world.getCellGeneration();
+    if (cellGeneration == _cellGeneration) {
+        return;
+    }
+
+    // The graph of a chunk depends only on the openness of its own cells (the portals on both
+    // sides of an edge are matched when searching), so it's enough to drop the graphs of the
+    // chunks which overlap the changes.
+    std::vector<ChunkId> changedChunks;
+    const bool           allChangesKnown =
+        _world.forEachCellChangeSince(_cellGeneration, [&](const CellRect& aRect) {
+            const auto start = _world.cellToChunkIdUnchecked(aRect.x, aRect.y);
+            const auto end = _world.cellToChunkIdUnchecked(aRect.x + aRect.w - 1, aRect.y + aRect.h - 1);
+            for (hg::PZInteger y = start.y; y <= end.y; y += 1) {
+                for (hg::PZInteger x = start.x; x <= end.x; x += 1) {
+                    changedChunks.push_back({x, y});
+                }
+            }
+        });
+    if (!allChangesKnown) {
+        changedChunks.clear();
+        for (const auto& [chunkId, graph] : _chunkGraphs) {
+            changedChunks.push_back(chunkId);
+        }
+    }
+    _cellGeneration = cellGeneration;
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        for (const auto chunkId : changedChunks) {
+            const auto iter = _chunkGraphs.find(chunkId);
+            if (iter == _chunkGraphs.end()) {
+                continue;
+            }
+            // The graph of a chunk which was unloaded is kept until it's saved (if it's out of
+            // date, it won't match the cells when the chunk is loaded again anyway)
+            if (_world.getChunkAtIdUnchecked(chunkId) == nullptr && _config.maxUnsavedGraphCount > 0) {
+                if (hg::stopz(_unsavedGraphs.size()) == _config.maxUnsavedGraphCount) {
+                    _unsavedGraphs.erase(_unsavedGraphs.begin());
+                }
+                _unsavedGraphs.emplace_back(chunkId, std::move(iter->second));
+            }
+            _chunkGraphs.erase(iter);
+            _stats.invalidatedGraphCount += 1;
+        }
+    }
+
+    // Loading a chunk also changes its cells, so this is the only time there can be new chunks
+    _buildMissingGraphs();
+}
+
+void HierarchicalPathfinder::_buildMissingGraphs() {
+    std::vector<ChunkId> missingChunks;
+    for (auto iter = _world.availableChunksBegin(); iter != _world.availableChunksEnd(); ++iter) {
+        if (_chunkGraphs.find(*iter) == _chunkGraphs.end()) {
+            missingChunks.push_back(*iter);
+        }
+    }
+    if (missingChunks.empty()) {
+        return;
+    }
+
+    std::vector<ChunkGraphPtr> graphs(missingChunks.size());
+    std::vector<bool>          reused(missingChunks.size(), false);
+
+    _workers.run(hg::stopz(missingChunks.size()), [&](hg::PZInteger aTaskIndex, hg::PZInteger) {
+        const auto i           = hg::pztos(aTaskIndex);
+        const auto chunkId     = missingChunks[i];
+        const auto fingerprint = _calcFingerprint(chunkId);
+
+        ChunkGraphPtr candidate;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            const auto loadedIter = _loadedGraphs.find(chunkId);
+            if (loadedIter != _loadedGraphs.end()) {
+                candidate = loadedIter->second;
+            } else {
+                for (const auto& [unsavedChunkId, unsavedGraph] : _unsavedGraphs) {
+                    if (unsavedChunkId == chunkId) {
+                        candidate = unsavedGraph;
+                    }
+                }
+            }
+        }
+
+        if (candidate && candidate->fingerprint == fingerprint) {
+            graphs[i] = std::move(candidate);
+            reused[i] = true;
+        } else {
+            graphs[i] = std::make_shared<ChunkGraph>(_buildChunkGraph(chunkId, fingerprint));
+        }
+    });
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    for (std::size_t i = 0; i < missingChunks.size(); i += 1) {
+        const auto chunkId = missingChunks[i];
+
+        _chunkGraphs[chunkId] = std::move(graphs[i]);
+        _loadedGraphs.erase(chunkId);
+        _unsavedGraphs.erase(std::remove_if(_unsavedGraphs.begin(),
+                                            _unsavedGraphs.end(),
+                                            [chunkId](const auto& aPair) {
+                                                return aPair.first == chunkId;
+                                            }),
+                             _unsavedGraphs.end());
+
+        if (reused[i]) {
+            _stats.reusedGraphCount += 1;
+        } else {
+            _stats.builtGraphCount += 1;
+        }
+    }
+}
+
+std::uint64_t HierarchicalPathfinder::_calcFingerprint(ChunkId aChunkId) const {
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+
+    const auto bounds = _getChunkBounds(aChunkId);
+    for (hg::PZInteger y = bounds.y; y < bounds.y + bounds.h; y += 1) {
+        for (hg::PZInteger x = bounds.x; x < bounds.x + bounds.w; x += 1) {
+            const auto* cell = _world.getCellAtUnchecked(x, y);
+            hash ^= (cell != nullptr) ? cell->getOpenness() : 0xFFu;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+HierarchicalPathfinder::ChunkGraph HierarchicalPathfinder::_buildChunkGraph(
+    ChunkId       aChunkId,
+    std::uint64_t aFingerprint) const //
+{
+    ChunkGraph graph;
+    graph.fingerprint = aFingerprint;
+    graph.sizeClasses.resize(hg::pztos(_config.maxObjectSize));
+
+    const auto bounds = _getChunkBounds(aChunkId);
+
+    PassabilityGrid    grid;
+    std::vector<float> costs;
+
+    for (hg::PZInteger objectSize = 1; objectSize <= _config.maxObjectSize; objectSize += 1) {
+        auto& sizeClass = graph.sizeClasses[hg::pztos(objectSize - 1)];
+        FillPassabilityGrid(_world, bounds, objectSize, grid);
+
+        // Find the portals: runs of passable cells along the edges which have another chunk on the
+        // other side
+        const auto addPortals = [&](std::uint8_t aSide, Vector2pz aFirst, Vector2pz aStep, int aCount) {
+            const bool horizontal = (aStep.x != 0);
+
+            int runStart = -1;
+            for (int i = 0; i <= aCount; i += 1) {
+                const Vector2pz cell{aFirst.x + aStep.x * i, aFirst.y + aStep.y * i};
+                const bool      passable =
+                    (i < aCount) && grid.isPassable(cell.x - bounds.x, cell.y - bounds.y);
+
+                if (passable && runStart < 0) {
+                    runStart = i;
+                } else if (!passable && runStart >= 0) {
+                    const int middle = (runStart + i - 1) / 2;
+
+                    Portal portal;
+                    portal.cell     = {aFirst.x + aStep.x * middle, aFirst.y + aStep.y * middle};
+                    portal.side     = aSide;
+                    portal.runStart = (horizontal ? aFirst.x : aFirst.y) + runStart;
+                    portal.runEnd   = (horizontal ? aFirst.x : aFirst.y) + i - 1;
+                    sizeClass.portals.push_back(portal);
+
+                    runStart = -1;
+                }
+            }
+        };
+
+        const auto right  = bounds.x + bounds.w - 1;
+        const auto bottom = bounds.y + bounds.h - 1;
+        if (aChunkId.y > 0) {
+            addPortals(TOP, {bounds.x, bounds.y}, {1, 0}, bounds.w);
+        }
+        if (aChunkId.y < _world.getChunkCountY() - 1) {
+            addPortals(BOTTOM, {bounds.x, bottom}, {1, 0}, bounds.w);
+        }
+        if (aChunkId.x > 0) {
+            addPortals(LEFT, {bounds.x, bounds.y}, {0, 1}, bounds.h);
+        }
+        if (aChunkId.x < _world.getChunkCountX() - 1) {
+            addPortals(RIGHT, {right, bounds.y}, {0, 1}, bounds.h);
+        }
+
+        // Find the costs of moving between them
+        const auto portalCount = sizeClass.portals.size();
+        sizeClass.costs.resize(portalCount * portalCount);
+        for (std::size_t i = 0; i < portalCount; i += 1) {
+            CalcCosts(grid, sizeClass.portals[i].cell, costs);
+            for (std::size_t t = 0; t < portalCount; t += 1) {
+                const auto index = grid.toIndex(sizeClass.portals[t].cell);
+                sizeClass.costs[i * portalCount + t] = costs[hg::pztos(index)];
+            }
+        }
+    }
+
+    return graph;
+}
+
+std::optional<std::vector<Vector2pz>> HierarchicalPathfinder::_findPath(const Request& aRequest) const {
+    const auto start      = aRequest.start;
+    const auto end        = aRequest.end;
+    const auto objectSize = aRequest.objectSize;
+    const auto classIndex = hg::pztos(objectSize - 1);
+
+    const auto isPassable = [&](Vector2pz aCell) {
+        const auto* cell = _world.getCellAtUnchecked(aCell);
+        return (cell != nullptr && cell->getOpenness() >= objectSize);
+    };
+    if (!isPassable(start) || !isPassable(end)) {
+        return std::nullopt;
+    }
+
+    std::vector<Vector2pz> path{start};
+    if (start == end) {
+        return path;
+    }
+
+    const auto startChunk = _world.cellToChunkIdUnchecked(start);
+    const auto endChunk   = _world.cellToChunkIdUnchecked(end);
+
+    PassabilityGrid grid;
+
+    // Try to stay within the chunk first
+    if (startChunk == endChunk) {
+        FillPassabilityGrid(_world, _getChunkBounds(startChunk), objectSize, grid);
+        if (FindPathInGrid(grid, start, end, path)) {
+            return path;
+        }
+    }
+
+    const auto getSizeClassGraph = [this, classIndex](ChunkId aChunkId) -> const SizeClassGraph* {
+        const auto iter = _chunkGraphs.find(aChunkId);
+        if (iter == _chunkGraphs.end()) {
+            return nullptr;
+        }
+        return &iter->second->sizeClasses[classIndex];
+    };
+
+    const auto* startGraph = getSizeClassGraph(startChunk);
+    const auto* endGraph   = getSizeClassGraph(endChunk);
+    if (startGraph == nullptr || endGraph == nullptr) {
+        return std::nullopt;
+    }
+
+    // Costs of getting from the start to the portals of its chunk, and from the end to the portals
+    // of its chunk (the costs are symmetric)
+    std::vector<float> startCosts;
+    std::vector<float> endCosts;
+    std::vector<float> costs;
+
+    FillPassabilityGrid(_world, _getChunkBounds(startChunk), objectSize, grid);
+    CalcCosts(grid, start, costs);
+    for (const auto& portal : startGraph->portals) {
+        startCosts.push_back(costs[hg::pztos(grid.toIndex(portal.cell))]);
+    }
+
+    FillPassabilityGrid(_world, _getChunkBounds(endChunk), objectSize, grid);
+    CalcCosts(grid, end, costs);
+    for (const auto& portal : endGraph->portals) {
+        endCosts.push_back(costs[hg::pztos(grid.toIndex(portal.cell))]);
+    }
+
+    // A* through the portals
+    using NodeKey                    = std::uint64_t;
+    static constexpr NodeKey END_KEY = ~NodeKey{0};
+
+    const auto makeKey = [](ChunkId aChunkId, std::size_t aPortalIndex) -> NodeKey {
+        return (NodeKey{aChunkId.x} << 48) | (NodeKey{aChunkId.y} << 32) | aPortalIndex;
+    };
+    const auto getChunkId = [](NodeKey aKey) {
+        return ChunkId{static_cast<std::uint16_t>(aKey >> 48), static_cast<std::uint16_t>(aKey >> 32)};
+    };
+    const auto getPortalIndex = [](NodeKey aKey) {
+        return static_cast<std::size_t>(aKey & 0xFFFFFFFFu);
+    };
+
+    struct NodeInfo {
+        float     cost;
+        NodeKey   parent;
+        Vector2pz cell;
+    };
+    std::unordered_map<NodeKey, NodeInfo> nodes;
+
+    using Entry = std::pair<float, NodeKey>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    static constexpr NodeKey START_KEY = END_KEY - 1;
+
+    const auto relax = [&](NodeKey aKey, Vector2pz aCell, float aCost, NodeKey aParent) {
+        const auto iter = nodes.find(aKey);
+        if (iter != nodes.end() && iter->second.cost <= aCost) {
+            return;
+        }
+        nodes[aKey] = {aCost, aParent, aCell};
+        open.push({aCost + OctileDistance(aCell, end), aKey});
+    };
+
+    for (std::size_t i = 0; i < startGraph->portals.size(); i += 1) {
+        if (startCosts[i] >= 0.f) {
+            relax(makeKey(startChunk, i), startGraph->portals[i].cell, startCosts[i], START_KEY);
+        }
+    }
+
+    bool found = false;
+    while (!open.empty()) {
+        const auto [estimate, key] = open.top();
+        open.pop();
+        if (key == END_KEY) {
+            found = true;
+            break;
+        }
+
+        const auto& node = nodes.at(key);
+        if (estimate > node.cost + OctileDistance(node.cell, end) + 0.001f) {
+            continue; // Stale entry
+        }
+        const auto nodeCost = node.cost;
+
+        const auto  chunkId     = getChunkId(key);
+        const auto  portalIndex = getPortalIndex(key);
+        const auto* graph       = getSizeClassGraph(chunkId);
+        const auto& portal      = graph->portals[portalIndex];
+        const auto  portalCount = graph->portals.size();
+
+        // To the end
+        if (chunkId == endChunk && endCosts[portalIndex] >= 0.f) {
+            relax(END_KEY, end, nodeCost + endCosts[portalIndex], key);
+        }
+
+        // To the other portals of the same chunk
+        for (std::size_t i = 0; i < portalCount; i += 1) {
+            const auto cost = graph->costs[portalIndex * portalCount + i];
+            if (i != portalIndex && cost >= 0.f) {
+                relax(makeKey(chunkId, i), graph->portals[i].cell, nodeCost + cost, key);
+            }
+        }
+
+        // To the overlapping portals on the other side of the edge
+        hg::PZInteger neighbourX = chunkId.x;
+        hg::PZInteger neighbourY = chunkId.y;
+        switch (portal.side) {
+        case TOP:
+            neighbourY -= 1;
+            break;
+        case BOTTOM:
+            neighbourY += 1;
+            break;
+        case LEFT:
+            neighbourX -= 1;
+            break;
+        case RIGHT:
+            neighbourX += 1;
+            break;
+        default:
+            HG_UNREACHABLE("Invalid value for Side ({}).", (int)portal.side);
+        }
+
+        const ChunkId neighbourId{neighbourX, neighbourY};
+        const auto*   neighbourGraph = getSizeClassGraph(neighbourId);
+        if (neighbourGraph == nullptr) {
+            continue;
+        }
+
+        const auto horizontal   = (portal.side == TOP || portal.side == BOTTOM);
+        const auto position     = horizontal ? portal.cell.x : portal.cell.y;
+        const auto oppositeSide = GetOppositeSide(portal.side);
+        for (std::size_t i = 0; i < neighbourGraph->portals.size(); i += 1) {
+            const auto& other = neighbourGraph->portals[i];
+            if (other.side != oppositeSide) {
+                continue;
+            }
+            const auto overlapStart = std::max(portal.runStart, other.runStart);
+            const auto overlapEnd   = std::min(portal.runEnd, other.runEnd);
+            if (overlapStart > overlapEnd) {
+                continue;
+            }
+
+            // Walk along the edge to where the runs overlap, cross it and walk to the other
+            // portal; the refined path can only be cheaper than this
+            const auto otherPosition = horizontal ? other.cell.x : other.cell.y;
+            const auto crossing      = std::clamp<std::int32_t>(position, overlapStart, overlapEnd);
+            const auto cost          = static_cast<float>(std::abs(position - crossing) +
+                                                 std::abs(crossing - otherPosition) + 1);
+            relax(makeKey(neighbourId, i), other.cell, nodeCost + cost, key);
+        }
+    }
+
+    if (!found) {
+        return std::nullopt;
+    }
+
+    // Refine the path (backwards from the end) one chunk or pair of chunks at a time
+    std::vector<NodeKey> keys;
+    for (NodeKey key = END_KEY; key != START_KEY; key = nodes.at(key).parent) {
+        keys.push_back(key);
+    }
+    keys.push_back(START_KEY);
+    std::reverse(keys.begin(), keys.end());
+
+    const auto getNodeChunk = [&](NodeKey aKey) {
+        if (aKey == START_KEY) {
+            return startChunk;
+        }
+        if (aKey == END_KEY) {
+            return endChunk;
+        }
+        return getChunkId(aKey);
+    };
+
+    for (std::size_t i = 1; i < keys.size(); i += 1) {
+        const auto from = (keys[i - 1] == START_KEY) ? start : nodes.at(keys[i - 1]).cell;
+        const auto to   = nodes.at(keys[i]).cell;
+        if (from == to) {
+            continue;
+        }
+
+        const auto fromChunk = getNodeChunk(keys[i - 1]);
+        const auto toChunk   = getNodeChunk(keys[i]);
+        const auto bounds =
+            (fromChunk == toChunk)
+                ? _getChunkBounds(fromChunk)
+                : GetBoundingRect(_getChunkBounds(fromChunk), _getChunkBounds(toChunk));
+
+        FillPassabilityGrid(_world, bounds, objectSize, grid);
+        if (!FindPathInGrid(grid, from, to, path)) {
+            return std::nullopt; // Shouldn't happen if the graphs are up to date
+        }
+    }
+
+    return path;
+}
+
+bool HierarchicalPathfinder::_isValidPortal(ChunkId aChunkId, const Portal& aPortal) const {
+    const auto bounds = _getChunkBounds(aChunkId);
+    const auto right  = bounds.x + bounds.w - 1;
+    const auto bottom = bounds.y + bounds.h - 1;
+
+    // The portal must be on an edge which has another chunk on the other side (see
+    // `_buildChunkGraph()`), and its run must lie along that edge, within the chunk
+    bool onEdge;
+    switch (aPortal.side) {
+    case TOP:
+        onEdge = (aChunkId.y > 0 && aPortal.cell.y == bounds.y);
+        break;
+    case BOTTOM:
+        onEdge = (aChunkId.y < _world.getChunkCountY() - 1 && aPortal.cell.y == bottom);
+        break;
+    case LEFT:
+        onEdge = (aChunkId.x > 0 && aPortal.cell.x == bounds.x);
+        break;
+    case RIGHT:
+        onEdge = (aChunkId.x < _world.getChunkCountX() - 1 && aPortal.cell.x == right);
+        break;
+    default:
+        return false;
+    }
+    if (!onEdge) {
+        return false;
+    }
+
+    const bool horizontal = (aPortal.side == TOP || aPortal.side == BOTTOM);
+    const auto first      = horizontal ? bounds.x : bounds.y;
+    const auto last       = horizontal ? right : bottom;
+    const auto position   = horizontal ? aPortal.cell.x : aPortal.cell.y;
+    return (first <= aPortal.runStart && aPortal.runStart <= position && position <= aPortal.runEnd &&
+            aPortal.runEnd <= last);
+}
+
+CellRect HierarchicalPathfinder::_getChunkBounds(ChunkId aChunkId) const {
+    return {aChunkId.x * _cellsPerChunkX,
+            aChunkId.y * _cellsPerChunkY,
+            _cellsPerChunkX,
+            _cellsPerChunkY};
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,124 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Navigation/World_cost_provider.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+WorldCostProvider::WorldCostProvider(const World& aWorld, const WorldCostProviderConfig& aConfig)
+    : _world{aWorld}
+    , _config{aConfig}
+    , _cellCountX{aWorld.getCellCountX()}
+    , _cellCountY{aWorld.getCellCountY()}
+    , _chunkCountX{aWorld.getChunkCountX()}
+    , _chunkCountY{aWorld.getChunkCountY()}
+    , _cellsPerChunkX{_cellCountX / _chunkCountX}
+    , _cellsPerChunkY{_cellCountY / _chunkCountY}
+    , _cellGeneration{aWorld.getCellGeneration()} //
+{
+    HG_VALIDATE_ARGUMENT(aConfig.objectSize >= 1);
+    HG_VALIDATE_ARGUMENT(aConfig.baseCost >= 1 && aConfig.baseCost < hg::util::COST_IMPASSABLE);
+    HG_VALIDATE_ARGUMENT(aConfig.obstructedEdgeCost >= 0);
+
+    _costPlanes.resize(hg::pztos(_chunkCountX * _chunkCountY));
+    for (auto iter = aWorld.availableChunksBegin(); iter != aWorld.availableChunksEnd(); ++iter) {
+        _rebuildCostPlane(*iter);
+    }
+}
+
+hg::PZInteger WorldCostProvider::refresh(const std::function<void(const CellRect&)>& aOnCellsChanged) {
+    const auto cellGeneration = _world.getCellGeneration();
+    if (cellGeneration == _cellGeneration) {
+        return 0;
+    }
+
+    auto& changedRects  = _changedRectsBuffer;
+    auto& changedChunks = _changedChunksBuffer;
+    changedRects.clear();
+    changedChunks.clear();
+
+    // Changes often come in many small rectangles within the same chunks, so the IDs of the
+    // chunks are collected first and deduplicated, so that each is rebuilt only once
+    const bool allChangesKnown =
+        _world.forEachCellChangeSince(_cellGeneration, [&](const CellRect& aRect) {
+            changedRects.push_back(aRect);
+
+            const auto start = _world.cellToChunkIdUnchecked(aRect.x, aRect.y);
+            const auto end =
+                _world.cellToChunkIdUnchecked(aRect.x + aRect.w - 1, aRect.y + aRect.h - 1);
+            for (hg::PZInteger y = start.y; y <= end.y; y += 1) {
+                for (hg::PZInteger x = start.x; x <= end.x; x += 1) {
+                    changedChunks.push_back({x, y});
+                }
+            }
+        });
+    _cellGeneration = cellGeneration;
+
+    hg::PZInteger rebuiltCount = 0;
+    if (allChangesKnown) {
+        std::sort(changedChunks.begin(), changedChunks.end());
+        changedChunks.erase(std::unique(changedChunks.begin(), changedChunks.end()),
+                            changedChunks.end());
+        for (const auto chunkId : changedChunks) {
+            _rebuildCostPlane(chunkId);
+        }
+        rebuiltCount = hg::stopz(changedChunks.size());
+    } else {
+        changedRects.clear();
+        changedRects.push_back({0, 0, _cellCountX, _cellCountY});
+        for (hg::PZInteger y = 0; y < _chunkCountY; y += 1) {
+            for (hg::PZInteger x = 0; x < _chunkCountX; x += 1) {
+                _rebuildCostPlane({x, y});
+            }
+        }
+        rebuiltCount = _chunkCountX * _chunkCountY;
+    }
+
+    if (aOnCellsChanged) {
+        for (const auto& rect : changedRects) {
+            aOnCellsChanged(rect);
+        }
+    }
+
+    return rebuiltCount;
+}
+
+void WorldCostProvider::_rebuildCostPlane(ChunkId aChunkId) {
+    auto& plane = _costPlanes[hg::pztos(aChunkId.y * _chunkCountX + aChunkId.x)];
+
+    const auto* chunk = _world.getChunkAtIdUnchecked(aChunkId);
+    if (chunk == nullptr || chunk->isEmpty()) {
+        plane.clear();
+        plane.shrink_to_fit();
+        return;
+    }
+
+    static constexpr std::uint16_t EDGE_FLAGS =
+        CellModel::RIGHT_EDGE_OBSTRUCTED | CellModel::TOP_EDGE_OBSTRUCTED |
+        CellModel::LEFT_EDGE_OBSTRUCTED | CellModel::BOTTOM_EDGE_OBSTRUCTED;
+    static constexpr hg::PZInteger MAX_PASSABLE_COST = hg::util::COST_IMPASSABLE - 1;
+
+    plane.resize(hg::pztos(_cellsPerChunkX * _cellsPerChunkY));
+    for (hg::PZInteger y = 0; y < _cellsPerChunkY; y += 1) {
+        auto* row = plane.data() + y * _cellsPerChunkX;
+        for (hg::PZInteger x = 0; x < _cellsPerChunkX; x += 1) {
+            const auto& cell = chunk->getCellAtUnchecked(x, y);
+            if (cell.getOpenness() < _config.objectSize) {
+                row[x] = hg::util::COST_IMPASSABLE;
+                continue;
+            }
+            const auto edges = std::popcount(static_cast<unsigned>(cell.getFlags() & EDGE_FLAGS));
+            const auto cost  = _config.baseCost + edges * _config.obstructedEdgeCost;
+            row[x]           = static_cast<std::uint8_t>(std::min(cost, MAX_PASSABLE_COST));
+        }
+    }
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -325,6 +325,12 @@ DrawingData CellModelExt::ExtensionData::getDrawingData(float           aCellRes
     return _pointerStorage.drawingDataPredicate(aCellResolution, aCellTopLeft, aPointOfView);
 }
 
+bool CellModelExt::ExtensionData::isNeverDrawn() const {
+    HG_ASSERT(!_holdingExtension);
+
+    return _pointerStorage.drawingDataPredicate == &predicate::AlwaysNone;
+}
+
 } // namespace detail
 } // namespace gridgoblin
 } // namespace jbatnozic
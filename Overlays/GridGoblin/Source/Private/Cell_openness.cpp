@@ -0,0 +1,116 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Cell_openness.hpp>
+
+#include <GridGoblin/Model/Cell_model.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <algorithm>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+//! Fills `aSquares` (width * height values) so that each value holds the size of the largest
+//! square with no solid cells which has the corresponding cell as its bottom-right corner, capped
+//! to `aCap`. Cells outside of the planes are treated as solid.
+void CalcFreeSquares(const CellPlanes& aPlanes, std::uint8_t aCap, std::uint8_t* aSquares) {
+    const auto width  = aPlanes.getWidth();
+    const auto height = aPlanes.getHeight();
+
+    for (hg::PZInteger y = 0; y < height; y += 1) {
+        const auto* flags = aPlanes.getFlagsRow(y);
+        auto*       curr  = aSquares + (y * width);
+
+        // The part which depends only on the previous row is computed for the whole row first;
+        // this loop has no dependencies between iterations, so it can be vectorized.
+        if (y == 0) {
+            for (hg::PZInteger x = 0; x < width; x += 1) {
+                const bool free = (flags[x] & CellModel::WALL_INITIALIZED) == 0;
+                curr[x]         = static_cast<std::uint8_t>(free ? std::min<std::uint8_t>(aCap, 1) : 0);
+            }
+        } else {
+            const auto* prev = curr - width;
+            if (width > 0) {
+                const bool free = (flags[0] & CellModel::WALL_INITIALIZED) == 0;
+                curr[0]         = static_cast<std::uint8_t>(free ? std::min<std::uint8_t>(aCap, 1) : 0);
+            }
+            for (hg::PZInteger x = 1; x < width; x += 1) {
+                const bool free  = (flags[x] & CellModel::WALL_INITIALIZED) == 0;
+                const auto above = static_cast<std::uint8_t>(std::min(prev[x], prev[x - 1]) + 1);
+                curr[x]          = static_cast<std::uint8_t>(free ? std::min(aCap, above) : 0);
+            }
+        }
+
+        // Only the dependency on the cell to the left remains, which needs a sequential scan
+        // (solid cells already hold 0 so they're not affected by this).
+        for (hg::PZInteger x = 1; x < width; x += 1) {
+            curr[x] = std::min(curr[x], static_cast<std::uint8_t>(curr[x - 1] + 1));
+        }
+    }
+}
+} // namespace
+
+void CalcOpennessInPlanes(CellPlanes&                aPlanes,
+                          hg::PZInteger              aMargin,
+                          std::uint8_t               aMaxCellOpenness,
+                          std::vector<std::uint8_t>& aScratch) {
+    HG_VALIDATE_ARGUMENT((aPlanes.getPlaneMask() & CellPlanes::FLAGS) != 0 &&
+                         (aPlanes.getPlaneMask() & CellPlanes::OPENNESS) != 0);
+    HG_VALIDATE_ARGUMENT(aMargin >= aMaxCellOpenness / 2);
+
+    const auto width  = aPlanes.getWidth();
+    const auto height = aPlanes.getHeight();
+
+    for (hg::PZInteger y = 0; y < height; y += 1) {
+        std::fill_n(aPlanes.getOpennessRow(y), width, std::uint8_t{0});
+    }
+    if (width <= 2 * aMargin || height <= 2 * aMargin || aMaxCellOpenness == 0) {
+        return;
+    }
+
+    aScratch.resize(hg::pztos(width * height));
+    const std::uint8_t* squares = aScratch.data();
+    CalcFreeSquares(aPlanes, aMaxCellOpenness, aScratch.data());
+
+    // A cell's openness is the largest N (up to aMaxCellOpenness) such that the N x N square
+    // centered on it (for even N, one of the 4 such squares which contain it) holds no solid cells.
+    // Since a smaller square centered on the cell is contained in any larger such square, the
+    // condition holds for every N up to the openness and for none above it, so the openness is
+    // equal to the number of values of N for which it holds.
+    const auto xBegin = aMargin;
+    const auto xEnd   = width - aMargin;
+
+    for (hg::PZInteger y = aMargin; y < height - aMargin; y += 1) {
+        auto* openness = aPlanes.getOpennessRow(y);
+
+        for (hg::PZInteger n = 1; n <= aMaxCellOpenness; n += 1) {
+            const auto k  = n / 2;
+            const auto sn = static_cast<std::uint8_t>(n);
+
+            if (n % 2 == 1) {
+                // Odd: the square spans [x - k, x + k] x [y - k, y + k]
+                const auto* row = squares + ((y + k) * width) + k;
+                for (hg::PZInteger x = xBegin; x < xEnd; x += 1) {
+                    openness[x] += static_cast<std::uint8_t>(row[x] >= sn);
+                }
+            } else {
+                // Even: the squares span [x - k + {0, 1}, x + k - {1, 0}] in both dimensions
+                const auto* row0 = squares + ((y + k - 1) * width) + k;
+                const auto* row1 = squares + ((y + k) * width) + k;
+                for (hg::PZInteger x = xBegin; x < xEnd; x += 1) {
+                    const auto best =
+                        std::max(std::max(row0[x - 1], row0[x]), std::max(row1[x - 1], row1[x]));
+                    openness[x] += static_cast<std::uint8_t>(best >= sn);
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,89 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Cell_planes.hpp>
+
+#include <algorithm>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+void CellPlanes::reset(hg::PZInteger aWidth, hg::PZInteger aHeight, std::uint8_t aPlaneMask) {
+    HG_VALIDATE_ARGUMENT(aWidth >= 0 && aHeight >= 0);
+    HG_VALIDATE_ARGUMENT((aPlaneMask & ~ALL) == 0);
+
+    const auto size = hg::pztos(aWidth * aHeight);
+
+    // Note: resize() doesn't release memory when shrinking
+    _flags.resize((aPlaneMask & FLAGS) ? size : 0);
+    _openness.resize((aPlaneMask & OPENNESS) ? size : 0);
+    _floors.resize((aPlaneMask & FLOOR) ? size : 0);
+    _walls.resize((aPlaneMask & WALL) ? size : 0);
+
+    _width     = aWidth;
+    _height    = aHeight;
+    _planeMask = aPlaneMask;
+}
+
+void CellPlanes::loadRow(hg::PZInteger       aX,
+                         hg::PZInteger       aY,
+                         const CellModelExt* aCells,
+                         hg::PZInteger       aCount) {
+    HG_ASSERT(aX >= 0 && aY >= 0 && aX + aCount <= _width && aY < _height);
+
+    // Each plane is filled in a separate loop so that every loop writes to only one
+    // destination (and only reads the part of each cell that it needs).
+
+    if (_planeMask & FLAGS) {
+        auto* dst = getFlagsRow(aY) + aX;
+        for (hg::PZInteger i = 0; i < aCount; i += 1) {
+            dst[i] = aCells[i].getFlags();
+        }
+    }
+
+    if (_planeMask & OPENNESS) {
+        auto* dst = getOpennessRow(aY) + aX;
+        for (hg::PZInteger i = 0; i < aCount; i += 1) {
+            dst[i] = aCells[i].getOpenness();
+        }
+    }
+
+    if (_planeMask & FLOOR) {
+        auto* dst = getFloorRow(aY) + aX;
+        for (hg::PZInteger i = 0; i < aCount; i += 1) {
+            dst[i] = aCells[i].isFloorInitialized() ? aCells[i].getFloor() : CellModel::Floor{};
+        }
+    }
+
+    if (_planeMask & WALL) {
+        auto* dst = getWallRow(aY) + aX;
+        for (hg::PZInteger i = 0; i < aCount; i += 1) {
+            dst[i] = aCells[i].isWallInitialized() ? aCells[i].getWall() : CellModel::Wall{};
+        }
+    }
+}
+
+void CellPlanes::fillRow(hg::PZInteger aX,
+                         hg::PZInteger aY,
+                         hg::PZInteger aCount,
+                         std::uint16_t aFlags) {
+    HG_ASSERT(aX >= 0 && aY >= 0 && aX + aCount <= _width && aY < _height);
+
+    if (_planeMask & FLAGS) {
+        std::fill_n(getFlagsRow(aY) + aX, aCount, aFlags);
+    }
+    if (_planeMask & OPENNESS) {
+        std::fill_n(getOpennessRow(aY) + aX, aCount, std::uint8_t{0});
+    }
+    if (_planeMask & FLOOR) {
+        std::fill_n(getFloorRow(aY) + aX, aCount, CellModel::Floor{});
+    }
+    if (_planeMask & WALL) {
+        std::fill_n(getWallRow(aY) + aX, aCount, CellModel::Wall{});
+    }
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
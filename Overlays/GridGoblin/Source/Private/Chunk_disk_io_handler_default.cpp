@@ -6,10 +6,13 @@
 
 #include <Hobgoblin/Format.hpp>
 #include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
 #include <Hobgoblin/Utility/File_io.hpp>
+#include <Hobgoblin/Utility/Stream.hpp>
 
 #include <GridGoblin/Private/Model_conversions.hpp>
 
+#include <algorithm>
 #include <fstream>
 
 namespace jbatnozic {
@@ -17,43 +20,216 @@ namespace gridgoblin {
 namespace detail {
 
 namespace {
-const std::filesystem::path CHUNKS_FOLDER = "DCIO_CHUNKS";
+constexpr auto LOG_ID = "GridGoblin";
+
+const std::filesystem::path CHUNKS_FOLDER  = "DCIO_CHUNKS";
+const std::filesystem::path REGIONS_FOLDER = "DCIO_REGIONS";
+
+//! Maximum number of region files to keep open at the same time.
+constexpr std::size_t MAX_OPEN_REGION_FILES = 64;
 } // namespace
 
 DefaultChunkDiskIoHandler::DefaultChunkDiskIoHandler(const WorldConfig& aConfig)
-    : _basePath{aConfig.chunkDirectoryPath} //
+    : _runtimeCache{aConfig.runtimeCacheByteLimit, aConfig.compressRuntimeCache}
+    , _basePath{aConfig.chunkDirectoryPath}
+    , _storeChunksAsJson{aConfig.storeChunksAsJson}
+    , _chunksPerRegionX{aConfig.chunksPerRegionX}
+    , _chunksPerRegionY{aConfig.chunksPerRegionY} //
 {
-    if (const auto path = _basePath / CHUNKS_FOLDER; !std::filesystem::exists(path)) {
+    const auto& folder = _usesRegionFiles() ? REGIONS_FOLDER : CHUNKS_FOLDER;
+    if (const auto path = _basePath / folder; !std::filesystem::exists(path)) {
         std::filesystem::create_directory(path);
     }
-    _reusableConversionBuffers = NewReusableConversionBuffers();
 }
 
 DefaultChunkDiskIoHandler::~DefaultChunkDiskIoHandler() {
-    DeleteReusableConversionBuffers(_reusableConversionBuffers);
+    dumpRuntimeCache();
+
+    const auto stats = _runtimeCache.getStats();
+    HG_LOG_INFO(LOG_ID,
+                "Runtime chunk cache: {} hits, {} misses (hit rate {:.1f}%), {} evictions, {} writes.",
+                stats.hitCount,
+                stats.missCount,
+                stats.getHitRate() * 100.0,
+                stats.evictionCount,
+                stats.writeCount);
+
+    for (auto* buffers : _conversionBufferPool) {
+        DeleteReusableConversionBuffers(buffers);
+    }
 }
 
+class DefaultChunkDiskIoHandler::ConversionBuffersLease {
+public:
+    explicit ConversionBuffersLease(DefaultChunkDiskIoHandler& aHandler)
+        : _handler{aHandler} //
+    {
+        {
+            std::lock_guard<std::mutex> lock{_handler._mutex};
+            auto&                       pool = _handler._conversionBufferPool;
+            if (!pool.empty()) {
+                _buffers = pool.back();
+                pool.pop_back();
+                return;
+            }
+        }
+        _buffers = NewReusableConversionBuffers();
+    }
+
+    ~ConversionBuffersLease() {
+        std::lock_guard<std::mutex> lock{_handler._mutex};
+        _handler._conversionBufferPool.push_back(_buffers);
+    }
+
+    ConversionBuffersLease(const ConversionBuffersLease&)            = delete;
+    ConversionBuffersLease& operator=(const ConversionBuffersLease&) = delete;
+
+    ReusableConversionBuffers* get() const {
+        return _buffers;
+    }
+
+private:
+    DefaultChunkDiskIoHandler& _handler;
+    ReusableConversionBuffers* _buffers = nullptr;
+};
+
 void DefaultChunkDiskIoHandler::setBinder(Binder* aBinder) {
+    std::lock_guard<std::mutex> lock{_mutex};
     _binder = aBinder;
 }
 
-std::optional<Chunk> DefaultChunkDiskIoHandler::loadChunkFromRuntimeCache(ChunkId aChunkId) {
-    // TODO: make runtime cache a separate thing
-    return loadChunkFromPersistentCache(aChunkId);
+std::optional<Chunk> DefaultChunkDiskIoHandler::loadChunkFromRuntimeCache(ChunkId aChunkId,
+                                                                          bool&   aIsUnsaved) {
+    std::string data;
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (!_runtimeCache.take(aChunkId, data, &aIsUnsaved)) {
+            return std::nullopt;
+        }
+    }
+    return _deserializeChunk(aChunkId, data.data(), hg::stopz(data.size()));
 }
 
 void DefaultChunkDiskIoHandler::storeChunkInRuntimeCache(const Chunk& aChunk, ChunkId aChunkId) {
-    storeChunkInPersistentCache(aChunk, aChunkId);
+    hg::util::BufferStream outputBuffer;
+    _serializeChunk(aChunk, outputBuffer);
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    _runtimeCache.store(aChunkId,
+                        outputBuffer.getData(),
+                        outputBuffer.getDataSize(),
+                        [this](ChunkId aChunkId, const void* aData, std::int64_t aByteCount) {
+                            _writeChunkFile(aChunkId, aData, aByteCount);
+                        });
 }
 
 std::optional<Chunk> DefaultChunkDiskIoHandler::loadChunkFromPersistentCache(ChunkId aChunkId) {
-    const auto path = _buildPathToChunk(aChunkId);
-    if (!std::filesystem::exists(path)) {
-        return std::nullopt;
+    std::string bytes;
+
+    if (_usesRegionFiles()) {
+        std::lock_guard<std::mutex> lock{_mutex};
+
+        const auto chunkData = _getRegionFile(aChunkId).readChunk(aChunkId.x % _chunksPerRegionX,
+                                                                  aChunkId.y % _chunksPerRegionY);
+        if (chunkData.data == nullptr) {
+            return std::nullopt;
+        }
+        // The view is only valid while the lock is held, so the data must be copied out
+        const auto* begin = static_cast<const char*>(chunkData.data);
+        bytes.assign(begin, hg::pztos(chunkData.byteCount));
+    } else {
+        const auto path = _buildPathToChunk(aChunkId);
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (!std::filesystem::exists(path)) {
+            return std::nullopt;
+        }
+        bytes = hg::util::SlurpFileBytes(path);
     }
 
-    auto bytes = hg::util::SlurpFileBytes(path);
+    return _deserializeChunk(aChunkId, bytes.data(), hg::stopz(bytes.size()));
+}
+
+void DefaultChunkDiskIoHandler::storeChunkInPersistentCache(const Chunk& aChunk, ChunkId aChunkId) {
+    hg::util::BufferStream outputBuffer;
+    _serializeChunk(aChunk, outputBuffer);
 
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    // Whatever was in the runtime cache for this chunk is now outdated
+    _runtimeCache.erase(aChunkId);
+
+    _writeChunkFile(aChunkId, outputBuffer.getData(), outputBuffer.getDataSize());
+}
+
+void DefaultChunkDiskIoHandler::dumpRuntimeCache() {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    _runtimeCache.flush([this](ChunkId aChunkId, const void* aData, std::int64_t aByteCount) {
+        _writeChunkFile(aChunkId, aData, aByteCount);
+    });
+}
+
+ChunkRuntimeCache::Stats DefaultChunkDiskIoHandler::getRuntimeCacheStats() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _runtimeCache.getStats();
+}
+
+std::filesystem::path DefaultChunkDiskIoHandler::_buildPathToChunk(ChunkId aChunkId) const {
+    return _basePath / CHUNKS_FOLDER / fmt::format(FMT_STRING("chunk_{}_{}"), aChunkId.x, aChunkId.y);
+}
+
+std::filesystem::path DefaultChunkDiskIoHandler::_buildPathToRegion(ChunkId aRegionId) const {
+    return _basePath / REGIONS_FOLDER /
+           fmt::format(FMT_STRING("region_{}_{}"), aRegionId.x, aRegionId.y);
+}
+
+RegionFile& DefaultChunkDiskIoHandler::_getRegionFile(ChunkId aChunkId) {
+    const ChunkId regionId{aChunkId.x / _chunksPerRegionX, aChunkId.y / _chunksPerRegionY};
+
+    _regionFileUseTick += 1;
+
+    auto iter = _regionFiles.find(regionId);
+    if (iter != _regionFiles.end()) {
+        iter->second.lastUseTick = _regionFileUseTick;
+        return *iter->second.file;
+    }
+
+    if (_regionFiles.size() >= MAX_OPEN_REGION_FILES) {
+        const auto lruIter =
+            std::min_element(_regionFiles.begin(), _regionFiles.end(), [](auto& aLhs, auto& aRhs) {
+                return aLhs.second.lastUseTick < aRhs.second.lastUseTick;
+            });
+        _regionFiles.erase(lruIter);
+    }
+
+    auto file = std::make_unique<RegionFile>(_buildPathToRegion(regionId),
+                                             _chunksPerRegionX,
+                                             _chunksPerRegionY);
+
+    auto& openFile = _regionFiles[regionId];
+
+    openFile.file        = std::move(file);
+    openFile.lastUseTick = _regionFileUseTick;
+    return *openFile.file;
+}
+
+void DefaultChunkDiskIoHandler::_serializeChunk(const Chunk&            aChunk,
+                                                hg::util::BufferStream& aOutputBuffer) {
+    ConversionBuffersLease buffers{*this};
+
+    if (_storeChunksAsJson) {
+        const auto str     = ChunkToJsonString(aChunk, buffers.get());
+        const auto written = aOutputBuffer.write(str.data(), hg::stopz(str.size()));
+        HG_HARD_ASSERT(written == hg::stopz(str.size()));
+    } else {
+        ChunkToBinary(aChunk, aOutputBuffer, buffers.get());
+    }
+}
+
+Chunk DefaultChunkDiskIoHandler::_deserializeChunk(ChunkId      aChunkId,
+                                                   const void*  aData,
+                                                   std::int64_t aByteCount) {
     auto chunkExtensionFactory = [this, aChunkId](const Chunk& aChunk) {
         HG_ASSERT(_binder != nullptr);
         auto extension = _binder->createChunkExtension();
@@ -63,25 +239,37 @@ std::optional<Chunk> DefaultChunkDiskIoHandler::loadChunkFromPersistentCache(Chu
         return extension;
     };
 
-    return JsonStringToChunk(std::move(bytes), chunkExtensionFactory, _reusableConversionBuffers);
+    ConversionBuffersLease buffers{*this};
+
+    if (IsBinaryChunkData(aData, aByteCount)) {
+        hg::util::ViewStream vstream{aData, aByteCount};
+        return BinaryToChunk(vstream, chunkExtensionFactory, buffers.get());
+    }
+
+    // Not in the binary format - must be a JSON export
+    return JsonStringToChunk(std::string{static_cast<const char*>(aData), hg::pztos(aByteCount)},
+                             chunkExtensionFactory,
+                             buffers.get());
 }
 
-void DefaultChunkDiskIoHandler::storeChunkInPersistentCache(const Chunk& aChunk, ChunkId aChunkId) {
-    const auto path = _buildPathToChunk(aChunkId);
+void DefaultChunkDiskIoHandler::_writeChunkFile(ChunkId      aChunkId,
+                                                const void*  aData,
+                                                std::int64_t aByteCount) {
+    if (_usesRegionFiles()) {
+        _getRegionFile(aChunkId).writeChunk(aChunkId.x % _chunksPerRegionX,
+                                            aChunkId.y % _chunksPerRegionY,
+                                            aData,
+                                            aByteCount);
+        return;
+    }
 
-    auto str = ChunkToJsonString(aChunk, _reusableConversionBuffers);
+    const auto path = _buildPathToChunk(aChunkId);
 
     std::ofstream file{path, std::ios::out | std::ios::binary | std::ios::trunc};
     HG_HARD_ASSERT(file.is_open() && file.good());
-    file << str;
-}
-
-std::filesystem::path DefaultChunkDiskIoHandler::_buildPathToChunk(ChunkId aChunkId) const {
-    return _basePath / CHUNKS_FOLDER / fmt::format(FMT_STRING("chunk_{}_{}"), aChunkId.x, aChunkId.y);
+    file.write(static_cast<const char*>(aData), static_cast<std::streamsize>(aByteCount));
 }
 
-void DefaultChunkDiskIoHandler::dumpRuntimeCache() {}
-
 } // namespace detail
 } // namespace gridgoblin
 } // namespace jbatnozic
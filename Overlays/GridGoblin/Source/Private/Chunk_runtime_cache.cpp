@@ -0,0 +1,208 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Chunk_runtime_cache.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <cstring>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+// The compression is a plain PackBits-style run-length encoding. Serialized chunks consist mostly of
+// long stretches of identical cells, so even this simple scheme shrinks them considerably, while
+// being cheap enough to run on every unload. The encoded data is a sequence of packets, each starting
+// with a control byte N:
+// - if 0 <= N <= 127: N + 1 literal bytes follow;
+// - if N >= 128:      a single byte follows, which is to be repeated (N - 126) times (2..129).
+
+constexpr std::size_t MAX_LITERAL_RUN  = 128;
+constexpr std::size_t MAX_REPEATED_RUN = 129;
+
+void Compress(const char* aData, std::size_t aByteCount, std::string& aOutput) {
+    aOutput.clear();
+    aOutput.reserve(aByteCount / 2);
+
+    std::size_t i = 0;
+    while (i < aByteCount) {
+        // Measure the run of identical bytes starting at i
+        std::size_t runLength = 1;
+        while (i + runLength < aByteCount && runLength < MAX_REPEATED_RUN &&
+               aData[i + runLength] == aData[i]) {
+            runLength += 1;
+        }
+
+        if (runLength >= 2) {
+            aOutput.push_back(static_cast<char>(runLength + 126));
+            aOutput.push_back(aData[i]);
+            i += runLength;
+            continue;
+        }
+
+        // Collect literals until a run of at least 2 identical bytes begins
+        const std::size_t literalStart = i;
+        while (i < aByteCount && (i - literalStart) < MAX_LITERAL_RUN) {
+            if (i + 1 < aByteCount && aData[i + 1] == aData[i]) {
+                break;
+            }
+            i += 1;
+        }
+        const auto literalCount = i - literalStart;
+        aOutput.push_back(static_cast<char>(literalCount - 1));
+        aOutput.append(aData + literalStart, literalCount);
+    }
+}
+
+void Decompress(const std::string& aData, std::int64_t aRawByteCount, std::string& aOutput) {
+    aOutput.clear();
+    aOutput.reserve(hg::pztos(aRawByteCount));
+
+    std::size_t i = 0;
+    while (i < aData.size()) {
+        const auto control = static_cast<std::uint8_t>(aData[i]);
+        i += 1;
+        if (control < 128) {
+            const std::size_t literalCount = control + 1u;
+            HG_HARD_ASSERT(i + literalCount <= aData.size());
+            aOutput.append(aData, i, literalCount);
+            i += literalCount;
+        } else {
+            HG_HARD_ASSERT(i < aData.size());
+            aOutput.append(static_cast<std::size_t>(control) - 126u, aData[i]);
+            i += 1;
+        }
+    }
+
+    HG_HARD_ASSERT(hg::stopz(aOutput.size()) == aRawByteCount);
+}
+} // namespace
+
+ChunkRuntimeCache::ChunkRuntimeCache(std::int64_t aByteLimit, bool aCompress)
+    : _byteLimit{aByteLimit}
+    , _compress{aCompress} //
+{
+    HG_VALIDATE_ARGUMENT(aByteLimit >= 0);
+}
+
+void ChunkRuntimeCache::store(ChunkId             aChunkId,
+                              const void*         aData,
+                              std::int64_t        aByteCount,
+                              const WriteHandler& aWriteHandler) {
+    _stats.storeCount += 1;
+
+    erase(aChunkId);
+
+    _entries.push_front(Entry{aChunkId, {}, aByteCount, false});
+    auto& entry = _entries.front();
+    if (_compress) {
+        Compress(static_cast<const char*>(aData), hg::pztos(aByteCount), entry.data);
+        entry.data.shrink_to_fit();
+    } else {
+        entry.data.assign(static_cast<const char*>(aData), hg::pztos(aByteCount));
+    }
+
+    _index[aChunkId] = _entries.begin();
+
+    _stats.byteCount += hg::stopz(entry.data.size());
+    _stats.rawByteCount += aByteCount;
+    _stats.entryCount += 1;
+
+    _evictUntilWithinLimit(aWriteHandler);
+}
+
+bool ChunkRuntimeCache::take(ChunkId aChunkId, std::string& aBytes, bool* aIsUnwritten) {
+    const auto iter = _index.find(aChunkId);
+    if (iter == _index.end()) {
+        _stats.missCount += 1;
+        return false;
+    }
+
+    _stats.hitCount += 1;
+
+    const auto entryIter = iter->second;
+    auto&      entry     = *entryIter;
+
+    if (aIsUnwritten != nullptr) {
+        *aIsUnwritten = !entry.isWritten;
+    }
+
+    // An entry which wasn't written out is the only copy of the chunk's latest state that's sure
+    // to exist, so it's kept until that state is persisted (if the taker ends up discarding the
+    // chunk, it's not lost)
+    if (!entry.isWritten) {
+        if (_compress) {
+            Decompress(entry.data, entry.rawByteCount, aBytes);
+        } else {
+            aBytes = entry.data;
+        }
+        return true;
+    }
+
+    _stats.byteCount -= hg::stopz(entry.data.size());
+    _stats.rawByteCount -= entry.rawByteCount;
+    _stats.entryCount -= 1;
+
+    if (_compress) {
+        Decompress(entry.data, entry.rawByteCount, aBytes);
+    } else {
+        aBytes = std::move(entry.data);
+    }
+
+    _index.erase(iter);
+    _entries.erase(entryIter);
+
+    return true;
+}
+
+void ChunkRuntimeCache::erase(ChunkId aChunkId) {
+    const auto iter = _index.find(aChunkId);
+    if (iter != _index.end()) {
+        _eraseEntry(iter->second);
+    }
+}
+
+void ChunkRuntimeCache::flush(const WriteHandler& aWriteHandler) {
+    for (auto& entry : _entries) {
+        if (!entry.isWritten) {
+            _writeEntry(entry, aWriteHandler);
+        }
+    }
+}
+
+void ChunkRuntimeCache::_eraseEntry(EntryList::iterator aIter) {
+    _stats.byteCount -= hg::stopz(aIter->data.size());
+    _stats.rawByteCount -= aIter->rawByteCount;
+    _stats.entryCount -= 1;
+
+    _index.erase(aIter->chunkId);
+    _entries.erase(aIter);
+}
+
+void ChunkRuntimeCache::_writeEntry(Entry& aEntry, const WriteHandler& aWriteHandler) {
+    if (_compress) {
+        Decompress(aEntry.data, aEntry.rawByteCount, _decompressionBuffer);
+        aWriteHandler(aEntry.chunkId, _decompressionBuffer.data(), aEntry.rawByteCount);
+    } else {
+        aWriteHandler(aEntry.chunkId, aEntry.data.data(), aEntry.rawByteCount);
+    }
+    aEntry.isWritten = true;
+    _stats.writeCount += 1;
+}
+
+void ChunkRuntimeCache::_evictUntilWithinLimit(const WriteHandler& aWriteHandler) {
+    while (!_entries.empty() && _stats.byteCount > _byteLimit) {
+        const auto iter = std::prev(_entries.end());
+        if (!iter->isWritten) {
+            _writeEntry(*iter, aWriteHandler);
+        }
+        _stats.evictionCount += 1;
+        _eraseEntry(iter);
+    }
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
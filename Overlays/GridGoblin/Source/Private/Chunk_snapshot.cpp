@@ -0,0 +1,94 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Chunk_snapshot.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Utility/Stream.hpp>
+
+#include <memory>
+#include <typeinfo>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+//! Stands in for the extension of a chunk created from a snapshot; when serialized, it writes
+//! out the data that the original extension produced when the snapshot was taken.
+class SerializedChunkExtension : public ChunkExtensionInterface {
+public:
+    SerializedChunkExtension(SerializationMethod aSerializationMethod, const std::string& aData)
+        : _serializationMethod{aSerializationMethod}
+        , _data{aData} {}
+
+    SerializationMethod getPreferredSerializationMethod() const override {
+        return _serializationMethod;
+    }
+
+    void serialize(hg::util::OutputStream& aOStream) const override {
+        const auto byteCount = hg::stopz(_data.size());
+        if (byteCount > 0 && aOStream.write(_data.data(), byteCount) != byteCount) {
+            HG_THROW_TRACED(hg::util::StreamWriteError,
+                            0,
+                            "Failed to write {} bytes of chunk extension data to stream.",
+                            byteCount);
+        }
+    }
+
+    std::int64_t getUniqueIdentifier() const override {
+        return 0;
+    }
+
+    const std::type_info& getTypeInfo() const override {
+        return typeid(SerializedChunkExtension);
+    }
+
+private:
+    SerializationMethod _serializationMethod;
+    std::string         _data;
+};
+} // namespace
+
+ChunkSnapshot::ChunkSnapshot(ChunkId aChunkId, const Chunk& aChunk)
+    : _chunkId{aChunkId}
+    , _cells{aChunk._cells.share()} //
+{
+    HG_ASSERT(!aChunk.isEmpty());
+
+    const auto* extension = aChunk.getExtension();
+    if (extension == nullptr) {
+        return;
+    }
+
+    _hasExtension                 = true;
+    _extensionSerializationMethod = extension->getPreferredSerializationMethod();
+    if (_extensionSerializationMethod == ChunkExtensionInterface::SerializationMethod::BINARY_STREAM) {
+        hg::util::BufferStream stream;
+        extension->serialize(stream);
+        _extensionData.assign(static_cast<const char*>(stream.getData()),
+                              hg::pztos(stream.getDataSize()));
+    }
+}
+
+Chunk ChunkSnapshot::toChunk() const {
+    Chunk chunk{_cells.getWidth(), _cells.getHeight()};
+
+    for (hg::PZInteger y = 0; y < _cells.getHeight(); y += 1) {
+        for (hg::PZInteger x = 0; x < _cells.getWidth(); x += 1) {
+            static_cast<CellModel&>(chunk.getCellAtUnchecked(x, y)) =
+                static_cast<const CellModel&>(_cells[y][x]);
+        }
+    }
+
+    if (_hasExtension) {
+        chunk.setExtension(
+            std::make_unique<SerializedChunkExtension>(_extensionSerializationMethod, _extensionData));
+    }
+
+    return chunk;
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -8,6 +8,7 @@
 #include <Hobgoblin/Utility/Log_with_scoped_stopwatch.hpp>
 
 #include <algorithm>
+#include <atomic>
 
 // TODO: SetThreadName
 
@@ -18,10 +19,15 @@ namespace detail {
 namespace {
 constexpr auto LOG_ID = "GridGoblin";
 
-std::optional<Chunk> LoadChunk(ChunkId aChunkId, ChunkDiskIoHandlerInterface& aDiskIoHandler) {
+//! `aIsUnsaved` is set to `true` if the chunk was loaded from a state which wasn't yet written to
+//! the persistent cache, and to `false` otherwise.
+std::optional<Chunk> LoadChunk(ChunkId                      aChunkId,
+                               ChunkDiskIoHandlerInterface& aDiskIoHandler,
+                               bool&                        aIsUnsaved) {
     HG_LOG_WITH_SCOPED_STOPWATCH_MS(INFO, LOG_ID, "Chunk {} loaded in {}ms.", aChunkId, elapsed_time_ms);
 
-    auto rtChunk = aDiskIoHandler.loadChunkFromRuntimeCache(aChunkId);
+    aIsUnsaved   = false;
+    auto rtChunk = aDiskIoHandler.loadChunkFromRuntimeCache(aChunkId, aIsUnsaved);
     if (rtChunk.has_value()) {
         HG_LOG_DEBUG(LOG_ID, "Chunk {} loaded from runtime cache.", aChunkId);
         return rtChunk;
@@ -33,6 +39,13 @@ std::optional<Chunk> LoadChunk(ChunkId aChunkId, ChunkDiskIoHandlerInterface& aD
 void UnloadChunk(const Chunk& aChunk, ChunkId aChunkId, ChunkDiskIoHandlerInterface& aDiskIoHandler) {
     aDiskIoHandler.storeChunkInRuntimeCache(aChunk, aChunkId);
 }
+
+void SaveChunk(const ChunkSnapshot& aSnapshot, ChunkDiskIoHandlerInterface& aDiskIoHandler) {
+    aDiskIoHandler.storeChunkInPersistentCache(aSnapshot.toChunk(), aSnapshot.getChunkId());
+}
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
 } // namespace
 
 ///////////////////////////////////////////////////////////////////////////
@@ -78,7 +91,8 @@ public:
             }
             _isCancelled = true;
         }
-        _spooler._cancelLoadRequest(_chunkId);
+        _cv_finished.notify_all();
+        _spooler._cancelLoadRequest(_chunkId, this);
     }
 
     ChunkId getChunkId() const override {
@@ -86,8 +100,20 @@ public:
     }
 
     bool isFinished() const override {
+        // Lock-free, as it's checked for every finished request in `ChunkStorageHandler::update()`
+        return _isFinished.load(std::memory_order_acquire);
+    }
+
+    bool waitUntilFinished(std::chrono::microseconds aTimeout) const override {
         std::unique_lock<std::mutex> lock{_mutex};
-        return _isFinished;
+        return _cv_finished.wait_for(lock, aTimeout, [this]() {
+            return _isFinished || _isCancelled;
+        }) && _isFinished;
+    }
+
+    bool isChunkUnsaved() const override {
+        std::unique_lock<std::mutex> lock{_mutex};
+        return _isChunkUnsaved;
     }
 
     std::optional<Chunk> takeChunk() override {
@@ -100,33 +126,43 @@ public:
                                 "takeChunk() called but request was not finished, "
                                 "or the result was already taken.");
             }
-            chunk       = std::move(_chunk);
-            _isFinished = false;
+            chunk = std::move(_chunk);
+            _isFinished.store(false, std::memory_order_relaxed);
         }
         return chunk;
     }
 
-    void giveResult(std::optional<Chunk> aChunkOpt) {
+    //! Returns `false`, without taking the chunk, if the request was cancelled in the meantime.
+    bool giveResult(std::optional<Chunk>&& aChunkOpt, bool aIsUnsaved) {
+        // (The mutex is still needed for `waitUntilFinished()`, but it's hardly ever contended)
         std::unique_lock<std::mutex> lock{_mutex};
-        _chunk      = std::move(aChunkOpt);
-        _isFinished = true;
+        if (_isCancelled) {
+            return false;
+        }
+        _chunk          = std::move(aChunkOpt);
+        _isChunkUnsaved = aIsUnsaved;
+        _isFinished.store(true, std::memory_order_release);
 
         lock.unlock();
+        _cv_finished.notify_all();
 
         if (_readyCallback) {
             _readyCallback(_chunkId);
         }
+        return true;
     }
 
 private:
     DefaultChunkSpooler& _spooler;
     ChunkId              _chunkId;
 
-    mutable std::mutex           _mutex;
-    std::optional<Chunk>         _chunk;
-    std::function<void(ChunkId)> _readyCallback = nullptr;
-    bool                         _isCancelled   = false;
-    bool                         _isFinished    = false;
+    mutable std::mutex              _mutex;
+    mutable std::condition_variable _cv_finished;
+    std::optional<Chunk>            _chunk;
+    std::function<void(ChunkId)>    _readyCallback  = nullptr;
+    bool                            _isCancelled    = false;
+    bool                            _isChunkUnsaved = false;
+    std::atomic<bool>               _isFinished     = false; //!< Only changed with `_mutex` locked
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -135,11 +171,21 @@ private:
 
 #define HOLDS_LOAD_REQUEST(_variant_)   std::holds_alternative<LoadRequest>(_variant_)
 #define HOLDS_UNLOAD_REQUEST(_variant_) std::holds_alternative<UnloadRequest>(_variant_)
+#define HOLDS_SAVE_REQUEST(_variant_)   std::holds_alternative<SaveRequest>(_variant_)
 
-DefaultChunkSpooler::DefaultChunkSpooler()
-    : _worker{&DefaultChunkSpooler::_workerBody, this} {
-    // SetThreadName(_worker, "chunkspool");
-    HG_LOG_INFO(LOG_ID, "Spooler started.");
+DefaultChunkSpooler::DefaultChunkSpooler(hg::PZInteger aWorkerCount) {
+    HG_VALIDATE_ARGUMENT(aWorkerCount >= 1);
+
+    _workerStats.resize(hg::pztos(aWorkerCount));
+    _startTime = std::chrono::steady_clock::now();
+
+    _workers.reserve(hg::pztos(aWorkerCount));
+    for (hg::PZInteger i = 0; i < aWorkerCount; i += 1) {
+        _workers.emplace_back(&DefaultChunkSpooler::_workerBody, this, i);
+        // SetThreadName(_workers.back(), "chunkspool");
+    }
+
+    HG_LOG_INFO(LOG_ID, "Spooler started ({} workers).", aWorkerCount);
 }
 
 void DefaultChunkSpooler::setDiskIoHandler(ChunkDiskIoHandlerInterface* aDiskIoHandler) {
@@ -153,8 +199,21 @@ DefaultChunkSpooler::~DefaultChunkSpooler() {
         std::unique_lock<Mutex> lock{_mutex};
         _stopped = true;
     }
-    _cv_workerSync.notify_one();
-    _worker.join();
+    _cv_workerSync.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+
+    const auto stats = getWorkerStats();
+    for (std::size_t i = 0; i < stats.size(); i += 1) {
+        HG_LOG_INFO(LOG_ID,
+                    "Spooler worker {}: {} loads, {} unloads, {} saves, utilisation {:.1f}%.",
+                    i,
+                    stats[i].loadCount,
+                    stats[i].unloadCount,
+                    stats[i].saveCount,
+                    stats[i].getUtilisation() * 100.0);
+    }
 
     HG_LOG_INFO(LOG_ID, "Spooler stopped.");
 }
@@ -162,6 +221,9 @@ DefaultChunkSpooler::~DefaultChunkSpooler() {
 void DefaultChunkSpooler::pause() {
     std::unique_lock<Mutex> lock{_mutex};
     _paused = true;
+    _cv_idle.wait(lock, [this, &lock]() {
+        return _isIdle(lock);
+    });
 }
 
 void DefaultChunkSpooler::unpause() {
@@ -196,7 +258,11 @@ std::vector<std::shared_ptr<DefaultChunkSpooler::RequestHandleInterface>> Defaul
     }
 
     lock.unlock();
-    _cv_workerSync.notify_one();
+    if (aLoadRequests.size() == 1) {
+        _cv_workerSync.notify_one();
+    } else {
+        _cv_workerSync.notify_all();
+    }
 
     return handles;
 }
@@ -221,6 +287,18 @@ hg::PZInteger DefaultChunkSpooler::unloadChunk(ChunkId aChunkId, Chunk&& aChunk)
                             "same chunk ({}, {}) already in progress.",
                             aChunkId.x,
                             aChunkId.y);
+        } else if (HOLDS_SAVE_REQUEST(existingRequest)) {
+            // The snapshot wasn't written yet, so the chunk itself is written in its place (the
+            // request keeps its place in the unload queue)
+            auto saveJobs   = std::move(std::get<SaveRequest>(existingRequest).saveJobs);
+            existingRequest = UnloadRequest{std::move(aChunk), aChunkId, std::move(saveJobs)};
+
+            const auto result = _unloadRequestCount;
+
+            lock.unlock();
+            _cv_workerSync.notify_one();
+
+            return result;
         } else {
             HG_UNREACHABLE("Invalid request found in request map for chunk {}, {}.",
                            aChunkId.x,
@@ -228,9 +306,13 @@ hg::PZInteger DefaultChunkSpooler::unloadChunk(ChunkId aChunkId, Chunk&& aChunk)
         }
     }
 
-    auto& cb   = _requests[aChunkId];
-    cb.request = UnloadRequest{std::move(aChunk), aChunkId};
-    cb.handle  = nullptr;
+    _sequenceCounter += 1;
+
+    auto& cb    = _requests[aChunkId];
+    cb.request  = UnloadRequest{std::move(aChunk), aChunkId};
+    cb.handle   = nullptr;
+    cb.sequence = _sequenceCounter;
+    _unloadQueue.push_back({0, cb.sequence, aChunkId});
     _unloadRequestCount += 1;
 
     const auto result = _unloadRequestCount;
@@ -241,6 +323,70 @@ hg::PZInteger DefaultChunkSpooler::unloadChunk(ChunkId aChunkId, Chunk&& aChunk)
     return result;
 }
 
+std::shared_future<void> DefaultChunkSpooler::saveChunks(std::vector<ChunkSnapshot> aSnapshots) {
+    auto job    = std::make_shared<SaveJob>();
+    auto future = job->promise.get_future().share();
+
+    std::unique_lock<Mutex> lock{_mutex};
+
+    for (const auto& snapshot : aSnapshots) {
+        const auto chunkId = snapshot.getChunkId();
+        const auto iter    = _requests.find(chunkId);
+        if (iter != _requests.end() && !HOLDS_SAVE_REQUEST(iter->second.request)) {
+            HG_THROW_TRACED(hg::TracedLogicError,
+                            0,
+                            "Save request received but there is a load or unload request for the "
+                            "same chunk ({}, {}) already in progress.",
+                            chunkId.x,
+                            chunkId.y);
+        }
+    }
+
+    // Chunks which were unloaded but not yet written anywhere are saved as well
+    for (auto& [chunkId, cb] : _requests) {
+        if (HOLDS_UNLOAD_REQUEST(cb.request)) {
+            std::get<UnloadRequest>(cb.request).saveJobs.push_back(job);
+            job->remainingWriteCount += 1;
+        }
+    }
+    for (auto& [chunkId, saveJobs] : _unloadsInProgress) {
+        saveJobs.push_back(job);
+        job->remainingWriteCount += 1;
+    }
+
+    for (auto& snapshot : aSnapshots) {
+        const auto chunkId = snapshot.getChunkId();
+        const auto iter    = _requests.find(chunkId);
+        if (iter != _requests.end()) {
+            // Snapshot from an earlier save which wasn't written yet - replace it with the new one
+            auto& saveRequest    = std::get<SaveRequest>(iter->second.request);
+            saveRequest.snapshot = std::move(snapshot);
+            saveRequest.saveJobs.push_back(job);
+            job->remainingWriteCount += 1;
+            continue;
+        }
+
+        _sequenceCounter += 1;
+
+        auto& cb    = _requests[chunkId];
+        cb.request  = SaveRequest{std::move(snapshot), {job}};
+        cb.handle   = nullptr;
+        cb.sequence = _sequenceCounter;
+        _unloadQueue.push_back({0, cb.sequence, chunkId});
+        _unloadRequestCount += 1;
+        job->remainingWriteCount += 1;
+    }
+
+    if (job->remainingWriteCount == 0) {
+        _saveJobsAwaitingDump.push_back(std::move(job));
+    }
+
+    lock.unlock();
+    _cv_workerSync.notify_all();
+
+    return future;
+}
+
 void DefaultChunkSpooler::dumpRuntimeCache() {
     std::unique_lock<Mutex> lock{_mutex};
 
@@ -249,53 +395,199 @@ void DefaultChunkSpooler::dumpRuntimeCache() {
     _diskIoHandler->dumpRuntimeCache();
 }
 
+std::vector<DefaultChunkSpooler::WorkerStats> DefaultChunkSpooler::getWorkerStats() const {
+    std::unique_lock<Mutex> lock{_mutex};
+
+    auto       result   = _workerStats;
+    const auto lifetime = duration_cast<microseconds>(std::chrono::steady_clock::now() - _startTime);
+    for (auto& stats : result) {
+        stats.lifetime = lifetime;
+    }
+    return result;
+}
+
+DefaultChunkSpooler::QueueStats DefaultChunkSpooler::getQueueStats() const {
+    std::unique_lock<Mutex> lock{_mutex};
+    return {.loadCount = _loadRequestCount, .unloadCount = _unloadRequestCount};
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // PRIVATE METHODS                                                       //
 ///////////////////////////////////////////////////////////////////////////
 
-void DefaultChunkSpooler::_workerBody() {
+void DefaultChunkSpooler::_workerBody(hg::PZInteger aWorkerIndex) {
     while (true) {
-        RequestControlBlock cb;
+        RequestControlBlock      cb;
+        ChunkId                  chunkId;
+        std::shared_ptr<SaveJob> saveJobAwaitingDump;
 
         /* SYNCHRONIZATION */
         {
             std::unique_lock<Mutex> lock{_mutex};
+            RequestIter             requestIter;
             while (true) {
                 if (_stopped) {
                     return; // Spooler is being destroyed
                 }
-                if (!_paused && _countAvailableRequests(lock) > 0) {
+                if (!_paused && !_saveJobsAwaitingDump.empty()) {
+                    saveJobAwaitingDump = std::move(_saveJobsAwaitingDump.front());
+                    _saveJobsAwaitingDump.pop_front();
+                    _dumpsInProgress += 1;
                     break; // Ready to work
                 }
+                if (!_paused && _countAvailableRequests(lock) > 0) {
+                    requestIter = _findRequestWithBestPriority(lock);
+                    if (requestIter != _requests.end()) {
+                        break; // Ready to work
+                    }
+                    // All pending requests are for chunks which are already being processed
+                }
                 _cv_workerSync.wait(lock);
             }
 
-            const auto requestIter = _findRequestWithBestPriority(lock);
-            cb                     = _eraseRequest(requestIter, lock);
-            _adjustUnloadPriority(cb.request, lock);
+            if (saveJobAwaitingDump == nullptr) {
+                chunkId = requestIter->first;
+                cb      = _eraseRequest(requestIter, lock);
+                _chunksInProgress.insert(chunkId);
+                if (HOLDS_UNLOAD_REQUEST(cb.request) &&
+                    std::get<UnloadRequest>(cb.request).saveJobs.empty()) {
+                    _unloadsInProgress[chunkId];
+                }
+                _adjustUnloadPriority(cb.request, lock);
+            }
+        }
+
+        if (saveJobAwaitingDump != nullptr) {
+            _finishSaveJob(*saveJobAwaitingDump);
+
+            bool isIdle;
+            {
+                std::unique_lock<Mutex> lock{_mutex};
+                _dumpsInProgress -= 1;
+                isIdle = _isIdle(lock);
+            }
+            if (isIdle) {
+                _cv_idle.notify_all();
+            }
+            continue;
         }
 
         /* WORK */
+        const auto workStart = std::chrono::steady_clock::now();
+
         auto& requestVariant = cb.request;
         HG_ASSERT(!std::holds_alternative<std::monostate>(requestVariant));
         HG_ASSERT(_diskIoHandler != nullptr);
 
-        if (HOLDS_LOAD_REQUEST(requestVariant)) {
+        const SaveJobList* saveJobs = nullptr;
+        std::exception_ptr saveError;
+
+        const bool isLoad = HOLDS_LOAD_REQUEST(requestVariant);
+        const bool isSave = HOLDS_SAVE_REQUEST(requestVariant);
+        if (isLoad) {
             const auto& loadRequest = std::get<LoadRequest>(requestVariant);
-            auto        chunk       = LoadChunk(loadRequest.chunkId, *_diskIoHandler);
-            if (cb.handle) {
-                cb.handle->giveResult(std::move(chunk));
+            bool        isUnsaved   = false;
+            auto        chunk       = LoadChunk(loadRequest.chunkId, *_diskIoHandler, isUnsaved);
+            if (cb.handle && !cb.handle->giveResult(std::move(chunk), isUnsaved) && chunk.has_value() &&
+                isUnsaved) {
+                // The request was cancelled while the chunk was being loaded, and no one will take
+                // it; as its state wasn't saved yet, it's put back where it was loaded from
+                UnloadChunk(*chunk, loadRequest.chunkId, *_diskIoHandler);
+            }
+        } else if (isSave) {
+            const auto& saveRequest = std::get<SaveRequest>(requestVariant);
+            saveJobs                = &saveRequest.saveJobs;
+            try {
+                SaveChunk(saveRequest.snapshot, *_diskIoHandler);
+            } catch (...) {
+                saveError = std::current_exception();
             }
         } else /*if (HOLDS_UNLOAD_REQUEST(requestVariant))*/ {
             const auto& unloadRequest = std::get<UnloadRequest>(requestVariant);
-            UnloadChunk(unloadRequest.chunk, unloadRequest.id, *_diskIoHandler);
+            if (unloadRequest.saveJobs.empty()) {
+                UnloadChunk(unloadRequest.chunk, unloadRequest.id, *_diskIoHandler);
+            } else {
+                saveJobs = &unloadRequest.saveJobs;
+                try {
+                    _diskIoHandler->storeChunkInPersistentCache(unloadRequest.chunk, unloadRequest.id);
+                } catch (...) {
+                    saveError = std::current_exception();
+                    // Don't lose the chunk's data; the next save will get another go at it
+                    UnloadChunk(unloadRequest.chunk, unloadRequest.id, *_diskIoHandler);
+                }
+            }
         }
+
+        const auto workDuration = std::chrono::steady_clock::now() - workStart;
+
+        /* CLEANUP */
+        bool isChunkAwaited;
+        bool isDumpAwaited = false;
+        bool isIdle;
+        {
+            std::unique_lock<Mutex> lock{_mutex};
+            _chunksInProgress.erase(chunkId);
+
+            auto& stats = _workerStats[hg::pztos(aWorkerIndex)];
+            stats.busyTime += duration_cast<microseconds>(workDuration);
+            if (isLoad) {
+                stats.loadCount += 1;
+            } else if (isSave) {
+                stats.saveCount += 1;
+            } else {
+                stats.unloadCount += 1;
+            }
+
+            if (saveJobs != nullptr) {
+                isDumpAwaited = _onChunkSaved(*saveJobs, saveError, lock);
+            }
+
+            const auto unloadIter = _unloadsInProgress.find(chunkId);
+            if (unloadIter != _unloadsInProgress.end()) {
+                // The chunk is now in the runtime cache, so the saves which were started while it
+                // was on its way there can go on to dump it
+                const auto laterSaveJobs = std::move(unloadIter->second);
+                _unloadsInProgress.erase(unloadIter);
+                isDumpAwaited = _onChunkSaved(laterSaveJobs, nullptr, lock) || isDumpAwaited;
+            }
+
+            isChunkAwaited = (_requests.find(chunkId) != _requests.end());
+            isIdle         = _isIdle(lock);
+        }
+        if (isChunkAwaited || isDumpAwaited) {
+            // Another request for the same chunk was waiting for this one to finish,
+            // or a save job is ready to be finished off
+            _cv_workerSync.notify_one();
+        }
+        if (isIdle) {
+            _cv_idle.notify_all();
+        }
+    }
+}
+
+void DefaultChunkSpooler::_finishSaveJob(SaveJob& aSaveJob) {
+    HG_ASSERT(_diskIoHandler != nullptr);
+
+    try {
+        _diskIoHandler->dumpRuntimeCache();
+    } catch (...) {
+        if (!aSaveJob.firstError) {
+            aSaveJob.firstError = std::current_exception();
+        }
+    }
+
+    // No need to lock: no one else refers to the job anymore, apart from through the future
+    if (aSaveJob.firstError) {
+        HG_LOG_WARN(LOG_ID, "Saving chunks failed.");
+        aSaveJob.promise.set_exception(aSaveJob.firstError);
+    } else {
+        aSaveJob.promise.set_value();
     }
 }
 
 std::shared_ptr<DefaultChunkSpooler::RequestHandleInterface> DefaultChunkSpooler::_onNewLoadRequest(
-    LoadRequest aLoadRequest,
-    const std::unique_lock<Mutex>&)
+    LoadRequest                    aLoadRequest,
+    const std::unique_lock<Mutex>& aLock)
 //
 {
     auto handle = std::make_shared<RequestHandleImpl>(*this,
@@ -308,14 +600,30 @@ std::shared_ptr<DefaultChunkSpooler::RequestHandleInterface> DefaultChunkSpooler
         if (HOLDS_LOAD_REQUEST(existingRequest)) {
             HG_NOT_IMPLEMENTED("Handling of duplicate load requests not implemented.");
         } else if (HOLDS_UNLOAD_REQUEST(existingRequest)) {
-            handle->giveResult(std::move(std::get<UnloadRequest>(existingRequest).chunk));
-            _requests.erase(iter);
-            _unloadRequestCount -= 1;
+            auto& unloadRequest = std::get<UnloadRequest>(existingRequest);
+            if (unloadRequest.saveJobs.empty()) {
+                handle->giveResult(std::move(unloadRequest.chunk), true);
+                _requests.erase(iter);
+                _unloadRequestCount -= 1;
+            } else {
+                // The chunk still has to be saved, so a snapshot of it is left in its place
+                auto saveJobs = std::move(unloadRequest.saveJobs);
+                auto snapshot = ChunkSnapshot{aLoadRequest.chunkId, unloadRequest.chunk};
+                handle->giveResult(std::move(unloadRequest.chunk), true);
+                existingRequest = SaveRequest{std::move(snapshot), std::move(saveJobs)};
+            }
             HG_LOG_DEBUG(LOG_ID,
                          "Load request for chunk {}, {} resolved by moving the "
                          "chunk out of a pending unload request.",
                          aLoadRequest.chunkId.x,
                          aLoadRequest.chunkId.y);
+        } else if (HOLDS_SAVE_REQUEST(existingRequest)) {
+            HG_THROW_TRACED(hg::TracedLogicError,
+                            0,
+                            "Load request received but there is a save request for the "
+                            "same chunk ({}, {}) pending, which means it's still loaded.",
+                            aLoadRequest.chunkId.x,
+                            aLoadRequest.chunkId.y);
         } else {
             HG_UNREACHABLE("Invalid request found in request map for chunk {}, {}.",
                            aLoadRequest.chunkId.x,
@@ -327,67 +635,105 @@ std::shared_ptr<DefaultChunkSpooler::RequestHandleInterface> DefaultChunkSpooler
     auto& cb   = _requests[aLoadRequest.chunkId];
     cb.request = aLoadRequest;
     cb.handle  = handle;
+    _enqueueLoadRequest(cb, aLock);
     _loadRequestCount += 1;
 
     return handle;
 }
 
+void DefaultChunkSpooler::_enqueueLoadRequest(RequestControlBlock& aControlBlock,
+                                              const std::unique_lock<Mutex>&) {
+    const auto& loadRequest = std::get<LoadRequest>(aControlBlock.request);
+
+    _sequenceCounter += 1;
+    aControlBlock.sequence = _sequenceCounter;
+    _loadQueue.push({loadRequest.priority, aControlBlock.sequence, loadRequest.chunkId});
+}
+
 hg::PZInteger DefaultChunkSpooler::_countAvailableRequests(const std::unique_lock<Mutex>&) const {
     HG_ASSERT(hg::stopz(_requests.size()) == _loadRequestCount + _unloadRequestCount);
     return hg::stopz(_requests.size());
 }
 
-DefaultChunkSpooler::RequestIter DefaultChunkSpooler::_findLoadRequestWithBestPriority(
+DefaultChunkSpooler::RequestIter DefaultChunkSpooler::_findEligibleLoadRequest(
     const std::unique_lock<Mutex>&) {
-    auto iterToLoadRequestWithBestPriority = _requests.end();
-    for (auto iter = _requests.begin(); iter != _requests.end(); iter = std::next(iter)) {
-        if (HOLDS_LOAD_REQUEST(iter->second.request)) {
-            if (iterToLoadRequestWithBestPriority == _requests.end()) {
-                iterToLoadRequestWithBestPriority = iter;
-            } else {
-                const LoadRequest curr = std::get<LoadRequest>(iter->second.request);
-                const LoadRequest best =
-                    std::get<LoadRequest>(iterToLoadRequestWithBestPriority->second.request);
-                if (curr.priority < best.priority) {
-                    iterToLoadRequestWithBestPriority = iter;
-                }
-            }
+    std::vector<QueueEntry> blockedEntries;
+
+    auto result = _requests.end();
+    while (!_loadQueue.empty()) {
+        const auto& entry = _loadQueue.top();
+
+        const auto iter = _requests.find(entry.chunkId);
+        if (iter == _requests.end() || iter->second.sequence != entry.sequence) {
+            _loadQueue.pop(); // Stale entry
+            continue;
+        }
+        if (_chunksInProgress.count(entry.chunkId) > 0) {
+            blockedEntries.push_back(entry);
+            _loadQueue.pop();
+            continue;
         }
+
+        // The entry is left in the queue; it will become stale once the request is erased
+        result = iter;
+        break;
+    }
+
+    for (const auto& entry : blockedEntries) {
+        _loadQueue.push(entry);
     }
-    HG_ASSERT(iterToLoadRequestWithBestPriority != _requests.end());
-    return iterToLoadRequestWithBestPriority;
+
+    return result;
 }
 
-DefaultChunkSpooler::RequestIter DefaultChunkSpooler::_findAnyUnloadRequest(
+DefaultChunkSpooler::RequestIter DefaultChunkSpooler::_findEligibleUnloadRequest(
     const std::unique_lock<Mutex>&) {
-    for (auto iter = _requests.begin(); iter != _requests.end(); iter = std::next(iter)) {
-        if (HOLDS_UNLOAD_REQUEST(iter->second.request)) {
+    // Discard stale entries from the front
+    while (!_unloadQueue.empty()) {
+        const auto& entry = _unloadQueue.front();
+
+        const auto iter = _requests.find(entry.chunkId);
+        if (iter == _requests.end() || iter->second.sequence != entry.sequence) {
+            _unloadQueue.pop_front();
+            continue;
+        }
+        break;
+    }
+
+    for (const auto& entry : _unloadQueue) {
+        const auto iter = _requests.find(entry.chunkId);
+        if (iter == _requests.end() || iter->second.sequence != entry.sequence) {
+            continue; // Stale entry
+        }
+        if (_chunksInProgress.count(entry.chunkId) == 0) {
             return iter;
         }
     }
-    HG_UNREACHABLE("No unload request could be found.");
+
+    return _requests.end();
 }
 
 DefaultChunkSpooler::RequestIter DefaultChunkSpooler::_findRequestWithBestPriority(
     const std::unique_lock<Mutex>& aLock) {
     HG_ASSERT(!_requests.empty());
 
-    if (_unloadRequestCount == 0) {
-        return _findLoadRequestWithBestPriority(aLock);
-    }
+    const auto loadIter   = (_loadRequestCount > 0) ? _findEligibleLoadRequest(aLock) : _requests.end();
+    const auto unloadIter = (_unloadRequestCount > 0) ? _findEligibleUnloadRequest(aLock)
+                                                       : _requests.end();
 
-    if (_loadRequestCount == 0) {
-        return _findAnyUnloadRequest(aLock);
+    if (unloadIter == _requests.end()) {
+        return loadIter;
     }
 
-    const auto iterToLoadRequestWithBestPriority = _findLoadRequestWithBestPriority(aLock);
-    const auto loadRequestWithBestPriority =
-        std::get<LoadRequest>(iterToLoadRequestWithBestPriority->second.request);
+    if (loadIter == _requests.end()) {
+        return unloadIter;
+    }
 
-    if (loadRequestWithBestPriority.priority <= _unloadPriority) {
-        return iterToLoadRequestWithBestPriority;
+    const auto& loadRequest = std::get<LoadRequest>(loadIter->second.request);
+    if (loadRequest.priority <= _unloadPriority) {
+        return loadIter;
     } else {
-        return _findAnyUnloadRequest(aLock);
+        return unloadIter;
     }
 }
 
@@ -398,7 +744,7 @@ DefaultChunkSpooler::RequestControlBlock DefaultChunkSpooler::_eraseRequest(
     _requests.erase(aRequestIter);
     if (HOLDS_LOAD_REQUEST(cb.request)) {
         _loadRequestCount -= 1;
-    } else if (HOLDS_UNLOAD_REQUEST(cb.request)) {
+    } else if (HOLDS_UNLOAD_REQUEST(cb.request) || HOLDS_SAVE_REQUEST(cb.request)) {
         _unloadRequestCount -= 1;
     } else {
         HG_UNREACHABLE("Invalid request found in request map.");
@@ -406,11 +752,35 @@ DefaultChunkSpooler::RequestControlBlock DefaultChunkSpooler::_eraseRequest(
     return cb;
 }
 
-void DefaultChunkSpooler::_cancelLoadRequest(ChunkId aChunkId) {
+bool DefaultChunkSpooler::_isIdle(const std::unique_lock<Mutex>&) const {
+    return _chunksInProgress.empty() && _dumpsInProgress == 0;
+}
+
+bool DefaultChunkSpooler::_onChunkSaved(const SaveJobList&        aSaveJobs,
+                                        const std::exception_ptr& aError,
+                                        const std::unique_lock<Mutex>&) {
+    bool result = false;
+    for (const auto& job : aSaveJobs) {
+        if (aError && !job->firstError) {
+            job->firstError = aError;
+        }
+        HG_ASSERT(job->remainingWriteCount > 0);
+        if ((job->remainingWriteCount -= 1) == 0) {
+            _saveJobsAwaitingDump.push_back(job);
+            result = true;
+        }
+    }
+    return result;
+}
+
+void DefaultChunkSpooler::_cancelLoadRequest(ChunkId aChunkId, const RequestHandleImpl* aHandle) {
     std::unique_lock<Mutex> lock{_mutex};
 
+    // If the request is already being processed (or was resolved right away), what's stored for the
+    // chunk could be a different request, which must be left alone
     const auto iter = _requests.find(aChunkId);
-    if (iter != _requests.end()) {
+    if (iter != _requests.end() && HOLDS_LOAD_REQUEST(iter->second.request) &&
+        iter->second.handle.get() == aHandle) {
         _eraseRequest(iter, lock);
     }
 }
@@ -426,6 +796,7 @@ std::optional<hg::PZInteger> DefaultChunkSpooler::_swapLoadRequestPriority(Chunk
 
         auto& loadRequest = std::get<LoadRequest>(request);
         std::swap(loadRequest.priority, aNewPriority);
+        _enqueueLoadRequest(iter->second, lock);
         return {aNewPriority};
     }
 
@@ -446,6 +817,7 @@ std::optional<hg::PZInteger> DefaultChunkSpooler::_boostLoadRequestPriority(Chun
             return {};
         }
         std::swap(loadRequest.priority, aNewPriority);
+        _enqueueLoadRequest(iter->second, lock);
         return {aNewPriority};
     }
 
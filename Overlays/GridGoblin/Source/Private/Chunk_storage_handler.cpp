@@ -7,7 +7,7 @@
 #include <Hobgoblin/Logging.hpp>
 #include <Hobgoblin/Utility/Time_utils.hpp>
 
-#include <thread>
+#include <algorithm>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -20,9 +20,12 @@ static constexpr auto LOG_ID = "GridGoblin";
 
 ChunkStorageHandler::ChunkStorageHandler(const WorldConfig& aConfig)
     : _chunks{aConfig.chunkCountX, aConfig.chunkCountY}
+    , _chunkModifiedFlags{aConfig.chunkCountX, aConfig.chunkCountY, 0}
     , _chunkWidth{aConfig.cellsPerChunkX}
     , _chunkHeight{aConfig.cellsPerChunkY}
-    , _freeChunkLimit{aConfig.maxLoadedNonessentialChunks} {}
+    , _freeChunkLimit{aConfig.maxLoadedNonessentialChunks}
+    , _chunkByteBudget{aConfig.loadedChunkByteBudget}
+    , _immediateLoadTimeout{aConfig.immediateChunkLoadTimeout} {}
 
 ///////////////////////////////////////////////////////////////////////////
 // MARK: DEPENDENCIES                                                    //
@@ -49,41 +52,160 @@ ActiveArea ChunkStorageHandler::createNewActiveArea() {
 ///////////////////////////////////////////////////////////////////////////
 
 void ChunkStorageHandler::update() {
-    auto iter = _chunkControlBlocks.begin();
-    for (; iter != _chunkControlBlocks.end(); iter = std::next(iter)) {
+    _readyChunks.drain([this](ChunkId aChunkId) {
+        // The entry can be stale: the request might have been cancelled in the meantime, or its
+        // chunk already integrated some other way (see `_updateChunkUsage()` and
+        // `_loadChunkImmediately()`), possibly followed by a new request for the same chunk
+        const auto iter = _chunkControlBlocks.find(aChunkId);
+        if (iter == _chunkControlBlocks.end()) {
+            return;
+        }
         auto& cb = iter->second;
-        if (cb.requestHandle != nullptr && cb.requestHandle->isFinished()) {
-            const auto id    = iter->first;
-            auto       chunk = cb.requestHandle->takeChunk();
-            if (chunk.has_value()) {
-                _onChunkLoaded(id, std::move(*chunk));
-            } else {
-                _createDefaultChunk(id);
-            }
-            cb.requestHandle = nullptr;
+        if (cb.requestHandle == nullptr || !cb.requestHandle->isFinished()) {
+            return;
         }
-    }
+
+        const auto isUnsaved = cb.requestHandle->isChunkUnsaved();
+        auto       chunk     = cb.requestHandle->takeChunk();
+        cb.requestHandle     = nullptr;
+        if (chunk.has_value()) {
+            _onChunkLoaded(aChunkId, std::move(*chunk), isUnsaved);
+        } else {
+            _createDefaultChunk(aChunkId);
+        }
+    });
 }
 
 void ChunkStorageHandler::prune() {
     HG_ASSERT(_chunkSpooler != nullptr);
 
-    while (_freeChunks.size() > hg::pztos(_freeChunkLimit)) {
+    // Only summed up when needed, as it has to go through all loaded chunks
+    std::int64_t residentByteCount = (_chunkByteBudget > 0) ? getResidentChunkByteCount() : 0;
+
+    while (!_freeChunks.empty() && (_freeChunks.size() > hg::pztos(_freeChunkLimit) ||
+                                    residentByteCount > _chunkByteBudget)) {
+        // Ordered by the time when they were freed, so this is the least recently used one
         const auto iter = _freeChunks.begin();
         const auto id   = iter->first;
 
         auto& chunk = CHUNK_AT_ID(id);
         HG_HARD_ASSERT(!chunk.isEmpty());
+        residentByteCount -= static_cast<std::int64_t>(chunk.getResidentSize());
         _chunkSpooler->unloadChunk(id, std::move(chunk));
         chunk.makeEmpty();
         _chunksInGridCount -= 1;
 
+        // The chunk's current state will be stored as part of unloading it (if it's reloaded before
+        // that state is written to disk, it will be flagged as modified again - see `_onChunkLoaded()`)
+        _chunkModifiedFlags[id.y][id.x] = 0;
+
         _freeChunks.erase(iter);
     }
 
     HG_HARD_ASSERT(hg::pztos(_chunksInGridCount) <= _chunkControlBlocks.size() + _freeChunks.size());
 }
 
+///////////////////////////////////////////////////////////////////////////
+// MARK: BULK CELL ACCESS                                                //
+///////////////////////////////////////////////////////////////////////////
+
+void ChunkStorageHandler::copyCellsToPlanes(hg::PZInteger aX,
+                                            hg::PZInteger aY,
+                                            CellPlanes&   aPlanes,
+                                            std::uint16_t aMissingCellFlags) const {
+    const auto cellCountX = _chunks.getWidth() * _chunkWidth;
+    const auto cellCountY = _chunks.getHeight() * _chunkHeight;
+
+    const auto width  = aPlanes.getWidth();
+    const auto height = aPlanes.getHeight();
+
+    for (hg::PZInteger row = 0; row < height; row += 1) {
+        const auto y = aY + row;
+        if (y < 0 || y >= cellCountY) {
+            aPlanes.fillRow(0, row, width, aMissingCellFlags);
+            continue;
+        }
+
+        const auto chunkY = y / _chunkHeight;
+        const auto cellY  = y % _chunkHeight;
+
+        hg::PZInteger col = 0;
+        while (col < width) {
+            const auto x = aX + col;
+            if (x < 0) {
+                const auto count = std::min(-x, width - col);
+                aPlanes.fillRow(col, row, count, aMissingCellFlags);
+                col += count;
+                continue;
+            }
+            if (x >= cellCountX) {
+                aPlanes.fillRow(col, row, width - col, aMissingCellFlags);
+                break;
+            }
+
+            const auto chunkX = x / _chunkWidth;
+            const auto cellX  = x % _chunkWidth;
+            const auto count  = std::min(_chunkWidth - cellX, width - col);
+
+            const auto& chunk = _chunks[chunkY][chunkX];
+            if (chunk.isEmpty()) {
+                aPlanes.fillRow(col, row, count, aMissingCellFlags);
+            } else {
+                aPlanes.loadRow(col, row, &chunk._getCellExtAtUnchecked(cellX, cellY), count);
+            }
+            col += count;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// MARK: SNAPSHOTS                                                       //
+///////////////////////////////////////////////////////////////////////////
+
+std::vector<ChunkSnapshot> ChunkStorageHandler::snapshotModifiedChunks() {
+    std::vector<ChunkSnapshot> snapshots;
+    snapshots.reserve(_modifiedChunks.size());
+
+    for (const auto id : _modifiedChunks) {
+        auto& isModified = _chunkModifiedFlags[id.y][id.x];
+        if (!isModified) {
+            continue; // Stale entry
+        }
+        isModified = 0;
+
+        const auto& chunk = CHUNK_AT_ID(id);
+        HG_ASSERT(!chunk.isEmpty());
+        snapshots.emplace_back(id, chunk);
+    }
+    _modifiedChunks.clear();
+
+    return snapshots;
+}
+
+hg::PZInteger ChunkStorageHandler::getModifiedChunkCount() const {
+    hg::PZInteger count = 0;
+    for (const auto id : _modifiedChunks) {
+        count += _chunkModifiedFlags[id.y][id.x];
+    }
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// MARK: DIAGNOSTICS                                                     //
+///////////////////////////////////////////////////////////////////////////
+
+std::int64_t ChunkStorageHandler::getResidentChunkByteCount() const {
+    // Every loaded chunk is either in an active area (and thus has a control block) or free
+    std::int64_t result = 0;
+    for (const auto& [id, cb] : _chunkControlBlocks) {
+        result += static_cast<std::int64_t>(CHUNK_AT_ID(id).getResidentSize());
+    }
+    for (const auto& [id, timestamp] : _freeChunks) {
+        result += static_cast<std::int64_t>(CHUNK_AT_ID(id).getResidentSize());
+    }
+    return result;
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // MARK: PRIVATE                                                         //
 ///////////////////////////////////////////////////////////////////////////
@@ -117,35 +239,70 @@ void ChunkStorageHandler::_loadChunkImmediately(ChunkId aChunkId) {
         requestHandle = std::move(handles.at(0));
     }
 
+    // Wait in short slices only so that progress can be logged; the thread sleeps in between.
+    static constexpr std::chrono::microseconds LOG_INTERVAL{10'000};
+
     hg::util::Stopwatch stopwatch;
-    int                 i = 0;
-    while (!requestHandle->isFinished()) {
-        if (stopwatch.getElapsedTime() >= std::chrono::milliseconds{10}) {
-            stopwatch.restart();
-            i += 1;
-            HG_LOG_DEBUG(LOG_ID, "Blocking until chunk {} is loaded ({}ms elapsed so far).", id, i * 10);
+    while (!requestHandle->waitUntilFinished(LOG_INTERVAL)) {
+        const auto elapsed = stopwatch.getElapsedTime<std::chrono::microseconds>();
+        if (_immediateLoadTimeout.count() > 0 && elapsed >= _immediateLoadTimeout) {
+            if (iter == _chunkControlBlocks.end()) {
+                // No one else knows about the request, so it must not be left pending (the spooler
+                // would reject the next request for the same chunk)
+                requestHandle->cancel();
+            }
+            HG_THROW_TRACED(hg::TracedRuntimeError,
+                            0,
+                            "Timed out waiting for chunk {} to be loaded ({}ms elapsed).",
+                            id,
+                            elapsed.count() / 1000);
         }
-        std::this_thread::yield();
+        HG_LOG_DEBUG(LOG_ID,
+                     "Blocking until chunk {} is loaded ({}ms elapsed so far).",
+                     id,
+                     elapsed.count() / 1000);
     }
 
-    auto chunk = requestHandle->takeChunk();
+    const auto blockedTime = stopwatch.getElapsedTime<std::chrono::microseconds>();
+    _immediateLoadStats.loadCount += 1;
+    _immediateLoadStats.blockedTime += blockedTime;
+    _immediateLoadStats.maxBlockedTime = std::max(_immediateLoadStats.maxBlockedTime, blockedTime);
+
+    const auto isUnsaved = requestHandle->isChunkUnsaved();
+    auto       chunk     = requestHandle->takeChunk();
     if (chunk.has_value()) {
-        _onChunkLoaded(id, std::move(*chunk));
+        _onChunkLoaded(id, std::move(*chunk), isUnsaved);
     } else {
         _createDefaultChunk(id);
     }
 
     if (iter == _chunkControlBlocks.end()) {
         _freeChunks.insert(std::make_pair(id, std::chrono::steady_clock::now()));
+    } else {
+        // (Looked up again as the binder could have changed the control blocks in the meantime)
+        const auto cbIter = _chunkControlBlocks.find(id);
+        if (cbIter != _chunkControlBlocks.end() && cbIter->second.requestHandle == requestHandle) {
+            cbIter->second.requestHandle = nullptr;
+        }
     }
 }
 
-void ChunkStorageHandler::_onChunkLoaded(ChunkId aChunkId, Chunk&& aChunk) {
+void ChunkStorageHandler::_onChunkLoaded(ChunkId aChunkId, Chunk&& aChunk, bool aIsUnsaved) {
     HG_HARD_ASSERT(!aChunk.isEmpty());
 
     auto& chunk = (CHUNK_AT_ID(aChunkId) = std::move(aChunk));
     _chunksInGridCount += 1;
 
+    // The chunk was unloaded with changes that weren't written to disk yet, so they still have to
+    // be included in the next save
+    if (aIsUnsaved) {
+        auto& isModified = _chunkModifiedFlags[aChunkId.y][aChunkId.x];
+        if (!isModified) {
+            isModified = true;
+            _modifiedChunks.push_back(aChunkId);
+        }
+    }
+
     HG_ASSERT(_binder != nullptr);
     _binder->onChunkLoaded(aChunkId, chunk);
 }
@@ -198,20 +355,23 @@ void ChunkStorageHandler::_updateChunkUsage(
                         cb.requestHandle->tryBoostPriority(change.loadPriority);
                     }
                 } else if (usageDelta < 0) {
-                    HG_ASSERT(cb.usageCount <= -usageDelta);
+                    HG_ASSERT(cb.usageCount >= -usageDelta);
                     if ((cb.usageCount += usageDelta) == 0) {
                         if (cb.requestHandle) {
+                            // (Cancelling does nothing if the request is already finished)
+                            cb.requestHandle->cancel();
                             if (cb.requestHandle->isFinished()) {
                                 // Handle edge case where the request was finished but the owning
-                                // active area moves before the chunk could be integrated
-                                auto chunk = cb.requestHandle->takeChunk();
+                                // active area moves before the chunk could be integrated (checked
+                                // only after cancelling, as the request could finish right before
+                                // it's cancelled, and then no one would take the chunk otherwise)
+                                const auto isUnsaved = cb.requestHandle->isChunkUnsaved();
+                                auto       chunk     = cb.requestHandle->takeChunk();
                                 if (chunk.has_value()) {
-                                    _onChunkLoaded(chunkId, std::move(*chunk));
+                                    _onChunkLoaded(chunkId, std::move(*chunk), isUnsaved);
                                 } else {
                                     _createDefaultChunk(chunkId);
                                 }
-                            } else {
-                                cb.requestHandle->cancel();
                             }
                         }
                         if (!CHUNK_AT_ID(chunkId).isEmpty()) {
@@ -255,6 +415,7 @@ void ChunkStorageHandler::_updateChunkUsage(
             cb.usageCount = usageDelta;
             cbs.push_back(&cb);
             requests.push_back({chunkId, change.loadPriority, [this](ChunkId aChunkId) {
+                                    _readyChunks.push(aChunkId);
                                     if (_binder != nullptr) {
                                         _binder->onChunkReady(aChunkId);
                                     }
@@ -278,6 +439,13 @@ void ChunkStorageHandler::_updateChunkUsage(
     }
 }
 
+void ChunkStorageHandler::_setChunkLoadPriority(ChunkId aChunkId, hg::PZInteger aLoadPriority) {
+    const auto iter = _chunkControlBlocks.find(aChunkId);
+    if (iter != _chunkControlBlocks.end() && iter->second.requestHandle != nullptr) {
+        iter->second.requestHandle->trySwapPriority(aLoadPriority);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // MARK: ITERATOR                                                        //
 ///////////////////////////////////////////////////////////////////////////
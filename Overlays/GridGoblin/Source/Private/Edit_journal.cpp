@@ -0,0 +1,381 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Edit_journal.hpp>
+
+#include <Hobgoblin/Logging.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <system_error>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin";
+
+// Format of a journal segment file (all numbers are little-endian):
+// - header:
+//   - 4 bytes: signature "GGEJ"
+//   - u16:     format version
+//   - u16:     reserved (0)
+// - any number of batches, each consisting of:
+//   - u32: number of entries in the batch (N)
+//   - u32: FNV-1a checksum of the entries
+//   - N entries, each consisting of:
+//     - u8:  kind (see EditJournal::Entry::Kind)
+//     - u32: cell X
+//     - u32: cell Y
+//     - u32: sprite ID
+//     - u32: reduced sprite ID
+//     - u8:  shape
+
+constexpr char          JOURNAL_SIGNATURE[4]      = {'G', 'G', 'E', 'J'};
+constexpr std::uint16_t JOURNAL_FORMAT_VERSION    = 1;
+constexpr std::int64_t  JOURNAL_HEADER_SIZE       = 8;
+constexpr std::int64_t  JOURNAL_BATCH_HEADER_SIZE = 8;
+constexpr std::int64_t  JOURNAL_ENTRY_SIZE        = 18;
+
+constexpr auto SEGMENT_PREFIX    = "edits_";
+constexpr auto SEGMENT_EXTENSION = ".ggej";
+
+void PutLE(char* aDst, std::uint64_t aValue, int aByteCount) {
+    for (int i = 0; i < aByteCount; i += 1) {
+        aDst[i] = static_cast<char>((aValue >> (8 * i)) & 0xFF);
+    }
+}
+
+std::uint64_t GetLE(const char* aSrc, int aByteCount) {
+    std::uint64_t result = 0;
+    for (int i = 0; i < aByteCount; i += 1) {
+        result |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(aSrc[i])) << (8 * i);
+    }
+    return result;
+}
+
+std::uint32_t CalculateChecksum(const char* aData, std::int64_t aByteCount) {
+    std::uint32_t hash = 2166136261u;
+    for (std::int64_t i = 0; i < aByteCount; i += 1) {
+        hash = (hash ^ static_cast<std::uint8_t>(aData[i])) * 16777619u;
+    }
+    return hash;
+}
+
+void EncodeEntry(const EditJournal::Entry& aEntry, char* aDst) {
+    PutLE(aDst + 0, aEntry.kind, 1);
+    PutLE(aDst + 1, static_cast<std::uint32_t>(aEntry.x), 4);
+    PutLE(aDst + 5, static_cast<std::uint32_t>(aEntry.y), 4);
+    PutLE(aDst + 9, static_cast<std::uint32_t>(aEntry.spriteId), 4);
+    PutLE(aDst + 13, static_cast<std::uint32_t>(aEntry.spriteId_reduced), 4);
+    PutLE(aDst + 17, static_cast<std::uint8_t>(aEntry.shape), 1);
+}
+
+//! \returns `false` if the encoded entry is not valid.
+bool DecodeEntry(const char* aSrc, EditJournal::Entry& aEntry) {
+    const auto kind  = GetLE(aSrc + 0, 1);
+    const auto shape = GetLE(aSrc + 17, 1);
+    if (kind > EditJournal::Entry::RESET_WALL || shape > static_cast<std::uint8_t>(Shape::FULL_SQUARE)) {
+        return false;
+    }
+    aEntry.kind             = static_cast<EditJournal::Entry::Kind>(kind);
+    aEntry.x                = static_cast<hg::PZInteger>(GetLE(aSrc + 1, 4));
+    aEntry.y                = static_cast<hg::PZInteger>(GetLE(aSrc + 5, 4));
+    aEntry.spriteId         = static_cast<SpriteId>(GetLE(aSrc + 9, 4));
+    aEntry.spriteId_reduced = static_cast<SpriteId>(GetLE(aSrc + 13, 4));
+    aEntry.shape            = static_cast<Shape>(shape);
+    return true;
+}
+} // namespace
+
+EditJournal::EditJournal(std::filesystem::path aDirectory, std::chrono::milliseconds aCommitInterval)
+    : _directory{std::move(aDirectory)}
+    , _commitInterval{aCommitInterval} //
+{
+    HG_VALIDATE_ARGUMENT(aCommitInterval.count() >= 0);
+
+    std::error_code ec;
+    std::filesystem::create_directories(_directory, ec);
+    if (ec) {
+        HG_THROW_TRACED(EditJournalError,
+                        0,
+                        "Failed to create edit journal directory '{}' ({}).",
+                        _directory.string(),
+                        ec.message());
+    }
+
+    for (const auto& dirEntry : std::filesystem::directory_iterator{_directory}) {
+        const auto fileName = dirEntry.path().filename().string();
+        if (!dirEntry.is_regular_file() || !fileName.starts_with(SEGMENT_PREFIX) ||
+            !fileName.ends_with(SEGMENT_EXTENSION)) {
+            continue;
+        }
+        const char*   first = fileName.data() + std::strlen(SEGMENT_PREFIX);
+        const char*   last  = fileName.data() + fileName.size() - std::strlen(SEGMENT_EXTENSION);
+        std::uint64_t index = 0;
+        if (std::from_chars(first, last, index).ptr == last) {
+            _segmentIndices.push_back(index);
+        }
+    }
+    std::sort(_segmentIndices.begin(), _segmentIndices.end());
+
+    for (const auto index : _segmentIndices) {
+        _readSegment(_getSegmentPath(index));
+    }
+    if (!_recoveredEntries.empty()) {
+        HG_LOG_INFO(LOG_ID,
+                    "Recovered {} edits from {} edit journal segments in '{}'.",
+                    _recoveredEntries.size(),
+                    _segmentIndices.size(),
+                    _directory.string());
+    }
+
+    _openSegment(_segmentIndices.empty() ? 0 : (_segmentIndices.back() + 1));
+
+    _writer = std::thread{[this]() {
+        _writerBody();
+    }};
+}
+
+EditJournal::~EditJournal() {
+    {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _stopped = true;
+    }
+    _cv_writer.notify_one();
+    _writer.join();
+}
+
+std::vector<EditJournal::Entry> EditJournal::takeRecoveredEntries() {
+    return std::move(_recoveredEntries);
+}
+
+void EditJournal::submit(const Entry* aEntries, hg::PZInteger aEntryCount) {
+    if (aEntryCount == 0) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _pendingEntries.insert(_pendingEntries.end(), aEntries, aEntries + aEntryCount);
+        _submittedBatchCount += 1;
+    }
+    _cv_writer.notify_one();
+}
+
+void EditJournal::flush() {
+    std::unique_lock<std::mutex> lock{_mutex};
+
+    const auto target = _submittedBatchCount;
+    if (_writtenBatchCount != target) {
+        _flushRequested = true;
+        _cv_writer.notify_one();
+        _cv_written.wait(lock, [this, target]() {
+            return _writtenBatchCount >= target;
+        });
+        _flushRequested = false;
+    }
+
+    if (_failed) {
+        HG_THROW_TRACED(EditJournalError,
+                        0,
+                        "Writing to the edit journal in '{}' failed; not all edits are journaled.",
+                        _directory.string());
+    }
+}
+
+std::uint64_t EditJournal::startNewSegment(const std::vector<Entry>& aCarriedOverEntries) {
+    // Once everything is written, the writer thread doesn't touch the file until something new is
+    // submitted (and that can only happen from this same thread)
+    flush();
+
+    try {
+        _file.close();
+        _openSegment(_segmentIndices.back() + 1);
+        if (!aCarriedOverEntries.empty()) {
+            _writeBatch(aCarriedOverEntries);
+        }
+    } catch (const EditJournalError&) {
+        _failed = true;
+        throw;
+    }
+
+    return _segmentIndices.back();
+}
+
+void EditJournal::discardSegmentsBefore(std::uint64_t aSegmentIndex) {
+    if (_failed) {
+        // Some edits might be missing from the newer segments, in which case the older ones might
+        // still be needed to piece together what happened
+        HG_LOG_WARN(LOG_ID, "Not discarding edit journal segments, as writing to the journal failed.");
+        return;
+    }
+
+    // The current segment is never discarded
+    while (_segmentIndices.size() > 1 && _segmentIndices.front() < aSegmentIndex) {
+        const auto      path = _getSegmentPath(_segmentIndices.front());
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        if (ec) {
+            HG_LOG_WARN(LOG_ID,
+                        "Failed to delete edit journal segment '{}' ({}).",
+                        path.string(),
+                        ec.message());
+        }
+        _segmentIndices.pop_front();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// MARK: PRIVATE METHODS                                                 //
+///////////////////////////////////////////////////////////////////////////
+
+void EditJournal::_writerBody() {
+    std::vector<Entry> batch;
+
+    std::unique_lock<std::mutex> lock{_mutex};
+    while (true) {
+        _cv_writer.wait(lock, [this]() {
+            return _stopped || _submittedBatchCount != _writtenBatchCount;
+        });
+        if (_submittedBatchCount == _writtenBatchCount) {
+            return; // Stopped, and there is nothing left to write
+        }
+
+        if (!_stopped && !_flushRequested) {
+            // Give further submissions a chance to join this batch
+            _cv_writer.wait_for(lock, _commitInterval, [this]() {
+                return _stopped || _flushRequested;
+            });
+        }
+
+        std::swap(batch, _pendingEntries);
+        const auto batchCount = _submittedBatchCount;
+
+        lock.unlock();
+        try {
+            _writeBatch(batch);
+        } catch (const std::exception& aEx) {
+            HG_LOG_ERROR(LOG_ID,
+                         "Failed to write {} edits to the edit journal: {}",
+                         batch.size(),
+                         aEx.what());
+            _failed = true;
+        }
+        batch.clear();
+        lock.lock();
+
+        _writtenBatchCount = batchCount;
+        _cv_written.notify_all();
+    }
+}
+
+std::filesystem::path EditJournal::_getSegmentPath(std::uint64_t aSegmentIndex) const {
+    return _directory / (SEGMENT_PREFIX + std::to_string(aSegmentIndex) + SEGMENT_EXTENSION);
+}
+
+void EditJournal::_readSegment(const std::filesystem::path& aPath) {
+    std::ifstream in{aPath, std::ios::in | std::ios::binary};
+    if (!in.is_open()) {
+        HG_LOG_WARN(LOG_ID, "Failed to open edit journal segment '{}'; ignoring it.", aPath.string());
+        return;
+    }
+    const std::vector<char> data{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+
+    const auto size = static_cast<std::int64_t>(data.size());
+    if (size < JOURNAL_HEADER_SIZE ||
+        std::memcmp(data.data(), JOURNAL_SIGNATURE, sizeof(JOURNAL_SIGNATURE)) != 0 ||
+        GetLE(data.data() + 4, 2) != JOURNAL_FORMAT_VERSION) {
+        HG_LOG_WARN(LOG_ID, "'{}' is not a valid edit journal segment; ignoring it.", aPath.string());
+        return;
+    }
+
+    std::int64_t offset = JOURNAL_HEADER_SIZE;
+    while (offset < size) {
+        bool valid = (size - offset >= JOURNAL_BATCH_HEADER_SIZE);
+
+        std::int64_t entryCount = 0;
+        const char*  entries    = nullptr;
+        if (valid) {
+            entryCount = static_cast<std::int64_t>(GetLE(data.data() + offset, 4));
+            entries    = data.data() + offset + JOURNAL_BATCH_HEADER_SIZE;
+
+            const auto checksum = static_cast<std::uint32_t>(GetLE(data.data() + offset + 4, 4));
+            valid = (size - offset - JOURNAL_BATCH_HEADER_SIZE >= entryCount * JOURNAL_ENTRY_SIZE) &&
+                    (CalculateChecksum(entries, entryCount * JOURNAL_ENTRY_SIZE) == checksum);
+        }
+
+        const auto previousCount = _recoveredEntries.size();
+        for (std::int64_t i = 0; valid && i < entryCount; i += 1) {
+            Entry entry{};
+            valid = DecodeEntry(entries + i * JOURNAL_ENTRY_SIZE, entry);
+            _recoveredEntries.push_back(entry);
+        }
+
+        if (!valid) {
+            // Most likely the program was interrupted while the batch was being written
+            _recoveredEntries.resize(previousCount);
+            HG_LOG_WARN(LOG_ID,
+                        "Discarding the last {} bytes of edit journal segment '{}' (incomplete or "
+                        "corrupted batch).",
+                        size - offset,
+                        aPath.string());
+            return;
+        }
+
+        offset += JOURNAL_BATCH_HEADER_SIZE + entryCount * JOURNAL_ENTRY_SIZE;
+    }
+}
+
+void EditJournal::_openSegment(std::uint64_t aSegmentIndex) {
+    const auto path = _getSegmentPath(aSegmentIndex);
+
+    _file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    char header[JOURNAL_HEADER_SIZE];
+    std::memcpy(header, JOURNAL_SIGNATURE, sizeof(JOURNAL_SIGNATURE));
+    PutLE(header + 4, JOURNAL_FORMAT_VERSION, 2);
+    PutLE(header + 6, 0, 2);
+    _file.write(header, sizeof(header));
+
+    if (!_file.flush()) {
+        HG_THROW_TRACED(EditJournalError,
+                        0,
+                        "Failed to create edit journal segment '{}'.",
+                        path.string());
+    }
+
+    _segmentIndices.push_back(aSegmentIndex);
+    _currentSegmentByteCount = JOURNAL_HEADER_SIZE;
+}
+
+void EditJournal::_writeBatch(const std::vector<Entry>& aEntries) {
+    const auto        entryCount = static_cast<std::int64_t>(aEntries.size());
+    std::vector<char> buffer(hg::pztos(JOURNAL_BATCH_HEADER_SIZE + entryCount * JOURNAL_ENTRY_SIZE));
+
+    char* entries = buffer.data() + JOURNAL_BATCH_HEADER_SIZE;
+    for (std::int64_t i = 0; i < entryCount; i += 1) {
+        EncodeEntry(aEntries[hg::pztos(i)], entries + i * JOURNAL_ENTRY_SIZE);
+    }
+    PutLE(buffer.data(), static_cast<std::uint64_t>(entryCount), 4);
+    PutLE(buffer.data() + 4, CalculateChecksum(entries, entryCount * JOURNAL_ENTRY_SIZE), 4);
+
+    // The whole batch is written with a single call and then flushed, so that the operating system
+    // has it even if the program crashes right after
+    _file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!_file.flush()) {
+        _file.clear();
+        HG_THROW_TRACED(EditJournalError,
+                        0,
+                        "Failed to write to edit journal segment '{}'.",
+                        _getSegmentPath(_segmentIndices.back()).string());
+    }
+    _currentSegmentByteCount += static_cast<std::int64_t>(buffer.size());
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
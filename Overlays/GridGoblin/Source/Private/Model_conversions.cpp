@@ -15,6 +15,8 @@
 #include <rapidjson/stringbuffer.h>
 
 #include <chrono>
+#include <cstring>
+#include <limits>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -431,6 +433,349 @@ Chunk JsonStringToChunk(std::string                  aJsonString,
     return result;
 }
 
+// MARK: Chunk <-> Binary
+
+/*
+ * Binary chunk format (all multi-byte integers are little-endian):
+ *
+ *   size  field
+ *   ----  -----
+ *      4  signature ("GGCB")
+ *      2  format version
+ *      2  chunk width (in cells)
+ *      2  chunk height (in cells)
+ *      4  byte count (N) of the cell block
+ *      N  cell block - for each cell, in row-major order:
+ *           2  flags
+ *           1  openness
+ *           4  floor sprite ID                         (only if FLOOR_INITIALIZED)
+ *           4  wall sprite ID                          (only if WALL_INITIALIZED)
+ *           4  wall reduced sprite ID                  (only if WALL_INITIALIZED)
+ *           1  wall shape                              (only if WALL_INITIALIZED)
+ *      1  extension kind (0 = none, 1 = binary stream)
+ *      4  byte count (M) of extension data             (only if extension kind != 0)
+ *      M  extension data                               (only if extension kind != 0)
+ */
+
+namespace {
+constexpr char BINARY_SIGNATURE[4] = {'G', 'G', 'C', 'B'};
+
+constexpr std::int64_t BINARY_HEADER_SIZE = sizeof(BINARY_SIGNATURE) + 2 + 2 + 2 + 4;
+
+constexpr std::size_t BINARY_MAX_CELL_SIZE = 2 + 1 + 4 + 4 + 4 + 1;
+
+enum BinaryExtensionKind : std::uint8_t {
+    BEK_NONE          = 0,
+    BEK_BINARY_STREAM = 1
+};
+
+void PutU8(char*& aCursor, std::uint8_t aValue) {
+    *(aCursor++) = static_cast<char>(aValue);
+}
+
+void PutU16(char*& aCursor, std::uint16_t aValue) {
+    *(aCursor++) = static_cast<char>(aValue & 0xFF);
+    *(aCursor++) = static_cast<char>((aValue >> 8) & 0xFF);
+}
+
+void PutU32(char*& aCursor, std::uint32_t aValue) {
+    *(aCursor++) = static_cast<char>(aValue & 0xFF);
+    *(aCursor++) = static_cast<char>((aValue >> 8) & 0xFF);
+    *(aCursor++) = static_cast<char>((aValue >> 16) & 0xFF);
+    *(aCursor++) = static_cast<char>((aValue >> 24) & 0xFF);
+}
+
+//! Reads little-endian integers from a contiguous block of bytes, with bounds checking.
+class BinaryReader {
+public:
+    BinaryReader(const void* aData, std::size_t aByteCount)
+        : _data{static_cast<const std::uint8_t*>(aData)}
+        , _byteCount{aByteCount} {}
+
+    std::uint8_t getU8() {
+        _require(1);
+        return _data[_pos++];
+    }
+
+    std::uint16_t getU16() {
+        _require(2);
+        const auto result = static_cast<std::uint16_t>(_data[_pos] | (_data[_pos + 1] << 8));
+        _pos += 2;
+        return result;
+    }
+
+    std::uint32_t getU32() {
+        _require(4);
+        const auto result = static_cast<std::uint32_t>(_data[_pos]) |
+                            (static_cast<std::uint32_t>(_data[_pos + 1]) << 8) |
+                            (static_cast<std::uint32_t>(_data[_pos + 2]) << 16) |
+                            (static_cast<std::uint32_t>(_data[_pos + 3]) << 24);
+        _pos += 4;
+        return result;
+    }
+
+    bool isExhausted() const {
+        return _pos == _byteCount;
+    }
+
+private:
+    const std::uint8_t* _data;
+    std::size_t         _byteCount;
+    std::size_t         _pos = 0;
+
+    void _require(std::size_t aByteCount) const {
+        if (_pos + aByteCount > _byteCount) {
+            HG_THROW_TRACED(BinaryParseError,
+                            0,
+                            "Unexpected end of cell block (needed {} bytes at offset {}, block "
+                            "size is {}).",
+                            aByteCount,
+                            _pos,
+                            _byteCount);
+        }
+    }
+};
+
+const void* ReadInPlaceOrThrow(hg::util::InputStream& aIStream,
+                               std::int64_t           aByteCount,
+                               const char*            aWhat) {
+    const void* result = aIStream.readInPlaceNoThrow(aByteCount);
+    if (!aIStream || (result == nullptr && aByteCount > 0)) {
+        HG_THROW_TRACED(BinaryParseError,
+                        0,
+                        "Failed to read {} ({} bytes) from stream.",
+                        aWhat,
+                        aByteCount);
+    }
+    return result;
+}
+
+void WriteOrThrow(hg::util::OutputStream& aOStream, const void* aData, std::int64_t aByteCount) {
+    if (aByteCount == 0) {
+        return;
+    }
+    if (aOStream.write(aData, aByteCount) != aByteCount) {
+        HG_THROW_TRACED(hg::util::StreamWriteError,
+                        0,
+                        "Failed to write {} bytes of binary chunk data to stream.",
+                        aByteCount);
+    }
+}
+
+void ChunkToBinaryImpl(const Chunk&               aChunk,
+                       hg::util::OutputStream&    aOStream,
+                       ReusableConversionBuffers& aBuffers) {
+    const auto chunkWidth  = aChunk.getCellCountX();
+    const auto chunkHeight = aChunk.getCellCountY();
+
+    // Header and cells are first encoded into a single buffer and then written to the stream
+    // all at once, as writing them one by one through the stream interface would be much slower
+    auto& buffer = aBuffers.string;
+    buffer.resize(hg::pztos(BINARY_HEADER_SIZE) +
+                  hg::pztos(chunkWidth * chunkHeight) * BINARY_MAX_CELL_SIZE);
+
+    char* cursor = buffer.data();
+
+    std::memcpy(cursor, BINARY_SIGNATURE, sizeof(BINARY_SIGNATURE));
+    cursor += sizeof(BINARY_SIGNATURE);
+    PutU16(cursor, BINARY_CHUNK_FORMAT_VERSION);
+    PutU16(cursor, static_cast<std::uint16_t>(chunkWidth));
+    PutU16(cursor, static_cast<std::uint16_t>(chunkHeight));
+
+    char* cellBlockSizeCursor = cursor;
+    cursor += 4; // Filled in after the cells are written
+
+    char* const cellBlockStart = cursor;
+    for (hg::PZInteger y = 0; y < chunkHeight; y += 1) {
+        for (hg::PZInteger x = 0; x < chunkWidth; x += 1) {
+            const auto& cell  = aChunk.getCellAtUnchecked(x, y);
+            const auto  flags = cell.getFlags();
+
+            PutU16(cursor, flags);
+            PutU8(cursor, cell.getOpenness());
+
+            if (flags & CellModel::FLOOR_INITIALIZED) {
+                PutU32(cursor, static_cast<std::uint32_t>(cell.getFloor().spriteId));
+            }
+
+            if (flags & CellModel::WALL_INITIALIZED) {
+                const auto& wall = cell.getWall();
+                PutU32(cursor, static_cast<std::uint32_t>(wall.spriteId));
+                PutU32(cursor, static_cast<std::uint32_t>(wall.spriteId_reduced));
+                PutU8(cursor, static_cast<std::uint8_t>(wall.shape));
+            }
+        }
+    }
+    PutU32(cellBlockSizeCursor, static_cast<std::uint32_t>(cursor - cellBlockStart));
+
+    // Extension
+    const auto* extension = aChunk.getExtension();
+    const auto  method    = extension ? extension->getPreferredSerializationMethod()
+                                        : ChunkExtensionInterface::SerializationMethod::NONE;
+
+    switch (method) {
+    case ChunkExtensionInterface::SerializationMethod::NONE:
+        PutU8(cursor, BEK_NONE);
+        WriteOrThrow(aOStream, buffer.data(), cursor - buffer.data());
+        break;
+
+    case ChunkExtensionInterface::SerializationMethod::BINARY_STREAM:
+        {
+            aBuffers.stream.clear();
+            extension->serialize(aBuffers.stream);
+
+            const auto extDataSize = aBuffers.stream.getDataSize();
+
+            PutU8(cursor, BEK_BINARY_STREAM);
+            PutU32(cursor, static_cast<std::uint32_t>(extDataSize));
+            WriteOrThrow(aOStream, buffer.data(), cursor - buffer.data());
+            if (extDataSize > 0) {
+                WriteOrThrow(aOStream, aBuffers.stream.getData(), extDataSize);
+            }
+        }
+        break;
+
+    default:
+        HG_UNREACHABLE("Invalid value for ChunkExtensionInterface::SerializationMethod ({}).",
+                       (int)method);
+    }
+}
+} // namespace
+
+bool IsBinaryChunkData(const void* aData, std::int64_t aByteCount) {
+    return (aData != nullptr && aByteCount >= BINARY_HEADER_SIZE &&
+            std::memcmp(aData, BINARY_SIGNATURE, sizeof(BINARY_SIGNATURE)) == 0);
+}
+
+void ChunkToBinary(const Chunk&               aChunk,
+                   hg::util::OutputStream&    aOStream,
+                   ReusableConversionBuffers* aReusableConversionBuffers) {
+    if (aReusableConversionBuffers != nullptr) {
+        ChunkToBinaryImpl(aChunk, aOStream, *aReusableConversionBuffers);
+    } else {
+        ReusableConversionBuffers defaultBuffers;
+        ChunkToBinaryImpl(aChunk, aOStream, defaultBuffers);
+    }
+}
+
+Chunk BinaryToChunk(hg::util::InputStream&       aIStream,
+                    const ChunkExtensionFactory& aChunkExtensionFactory,
+                    ReusableConversionBuffers*   aReusableConversionBuffers) {
+    (void)aReusableConversionBuffers; // Everything is read in place, no buffers are needed
+
+    // Read header
+    const auto* header = ReadInPlaceOrThrow(aIStream, BINARY_HEADER_SIZE, "header");
+    if (!IsBinaryChunkData(header, BINARY_HEADER_SIZE)) {
+        HG_THROW_TRACED(BinaryParseError, 0, "Binary chunk signature not found.");
+    }
+
+    BinaryReader headerReader{static_cast<const char*>(header) + sizeof(BINARY_SIGNATURE),
+                              hg::pztos(BINARY_HEADER_SIZE) - sizeof(BINARY_SIGNATURE)};
+
+    const auto version = headerReader.getU16();
+    if (version != BINARY_CHUNK_FORMAT_VERSION) {
+        HG_THROW_TRACED(BinaryParseError,
+                        0,
+                        "Unsupported binary chunk format version ({}; expected {}).",
+                        version,
+                        BINARY_CHUNK_FORMAT_VERSION);
+    }
+
+    const auto chunkWidth    = static_cast<hg::PZInteger>(headerReader.getU16());
+    const auto chunkHeight   = static_cast<hg::PZInteger>(headerReader.getU16());
+    const auto cellBlockSize = static_cast<std::int64_t>(headerReader.getU32());
+
+    if (chunkWidth == 0 || chunkHeight == 0) {
+        HG_THROW_TRACED(BinaryParseError,
+                        0,
+                        "Invalid chunk dimensions ({} x {}).",
+                        chunkWidth,
+                        chunkHeight);
+    }
+
+    Chunk chunk{chunkWidth, chunkHeight};
+
+    // Read cells
+    {
+        BinaryReader cellReader{ReadInPlaceOrThrow(aIStream, cellBlockSize, "cell block"),
+                                static_cast<std::size_t>(cellBlockSize)};
+
+        const auto getSpriteId = [&cellReader]() -> SpriteId {
+            const auto spriteId = cellReader.getU32();
+            if (spriteId > static_cast<std::uint32_t>(std::numeric_limits<SpriteId>::max())) {
+                HG_THROW_TRACED(BinaryParseError, 0, "Invalid sprite ID ({}).", spriteId);
+            }
+            return static_cast<SpriteId>(spriteId);
+        };
+
+        for (hg::PZInteger y = 0; y < chunkHeight; y += 1) {
+            for (hg::PZInteger x = 0; x < chunkWidth; x += 1) {
+                auto& cell = chunk.getCellAtUnchecked(x, y);
+
+                const auto flags    = cellReader.getU16();
+                const auto openness = cellReader.getU8();
+
+                if (flags & CellModel::FLOOR_INITIALIZED) {
+                    CellModel::Floor floor;
+                    floor.spriteId = getSpriteId();
+                    cell.setFloor(floor);
+                }
+
+                if (flags & CellModel::WALL_INITIALIZED) {
+                    CellModel::Wall wall;
+                    wall.spriteId         = getSpriteId();
+                    wall.spriteId_reduced = getSpriteId();
+                    wall.shape            = static_cast<Shape>(cellReader.getU8());
+                    cell.setWall(wall);
+                }
+
+                cell.setObstructionFlags(flags);
+                cell.setOpenness(openness);
+            }
+        }
+
+        if (!cellReader.isExhausted()) {
+            HG_THROW_TRACED(BinaryParseError, 0, "Cell block contains unexpected trailing data.");
+        }
+    }
+
+    // Read extension
+    auto extension = aChunkExtensionFactory ? aChunkExtensionFactory(chunk) : nullptr;
+
+    const auto kind = *static_cast<const std::uint8_t*>(
+        ReadInPlaceOrThrow(aIStream, sizeof(std::uint8_t), "extension kind"));
+
+    switch (kind) {
+    case BEK_NONE:
+        break;
+
+    case BEK_BINARY_STREAM:
+        {
+            BinaryReader sizeReader{ReadInPlaceOrThrow(aIStream, 4, "extension data size"), 4};
+
+            const auto  extDataSize = static_cast<std::int64_t>(sizeReader.getU32());
+            const auto* extData     = ReadInPlaceOrThrow(aIStream, extDataSize, "extension data");
+
+            if (extension != nullptr) {
+                hg::util::ViewStream vstream{extData, extDataSize};
+                extension->deserialize(vstream);
+            } else {
+                HG_LOG_WARN(LOG_ID,
+                            "Found serialized data for chunk extension but failed to instantiate "
+                            "the extension.");
+            }
+        }
+        break;
+
+    default:
+        HG_THROW_TRACED(BinaryParseError, 0, "Unsupported extension kind ({}).", (int)kind);
+    }
+
+    chunk.setExtension(std::move(extension));
+
+    return chunk;
+}
+
 } // namespace detail
 } // namespace gridgoblin
 } // namespace jbatnozic
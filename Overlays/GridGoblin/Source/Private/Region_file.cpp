@@ -0,0 +1,419 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Region_file.hpp>
+
+#include <Hobgoblin/Logging.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin";
+
+// Format of a region file (all numbers are little-endian):
+// - header:
+//   - 4 bytes: signature "GGRF"
+//   - u16:     format version
+//   - u16:     number of chunks in the region along the X axis (W)
+//   - u16:     number of chunks in the region along the Y axis (H)
+//   - u16:     reserved (0)
+// - table: W * H entries in row-major order, each consisting of:
+//   - u64: offset of the chunk's data from the start of the file
+//   - u32: size of the chunk's data in bytes (0 if there is no data for the chunk)
+// - chunk data: arbitrary blobs referenced by the table
+
+constexpr char          REGION_SIGNATURE[4]       = {'G', 'G', 'R', 'F'};
+constexpr std::uint16_t REGION_FORMAT_VERSION     = 1;
+constexpr std::int64_t  REGION_FIXED_HEADER_SIZE  = 12;
+constexpr std::int64_t  REGION_TABLE_ENTRY_SIZE   = 12;
+constexpr std::int64_t  REGION_COMPACTION_MINIMUM = 1024 * 1024;
+
+void PutLE(char* aDst, std::uint64_t aValue, int aByteCount) {
+    for (int i = 0; i < aByteCount; i += 1) {
+        aDst[i] = static_cast<char>((aValue >> (8 * i)) & 0xFF);
+    }
+}
+
+std::uint64_t GetLE(const char* aSrc, int aByteCount) {
+    std::uint64_t result = 0;
+    for (int i = 0; i < aByteCount; i += 1) {
+        result |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(aSrc[i])) << (8 * i);
+    }
+    return result;
+}
+
+//! Makes sure that everything written to the file at `aPath` so far (and flushed from the
+//! stream which wrote it) is on the disk.
+void SyncToDisk(const std::filesystem::path& aPath) {
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(aPath.c_str(),
+                                    GENERIC_WRITE,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    nullptr,
+                                    OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL,
+                                    nullptr);
+    const bool success = (file != INVALID_HANDLE_VALUE) && FlushFileBuffers(file);
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+#else
+    const int  fd      = ::open(aPath.c_str(), O_RDWR);
+    const bool success = (fd >= 0) && (::fsync(fd) == 0);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+    if (!success) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to sync file '{}' to disk.", aPath.string());
+    }
+}
+} // namespace
+
+RegionFile::RegionFile(std::filesystem::path aPath,
+                       hg::PZInteger         aChunkCountX,
+                       hg::PZInteger         aChunkCountY)
+    : _path{std::move(aPath)}
+    , _chunkCountX{aChunkCountX}
+    , _chunkCountY{aChunkCountY}
+    , _headerSize{REGION_FIXED_HEADER_SIZE +
+                  static_cast<std::int64_t>(aChunkCountX) * aChunkCountY * REGION_TABLE_ENTRY_SIZE} //
+{
+    HG_VALIDATE_ARGUMENT(aChunkCountX >= 1 && aChunkCountX <= 256);
+    HG_VALIDATE_ARGUMENT(aChunkCountY >= 1 && aChunkCountY <= 256);
+
+    _table.resize(hg::pztos(aChunkCountX * aChunkCountY));
+    _open();
+}
+
+RegionFile::~RegionFile() {
+    _unmap();
+}
+
+RegionFile::ChunkData RegionFile::readChunk(hg::PZInteger aX, hg::PZInteger aY) {
+    HG_ASSERT(aX >= 0 && aX < _chunkCountX && aY >= 0 && aY < _chunkCountY);
+
+    const auto& entry = _table[hg::pztos(aY * _chunkCountX + aX)];
+    if (entry.byteCount == 0) {
+        return {};
+    }
+
+    const auto end = static_cast<std::int64_t>(entry.offset + entry.byteCount);
+    if (end > _fileSize) {
+        HG_THROW_TRACED(RegionFileError,
+                        0,
+                        "Region file '{}' is corrupted (chunk data at {}..{} is past the end of file).",
+                        _path.string(),
+                        entry.offset,
+                        end);
+    }
+    if (end > _mappedSize) {
+        // The file has grown past the mapping since it was last mapped
+        _map();
+    }
+
+    return {_mappedData + entry.offset, static_cast<std::int64_t>(entry.byteCount)};
+}
+
+void RegionFile::writeChunk(hg::PZInteger aX,
+                            hg::PZInteger aY,
+                            const void*   aData,
+                            std::int64_t  aByteCount) {
+    HG_ASSERT(aX >= 0 && aX < _chunkCountX && aY >= 0 && aY < _chunkCountY);
+    HG_VALIDATE_ARGUMENT(aByteCount >= 0 && aByteCount <= UINT32_MAX);
+
+    const auto index = aY * _chunkCountX + aX;
+    auto&      entry = _table[hg::pztos(index)];
+
+    _liveByteCount -= entry.byteCount;
+
+    if (aByteCount > 0) {
+        _file.seekp(_fileSize);
+        _file.write(static_cast<const char*>(aData), static_cast<std::streamsize>(aByteCount));
+        entry.offset    = static_cast<std::uint64_t>(_fileSize);
+        entry.byteCount = static_cast<std::uint32_t>(aByteCount);
+        _fileSize += aByteCount;
+        _liveByteCount += aByteCount;
+
+        // The data must reach the disk before the table entry that points to it, so that the file
+        // remains consistent even if the program (or the system) is interrupted in between
+        if (!_file.flush()) {
+            HG_THROW_TRACED(RegionFileError,
+                            0,
+                            "Failed to write to region file '{}'.",
+                            _path.string());
+        }
+        SyncToDisk(_path);
+    } else {
+        entry = TableEntry{};
+    }
+
+    _writeTableEntry(index);
+    _file.flush();
+
+    if (!_file) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to write to region file '{}'.", _path.string());
+    }
+
+    const auto garbage = getGarbageByteCount();
+    if (garbage > _liveByteCount && garbage > REGION_COMPACTION_MINIMUM) {
+        compact();
+    }
+}
+
+void RegionFile::compact() {
+    const auto tempPath = std::filesystem::path{_path}.concat(".tmp");
+
+    HG_LOG_DEBUG(LOG_ID,
+                 "Compacting region file '{}' ({} bytes, of which {} are outdated).",
+                 _path.string(),
+                 _fileSize,
+                 getGarbageByteCount());
+
+    // Make sure all the data is readable through the mapping
+    if (_fileSize > _mappedSize) {
+        _map();
+    }
+
+    std::vector<TableEntry> newTable(_table.size());
+    {
+        std::ofstream out{tempPath, std::ios::out | std::ios::binary | std::ios::trunc};
+        if (!out) {
+            HG_THROW_TRACED(RegionFileError, 0, "Failed to create file '{}'.", tempPath.string());
+        }
+
+        std::vector<char> header(hg::pztos(_headerSize));
+        out.write(header.data(), static_cast<std::streamsize>(header.size())); // Rewritten below
+
+        auto offset = _headerSize;
+        for (std::size_t i = 0; i < _table.size(); i += 1) {
+            const auto& entry = _table[i];
+            if (entry.byteCount == 0) {
+                continue;
+            }
+            out.write(_mappedData + entry.offset, static_cast<std::streamsize>(entry.byteCount));
+            newTable[i] = {static_cast<std::uint64_t>(offset), entry.byteCount};
+            offset += entry.byteCount;
+        }
+
+        _encodeHeader(newTable, header);
+        out.seekp(0);
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+        if (!out.flush()) {
+            HG_THROW_TRACED(RegionFileError, 0, "Failed to write to file '{}'.", tempPath.string());
+        }
+    }
+    // Otherwise, the rename could reach the disk before the data it refers to
+    SyncToDisk(tempPath);
+
+    // (Some systems don't allow replacing a file which is still open)
+    _unmap();
+    _file.close();
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, _path, ec);
+
+    // Whether or not the original file was replaced, it has to be opened again
+    _open();
+
+    if (ec) {
+        std::error_code removeEc;
+        std::filesystem::remove(tempPath, removeEc);
+        HG_THROW_TRACED(RegionFileError,
+                        0,
+                        "Failed to replace region file '{}' with its compacted version ({}).",
+                        _path.string(),
+                        ec.message());
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// MARK: PRIVATE METHODS                                                 //
+///////////////////////////////////////////////////////////////////////////
+
+void RegionFile::_open() {
+    if (!std::filesystem::exists(_path)) {
+        _createNew();
+    }
+
+    _file.open(_path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!_file.is_open()) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to open region file '{}'.", _path.string());
+    }
+
+    _fileSize = static_cast<std::int64_t>(std::filesystem::file_size(_path));
+    _loadHeader();
+}
+
+void RegionFile::_createNew() {
+    std::vector<char> header(hg::pztos(_headerSize));
+    _encodeHeader(std::vector<TableEntry>(_table.size()), header);
+
+    std::ofstream out{_path, std::ios::out | std::ios::binary | std::ios::trunc};
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    if (!out.flush()) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to create region file '{}'.", _path.string());
+    }
+}
+
+void RegionFile::_encodeHeader(const std::vector<TableEntry>& aTable, std::vector<char>& aBuffer) const {
+    HG_ASSERT(hg::stopz(aBuffer.size()) == _headerSize);
+
+    char* header = aBuffer.data();
+    std::memcpy(header, REGION_SIGNATURE, sizeof(REGION_SIGNATURE));
+    PutLE(header + 4, REGION_FORMAT_VERSION, 2);
+    PutLE(header + 6, static_cast<std::uint64_t>(_chunkCountX), 2);
+    PutLE(header + 8, static_cast<std::uint64_t>(_chunkCountY), 2);
+    PutLE(header + 10, 0, 2);
+
+    for (std::size_t i = 0; i < aTable.size(); i += 1) {
+        char* dst = header + REGION_FIXED_HEADER_SIZE + i * REGION_TABLE_ENTRY_SIZE;
+        PutLE(dst, aTable[i].offset, 8);
+        PutLE(dst + 8, aTable[i].byteCount, 4);
+    }
+}
+
+void RegionFile::_loadHeader() {
+    if (_fileSize < _headerSize) {
+        HG_THROW_TRACED(RegionFileError,
+                        0,
+                        "Region file '{}' is corrupted (size {} is smaller than header size {}).",
+                        _path.string(),
+                        _fileSize,
+                        _headerSize);
+    }
+
+    _map();
+
+    const char* header = _mappedData;
+    if (std::memcmp(header, REGION_SIGNATURE, sizeof(REGION_SIGNATURE)) != 0) {
+        HG_THROW_TRACED(RegionFileError, 0, "File '{}' is not a region file.", _path.string());
+    }
+
+    const auto version = GetLE(header + 4, 2);
+    const auto countX  = static_cast<hg::PZInteger>(GetLE(header + 6, 2));
+    const auto countY  = static_cast<hg::PZInteger>(GetLE(header + 8, 2));
+    if (version != REGION_FORMAT_VERSION) {
+        HG_THROW_TRACED(RegionFileError,
+                        0,
+                        "Region file '{}' has unsupported format version {}.",
+                        _path.string(),
+                        version);
+    }
+    if (countX != _chunkCountX || countY != _chunkCountY) {
+        HG_THROW_TRACED(RegionFileError,
+                        0,
+                        "Region file '{}' holds {}x{} chunks, but {}x{} was expected.",
+                        _path.string(),
+                        countX,
+                        countY,
+                        _chunkCountX,
+                        _chunkCountY);
+    }
+
+    _liveByteCount = 0;
+    for (std::size_t i = 0; i < _table.size(); i += 1) {
+        const char* src = header + REGION_FIXED_HEADER_SIZE + i * REGION_TABLE_ENTRY_SIZE;
+
+        _table[i].offset    = GetLE(src, 8);
+        _table[i].byteCount = static_cast<std::uint32_t>(GetLE(src + 8, 4));
+        _liveByteCount += _table[i].byteCount;
+    }
+}
+
+void RegionFile::_writeTableEntry(hg::PZInteger aIndex) {
+    const auto& entry = _table[hg::pztos(aIndex)];
+
+    char buffer[REGION_TABLE_ENTRY_SIZE];
+    PutLE(buffer, entry.offset, 8);
+    PutLE(buffer + 8, entry.byteCount, 4);
+
+    _file.seekp(REGION_FIXED_HEADER_SIZE + aIndex * REGION_TABLE_ENTRY_SIZE);
+    _file.write(buffer, sizeof(buffer));
+}
+
+void RegionFile::_map() {
+#ifdef _WIN32
+    // Read-only mappings can't extend past the end of the file
+    const auto mappingSize = _fileSize;
+#else
+    // Leave room for the file to grow, so that it doesn't have to be remapped after every append
+    // (the part of the mapping past the end of the file becomes readable as the file grows, and
+    // it's never read before that)
+    const auto mappingSize = std::max(_fileSize, 2 * _mappedSize);
+#endif
+
+    _unmap();
+
+    // Make sure everything written through the stream is visible to the mapping
+    _file.flush();
+
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(_path.c_str(),
+                                    GENERIC_READ,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    nullptr,
+                                    OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL,
+                                    nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to open region file '{}'.", _path.string());
+    }
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to map region file '{}'.", _path.string());
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(mappingSize));
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to map region file '{}'.", _path.string());
+    }
+#else
+    const int fd = ::open(_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to open region file '{}'.", _path.string());
+    }
+    void* data = ::mmap(nullptr, static_cast<std::size_t>(mappingSize), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        HG_THROW_TRACED(RegionFileError, 0, "Failed to map region file '{}'.", _path.string());
+    }
+#endif
+
+    _mappedData = static_cast<const char*>(data);
+    _mappedSize = mappingSize;
+}
+
+void RegionFile::_unmap() {
+    if (_mappedData == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(_mappedData);
+#else
+    ::munmap(const_cast<char*>(_mappedData), static_cast<std::size_t>(_mappedSize));
+#endif
+    _mappedData = nullptr;
+    _mappedSize = 0;
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
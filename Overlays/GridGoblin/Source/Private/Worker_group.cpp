@@ -0,0 +1,117 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Worker_group.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <utility>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+WorkerGroup::WorkerGroup(hg::PZInteger aBackgroundThreadCount) {
+    HG_VALIDATE_ARGUMENT(aBackgroundThreadCount >= 0);
+
+    _threads.reserve(hg::pztos(aBackgroundThreadCount));
+    for (hg::PZInteger i = 0; i < aBackgroundThreadCount; i += 1) {
+        // Worker index 0 is reserved for the thread calling run()
+        _threads.emplace_back(&WorkerGroup::_threadBody, this, i + 1);
+    }
+}
+
+WorkerGroup::~WorkerGroup() {
+    {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _stopped = true;
+    }
+    _cv_batchStarted.notify_all();
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+hg::PZInteger WorkerGroup::getWorkerCount() const {
+    return hg::stopz(_threads.size()) + 1;
+}
+
+void WorkerGroup::run(hg::PZInteger aTaskCount, const Task& aTask) {
+    if (aTaskCount <= 0) {
+        return;
+    }
+
+    // No need to involve the other threads for a single task
+    if (aTaskCount == 1 || _threads.empty()) {
+        for (hg::PZInteger i = 0; i < aTaskCount; i += 1) {
+            aTask(i, 0);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock{_mutex};
+
+    _task           = &aTask;
+    _taskCount      = aTaskCount;
+    _nextTaskIndex  = 0;
+    _firstException = nullptr;
+    _batchId += 1;
+    _cv_batchStarted.notify_all();
+
+    _executeTasks(lock, 0);
+
+    _cv_batchFinished.wait(lock, [this]() {
+        return _busyCount == 0;
+    });
+
+    _task = nullptr;
+    if (_firstException) {
+        std::rethrow_exception(std::exchange(_firstException, nullptr));
+    }
+}
+
+void WorkerGroup::_threadBody(hg::PZInteger aWorkerIndex) {
+    std::uint64_t lastBatchId = 0;
+
+    std::unique_lock<std::mutex> lock{_mutex};
+    while (true) {
+        _cv_batchStarted.wait(lock, [&]() {
+            return _stopped || _batchId != lastBatchId;
+        });
+        if (_stopped) {
+            return;
+        }
+        lastBatchId = _batchId;
+        _executeTasks(lock, aWorkerIndex);
+    }
+}
+
+void WorkerGroup::_executeTasks(std::unique_lock<std::mutex>& aLock, hg::PZInteger aWorkerIndex) {
+    while (_task != nullptr && _nextTaskIndex < _taskCount) {
+        const auto  taskIndex = _nextTaskIndex++;
+        const auto& task      = *_task;
+        _busyCount += 1;
+
+        aLock.unlock();
+        std::exception_ptr exception = nullptr;
+        try {
+            task(taskIndex, aWorkerIndex);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        aLock.lock();
+
+        _busyCount -= 1;
+        if (exception && !_firstException) {
+            _firstException = exception;
+        }
+    }
+
+    if (_busyCount == 0) {
+        _cv_batchFinished.notify_all();
+    }
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
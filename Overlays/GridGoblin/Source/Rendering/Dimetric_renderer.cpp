@@ -11,6 +11,7 @@
 #include <Hobgoblin/Math/Core.hpp>
 
 #include <algorithm>
+#include <cmath>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -93,51 +94,54 @@ void DimetricRenderer::startPrepareToRender(const hg::gr::View&       aView,
 
     _objectsToRender.clear();
     _cellAdapters.clear();
+    _frameStats = {};
 
+    if (_config.cacheChunkGeometry) {
+        _prepareChunkGeometry();
+    }
     _prepareCells(aRenderFlags, aVisProv);
 
     _renderCycleCounter += 1;
 }
 
 void DimetricRenderer::addObject(const RenderedObject& aObject) {
-    HG_NOT_IMPLEMENTED("TODO");
+    _objectsToRender.push_back(&aObject);
 }
 
 void DimetricRenderer::endPrepareToRender() {
-    std::sort(_objectsToRender.begin(),
-              _objectsToRender.end(),
-              [](const RenderedObject* aLhs, const RenderedObject* aRhs) -> bool {
-                  // Implements: Does `aLhs` come before `aRhs`?
-
-                  HG_ASSERT(aLhs != nullptr && aRhs != nullptr);
-
-                  const auto order =
-                      dimetric::CheckDrawingOrder(aLhs->getSpatialInfo(), aRhs->getSpatialInfo());
-
-                  switch (order) {
-                  case dimetric::DRAW_LHS_FIRST:
-                      return true;
-
-                  case dimetric::DOES_NOT_MATTER:
-                      return (aLhs < aRhs);
-
-                  case dimetric::DRAW_RHS_FIRST:
-                      return false;
-
-                  default:
-                      HG_UNREACHABLE("Invalid value for drawing order ({}).", (int)order);
-                      return {};
-                  }
-              });
+    // The cells are already sorted, so only the objects which were added since need to be sorted
+    // and then merged in among them
+    dimetric::MergeObjectsIntoSortedCells(
+        _objectsToRender,
+        _cellAdapters.size(),
+        _world.getCellResolution(),
+        [](const RenderedObject* aObject) -> const SpatialInfo& {
+            return aObject->getSpatialInfo();
+        },
+        _cellSortBuffer);
 }
 
 void DimetricRenderer::render(hg::gr::Canvas& aCanvas) {
+    // Floors are always drawn before everything else (see `dimetric::CheckDrawingOrder()`)
+    for (const auto* geometry : _visibleChunkGeometry) {
+        for (const auto& batch : geometry->floorBatches) {
+            aCanvas.draw(batch.vertices.data(),
+                         hg::stopz(batch.vertices.size()),
+                         hg::gr::PrimitiveType::TRIANGLES,
+                         hg::gr::RenderStates{batch.texture});
+        }
+    }
+
     for (const auto& object : _objectsToRender) {
         const auto& spatialInfo = object->getSpatialInfo();
         object->render(aCanvas, dimetric::ToPositionInView(spatialInfo.getCenter()));
     }
 }
 
+const DimetricRenderer::FrameStats& DimetricRenderer::getFrameStats() const {
+    return _frameStats;
+}
+
 // MARK: Private
 
 hg::gr::Sprite& DimetricRenderer::_getSprite(SpriteId aSpriteId) const {
@@ -252,6 +256,7 @@ void DimetricRenderer::_prepareCells(std::int32_t aRenderFlags, const Visibility
             }
 
             if (flags & CellModel::WALL_INITIALIZED) {
+                _frameStats.cellObjectCount += 1;
                 _cellAdapters.emplace_back(
                     *this,
                     *aCellInfo.cell,
@@ -259,7 +264,9 @@ void DimetricRenderer::_prepareCells(std::int32_t aRenderFlags, const Visibility
                                                     {cr, cr},
                                                     Layer::WALL),
                     mask);
-            } else if (flags & CellModel::FLOOR_INITIALIZED) {
+            } else if ((flags & CellModel::FLOOR_INITIALIZED) && !_config.cacheChunkGeometry) {
+                _frameStats.cellObjectCount += 1;
+                _frameStats.generatedVertexCount += 4;
                 _cellAdapters.emplace_back(
                     *this,
                     *aCellInfo.cell,
@@ -273,6 +280,169 @@ void DimetricRenderer::_prepareCells(std::int32_t aRenderFlags, const Visibility
     for (const auto& adapter : _cellAdapters) {
         _objectsToRender.push_back(&adapter);
     }
+    dimetric::SortCellsForDrawing(
+        _objectsToRender,
+        cr,
+        [](const RenderedObject* aObject) -> const SpatialInfo& {
+            return aObject->getSpatialInfo();
+        },
+        _cellSortBuffer);
+}
+
+void DimetricRenderer::_prepareChunkGeometry() {
+    _visibleChunkGeometry.clear();
+
+    // Drop the geometry of the chunks which changed (or were loaded or unloaded) since last time
+    const auto cellGeneration = _world.getCellGeneration();
+    if (cellGeneration != _chunkGeometryCellGeneration) {
+        const bool allChangesKnown = _world.forEachCellChangeSince(
+            _chunkGeometryCellGeneration,
+            [this](const hg::math::Rectangle<hg::PZInteger>& aRect) {
+                const auto start = _world.cellToChunkIdUnchecked(aRect.x, aRect.y);
+                const auto end =
+                    _world.cellToChunkIdUnchecked(aRect.x + aRect.w - 1, aRect.y + aRect.h - 1);
+                for (hg::PZInteger y = start.y; y <= end.y; y += 1) {
+                    for (hg::PZInteger x = start.x; x <= end.x; x += 1) {
+                        _chunkGeometry.erase(ChunkId{x, y});
+                    }
+                }
+            });
+        if (!allChangesKnown) {
+            _chunkGeometry.clear();
+        }
+        _chunkGeometryCellGeneration = cellGeneration;
+    }
+
+    // Find the chunks which intersect the view (with a margin of one cell, because sprites can
+    // stick out of their cells a bit)
+    const float left   = _viewData.center->x - (_viewData.size.x / 2.f) - _viewData.overdraw.left;
+    const float right  = _viewData.center->x + (_viewData.size.x / 2.f) + _viewData.overdraw.right;
+    const float top    = _viewData.center->y - (_viewData.size.y / 2.f) - _viewData.overdraw.top;
+    const float bottom = _viewData.center->y + (_viewData.size.y / 2.f) + _viewData.overdraw.bottom;
+
+    const PositionInWorld corners[4] = {dimetric::ToPositionInWorld(PositionInView{left, top}),
+                                        dimetric::ToPositionInWorld(PositionInView{right, top}),
+                                        dimetric::ToPositionInWorld(PositionInView{right, bottom}),
+                                        dimetric::ToPositionInWorld(PositionInView{left, bottom})};
+
+    float minX = corners[0]->x;
+    float maxX = corners[0]->x;
+    float minY = corners[0]->y;
+    float maxY = corners[0]->y;
+    for (const auto& corner : corners) {
+        minX = std::min(minX, corner->x);
+        maxX = std::max(maxX, corner->x);
+        minY = std::min(minY, corner->y);
+        maxY = std::max(maxY, corner->y);
+    }
+
+    const auto cr     = _world.getCellResolution();
+    const auto cellAt = [cr](float aCoord, hg::PZInteger aCellCount) {
+        return hg::math::Clamp(static_cast<int>(std::floor(aCoord / cr)), 0, aCellCount - 1);
+    };
+    const auto startChunk = _world.cellToChunkIdUnchecked(cellAt(minX - cr, _world.getCellCountX()),
+                                                          cellAt(minY - cr, _world.getCellCountY()));
+    const auto endChunk   = _world.cellToChunkIdUnchecked(cellAt(maxX + cr, _world.getCellCountX()),
+                                                          cellAt(maxY + cr, _world.getCellCountY()));
+
+    // Going by rows from the top and from right to left within each row satisfies
+    // `dimetric::CheckDrawingOrder()` for all pairs of floors from different chunks
+    for (hg::PZInteger y = startChunk.y; y <= endChunk.y; y += 1) {
+        for (hg::PZInteger x = endChunk.x; x >= startChunk.x; x -= 1) {
+            const ChunkId chunkId{x, y};
+            if (_world.getChunkAtIdUnchecked(chunkId) == nullptr) {
+                continue;
+            }
+
+            _frameStats.visibleChunkCount += 1;
+
+            auto [iter, inserted] = _chunkGeometry.try_emplace(chunkId);
+            auto& geometry        = iter->second;
+            if (inserted) {
+                _buildChunkGeometry(chunkId, geometry);
+                _frameStats.rebuiltChunkCount += 1;
+            }
+            geometry.lastUsedCycle = _renderCycleCounter;
+
+            for (const auto& batch : geometry.floorBatches) {
+                // 6 vertices (two triangles) are stored per floor, but 4 are counted (see FrameStats)
+                _frameStats.cachedVertexCount += hg::stopz(batch.vertices.size() / 6 * 4);
+            }
+            _visibleChunkGeometry.push_back(&geometry);
+        }
+    }
+
+    // Don't let the geometry of the chunks which went out of view pile up
+    static constexpr std::size_t EXTRA_CACHED_CHUNKS = 16;
+    if (_chunkGeometry.size() > 2 * _visibleChunkGeometry.size() + EXTRA_CACHED_CHUNKS) {
+        for (auto iter = _chunkGeometry.begin(); iter != _chunkGeometry.end();) {
+            if (iter->second.lastUsedCycle != _renderCycleCounter) {
+                iter = _chunkGeometry.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+}
+
+void DimetricRenderer::_buildChunkGeometry(ChunkId aChunkId, ChunkGeometry& aGeometry) {
+    const auto cr             = _world.getCellResolution();
+    const auto cellsPerChunkX = _world.getCellCountX() / _world.getChunkCountX();
+    const auto cellsPerChunkY = _world.getCellCountY() / _world.getChunkCountY();
+
+    aGeometry.floorBatches.clear();
+
+    // Same order as `dimetric::CheckDrawingOrder()` would impose: by rows from the top, and from
+    // right to left within each row
+    for (hg::PZInteger y = aChunkId.y * cellsPerChunkY; y < (aChunkId.y + 1) * cellsPerChunkY; y += 1) {
+        for (hg::PZInteger x = (aChunkId.x + 1) * cellsPerChunkX - 1; x >= aChunkId.x * cellsPerChunkX;
+             x -= 1) {
+            const auto* cell = _world.getCellAtUnchecked(x, y);
+            if (cell == nullptr || (cell->getFlags() & CellModel::WALL_INITIALIZED) != 0 ||
+                (cell->getFlags() & CellModel::FLOOR_INITIALIZED) == 0 ||
+                GetExtensionData(*cell).isNeverDrawn()) {
+                continue;
+            }
+
+            auto& sprite = _getSprite(cell->getFloor().spriteId);
+            sprite.setPosition(
+                *dimetric::ToPositionInView(PositionInWorld{(x + 0.5f) * cr, (y + 0.5f) * cr}));
+
+            if (aGeometry.floorBatches.empty() ||
+                aGeometry.floorBatches.back().texture != sprite.getTexture()) {
+                aGeometry.floorBatches.push_back({sprite.getTexture(), {}});
+            }
+
+            const auto transform = sprite.getTransform();
+            const auto bounds    = sprite.getLocalBounds();
+            const auto texRect   = sprite.getTextureRect();
+
+            const float texLeft   = texRect.x;
+            const float texTop    = texRect.y;
+            const float texRight  = texLeft + texRect.w;
+            const float texBottom = texTop + texRect.h;
+
+            const hg::gr::Vertex topLeft{transform.transformPoint(bounds.x, bounds.y),
+                                         hg::gr::COLOR_WHITE,
+                                         {texLeft, texTop}};
+            const hg::gr::Vertex topRight{transform.transformPoint(bounds.x + bounds.w, bounds.y),
+                                          hg::gr::COLOR_WHITE,
+                                          {texRight, texTop}};
+            const hg::gr::Vertex bottomRight{
+                transform.transformPoint(bounds.x + bounds.w, bounds.y + bounds.h),
+                hg::gr::COLOR_WHITE,
+                {texRight, texBottom}};
+            const hg::gr::Vertex bottomLeft{transform.transformPoint(bounds.x, bounds.y + bounds.h),
+                                            hg::gr::COLOR_WHITE,
+                                            {texLeft, texBottom}};
+
+            auto& vertices = aGeometry.floorBatches.back().vertices;
+            vertices.insert(vertices.end(),
+                            {topLeft, topRight, bottomLeft, topRight, bottomRight, bottomLeft});
+
+            _frameStats.generatedVertexCount += 4; // (see FrameStats)
+        }
+    }
 }
 
 std::uint16_t DimetricRenderer::_updateFlagsOfCellRendererMask(const CellModel& aCell) {
@@ -0,0 +1,241 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Rendering/Top_down_los_cpu_renderer.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Top_down_los_shadows.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+using hg::math::Vector2f;
+
+float MultiplierForPurpose(TopDownLineOfSightCpuRenderer::Purpose aPurpose) {
+    switch (aPurpose) {
+    case TopDownLineOfSightCpuRenderer::FOR_TOPDOWN:
+        return 1.f;
+
+    case TopDownLineOfSightCpuRenderer::FOR_DIMETRIC:
+        {
+            // (17/16) * sqrt(2) - same as for TopDownLineOfSightRenderer
+            static constexpr float MAGIC_DIMETRIC_MULTIPLIER = 1.41421356237f * 17.f / 16.f;
+            return MAGIC_DIMETRIC_MULTIPLIER;
+        }
+
+    default:
+        HG_UNREACHABLE("Invalid value for TopDownLineOfSightCpuRenderer::Purpose ({}).", (int)aPurpose);
+    }
+}
+
+float Cross(Vector2f aO, Vector2f aA, Vector2f aB) {
+    return (aA.x - aO.x) * (aB.y - aO.y) - (aA.y - aO.y) * (aB.x - aO.x);
+}
+
+//! Replaces the points in `aPoints` with their convex hull (monotone chain algorithm).
+//! \returns the number of points in the hull.
+template <std::size_t taCount>
+std::size_t MakeConvexHull(std::array<Vector2f, taCount>& aPoints) {
+    std::sort(aPoints.begin(), aPoints.end(), [](Vector2f aLhs, Vector2f aRhs) {
+        return (aLhs.x < aRhs.x) || (aLhs.x == aRhs.x && aLhs.y < aRhs.y);
+    });
+
+    std::array<Vector2f, taCount * 2> hull;
+    std::size_t                       cnt = 0;
+
+    // Lower hull
+    for (std::size_t i = 0; i < taCount; i += 1) {
+        while (cnt >= 2 && Cross(hull[cnt - 2], hull[cnt - 1], aPoints[i]) <= 0.f) {
+            cnt -= 1;
+        }
+        hull[cnt++] = aPoints[i];
+    }
+    // Upper hull
+    const auto lowerCnt = cnt + 1;
+    for (std::size_t i = taCount - 1; i > 0; i -= 1) {
+        while (cnt >= lowerCnt && Cross(hull[cnt - 2], hull[cnt - 1], aPoints[i - 1]) <= 0.f) {
+            cnt -= 1;
+        }
+        hull[cnt++] = aPoints[i - 1];
+    }
+    cnt -= 1; // Last point is the same as the first one
+
+    std::copy_n(hull.begin(), cnt, aPoints.begin());
+    return cnt;
+}
+} // namespace
+
+TopDownLineOfSightCpuRenderer::TopDownLineOfSightCpuRenderer(const World&  aWorld,
+                                                             hg::PZInteger aBitmapSize,
+                                                             Purpose       aPurpose)
+    : _world{aWorld}
+    , _sizeMultiplier{MultiplierForPurpose(aPurpose)}
+    , _bitmapSize{aBitmapSize}
+    , _wordsPerRow{(aBitmapSize + 63) / 64} {
+    HG_VALIDATE_ARGUMENT(aBitmapSize > 0);
+
+    _bitmap.resize(hg::pztos(_wordsPerRow) * hg::pztos(_bitmapSize), 0);
+}
+
+void TopDownLineOfSightCpuRenderer::start(PositionInWorld    aPosInView,
+                                          hg::math::Vector2f aViewSize,
+                                          PositionInWorld    aLineOfSightOrigin,
+                                          float              aPadding) {
+    const float width           = aViewSize.x + aPadding;
+    const float height          = aViewSize.y + aPadding;
+    const float largerDimension = std::max(width, height);
+
+    const float virtualSquareEdge = std::ceil(largerDimension * _sizeMultiplier);
+
+    _losOrigin    = aLineOfSightOrigin;
+    _pixelSize    = virtualSquareEdge / _bitmapSize;
+    _bitmapOrigin = {aPosInView->x - virtualSquareEdge / 2.f, aPosInView->y - virtualSquareEdge / 2.f};
+}
+
+void TopDownLineOfSightCpuRenderer::render() {
+    std::fill(_bitmap.begin(), _bitmap.end(), std::uint64_t{0});
+
+    _renderOcclusion();
+}
+
+std::optional<bool> TopDownLineOfSightCpuRenderer::testVisibilityAt(PositionInWorld aPos) const {
+    const auto pixelX = static_cast<hg::PZInteger>(std::floor((aPos->x - _bitmapOrigin.x) / _pixelSize));
+    const auto pixelY = static_cast<hg::PZInteger>(std::floor((aPos->y - _bitmapOrigin.y) / _pixelSize));
+
+    if (pixelX < 0 || pixelX >= _bitmapSize || pixelY < 0 || pixelY >= _bitmapSize) {
+        return {};
+    }
+
+    const auto word = _bitmap[hg::pztos(pixelY * _wordsPerRow + pixelX / 64)];
+    return ((word >> (pixelX % 64)) & 1u) == 0;
+}
+
+void TopDownLineOfSightCpuRenderer::_renderOcclusion() {
+    const auto cellResolution = _world.getCellResolution();
+    const auto edge           = _pixelSize * _bitmapSize;
+
+    const auto cellAt = [cellResolution](float aCoord, hg::PZInteger aCellCount) {
+        return hg::math::Clamp(static_cast<int>(std::trunc(aCoord / cellResolution)), 0, aCellCount - 1);
+    };
+
+    const auto startGridX = cellAt(_bitmapOrigin.x, _world.getCellCountX());
+    const auto startGridY = cellAt(_bitmapOrigin.y, _world.getCellCountY());
+    const auto endGridX   = cellAt(_bitmapOrigin.x + edge, _world.getCellCountX());
+    const auto endGridY   = cellAt(_bitmapOrigin.y + edge, _world.getCellCountY());
+
+    for (hg::PZInteger y = startGridY; y <= endGridY; y += 1) {
+        for (hg::PZInteger x = startGridX; x <= endGridX; x += 1) {
+            const auto* cell = _world.getCellAtUnchecked(x, y);
+            if (cell == nullptr || !cell->isWallInitialized()) {
+                continue;
+            }
+
+            // The GPU renderer draws each edge of the cell extruded away from the point of view;
+            // together those cover the cell and its shadow, which is the convex hull of the
+            // cell's corners and their extruded counterparts, so it can be filled in one go.
+            std::array<Vector2f, 8> points;
+            // clang-format off
+            points[0] = { x      * cellResolution,  y      * cellResolution};
+            points[1] = { x      * cellResolution, (y + 1) * cellResolution};
+            points[2] = {(x + 1) * cellResolution, (y + 1) * cellResolution};
+            points[3] = {(x + 1) * cellResolution,  y      * cellResolution};
+            // clang-format on
+            for (std::size_t i = 0; i < 4; i += 1) {
+                Vector2f diff = {points[i].x - _losOrigin->x, points[i].y - _losOrigin->y};
+                diff.x *= LOS_SHADOW_EXTRUSION_FACTOR;
+                diff.y *= LOS_SHADOW_EXTRUSION_FACTOR;
+
+                points[i + 4] = {points[i].x + diff.x, points[i].y + diff.y};
+            }
+
+            const auto cnt = MakeConvexHull(points);
+            _fillConvexPolygon(points.data(), cnt);
+        }
+    }
+}
+
+void TopDownLineOfSightCpuRenderer::_fillConvexPolygon(const hg::math::Vector2f* aVertices,
+                                                       std::size_t               aVertexCount) {
+    if (aVertexCount < 3) {
+        return;
+    }
+
+    float minY = aVertices[0].y;
+    float maxY = aVertices[0].y;
+    for (std::size_t i = 1; i < aVertexCount; i += 1) {
+        minY = std::min(minY, aVertices[i].y);
+        maxY = std::max(maxY, aVertices[i].y);
+    }
+
+    // Pixels are covered when their centers are inside the polygon
+    const auto toPixelSpace = [this](float aCoord, float aOrigin) {
+        return (aCoord - aOrigin) / _pixelSize - 0.5f;
+    };
+
+    const auto firstRow = std::max(0.f, std::ceil(toPixelSpace(minY, _bitmapOrigin.y)));
+    const auto lastRow =
+        std::min(static_cast<float>(_bitmapSize - 1), std::floor(toPixelSpace(maxY, _bitmapOrigin.y)));
+
+    for (auto row = static_cast<hg::PZInteger>(firstRow); row <= static_cast<hg::PZInteger>(lastRow);
+         row += 1) {
+        const float y = _bitmapOrigin.y + (row + 0.5f) * _pixelSize;
+
+        // A convex polygon crosses a horizontal line in a single interval
+        float minX = INFINITY;
+        float maxX = -INFINITY;
+        for (std::size_t i = 0; i < aVertexCount; i += 1) {
+            const auto& a = aVertices[i];
+            const auto& b = aVertices[(i + 1) % aVertexCount];
+            if ((y < a.y && y < b.y) || (y > a.y && y > b.y)) {
+                continue;
+            }
+            if (a.y == b.y) {
+                minX = std::min({minX, a.x, b.x});
+                maxX = std::max({maxX, a.x, b.x});
+            } else {
+                const float x = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+                minX          = std::min(minX, x);
+                maxX          = std::max(maxX, x);
+            }
+        }
+
+        const auto first = std::max(0.f, std::ceil(toPixelSpace(minX, _bitmapOrigin.x)));
+        const auto last  = std::min(static_cast<float>(_bitmapSize - 1),
+                                   std::floor(toPixelSpace(maxX, _bitmapOrigin.x)));
+        if (first <= last) {
+            _fillRun(row, static_cast<hg::PZInteger>(first), static_cast<hg::PZInteger>(last));
+        }
+    }
+}
+
+void TopDownLineOfSightCpuRenderer::_fillRun(hg::PZInteger aRow,
+                                             hg::PZInteger aFirst,
+                                             hg::PZInteger aLast) {
+    // Whole 64-pixel words are filled at a time; only the words at the ends of the run need masks
+    static constexpr std::uint64_t ALL_SET = ~std::uint64_t{0};
+
+    auto* row = _bitmap.data() + (aRow * _wordsPerRow);
+
+    const auto firstWord = aFirst / 64;
+    const auto lastWord  = aLast / 64;
+    const auto firstMask = ALL_SET << (aFirst % 64);
+    const auto lastMask  = ALL_SET >> (63 - (aLast % 64));
+
+    if (firstWord == lastWord) {
+        row[firstWord] |= (firstMask & lastMask);
+        return;
+    }
+
+    row[firstWord] |= firstMask;
+    std::fill(row + firstWord + 1, row + lastWord, ALL_SET);
+    row[lastWord] |= lastMask;
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
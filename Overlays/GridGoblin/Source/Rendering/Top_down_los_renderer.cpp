@@ -15,6 +15,7 @@
 #include <cmath>
 
 #include "OpenGL_helpers.hpp"
+#include "Top_down_los_shadows.hpp"
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -180,8 +181,8 @@ void TopDownLineOfSightRenderer::_renderOcclusion() {
                 for (int i = 1; i < 10; i += 2) {
                     hg::math::Vector2f diff = {vertices[i - 1].position.x - _losOrigin->x,
                                                vertices[i - 1].position.y - _losOrigin->y};
-                    diff.x *= 2000.f; // TODO: magic number
-                    diff.y *= 2000.f; // TODO: magic number
+                    diff.x *= LOS_SHADOW_EXTRUSION_FACTOR;
+                    diff.y *= LOS_SHADOW_EXTRUSION_FACTOR;
 
                     vertices[i].position = {vertices[i - 1].position.x + diff.x,
                                             vertices[i - 1].position.y + diff.y};
@@ -0,0 +1,16 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+//! When a wall's shadow is drawn by the top-down line of sight renderers (both the GPU and the CPU
+//! one), each corner of the wall is extruded away from the point of view by this many times its
+//! distance from the point of view. It only needs to be large enough for the shadow to reach past
+//! the edge of any view.
+constexpr float LOS_SHADOW_EXTRUSION_FACTOR = 2000.f;
+
+} // namespace gridgoblin
+} // namespace jbatnozic
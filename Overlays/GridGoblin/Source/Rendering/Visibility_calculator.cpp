@@ -6,8 +6,11 @@
 #include <Hobgoblin/Common.hpp>
 #include <Hobgoblin/Logging.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdlib>
+#include <utility>
 #include <type_traits>
 
 namespace jbatnozic {
@@ -85,9 +88,19 @@ VisibilityCalculator::VisibilityCalculator(const World&                      aWo
     , _minRingsBeforeRaycasting{aConfig.minRingsBeforeRaycasting}
     , _minTrianglesBeforeRaycasting{aConfig.minTrianglesBeforeRaycasting}
     , _rayCount{aConfig.rayCount}
-    , _rayPointsPerCell{aConfig.rayPointsPerCell} //
+    , _rayPointsPerCell{aConfig.rayPointsPerCell}
+    , _incremental{aConfig.incremental}
+    , _rayWorkers{aConfig.rayWorkerCount} //
 {
+    _rayDirectionsX.resize(hg::pztos(_rayCount));
+    _rayDirectionsY.resize(hg::pztos(_rayCount));
     _rays.resize(hg::pztos(_rayCount));
+
+    for (hg::PZInteger i = 0; i < _rayCount; i += 1) {
+        const auto direction = (AngleF::fullCircle() * i / _rayCount).asNormalizedVector();
+        _rayDirectionsX[hg::pztos(i)] = direction.x;
+        _rayDirectionsY[hg::pztos(i)] = direction.y;
+    }
 }
 
 std::optional<bool> VisibilityCalculator::testVisibilityAt(PositionInWorld aPos) const {
@@ -100,9 +113,20 @@ std::optional<bool> VisibilityCalculator::testVisibilityAt(PositionInWorld aPos)
 void VisibilityCalculator::calc(PositionInWorld aViewCenter,
                                 Vector2f        aViewSize,
                                 PositionInWorld aLineOfSightOrigin) {
+    if (_canReusePreviousResult(aViewCenter, aViewSize, aLineOfSightOrigin)) {
+        _stats.reusedRingCount      = _stats.highDetailRingCount;
+        _stats.triangleCheckCount   = 0;
+        _stats.reusedPreviousResult = true;
+        return;
+    }
+
     _resetData();
     _setInitialCalculationContext(aViewCenter, aViewSize, aLineOfSightOrigin);
 
+    if (_incremental) {
+        _updateRingCaches();
+    }
+
     _calcOngoing = true;
 
     hg::PZInteger currentRingIndex = 0;
@@ -128,6 +152,11 @@ void VisibilityCalculator::calc(PositionInWorld aViewCenter,
     _calcOngoing = false;
 
     _stats.triangleCount = hg::stopz(_triangles.size());
+
+    _hasPreviousResult     = true;
+    _prevViewCenter        = *aViewCenter;
+    _prevViewSize          = aViewSize;
+    _prevLineOfSightOrigin = *aLineOfSightOrigin;
 }
 
 auto VisibilityCalculator::getStats() const -> const CalculationStats& {
@@ -143,7 +172,73 @@ void VisibilityCalculator::_resetData() {
 
     _triangles.clear();
 
-    _stats = {.highDetailRingCount = 0, .triangleCount = 0, .triangleCheckCount = 0};
+    _stats = {.highDetailRingCount  = 0,
+              .triangleCount        = 0,
+              .triangleCheckCount   = 0,
+              .reusedRingCount      = 0,
+              .reusedOccluderCount  = 0,
+              .reusedPreviousResult = false};
+}
+
+bool VisibilityCalculator::_canReusePreviousResult(PositionInWorld    aViewCenter,
+                                                   hg::math::Vector2f aViewSize,
+                                                   PositionInWorld    aLineOfSightOrigin) const {
+    return _incremental && _hasPreviousResult && *aViewCenter == _prevViewCenter &&
+           aViewSize == _prevViewSize && *aLineOfSightOrigin == _prevLineOfSightOrigin &&
+           _world.getCellGeneration() == _cacheCellGeneration;
+}
+
+void VisibilityCalculator::_updateRingCaches() {
+    const auto generation = _world.getCellGeneration();
+
+    const auto invalidateAll = [this]() {
+        for (auto& cache : _ringCaches) {
+            cache.valid = false;
+        }
+    };
+
+    // Which cells are in which ring, and which of their edges are of interest, depends on the
+    // cell of the point of view, and only the visible cells are included in the rings
+    if (_lineOfSightOriginCell != _cacheOriginCell || _viewTopLeftCell != _cacheViewTopLeftCell ||
+        _viewBottomRightCell != _cacheViewBottomRightCell) {
+        invalidateAll();
+    } else if (generation != _cacheCellGeneration) {
+        const bool complete = _world.forEachCellChangeSince(
+            _cacheCellGeneration,
+            [this](const hg::math::Rectangle<hg::PZInteger>& aRect) {
+                _invalidateRingCaches(aRect);
+            });
+        if (!complete) {
+            invalidateAll();
+        }
+    }
+
+    _cacheOriginCell          = _lineOfSightOriginCell;
+    _cacheViewTopLeftCell     = _viewTopLeftCell;
+    _cacheViewBottomRightCell = _viewBottomRightCell;
+    _cacheCellGeneration      = generation;
+}
+
+void VisibilityCalculator::_invalidateRingCaches(const hg::math::Rectangle<hg::PZInteger>& aRect) {
+    // Rings are squares around the origin cell, so the ring of a cell is its Chebyshev distance
+    // from the origin cell; find the range of such distances over the rectangle
+    const auto distanceRange = [](hg::PZInteger aOrigin, hg::PZInteger aStart, hg::PZInteger aEnd) {
+        const auto nearest =
+            (aOrigin < aStart) ? (aStart - aOrigin) : ((aOrigin > aEnd) ? (aOrigin - aEnd) : 0);
+        const auto farthest = std::max(std::abs(aOrigin - aStart), std::abs(aOrigin - aEnd));
+        return std::make_pair(nearest, farthest);
+    };
+
+    const auto [nearestX, farthestX] =
+        distanceRange(_lineOfSightOriginCell.x, aRect.x, aRect.x + aRect.w - 1);
+    const auto [nearestY, farthestY] =
+        distanceRange(_lineOfSightOriginCell.y, aRect.y, aRect.y + aRect.h - 1);
+
+    const auto firstRing = std::max(nearestX, nearestY);
+    const auto lastRing  = std::min(std::max(farthestX, farthestY), hg::stopz(_ringCaches.size()) - 1);
+    for (hg::PZInteger ring = firstRing; ring <= lastRing; ring += 1) {
+        _ringCaches[hg::pztos(ring)].valid = false;
+    }
 }
 
 void VisibilityCalculator::_setInitialCalculationContext(PositionInWorld    aViewCenter,
@@ -240,6 +335,26 @@ void VisibilityCalculator::_processRing(hg::PZInteger aRingIndex) {
         _rayRadius += _cr;
     }
 
+    RingCache* cache = nullptr;
+    if (_incremental) {
+        if (hg::stopz(_ringCaches.size()) <= aRingIndex) {
+            _ringCaches.resize(hg::pztos(aRingIndex + 1));
+        }
+        cache = &_ringCaches[hg::pztos(aRingIndex)];
+
+        if (cache->valid) {
+            for (const auto& occluder : cache->occluders) {
+                _processOccluder(occluder);
+            }
+            _stats.reusedRingCount += 1;
+            _stats.reusedOccluderCount += hg::stopz(cache->occluders.size());
+            _setProcessedRingsBbox(aRingIndex);
+            return;
+        }
+
+        cache->occluders.clear();
+    }
+
     const auto xStart = _lineOfSightOriginCell.x - aRingIndex;
     const auto xEnd   = _lineOfSightOriginCell.x + aRingIndex;
 
@@ -252,7 +367,7 @@ void VisibilityCalculator::_processRing(hg::PZInteger aRingIndex) {
         if (CELL_Y_IS_IN_BOUNDS(y)) {
             for (int x = xStart; x <= xEnd; x += 1) {
                 if (CELL_X_IS_IN_BOUNDS(x)) {
-                    _processCell({x, y}, aRingIndex);
+                    _processCell({x, y}, aRingIndex, cache);
                 }
             }
         }
@@ -264,10 +379,10 @@ void VisibilityCalculator::_processRing(hg::PZInteger aRingIndex) {
          y += 1) {
         if (CELL_Y_IS_IN_BOUNDS(y)) {
             if (CELL_X_IS_IN_BOUNDS(xStart)) {
-                _processCell({xStart, y}, aRingIndex);
+                _processCell({xStart, y}, aRingIndex, cache);
             }
             if (CELL_X_IS_IN_BOUNDS(xEnd)) {
-                _processCell({xEnd, y}, aRingIndex);
+                _processCell({xEnd, y}, aRingIndex, cache);
             }
         }
     }
@@ -278,7 +393,7 @@ void VisibilityCalculator::_processRing(hg::PZInteger aRingIndex) {
         if (CELL_Y_IS_IN_BOUNDS(y)) {
             for (int x = xStart; x <= xEnd; x += 1) {
                 if (CELL_X_IS_IN_BOUNDS(x)) {
-                    _processCell({x, y}, aRingIndex);
+                    _processCell({x, y}, aRingIndex, cache);
                 }
             }
         }
@@ -287,13 +402,23 @@ void VisibilityCalculator::_processRing(hg::PZInteger aRingIndex) {
 #undef X_IS_IN_BOUNDS
 #undef Y_IS_IN_BOUNDS
 
+    if (cache != nullptr) {
+        cache->valid = true;
+    }
+
+    _setProcessedRingsBbox(aRingIndex);
+}
+
+void VisibilityCalculator::_setProcessedRingsBbox(hg::PZInteger aRingIndex) {
     _processedRingsBbox = {(_lineOfSightOriginCell.x - aRingIndex) * _cr,
                            (_lineOfSightOriginCell.y - aRingIndex) * _cr,
                            (aRingIndex * 2 + 1) * _cr,
                            (aRingIndex * 2 + 1) * _cr};
 }
 
-void VisibilityCalculator::_processCell(Vector2pz aCell, hg::PZInteger aRingIndex) {
+void VisibilityCalculator::_processCell(Vector2pz     aCell,
+                                        hg::PZInteger aRingIndex,
+                                        RingCache*    aCache) {
     const auto* cell = _world.getCellAtUnchecked(aCell);
     if (HG_UNLIKELY_CONDITION(cell == nullptr)) {
         HG_UNLIKELY_BRANCH;
@@ -307,14 +432,27 @@ void VisibilityCalculator::_processCell(Vector2pz aCell, hg::PZInteger aRingInde
     const auto edgesOfInterest  = _calcEdgesOfInterest(aCell);
     const bool allEdgesOverride = (aRingIndex <= 1);
 
-    std::array<Vector2f, 8> vertices;
-    const auto              vertCnt =
-        GetUnobstructedVertices(*cell, aCell, edgesOfInterest, allEdgesOverride, _cr, vertices);
+    Occluder occluder;
+    occluder.edgesOfInterest = edgesOfInterest;
+    occluder.vertCount       = static_cast<std::uint16_t>(GetUnobstructedVertices(
+        *cell, aCell, edgesOfInterest, allEdgesOverride, _cr, occluder.vertices));
 
-    if (vertCnt == 0) {
+    if (occluder.vertCount == 0) {
         return;
     }
 
+    if (aCache != nullptr) {
+        aCache->occluders.push_back(occluder);
+    }
+
+    _processOccluder(occluder);
+}
+
+void VisibilityCalculator::_processOccluder(const Occluder& aOccluder) {
+    const auto& vertices        = aOccluder.vertices;
+    const auto  vertCnt         = static_cast<std::size_t>(aOccluder.vertCount);
+    const auto  edgesOfInterest = aOccluder.edgesOfInterest;
+
     if (!_areAnyVerticesVisible(vertices, vertCnt, edgesOfInterest)) {
         return;
     }
@@ -363,23 +501,34 @@ void VisibilityCalculator::_setRaysFromTriangles(hg::math::AngleF aAngle1, hg::m
 }
 
 void VisibilityCalculator::_processRays() {
-    for (std::size_t i = 0; i < _rays.size(); i += 1) {
-        if (_rays[i] != INFINITY) {
-            continue;
+    // Each ray only reads the world and writes its own element of `_rays`, so batches of
+    // consecutive rays can be cast in parallel without any synchronization
+    static constexpr hg::PZInteger RAYS_PER_BATCH = 16;
+
+    const auto batchCount = (_rayCount + RAYS_PER_BATCH - 1) / RAYS_PER_BATCH;
+
+    _rayWorkers.run(batchCount, [this](hg::PZInteger aBatchIndex, hg::PZInteger) {
+        const auto start = aBatchIndex * RAYS_PER_BATCH;
+        const auto end   = std::min(start + RAYS_PER_BATCH, _rayCount);
+        for (hg::PZInteger i = start; i < end; i += 1) {
+            if (_rays[hg::pztos(i)] != INFINITY) {
+                continue;
+            }
+            _castRay(i);
         }
-        _castRay(hg::stopz(i));
-    }
+    });
 }
 
 void VisibilityCalculator::_castRay(hg::PZInteger aRayIndex) {
-    const auto direction         = AngleF::fullCircle() * aRayIndex / _rayCount;
-    const auto incrementDistance = _world.getCellResolution() / _rayPointsPerCell;
-    const auto incrementVector   = direction.asNormalizedVector() * incrementDistance;
+    const Vector2f direction         = {_rayDirectionsX[hg::pztos(aRayIndex)],
+                                        _rayDirectionsY[hg::pztos(aRayIndex)]};
+    const auto     incrementDistance = _world.getCellResolution() / _rayPointsPerCell;
+    const auto     incrementVector   = direction * incrementDistance;
 
     Vector2pz     prevCoords   = {};
     hg::PZInteger prevOpenness = 3; // cell with an openness of 3+ surely has no neighbouring walls
 
-    Vector2f point = _lineOfSightOrigin + direction.asNormalizedVector() * _rayRadius;
+    Vector2f point = _lineOfSightOrigin + direction * _rayRadius;
     for (hg::PZInteger t = 0; t < _maxPointsPerRay; t += 1) {
         point += incrementVector;
         if (HG_UNLIKELY_CONDITION(point.x < 0.f || point.y < 0.f || point.x >= _xLimit ||
@@ -419,7 +568,8 @@ bool VisibilityCalculator::_isPointVisible(PositionInWorld aPosInWorld, std::uin
         const float dist = hg::math::EuclideanDist(*aPosInWorld, _lineOfSightOrigin);
         Vector2f   diff = {aPosInWorld->x - _lineOfSightOrigin.x, aPosInWorld->y - _lineOfSightOrigin.y};
         const auto angle = AngleF::fromVector(diff.x, diff.y);
-        const int  idx   = hg::ToPz(std::round(_rayCount * (angle / AngleF::fullCircle())));
+        // (angles just below a full circle round up to _rayCount, which is the same as ray 0)
+        const int idx = hg::ToPz(std::round(_rayCount * (angle / AngleF::fullCircle()))) % _rayCount;
         if (dist > _rays[idx]) {
             return false;
         }
@@ -14,6 +14,44 @@ namespace gridgoblin {
 #define PRIORITY_NOT_IMPORTANT 999999
 
 namespace {
+hg::PZInteger ManhattanDistance(ChunkId aChunkId1, ChunkId aChunkId2) {
+    return std::abs((int)aChunkId1.x - (int)aChunkId2.x) + std::abs((int)aChunkId1.y - (int)aChunkId2.y);
+}
+
+//! Returns the IDs of all chunks in the ring square (see `ActiveArea::setToChunkRingSquare()`)
+//! which are within the bounds of the world.
+std::vector<ChunkId> MakeChunkRingSquare(ChunkId       aCentralChunk,
+                                         hg::PZInteger aRingCount,
+                                         hg::PZInteger aWorldChunkCountX,
+                                         hg::PZInteger aWorldChunkCountY) {
+    const auto squareSize = aRingCount * 2 + 1;
+    const auto startX     = static_cast<int>(aCentralChunk.x) - aRingCount;
+    const auto startY     = static_cast<int>(aCentralChunk.y) - aRingCount;
+
+    std::vector<ChunkId> result;
+    result.reserve(static_cast<std::size_t>(squareSize * squareSize));
+
+    for (int y = startY; y < startY + squareSize; y += 1) {
+        if (y < 0) {
+            continue;
+        }
+        if (y >= aWorldChunkCountY) {
+            break;
+        }
+        for (int x = startX; x < startX + squareSize; x += 1) {
+            if (x < 0) {
+                continue;
+            }
+            if (x >= aWorldChunkCountX) {
+                break;
+            }
+            result.push_back(ChunkId{(std::uint16_t)x, (std::uint16_t)y});
+        }
+    }
+
+    return result;
+}
+
 std::vector<detail::ChunkUsageChange> SetChunkListToEmpty(std::vector<ChunkId>& aCurrentChunkList) {
     if (aCurrentChunkList.empty()) {
         return {};
@@ -86,8 +124,7 @@ ActiveArea::~ActiveArea() {
 }
 
 void ActiveArea::setToNone() {
-    auto changes = SetChunkListToEmpty(_chunkList);
-    _storageHandler->_updateChunkUsage(changes);
+    _setChunkLists({}, {}, nullptr);
 }
 
 void ActiveArea::setToChunkRingSquare(ChunkId                                      aCentralChunk,
@@ -96,39 +133,49 @@ void ActiveArea::setToChunkRingSquare(ChunkId
     const auto worldChunkCountX = _storageHandler->_chunks.getWidth();
     const auto worldChunkCountY = _storageHandler->_chunks.getHeight();
 
-    const auto squareSize = aRingCount * 2 + 1;
-    const auto startX     = static_cast<int>(aCentralChunk.x) - aRingCount;
-    const auto startY     = static_cast<int>(aCentralChunk.y) - aRingCount;
+    auto newChunkList =
+        MakeChunkRingSquare(aCentralChunk, aRingCount, worldChunkCountX, worldChunkCountY);
 
-    std::vector<ChunkId> newChunkList;
-    newChunkList.reserve(static_cast<std::size_t>(squareSize * squareSize));
+    _setChunkLists(std::move(newChunkList),
+                   {},
+                   aGetLoadPriority ? aGetLoadPriority : [aCentralChunk](ChunkId aId) -> hg::PZInteger {
+                       return ManhattanDistance(aId, aCentralChunk);
+                   });
+}
 
-    for (int y = startY; y < startY + squareSize; y += 1) {
-        if (y < 0) {
-            continue;
-        }
-        if (y >= worldChunkCountY) {
-            break;
-        }
-        for (int x = startX; x < startX + squareSize; x += 1) {
-            if (x < 0) {
-                continue;
-            }
-            if (x >= worldChunkCountX) {
-                break;
-            }
-            newChunkList.push_back(ChunkId{(std::uint16_t)x, (std::uint16_t)y});
-        }
-    }
+void ActiveArea::setToChunkRingSquareWithPrefetch(
+    ChunkId                                      aCentralChunk,
+    hg::PZInteger                                aRingCount,
+    ChunkId                                      aPredictedCentralChunk,
+    const std::function<hg::PZInteger(ChunkId)>& aGetLoadPriority) {
+    const auto worldChunkCountX = _storageHandler->_chunks.getWidth();
+    const auto worldChunkCountY = _storageHandler->_chunks.getHeight();
 
-    auto changes = detail::UpdateChunkList(
-        _chunkList,
-        newChunkList,
-        aGetLoadPriority ? aGetLoadPriority : [aCentralChunk](ChunkId aId) -> hg::PZInteger {
-            return std::abs((int)aId.x - (int)aCentralChunk.x) +
-                   std::abs((int)aId.y - (int)aCentralChunk.y);
-        });
-    _storageHandler->_updateChunkUsage(changes);
+    auto mainList = MakeChunkRingSquare(aCentralChunk, aRingCount, worldChunkCountX, worldChunkCountY);
+    auto prefetchList =
+        MakeChunkRingSquare(aPredictedCentralChunk, aRingCount, worldChunkCountX, worldChunkCountY);
+
+    const auto isInMainSquare = [=](ChunkId aChunkId) {
+        return std::abs((int)aChunkId.x - (int)aCentralChunk.x) <= aRingCount &&
+               std::abs((int)aChunkId.y - (int)aCentralChunk.y) <= aRingCount;
+    };
+
+    prefetchList.erase(std::remove_if(prefetchList.begin(), prefetchList.end(), isInMainSquare),
+                       prefetchList.end());
+
+    // The largest default priority in the main square is (aRingCount * 2)
+    const auto firstPrefetchPriority = aRingCount * 2 + 1;
+
+    _setChunkLists(std::move(mainList),
+                   std::move(prefetchList),
+                   [&](ChunkId aChunkId) -> hg::PZInteger {
+                       if (!isInMainSquare(aChunkId)) {
+                           return firstPrefetchPriority +
+                                  ManhattanDistance(aChunkId, aPredictedCentralChunk);
+                       }
+                       return aGetLoadPriority ? aGetLoadPriority(aChunkId)
+                                               : ManhattanDistance(aChunkId, aCentralChunk);
+                   });
 }
 
 void ActiveArea::setToChunkRingDiamond(ChunkId                                      aCentralChunk,
@@ -164,25 +211,99 @@ void ActiveArea::setToChunkRingDiamond(ChunkId
         }
     }
 
-    auto changes = detail::UpdateChunkList(
-        _chunkList,
-        newChunkList,
-        aGetLoadPriority ? aGetLoadPriority : [aCentralChunk](ChunkId aId) -> hg::PZInteger {
-            return std::abs((int)aId.x - (int)aCentralChunk.x) +
-                   std::abs((int)aId.y - (int)aCentralChunk.y);
-        });
-    _storageHandler->_updateChunkUsage(changes);
+    _setChunkLists(std::move(newChunkList),
+                   {},
+                   aGetLoadPriority ? aGetLoadPriority : [aCentralChunk](ChunkId aId) -> hg::PZInteger {
+                       return ManhattanDistance(aId, aCentralChunk);
+                   });
 }
 
 void ActiveArea::setToChunkList(std::vector<ChunkId>                         aChunkList,
                                 const std::function<hg::PZInteger(ChunkId)>& aGetLoadPriority) {
-    auto changes = detail::UpdateChunkList(_chunkList, aChunkList, aGetLoadPriority);
-    _storageHandler->_updateChunkUsage(changes);
+    _setChunkLists(std::move(aChunkList), {}, aGetLoadPriority);
 }
 
 const std::vector<ChunkId>& ActiveArea::getChunkList() const {
     return _chunkList;
 }
 
+ActiveArea::PrefetchStats ActiveArea::getPrefetchStats() const {
+    return _prefetchStats;
+}
+
+void ActiveArea::_setChunkLists(std::vector<ChunkId>                         aMainList,
+                                std::vector<ChunkId>                         aPrefetchList,
+                                const std::function<hg::PZInteger(ChunkId)>& aGetLoadPriority) {
+    std::sort(aPrefetchList.begin(), aPrefetchList.end());
+
+    // Chunks which are pending can't be found among the loaded ones yet
+    const auto isLoaded = [this](ChunkId aChunkId) {
+        return _storageHandler->getChunkAtIdUnchecked(aChunkId) != nullptr;
+    };
+
+    // Chunks which stay in the area keep their load priorities by default (see UpdateChunkList),
+    // so those which switch between the main and the speculative part need to be adjusted after.
+    std::vector<ChunkId> reprioritized;
+
+    std::vector<ChunkId> prefetchRequestedList;
+
+    if (!_prefetchList.empty() || !aPrefetchList.empty()) {
+        auto sortedMainList = aMainList;
+        std::sort(sortedMainList.begin(), sortedMainList.end());
+        auto sortedOldList = _chunkList;
+        std::sort(sortedOldList.begin(), sortedOldList.end());
+
+        const auto contains = [](const std::vector<ChunkId>& aSortedList, ChunkId aChunkId) {
+            return std::binary_search(aSortedList.begin(), aSortedList.end(), aChunkId);
+        };
+
+        for (const auto id : _prefetchList) {
+            if (contains(sortedMainList, id)) {
+                // Chunks which were loaded (or loading) before they were predicted are no merit of
+                // the prefetch, so they count as neither hits nor late loads
+                const auto countIt = contains(_prefetchRequestedList, id) ? 1 : 0;
+                if (isLoaded(id)) {
+                    _prefetchStats.hitCount += countIt;
+                } else {
+                    _prefetchStats.lateCount += countIt;
+                    reprioritized.push_back(id);
+                }
+            } else if (!contains(aPrefetchList, id)) {
+                _prefetchStats.discardedCount += 1;
+            }
+        }
+
+        for (const auto id : aPrefetchList) {
+            if (contains(_prefetchList, id)) {
+                if (contains(_prefetchRequestedList, id)) {
+                    prefetchRequestedList.push_back(id);
+                }
+                continue;
+            }
+            if (!contains(sortedOldList, id)) {
+                if (!isLoaded(id)) {
+                    _prefetchStats.requestCount += 1;
+                    prefetchRequestedList.push_back(id);
+                }
+            } else if (!isLoaded(id)) {
+                reprioritized.push_back(id); // Moved from the main part to the speculative one
+            }
+        }
+    }
+
+    std::vector<ChunkId> newChunkList = std::move(aMainList);
+    newChunkList.insert(newChunkList.end(), aPrefetchList.begin(), aPrefetchList.end());
+
+    auto changes = detail::UpdateChunkList(_chunkList, std::move(newChunkList), aGetLoadPriority);
+    _storageHandler->_updateChunkUsage(changes);
+
+    for (const auto id : reprioritized) {
+        _storageHandler->_setChunkLoadPriority(id, aGetLoadPriority ? aGetLoadPriority(id) : 0);
+    }
+
+    _prefetchList          = std::move(aPrefetchList);
+    _prefetchRequestedList = std::move(prefetchRequestedList);
+}
+
 } // namespace gridgoblin
 } // namespace jbatnozic
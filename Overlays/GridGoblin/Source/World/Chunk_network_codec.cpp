@@ -0,0 +1,606 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/World/Chunk_network_codec.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+// Format of an encoded chunk (all fixed-size numbers are little-endian; 'varint' denotes an
+// unsigned LEB128 number, and 'sprite ID' a zigzag-encoded varint, so that any `SpriteId`,
+// including negative ones, can be sent):
+// - header:
+//   - u8:  format version
+//   - u8:  encoding (0 = full, 1 = delta)
+//   - u16: chunk ID (X)
+//   - u16: chunk ID (Y)
+//   - u16: number of cells in the chunk along the X axis (W)
+//   - u16: number of cells in the chunk along the Y axis (H)
+//   - u64: version
+//   - u64: base version (same as version for full encodings)
+//   - u32: size of the body in bytes
+// - body:
+//   - cell selection (delta only): varint N, followed by N pairs of varints (number of cells to
+//     skip, number of cells to take), in row-major order; full encodings include all W * H cells
+//   - floors:
+//     - palette: varint P, followed by P entries, each consisting of:
+//       - u8: 1 if the floor is initialized, or 0 if it isn't (in which case the entry ends here)
+//       - sprite ID
+//     - runs: pairs of varints (run length, palette index) until all selected cells are covered
+//   - walls:
+//     - palette: varint P, followed by P entries, each consisting of:
+//       - u8: shape + 1, or 0 for no wall (in which case the entry ends here)
+//       - sprite ID
+//       - reduced sprite ID
+//     - runs: same as for floors
+
+constexpr std::uint8_t NETWORK_CHUNK_FORMAT_VERSION = 2;
+constexpr std::size_t  NETWORK_CHUNK_HEADER_SIZE    = 30;
+
+constexpr std::uint32_t NO_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+using Encoding = ChunkNetworkEncoder::Encoding;
+
+void PutLE(char* aDst, std::uint64_t aValue, int aByteCount) {
+    for (int i = 0; i < aByteCount; i += 1) {
+        aDst[i] = static_cast<char>((aValue >> (8 * i)) & 0xFF);
+    }
+}
+
+std::uint64_t GetLE(const char* aSrc, int aByteCount) {
+    std::uint64_t result = 0;
+    for (int i = 0; i < aByteCount; i += 1) {
+        result |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(aSrc[i])) << (8 * i);
+    }
+    return result;
+}
+
+void WriteOrThrow(hg::util::Packet& aPacket, const std::vector<char>& aData) {
+    const auto byteCount = static_cast<std::int64_t>(aData.size());
+    if (aPacket.write(aData.data(), byteCount) != byteCount) {
+        HG_THROW_TRACED(hg::util::StreamWriteError,
+                        0,
+                        "Failed to write {} bytes of encoded chunk data to packet.",
+                        byteCount);
+    }
+}
+
+void PutVarint(std::vector<char>& aBuffer, std::uint64_t aValue) {
+    while (aValue >= 0x80) {
+        aBuffer.push_back(static_cast<char>((aValue & 0x7F) | 0x80));
+        aValue >>= 7;
+    }
+    aBuffer.push_back(static_cast<char>(aValue));
+}
+
+void PutSpriteId(std::vector<char>& aBuffer, SpriteId aSpriteId) {
+    const auto value = static_cast<std::int32_t>(aSpriteId);
+    const auto zigzag =
+        (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+    PutVarint(aBuffer, zigzag);
+}
+
+//! Reads numbers from the body of an encoded chunk, throwing `ChunkCodecError` instead of
+//! reading past its end.
+class BodyReader {
+public:
+    BodyReader(const char* aData, std::size_t aByteCount)
+        : _cursor{aData}
+        , _end{aData + aByteCount} {}
+
+    bool isAtEnd() const {
+        return _cursor == _end;
+    }
+
+    std::uint8_t getU8() {
+        if (_cursor == _end) {
+            HG_THROW_TRACED(ChunkCodecError, 0, "Unexpected end of encoded chunk body.");
+        }
+        return static_cast<std::uint8_t>(*_cursor++);
+    }
+
+    std::uint64_t getVarint() {
+        std::uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const auto byte = getU8();
+            result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return result;
+            }
+        }
+        HG_THROW_TRACED(ChunkCodecError, 0, "Invalid varint in encoded chunk body.");
+    }
+
+    //! Reads a varint which must be less than or equal to `aMax`.
+    std::uint64_t getVarint(std::uint64_t aMax, const char* aWhat) {
+        const auto result = getVarint();
+        if (result > aMax) {
+            HG_THROW_TRACED(ChunkCodecError,
+                            0,
+                            "Invalid {} in encoded chunk ({}; max is {}).",
+                            aWhat,
+                            result,
+                            aMax);
+        }
+        return result;
+    }
+
+    SpriteId getSpriteId() {
+        const auto value = static_cast<std::uint32_t>(
+            getVarint(std::numeric_limits<std::uint32_t>::max(), "sprite ID"));
+        return static_cast<SpriteId>(static_cast<std::int32_t>((value >> 1) ^ (0u - (value & 1u))));
+    }
+
+private:
+    const char* _cursor;
+    const char* _end;
+};
+
+//! Reads runs of palette indices which cover `aCellCount` cells, and calls
+//! `aCallback(cellOrdinal, paletteIndex)` for each of the cells.
+template <class taCallback>
+void ReadRuns(BodyReader&   aReader,
+              std::size_t   aCellCount,
+              std::uint64_t aPaletteSize,
+              taCallback&&  aCallback) {
+    std::size_t ordinal = 0;
+    while (ordinal < aCellCount) {
+        const auto length = aReader.getVarint(aCellCount - ordinal, "run length");
+        const auto index  = aReader.getVarint();
+        if (length == 0 || index >= aPaletteSize) {
+            HG_THROW_TRACED(ChunkCodecError,
+                            0,
+                            "Invalid run in encoded chunk (length: {}, palette index: {}).",
+                            length,
+                            index);
+        }
+        for (std::size_t i = 0; i < length; i += 1) {
+            aCallback(ordinal + i, static_cast<std::uint32_t>(index));
+        }
+        ordinal += length;
+    }
+}
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////
+// ENCODER                                                               //
+///////////////////////////////////////////////////////////////////////////
+
+std::size_t ChunkNetworkEncoder::WallKeyHasher::operator()(const WallKey& aKey) const {
+    if (!aKey.wallOpt) {
+        return 0;
+    }
+    const auto& wall = *aKey.wallOpt;
+    std::size_t hash = std::hash<SpriteId>{}(wall.spriteId);
+    hash = hash * 31 + std::hash<SpriteId>{}(wall.spriteId_reduced);
+    hash = hash * 31 + static_cast<std::size_t>(wall.shape);
+    return hash;
+}
+
+void ChunkNetworkEncoder::encodeFull(ChunkId           aChunkId,
+                                     const Chunk&      aChunk,
+                                     ChunkVersion      aVersion,
+                                     hg::util::Packet& aPacket) {
+    HG_VALIDATE_ARGUMENT(!aChunk.isEmpty(), "Chunk must not be empty.");
+
+    const auto cellCount = aChunk.getCellCountX() * aChunk.getCellCountY();
+    _cellIndices.resize(hg::pztos(cellCount));
+    for (hg::PZInteger i = 0; i < cellCount; i += 1) {
+        _cellIndices[hg::pztos(i)] = static_cast<std::uint32_t>(i);
+    }
+
+    _encode(aChunkId, aChunk, Encoding::FULL, aVersion, aVersion);
+    WriteOrThrow(aPacket, _buffer);
+}
+
+auto ChunkNetworkEncoder::encode(const World&                aWorld,
+                                 ChunkId                     aChunkId,
+                                 std::optional<ChunkVersion> aAcknowledgedVersion,
+                                 hg::util::Packet&           aPacket) -> Encoding {
+    const Chunk* chunk = aWorld.getChunkAtId(aChunkId);
+    HG_VALIDATE_ARGUMENT(chunk != nullptr && !chunk->isEmpty(),
+                         "Chunk {} is not loaded.",
+                         aChunkId);
+
+    const auto version = aWorld.getCellGeneration();
+    if (!aAcknowledgedVersion.has_value() || *aAcknowledgedVersion > version) {
+        encodeFull(aChunkId, *chunk, version, aPacket);
+        return Encoding::FULL;
+    }
+
+    // Mark the cells of the chunk which were changed since the acknowledged version
+    const auto width   = chunk->getCellCountX();
+    const auto height  = chunk->getCellCountY();
+    const auto originX = static_cast<hg::PZInteger>(aChunkId.x) * width;
+    const auto originY = static_cast<hg::PZInteger>(aChunkId.y) * height;
+
+    _changedCells.assign(hg::pztos(width * height), 0);
+    const bool complete = aWorld.forEachCellChangeSince(
+        *aAcknowledgedVersion,
+        [&](const hg::math::Rectangle<hg::PZInteger>& aRect) {
+            const auto startX = std::max(aRect.x, originX) - originX;
+            const auto startY = std::max(aRect.y, originY) - originY;
+            const auto endX   = std::min(aRect.x + aRect.w, originX + width) - originX;
+            const auto endY   = std::min(aRect.y + aRect.h, originY + height) - originY;
+            if (startX >= endX) {
+                return;
+            }
+            for (hg::PZInteger y = startY; y < endY; y += 1) {
+                std::fill(_changedCells.begin() + y * width + startX,
+                          _changedCells.begin() + y * width + endX,
+                          1);
+            }
+        });
+    if (!complete) {
+        encodeFull(aChunkId, *chunk, version, aPacket);
+        return Encoding::FULL;
+    }
+
+    _cellIndices.clear();
+    for (std::size_t i = 0; i < _changedCells.size(); i += 1) {
+        if (_changedCells[i] != 0) {
+            _cellIndices.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    _encode(aChunkId, *chunk, Encoding::DELTA, version, *aAcknowledgedVersion);
+    WriteOrThrow(aPacket, _buffer);
+    return Encoding::DELTA;
+}
+
+void ChunkNetworkEncoder::_encode(ChunkId      aChunkId,
+                                  const Chunk& aChunk,
+                                  Encoding     aEncoding,
+                                  ChunkVersion aVersion,
+                                  ChunkVersion aBaseVersion) {
+    _buffer.resize(NETWORK_CHUNK_HEADER_SIZE);
+
+    if (aEncoding == Encoding::DELTA) {
+        _encodeCellSelection(aChunk.getCellCountX() * aChunk.getCellCountY());
+    }
+    _encodeFloors(aChunk);
+    _encodeWalls(aChunk);
+
+    char* cursor = _buffer.data();
+    PutLE(cursor + 0, NETWORK_CHUNK_FORMAT_VERSION, 1);
+    PutLE(cursor + 1, static_cast<std::uint8_t>(aEncoding), 1);
+    PutLE(cursor + 2, aChunkId.x, 2);
+    PutLE(cursor + 4, aChunkId.y, 2);
+    PutLE(cursor + 6, static_cast<std::uint16_t>(aChunk.getCellCountX()), 2);
+    PutLE(cursor + 8, static_cast<std::uint16_t>(aChunk.getCellCountY()), 2);
+    PutLE(cursor + 10, aVersion, 8);
+    PutLE(cursor + 18, aBaseVersion, 8);
+    PutLE(cursor + 26, _buffer.size() - NETWORK_CHUNK_HEADER_SIZE, 4);
+}
+
+void ChunkNetworkEncoder::_encodeCellSelection(hg::PZInteger aTotalCellCount) {
+    // Count the runs first, as their number comes before them
+    std::size_t runCount = 0;
+    for (std::size_t i = 0; i < _cellIndices.size(); i += 1) {
+        if (i == 0 || _cellIndices[i] != _cellIndices[i - 1] + 1) {
+            runCount += 1;
+        }
+    }
+    PutVarint(_buffer, runCount);
+
+    std::uint32_t position = 0; //!< First cell after the previous run
+    std::size_t   i        = 0;
+    while (i < _cellIndices.size()) {
+        const auto start = _cellIndices[i];
+        std::size_t end  = i + 1;
+        while (end < _cellIndices.size() && _cellIndices[end] == _cellIndices[end - 1] + 1) {
+            end += 1;
+        }
+        PutVarint(_buffer, start - position);
+        PutVarint(_buffer, end - i);
+        position = start + static_cast<std::uint32_t>(end - i);
+        i        = end;
+    }
+    HG_ASSERT(position <= static_cast<std::uint32_t>(aTotalCellCount));
+}
+
+void ChunkNetworkEncoder::_encodeFloors(const Chunk& aChunk) {
+    const auto width = aChunk.getCellCountX();
+
+    _floorPalette.clear();
+    _paletteCells.clear();
+    _paletteIndices.resize(_cellIndices.size());
+
+    FloorKey      prevKey;
+    std::uint32_t prevIndex = NO_INDEX;
+    for (std::size_t i = 0; i < _cellIndices.size(); i += 1) {
+        const auto  cellIndex = static_cast<hg::PZInteger>(_cellIndices[i]);
+        const auto& cell      = aChunk.getCellAtUnchecked(cellIndex % width, cellIndex / width);
+
+        FloorKey key;
+        if (cell.isFloorInitialized()) {
+            key = cell.getFloor().spriteId;
+        }
+
+        // Neighbouring cells usually have the same floor, which spares the lookup
+        if (key != prevKey || prevIndex == NO_INDEX) {
+            const auto [iter, inserted] =
+                _floorPalette.try_emplace(key, static_cast<std::uint32_t>(_paletteCells.size()));
+            if (inserted) {
+                _paletteCells.push_back(_cellIndices[i]);
+            }
+            prevKey   = key;
+            prevIndex = iter->second;
+        }
+        _paletteIndices[i] = prevIndex;
+    }
+
+    PutVarint(_buffer, _paletteCells.size());
+    for (const auto cellIndex : _paletteCells) {
+        const auto  index = static_cast<hg::PZInteger>(cellIndex);
+        const auto& cell  = aChunk.getCellAtUnchecked(index % width, index / width);
+        if (!cell.isFloorInitialized()) {
+            _buffer.push_back(0);
+            continue;
+        }
+        _buffer.push_back(1);
+        PutSpriteId(_buffer, cell.getFloor().spriteId);
+    }
+
+    _encodeRuns();
+}
+
+void ChunkNetworkEncoder::_encodeWalls(const Chunk& aChunk) {
+    const auto width = aChunk.getCellCountX();
+
+    _wallPalette.clear();
+    _paletteCells.clear();
+    _paletteIndices.resize(_cellIndices.size());
+
+    WallKey       prevKey;
+    std::uint32_t prevIndex = NO_INDEX;
+    for (std::size_t i = 0; i < _cellIndices.size(); i += 1) {
+        const auto  cellIndex = static_cast<hg::PZInteger>(_cellIndices[i]);
+        const auto& cell      = aChunk.getCellAtUnchecked(cellIndex % width, cellIndex / width);
+
+        WallKey key;
+        if (cell.isWallInitialized()) {
+            key.wallOpt = cell.getWall();
+        }
+
+        if (!(key == prevKey) || prevIndex == NO_INDEX) {
+            const auto [iter, inserted] =
+                _wallPalette.try_emplace(key, static_cast<std::uint32_t>(_paletteCells.size()));
+            if (inserted) {
+                _paletteCells.push_back(_cellIndices[i]);
+            }
+            prevKey   = key;
+            prevIndex = iter->second;
+        }
+        _paletteIndices[i] = prevIndex;
+    }
+
+    PutVarint(_buffer, _paletteCells.size());
+    for (const auto cellIndex : _paletteCells) {
+        const auto  index = static_cast<hg::PZInteger>(cellIndex);
+        const auto& cell  = aChunk.getCellAtUnchecked(index % width, index / width);
+        if (!cell.isWallInitialized()) {
+            _buffer.push_back(0);
+            continue;
+        }
+        const auto& wall = cell.getWall();
+        _buffer.push_back(static_cast<char>(static_cast<std::uint8_t>(wall.shape) + 1));
+        PutSpriteId(_buffer, wall.spriteId);
+        PutSpriteId(_buffer, wall.spriteId_reduced);
+    }
+
+    _encodeRuns();
+}
+
+void ChunkNetworkEncoder::_encodeRuns() {
+    std::size_t i = 0;
+    while (i < _paletteIndices.size()) {
+        std::size_t end = i + 1;
+        while (end < _paletteIndices.size() && _paletteIndices[end] == _paletteIndices[i]) {
+            end += 1;
+        }
+        PutVarint(_buffer, end - i);
+        PutVarint(_buffer, _paletteIndices[i]);
+        i = end;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// DECODER                                                               //
+///////////////////////////////////////////////////////////////////////////
+
+ChunkNetworkDecoder::Result ChunkNetworkDecoder::decode(hg::util::Packet& aPacket, Chunk& aChunk) {
+    const auto result = _decode(aPacket, {aChunk.getCellCountX(), aChunk.getCellCountY()});
+
+    const auto width = aChunk.getCellCountX();
+    for (std::size_t i = 0; i < _cellIndices.size(); i += 1) {
+        const auto cellIndex = static_cast<hg::PZInteger>(_cellIndices[i]);
+        auto&      cell      = aChunk.getCellAtUnchecked(cellIndex % width, cellIndex / width);
+        if (_floors[i]) {
+            cell.setFloor(*_floors[i]);
+        } else {
+            cell.resetFloor();
+        }
+        if (_walls[i]) {
+            cell.setWall(*_walls[i]);
+        } else {
+            cell.resetWall();
+        }
+    }
+
+    return result;
+}
+
+ChunkNetworkDecoder::Result ChunkNetworkDecoder::decode(hg::util::Packet& aPacket,
+                                                        const World&      aWorld,
+                                                        World::Editor&    aEditor) {
+    const hg::math::Vector2pz chunkSize{aWorld.getCellCountX() / aWorld.getChunkCountX(),
+                                        aWorld.getCellCountY() / aWorld.getChunkCountY()};
+
+    const auto result = _decode(aPacket, chunkSize);
+    if (result.chunkId.x >= aWorld.getChunkCountX() || result.chunkId.y >= aWorld.getChunkCountY()) {
+        HG_THROW_TRACED(ChunkCodecError,
+                        0,
+                        "Encoded chunk {} is outside of the world.",
+                        result.chunkId);
+    }
+
+    const auto originX = static_cast<hg::PZInteger>(result.chunkId.x) * chunkSize.x;
+    const auto originY = static_cast<hg::PZInteger>(result.chunkId.y) * chunkSize.y;
+    for (std::size_t i = 0; i < _cellIndices.size(); i += 1) {
+        const auto cellIndex = static_cast<hg::PZInteger>(_cellIndices[i]);
+        const auto x         = originX + cellIndex % chunkSize.x;
+        const auto y         = originY + cellIndex / chunkSize.x;
+        aEditor.setFloorAtUnchecked(x, y, _floors[i]);
+        aEditor.setWallAtUnchecked(x, y, _walls[i]);
+    }
+
+    return result;
+}
+
+ChunkNetworkDecoder::Result ChunkNetworkDecoder::_decode(hg::util::Packet&   aPacket,
+                                                         hg::math::Vector2pz aExpectedChunkSize) {
+    // Header
+    const auto* header =
+        static_cast<const char*>(aPacket.readInPlaceNoThrow(NETWORK_CHUNK_HEADER_SIZE));
+    if (!aPacket || header == nullptr) {
+        HG_THROW_TRACED(ChunkCodecError, 0, "Failed to read encoded chunk header.");
+    }
+
+    const auto formatVersion = static_cast<std::uint8_t>(GetLE(header + 0, 1));
+    const auto encoding      = static_cast<std::uint8_t>(GetLE(header + 1, 1));
+    if (formatVersion != NETWORK_CHUNK_FORMAT_VERSION) {
+        HG_THROW_TRACED(ChunkCodecError,
+                        0,
+                        "Unsupported encoded chunk format version ({}; expected {}).",
+                        formatVersion,
+                        NETWORK_CHUNK_FORMAT_VERSION);
+    }
+    if (encoding != static_cast<std::uint8_t>(Encoding::FULL) &&
+        encoding != static_cast<std::uint8_t>(Encoding::DELTA)) {
+        HG_THROW_TRACED(ChunkCodecError, 0, "Invalid chunk encoding ({}).", encoding);
+    }
+
+    Result result;
+    result.chunkId     = ChunkId{static_cast<std::uint16_t>(GetLE(header + 2, 2)),
+                                 static_cast<std::uint16_t>(GetLE(header + 4, 2))};
+    result.encoding    = static_cast<Encoding>(encoding);
+    result.version     = GetLE(header + 10, 8);
+    result.baseVersion = GetLE(header + 18, 8);
+
+    const auto width    = static_cast<hg::PZInteger>(GetLE(header + 6, 2));
+    const auto height   = static_cast<hg::PZInteger>(GetLE(header + 8, 2));
+    const auto bodySize = static_cast<std::int64_t>(GetLE(header + 26, 4));
+    if (width != aExpectedChunkSize.x || height != aExpectedChunkSize.y) {
+        HG_THROW_TRACED(ChunkCodecError,
+                        0,
+                        "Encoded chunk dimensions ({} x {}) don't match the expected ones "
+                        "({} x {}).",
+                        width,
+                        height,
+                        aExpectedChunkSize.x,
+                        aExpectedChunkSize.y);
+    }
+
+    const auto* body = static_cast<const char*>(aPacket.readInPlaceNoThrow(bodySize));
+    if (!aPacket || (body == nullptr && bodySize > 0)) {
+        HG_THROW_TRACED(ChunkCodecError,
+                        0,
+                        "Failed to read encoded chunk body ({} bytes).",
+                        bodySize);
+    }
+    BodyReader reader{body, static_cast<std::size_t>(bodySize)};
+
+    // Cell selection
+    const auto totalCellCount = static_cast<std::uint64_t>(width * height);
+    _cellIndices.clear();
+    if (result.encoding == Encoding::FULL) {
+        for (std::uint64_t i = 0; i < totalCellCount; i += 1) {
+            _cellIndices.push_back(static_cast<std::uint32_t>(i));
+        }
+    } else {
+        const auto    runCount = reader.getVarint(totalCellCount, "cell run count");
+        std::uint64_t position = 0;
+        for (std::uint64_t i = 0; i < runCount; i += 1) {
+            position += reader.getVarint(totalCellCount - position, "cell skip count");
+            const auto length = reader.getVarint(totalCellCount - position, "cell run length");
+            for (std::uint64_t j = 0; j < length; j += 1) {
+                _cellIndices.push_back(static_cast<std::uint32_t>(position + j));
+            }
+            position += length;
+        }
+    }
+
+    // Floors
+    {
+        const auto paletteSize = reader.getVarint(_cellIndices.size(), "floor palette size");
+
+        std::vector<std::optional<CellModel::Floor>> palette;
+        palette.reserve(paletteSize);
+        for (std::uint64_t i = 0; i < paletteSize; i += 1) {
+            const auto initialized = reader.getU8();
+            if (initialized == 0) {
+                palette.emplace_back(std::nullopt);
+                continue;
+            }
+            if (initialized != 1) {
+                HG_THROW_TRACED(ChunkCodecError, 0, "Invalid floor flag ({}).", initialized);
+            }
+            palette.emplace_back(CellModel::Floor{reader.getSpriteId()});
+        }
+
+        _floors.resize(_cellIndices.size());
+        ReadRuns(reader,
+                 _cellIndices.size(),
+                 paletteSize,
+                 [&](std::size_t aOrdinal, std::uint32_t aIndex) {
+                     _floors[aOrdinal] = palette[aIndex];
+                 });
+    }
+
+    // Walls
+    {
+        const auto paletteSize = reader.getVarint(_cellIndices.size(), "wall palette size");
+
+        std::vector<std::optional<CellModel::Wall>> palette;
+        palette.reserve(paletteSize);
+        for (std::uint64_t i = 0; i < paletteSize; i += 1) {
+            const auto shape = reader.getU8();
+            if (shape == 0) {
+                palette.emplace_back(std::nullopt);
+                continue;
+            }
+            if (shape - 1 > static_cast<std::uint8_t>(Shape::FULL_SQUARE)) {
+                HG_THROW_TRACED(ChunkCodecError, 0, "Invalid wall shape ({}).", shape - 1);
+            }
+            CellModel::Wall wall;
+            wall.spriteId         = reader.getSpriteId();
+            wall.spriteId_reduced = reader.getSpriteId();
+            wall.shape            = static_cast<Shape>(shape - 1);
+            palette.emplace_back(wall);
+        }
+
+        _walls.resize(_cellIndices.size());
+        ReadRuns(reader,
+                 _cellIndices.size(),
+                 paletteSize,
+                 [&](std::size_t aOrdinal, std::uint32_t aIndex) {
+                     _walls[aOrdinal] = palette[aIndex];
+                 });
+    }
+
+    if (!reader.isAtEnd()) {
+        HG_THROW_TRACED(ChunkCodecError, 0, "Unexpected data at the end of encoded chunk body.");
+    }
+
+    result.cellCount = static_cast<hg::PZInteger>(_cellIndices.size());
+    return result;
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
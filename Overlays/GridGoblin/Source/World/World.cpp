@@ -1,6 +1,7 @@
 // Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
 // See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
 
+#include <GridGoblin/Private/Cell_openness.hpp>
 #include <GridGoblin/Private/Chunk_disk_io_handler_default.hpp>
 #include <GridGoblin/Private/Chunk_disk_io_handler_interface.hpp>
 #include <GridGoblin/Private/Chunk_spooler_default.hpp>
@@ -8,8 +9,10 @@
 #include <GridGoblin/World/World.hpp>
 
 #include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
 #include "../Detail_access.hpp"
@@ -18,13 +21,39 @@ namespace jbatnozic {
 namespace gridgoblin {
 
 namespace {
+constexpr auto LOG_ID = "GridGoblin";
+
 std::unique_ptr<detail::ChunkDiskIoHandlerInterface> CreateDiskIoHandler(const WorldConfig& aConfig) {
     return std::make_unique<detail::DefaultChunkDiskIoHandler>(aConfig);
 }
 
 std::unique_ptr<detail::ChunkSpoolerInterface> CreateChunkSpooler(const WorldConfig& aConfig) {
-    (void)aConfig;
-    return std::make_unique<detail::DefaultChunkSpooler>();
+    return std::make_unique<detail::DefaultChunkSpooler>(aConfig.chunkSpoolerWorkerCount);
+}
+
+using JournalEntry = detail::EditJournal::Entry;
+
+JournalEntry MakeFloorJournalEntry(hg::PZInteger                          aX,
+                                   hg::PZInteger                          aY,
+                                   const std::optional<CellModel::Floor>& aFloorOpt) {
+    if (!aFloorOpt) {
+        return {.kind = JournalEntry::RESET_FLOOR, .x = aX, .y = aY};
+    }
+    return {.kind = JournalEntry::SET_FLOOR, .x = aX, .y = aY, .spriteId = aFloorOpt->spriteId};
+}
+
+JournalEntry MakeWallJournalEntry(hg::PZInteger                         aX,
+                                  hg::PZInteger                         aY,
+                                  const std::optional<CellModel::Wall>& aWallOpt) {
+    if (!aWallOpt) {
+        return {.kind = JournalEntry::RESET_WALL, .x = aX, .y = aY};
+    }
+    return {.kind             = JournalEntry::SET_WALL,
+            .x                = aX,
+            .y                = aY,
+            .spriteId         = aWallOpt->spriteId,
+            .spriteId_reduced = aWallOpt->spriteId_reduced,
+            .shape            = aWallOpt->shape};
 }
 } // namespace
 
@@ -34,9 +63,13 @@ World::World(const WorldConfig& aConfig)
     , _chunkDiskIoHandler{_internalChunkDiskIoHandler.get()}
     , _internalChunkSpooler{CreateChunkSpooler(aConfig)}
     , _chunkSpooler{_internalChunkSpooler.get()}
-    , _chunkStorage{aConfig} //
+    , _chunkStorage{aConfig}
+    , _refreshWorkers{aConfig.cellRefreshWorkerCount}
+    , _refreshScratch(hg::pztos(_refreshWorkers.getWorkerCount()))
+    , _raycastWorkers{aConfig.raycastWorkerCount} //
 {
     _connectSubcomponents();
+    _openEditJournal();
 }
 
 World::World(const WorldConfig&                                  aConfig,
@@ -46,9 +79,13 @@ World::World(const WorldConfig&                                  aConfig,
     , _chunkDiskIoHandler{aChunkDiskIoHandler}
     , _internalChunkSpooler{CreateChunkSpooler(aConfig)}
     , _chunkSpooler{_internalChunkSpooler.get()}
-    , _chunkStorage{aConfig} //
+    , _chunkStorage{aConfig}
+    , _refreshWorkers{aConfig.cellRefreshWorkerCount}
+    , _refreshScratch(hg::pztos(_refreshWorkers.getWorkerCount()))
+    , _raycastWorkers{aConfig.raycastWorkerCount} //
 {
     _connectSubcomponents();
+    _openEditJournal();
 }
 
 #ifdef FUTURE
@@ -60,6 +97,10 @@ World::World(const WorldConfig& aConfig, hg::NeverNull<detail::ChunkSpoolerInter
 #endif
 
 World::~World() {
+    // Saves which are still in progress would be abandoned when the spooler is destroyed
+    for (const auto& pendingSave : _pendingSaves) {
+        pendingSave.future.wait();
+    }
     _disconnectSubcomponents();
 }
 
@@ -78,169 +119,123 @@ void World::detachBinder(hg::NeverNull<Binder*> aBinder) {
 }
 
 ///////////////////////////////////////////////////////////////////////////
-// TEMPLATES                                                             //
+// asdasd                                                                //
 ///////////////////////////////////////////////////////////////////////////
 
-template <bool taAllowedToLoadAdjacent>
-World::RingAssessment World::_assessRing(hg::PZInteger aX, hg::PZInteger aY, hg::PZInteger aRing) {
-    RingAssessment result;
+void World::update() {
+    _chunkStorage.update();
+    _checkPendingSaves();
+
+    if (_editJournal != nullptr && !_journalCompactionBlocked && _pendingSaves.empty() &&
+        _config.editJournalCompactionThreshold > 0 &&
+        _editJournal->getCurrentSegmentByteCount() > _config.editJournalCompactionThreshold) {
+        // Saving makes the journaled edits redundant, so the journal can be started anew
+        HG_LOG_INFO(LOG_ID, "Edit journal exceeded the compaction threshold; saving the world.");
+        (void)saveAsync();
+    }
+}
 
-    bool hasTopSide    = false;
-    bool hasLeftSide   = false;
-    bool hasRightSide  = false;
-    bool hasBottomSide = false;
+void World::prune() {
+    _chunkStorage.prune();
+}
 
-    const auto isCellSolid = [this](hg::PZInteger aX, hg::PZInteger aY) -> bool {
-        if (aX < 0 || aX >= _config.cellCountX || aY < 0 || aY >= _config.cellCountY) {
-            return true;
-        }
+void World::save() {
+    _chunkSpooler->pause();
+    _chunkSpooler->dumpRuntimeCache();
+    _chunkSpooler->unpause();
+}
 
-        if constexpr (taAllowedToLoadAdjacent) {
-            auto& cell = _chunkStorage.getCellAtUnchecked(aX, aY, detail::LOAD_IF_MISSING);
-            return cell.isWallInitialized();
-        } else {
-            auto* cell = _chunkStorage.getCellAtUnchecked(aX, aY);
-            return !cell || cell->isWallInitialized();
+std::shared_future<void> World::saveAsync() {
+    std::uint64_t journalSegment = 0;
+    if (_editJournal != nullptr) {
+        // All the edits journaled so far will be covered by this save, except for the recovered
+        // edits which weren't applied yet, so those are carried over to the new segment
+        std::vector<JournalEntry> carriedOverEntries;
+        for (const auto& [chunkId, entries] : _recoveredEdits) {
+            carriedOverEntries.insert(carriedOverEntries.end(), entries.begin(), entries.end());
         }
-    };
-
-    if (aRing == 0) {
-        const bool solid = isCellSolid(aX, aY);
-        if (solid) {
-            result.hasOccupiedCells = true;
+        try {
+            journalSegment = _editJournal->startNewSegment(carriedOverEntries);
+        } catch (const detail::EditJournalError& aEx) {
+            // The save itself can still go ahead; only the journal can't be compacted anymore
+            HG_LOG_ERROR(LOG_ID, "Edit journal will no longer be compacted: {}", aEx.what());
+            _journalCompactionBlocked = true;
         }
-        return result;
     }
 
-    // Check top row (except corners)
-    {
-        const int y = aY - aRing;
+    auto snapshots = _chunkStorage.snapshotModifiedChunks();
+    auto future    = _chunkSpooler->saveChunks(std::move(snapshots));
+    _pendingSaves.push_back({future, journalSegment});
+    return future;
+}
 
-        for (int x = aX - aRing + 1; x <= aX + aRing - 1; x += 1) {
-            const bool solid = isCellSolid(x, y);
-            if (solid) {
-                result.hasOccupiedCells = true;
-                hasTopSide              = true;
-            }
-        }
+void World::flushEditJournal() {
+    if (_editJournal != nullptr) {
+        _editJournal->flush();
     }
-    // Check bottom row (except corners)
-    {
-        const int y = aY + aRing;
-
-        for (int x = aX - aRing + 1; x <= aX + aRing - 1; x += 1) {
-            const bool solid = isCellSolid(x, y);
-            if (solid) {
-                result.hasOccupiedCells = true;
-                hasBottomSide           = true;
+}
 
-                // Possible early exit
-                if (hasTopSide) {
-                    return result;
-                }
-            }
-        }
-    }
-    // Check middle rows (only extremes)
-    {
-        for (int y = aY - aRing + 1; y <= aY + aRing - 1; y += 1) {
-            {
-                const int  x     = aX - aRing;
-                const bool solid = isCellSolid(x, y);
-                if (solid) {
-                    result.hasOccupiedCells = true;
-                    hasLeftSide             = true;
-
-                    // Possible early exit
-                    if (hasRightSide) {
-                        return result;
-                    }
-                }
-            }
-            {
-                const int  x     = aX + aRing;
-                const bool solid = isCellSolid(x, y);
-                if (solid) {
-                    result.hasOccupiedCells = true;
-                    hasRightSide            = true;
-
-                    // Possible early exit
-                    if (hasLeftSide) {
-                        return result;
-                    }
-                }
-            }
-        }
+std::optional<detail::ChunkRuntimeCache::Stats> World::getRuntimeCacheStats() const {
+    if (_internalChunkDiskIoHandler == nullptr) {
+        return std::nullopt;
     }
-    // Check corners
-    {
-        // TopLeft, TopRight, BottomLeft, BottomRight
-        const bool tl = isCellSolid(aX - aRing, aY - aRing);
-        const bool tr = isCellSolid(aX + aRing, aY - aRing);
-        const bool bl = isCellSolid(aX - aRing, aY + aRing);
-        const bool br = isCellSolid(aX + aRing, aY + aRing);
-
-        const hg::PZInteger delta = hg::ToPz(tl) + hg::ToPz(tr) + hg::ToPz(bl) + hg::ToPz(br);
-        result.hasOccupiedCells |= (delta > 0);
-
-        if (delta == 4) {
-            return result;
-        }
+    return static_cast<const detail::DefaultChunkDiskIoHandler&>(*_internalChunkDiskIoHandler)
+        .getRuntimeCacheStats();
+}
 
-        // clang-format off
-        if ((!tl && !hasTopSide    && !hasLeftSide)  ||
-            (!tr && !hasTopSide    && !hasRightSide) ||
-            (!bl && !hasBottomSide && !hasLeftSide)  ||
-            (!br && !hasBottomSide && !hasRightSide))
-        {
-            result.extend = true;
-            return result;
-        }
-        // clang-format on
+std::vector<detail::DefaultChunkSpooler::WorkerStats> World::getSpoolerWorkerStats() const {
+    if (_internalChunkSpooler == nullptr) {
+        return {};
     }
-
-    return result;
+    return static_cast<const detail::DefaultChunkSpooler&>(*_internalChunkSpooler).getWorkerStats();
 }
 
-template <bool taAllowedToLoadAdjacent>
-hg::PZInteger World::_calcOpennessAt(hg::PZInteger aX, hg::PZInteger aY) {
-    if (_config.maxCellOpenness == 0) {
-        return 0;
+detail::DefaultChunkSpooler::QueueStats World::getSpoolerQueueStats() const {
+    if (_internalChunkSpooler == nullptr) {
+        return {};
     }
+    return static_cast<const detail::DefaultChunkSpooler&>(*_internalChunkSpooler).getQueueStats();
+}
 
-    const auto maxRing = static_cast<hg::PZInteger>((_config.maxCellOpenness + 1) / 2);
-
-    // Ring 0 = just the cell at (aX, aY)
-    // Ring 1 =  8 cells around Ring 0
-    // Ring 2 = 16 cells around Ring 1
-    // and so on...
-    for (hg::PZInteger ring = 0; ring < maxRing; ring += 1) {
-        const auto ras = _assessRing<taAllowedToLoadAdjacent>(aX, aY, ring);
-
-        if (!ras.hasOccupiedCells) {
-            continue;
-        }
-
-        if (ring == 0) {
-            return 0; // Ring 0 - special case
-        }
+detail::ChunkStorageHandler::ImmediateLoadStats World::getImmediateLoadStats() const {
+    return _chunkStorage.getImmediateLoadStats();
+}
 
-        return ((ring * 2) - 1 + hg::ToPz(ras.extend));
-    }
+World::EditStats World::getEditStats() const {
+    return _editStats;
+}
 
-    return ((maxRing * 2) - 1);
+std::uint64_t World::getCellGeneration() const {
+    return _cellGeneration;
 }
 
-///////////////////////////////////////////////////////////////////////////
-// asdasd                                                                //
-///////////////////////////////////////////////////////////////////////////
+bool World::forEachCellChangeSince(
+    std::uint64_t                                                         aGeneration,
+    const std::function<void(const hg::math::Rectangle<hg::PZInteger>&)>& aCallback) const {
+    if (aGeneration >= _cellGeneration) {
+        return true;
+    }
+    // The oldest remembered change might be only a part of its generation, so the generation
+    // right after `aGeneration` has to be newer than that for the records to be complete
+    if (_cellChanges.empty() || _cellChanges.front().generation > aGeneration) {
+        return false;
+    }
 
-void World::update() {
-    _chunkStorage.update();
+    for (auto iter = _cellChanges.rbegin(); iter != _cellChanges.rend(); ++iter) {
+        if (iter->generation <= aGeneration) {
+            break;
+        }
+        const auto& rect = iter->rect;
+        aCallback({rect.startX,
+                   rect.startY,
+                   rect.endX - rect.startX + 1,
+                   rect.endY - rect.startY + 1});
+    }
+    return true;
 }
 
-void World::prune() {
-    _chunkStorage.prune();
+std::int64_t World::getResidentChunkByteCount() const {
+    return _chunkStorage.getResidentChunkByteCount();
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -440,6 +435,142 @@ const Chunk& World::getChunkAtIdUnchecked(const EditPermission& /*aPerm*/, Chunk
     return _chunkStorage.getChunkAtIdUnchecked(aChunkId, detail::LOAD_IF_MISSING);
 }
 
+///////////////////////////////////////////////////////////////////////////
+// RAYCASTING                                                            //
+///////////////////////////////////////////////////////////////////////////
+
+RaycastResult World::castRay(const Ray& aRay) const {
+    // Coordinates are in cells from here on (1.0 = one cell)
+    const float cellResolution = _config.cellResolution;
+
+    const float startX = aRay.from->x / cellResolution;
+    const float startY = aRay.from->y / cellResolution;
+    const float dirX   = aRay.to->x / cellResolution - startX;
+    const float dirY   = aRay.to->y / cellResolution - startY;
+
+    const auto targetX = static_cast<hg::PZInteger>(std::floor(aRay.to->x / cellResolution));
+    const auto targetY = static_cast<hg::PZInteger>(std::floor(aRay.to->y / cellResolution));
+
+    auto x = static_cast<hg::PZInteger>(std::floor(startX));
+    auto y = static_cast<hg::PZInteger>(std::floor(startY));
+
+    RaycastResult result;
+    result.position = aRay.from;
+
+    const auto isInWorld = [this](hg::PZInteger aX, hg::PZInteger aY) {
+        return aX >= 0 && aX < _config.cellCountX && aY >= 0 && aY < _config.cellCountY;
+    };
+    if (!isInWorld(x, y)) {
+        result.outcome = RaycastResult::LEFT_WORLD;
+        return result;
+    }
+
+    // Amanatides-Woo: `tMax*` is the value of parameter t (0 at `from`, 1 at `to`) at which the
+    // ray crosses the next vertical/horizontal cell boundary, and `tDelta*` is how much t grows
+    // between two such boundaries.
+    const hg::PZInteger stepX  = (dirX > 0.f) ? 1 : ((dirX < 0.f) ? -1 : 0);
+    const hg::PZInteger stepY  = (dirY > 0.f) ? 1 : ((dirY < 0.f) ? -1 : 0);
+    const float         tDeltaX = (stepX != 0) ? std::abs(1.f / dirX) : INFINITY;
+    const float         tDeltaY = (stepY != 0) ? std::abs(1.f / dirY) : INFINITY;
+
+    float tMaxX = INFINITY;
+    if (stepX > 0) {
+        tMaxX = (static_cast<float>(x + 1) - startX) / dirX;
+    } else if (stepX < 0) {
+        tMaxX = (startX - static_cast<float>(x)) / -dirX;
+    }
+    float tMaxY = INFINITY;
+    if (stepY > 0) {
+        tMaxY = (static_cast<float>(y + 1) - startY) / dirY;
+    } else if (stepY < 0) {
+        tMaxY = (startY - static_cast<float>(y)) / -dirY;
+    }
+
+    // The chunk containing the current cell, and its bounds in cells (end exclusive); the chunk is
+    // looked up again only once the ray leaves them
+    const Chunk*  chunk       = nullptr;
+    hg::PZInteger chunkStartX = 0;
+    hg::PZInteger chunkStartY = 0;
+    hg::PZInteger chunkEndX   = 0;
+    hg::PZInteger chunkEndY   = 0;
+
+    while (true) {
+        if (x < chunkStartX || x >= chunkEndX || y < chunkStartY || y >= chunkEndY) {
+            const auto chunkId = cellToChunkIdUnchecked(x, y);
+            chunk              = _chunkStorage.getChunkAtIdUnchecked(chunkId);
+            chunkStartX        = chunkId.x * _config.cellsPerChunkX;
+            chunkStartY        = chunkId.y * _config.cellsPerChunkY;
+            chunkEndX          = chunkStartX + _config.cellsPerChunkX;
+            chunkEndY          = chunkStartY + _config.cellsPerChunkY;
+        }
+
+        result.cell = {x, y};
+        if (chunk == nullptr) {
+            result.outcome = RaycastResult::HIT_UNLOADED_CHUNK;
+            return result;
+        }
+        if (chunk->getCellAtUnchecked(x - chunkStartX, y - chunkStartY).isWallInitialized()) {
+            result.outcome = RaycastResult::HIT_WALL;
+            return result;
+        }
+
+        // The second condition guards against rounding errors making the ray miss its target cell
+        if ((x == targetX && y == targetY) || std::min(tMaxX, tMaxY) > 1.f) {
+            result.outcome  = RaycastResult::REACHED_TARGET;
+            result.position = aRay.to;
+            return result;
+        }
+
+        float t;
+        if (tMaxX < tMaxY) {
+            t = tMaxX;
+            x += stepX;
+            tMaxX += tDeltaX;
+            result.edge = (stepX > 0) ? RaycastResult::LEFT_EDGE : RaycastResult::RIGHT_EDGE;
+        } else {
+            t = tMaxY;
+            y += stepY;
+            tMaxY += tDeltaY;
+            result.edge = (stepY > 0) ? RaycastResult::TOP_EDGE : RaycastResult::BOTTOM_EDGE;
+        }
+        result.position = PositionInWorld{aRay.from->x + (aRay.to->x - aRay.from->x) * t,
+                                          aRay.from->y + (aRay.to->y - aRay.from->y) * t};
+
+        if (!isInWorld(x, y)) {
+            // Report the edge of the last cell in the world through which the ray left it
+            static constexpr RaycastResult::Edge OPPOSITE_EDGES[] = {RaycastResult::NO_EDGE,
+                                                                     RaycastResult::RIGHT_EDGE,
+                                                                     RaycastResult::LEFT_EDGE,
+                                                                     RaycastResult::BOTTOM_EDGE,
+                                                                     RaycastResult::TOP_EDGE};
+            result.outcome = RaycastResult::LEFT_WORLD;
+            result.edge    = OPPOSITE_EDGES[result.edge];
+            return result;
+        }
+    }
+}
+
+void World::castRays(const Ray* aRays, hg::PZInteger aRayCount, RaycastResult* aResults) const {
+    HG_VALIDATE_ARGUMENT(aRayCount >= 0);
+
+    // Rays are handed out in small batches so that workers don't contend over every single one
+    static constexpr hg::PZInteger RAYS_PER_TASK = 64;
+
+    const auto taskCount = (aRayCount + RAYS_PER_TASK - 1) / RAYS_PER_TASK;
+    _raycastWorkers.run(taskCount, [=, this](hg::PZInteger aTaskIndex, hg::PZInteger /*aWorkerIndex*/) {
+        const auto start = aTaskIndex * RAYS_PER_TASK;
+        const auto end   = std::min(start + RAYS_PER_TASK, aRayCount);
+        for (hg::PZInteger i = start; i < end; i += 1) {
+            aResults[i] = castRay(aRays[i]);
+        }
+    });
+}
+
+void World::castRays(const std::vector<Ray>& aRays, std::vector<RaycastResult>& aResults) const {
+    aResults.resize(aRays.size());
+    castRays(aRays.data(), hg::stopz(aRays.size()), aResults.data());
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // ACTIVE AREAS                                                          //
 ///////////////////////////////////////////////////////////////////////////
@@ -481,6 +612,53 @@ void World::_connectSubcomponents() {
     _chunkStorage.setChunkSpooler(_chunkSpooler);
 }
 
+void World::_checkPendingSaves() {
+    // Binders are notified only after the list is updated, in case any of them starts a new save
+    std::vector<bool> results;
+    for (auto iter = _pendingSaves.begin(); iter != _pendingSaves.end();) {
+        if (iter->future.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+            ++iter;
+            continue;
+        }
+
+        bool succeeded = true;
+        try {
+            iter->future.get();
+        } catch (const std::exception& aEx) {
+            HG_LOG_ERROR(LOG_ID, "Saving chunks failed: {}", aEx.what());
+            succeeded = false;
+        }
+        results.push_back(succeeded);
+
+        if (_editJournal != nullptr) {
+            if (!succeeded) {
+                HG_LOG_WARN(LOG_ID, "Edit journal will no longer be compacted, as a save failed.");
+                _journalCompactionBlocked = true;
+            } else {
+                _savedJournalSegment = std::max(_savedJournalSegment, iter->journalSegment);
+            }
+        }
+
+        iter = _pendingSaves.erase(iter);
+    }
+
+    if (_editJournal != nullptr && !_journalCompactionBlocked && !results.empty()) {
+        // Saves are started in order of their segments, so a pending save with an earlier segment
+        // was started earlier (and might yet fail)
+        const bool earlierSaveInProgress =
+            std::any_of(_pendingSaves.begin(), _pendingSaves.end(), [this](const auto& aSave) {
+                return aSave.journalSegment < _savedJournalSegment;
+            });
+        if (!earlierSaveInProgress) {
+            _editJournal->discardSegmentsBefore(_savedJournalSegment);
+        }
+    }
+
+    for (const bool succeeded : results) {
+        onSaveFinished(succeeded);
+    }
+}
+
 void World::_disconnectSubcomponents() {
     _chunkStorage.setChunkSpooler(nullptr);
     _chunkStorage.setBinder(nullptr);
@@ -496,18 +674,11 @@ void World::_refreshCellsInAndAroundChunk(ChunkId aChunkId) {
 
     const auto maxOffset = static_cast<hg::PZInteger>(_config.maxCellOpenness / 2);
 
-    const auto startX = std::max<hg::PZInteger>(0, left - maxOffset);
-    const auto startY = std::max<hg::PZInteger>(0, top - maxOffset);
-    const auto endX =
-        std::min<hg::PZInteger>(_config.cellCountX - 1, left + _config.cellsPerChunkX - 1 + maxOffset);
-    const auto endY =
-        std::min<hg::PZInteger>(_config.cellCountY - 1, top + _config.cellsPerChunkY - 1 + maxOffset);
-
-    for (hg::PZInteger y = startY; y <= endY; y += 1) {
-        for (hg::PZInteger x = startX; x <= endX; x += 1) {
-            _refreshCellAtUnchecked(x, y);
-        }
-    }
+    _queueCellsForRefresh(left - maxOffset,
+                          top - maxOffset,
+                          left + _config.cellsPerChunkX - 1 + maxOffset,
+                          top + _config.cellsPerChunkY - 1 + maxOffset);
+    _refreshQueuedCells();
 }
 
 void World::onChunkReady(ChunkId aChunkId) {
@@ -517,6 +688,7 @@ void World::onChunkReady(ChunkId aChunkId) {
 }
 
 void World::onChunkLoaded(ChunkId aChunkId, const Chunk& aChunk) {
+    _applyRecoveredEdits(aChunkId);
     _refreshCellsInAndAroundChunk(aChunkId);
 
     for (const auto& [binder, priority] : _binders) {
@@ -525,6 +697,7 @@ void World::onChunkLoaded(ChunkId aChunkId, const Chunk& aChunk) {
 }
 
 void World::onChunkCreated(ChunkId aChunkId, const Chunk& aChunk) {
+    _applyRecoveredEdits(aChunkId);
     _refreshCellsInAndAroundChunk(aChunkId);
 
     for (const auto& [binder, priority] : _binders) {
@@ -535,12 +708,24 @@ void World::onChunkCreated(ChunkId aChunkId, const Chunk& aChunk) {
 void World::onChunkUnloaded(ChunkId aChunkId) {
     // No need to refresh cell after a chunk is unloaded; cells near the edges of the loaded parts
     // of the world can have slightly inaccurate information - it doesn't matter.
+    // But the cells of the chunk itself are gone, so that counts as a change.
+    _cellGeneration += 1;
+    _recordCellChange({aChunkId.x * _config.cellsPerChunkX,
+                       aChunkId.y * _config.cellsPerChunkY,
+                       (aChunkId.x + 1) * _config.cellsPerChunkX - 1,
+                       (aChunkId.y + 1) * _config.cellsPerChunkY - 1});
 
     for (const auto& [binder, priority] : _binders) {
         binder->onChunkUnloaded(aChunkId);
     }
 }
 
+void World::onSaveFinished(bool aSucceeded) {
+    for (const auto& [binder, priority] : _binders) {
+        binder->onSaveFinished(aSucceeded);
+    }
+}
+
 std::unique_ptr<ChunkExtensionInterface> World::createChunkExtension() {
     for (const auto& [binder, priority] : _binders) {
         auto extension = binder->createChunkExtension();
@@ -551,77 +736,265 @@ std::unique_ptr<ChunkExtensionInterface> World::createChunkExtension() {
     return nullptr;
 }
 
+// ===== Edit journal =====
+
+void World::_openEditJournal() {
+    if (_config.editJournalPath.empty()) {
+        return;
+    }
+
+    _editJournal = std::make_unique<detail::EditJournal>(_config.editJournalPath,
+                                                         _config.editJournalCommitInterval);
+
+    hg::PZInteger invalidEntryCount = 0;
+    for (const auto& entry : _editJournal->takeRecoveredEntries()) {
+        if (entry.x < 0 || entry.x >= getCellCountX() || entry.y < 0 || entry.y >= getCellCountY()) {
+            invalidEntryCount += 1;
+            continue;
+        }
+        _recoveredEdits[cellToChunkIdUnchecked(entry.x, entry.y)].push_back(entry);
+    }
+    if (invalidEntryCount > 0) {
+        HG_LOG_WARN(LOG_ID,
+                    "Ignored {} recovered edits of cells outside of the world (was the edit journal "
+                    "made for a world with different dimensions?).",
+                    invalidEntryCount);
+    }
+}
+
+void World::_applyRecoveredEdits(ChunkId aChunkId) {
+    const auto iter = _recoveredEdits.find(aChunkId);
+    if (iter == _recoveredEdits.end()) {
+        return;
+    }
+
+    // The edits are applied directly (they're already in the journal), but the chunk is still
+    // marked as modified, so that the next save includes them
+    for (const auto& entry : iter->second) {
+        auto& cell =
+            _chunkStorage.getCellForEditingAtUnchecked(entry.x, entry.y, detail::LOAD_IF_MISSING);
+        switch (entry.kind) {
+        case JournalEntry::SET_FLOOR:
+            cell.setFloor({entry.spriteId});
+            break;
+
+        case JournalEntry::RESET_FLOOR:
+            cell.resetFloor();
+            break;
+
+        case JournalEntry::SET_WALL:
+            cell.setWall({entry.spriteId, entry.spriteId_reduced, entry.shape});
+            break;
+
+        case JournalEntry::RESET_WALL:
+            cell.resetWall();
+            break;
+
+        default:
+            HG_UNREACHABLE("Invalid edit journal entry kind ({}).", (int)entry.kind);
+        }
+    }
+
+    _recoveredEdits.erase(iter);
+}
+
 // ===== Editing cells =====
 
 void World::_startEdit() {
-    _editMinX = -1;
-    _editMinY = -1;
-    _editMaxX = -1;
-    _editMaxY = -1;
+    _editDirtyRects.clear();
+    _editChangedRects.clear();
+    _editStats.editCount += 1;
 }
 
 void World::_endEdit() {
-    if (_editMinX == -1 || _editMinY == -1 || _editMaxX == -1 || _editMaxY == -1) {
+    if (!_journalEntries.empty()) {
+        _editJournal->submit(_journalEntries.data(), hg::stopz(_journalEntries.size()));
+        _journalEntries.clear();
+    }
+
+    if (!_editChangedRects.empty()) {
+        _cellGeneration += 1;
+        for (const auto& [chunkId, rect] : _editChangedRects) {
+            _recordCellChange(rect);
+        }
+        _editChangedRects.clear();
+    }
+
+    if (_editDirtyRects.empty()) {
         return;
     }
 
     const auto maxOffset = static_cast<hg::PZInteger>(_config.maxCellOpenness / 2);
 
-    const auto startX = std::max<hg::PZInteger>(0, _editMinX - maxOffset);
-    const auto startY = std::max<hg::PZInteger>(0, _editMinY - maxOffset);
-    const auto endX   = std::min<hg::PZInteger>(_config.cellCountX - 1, _editMaxX + maxOffset);
-    const auto endY   = std::min<hg::PZInteger>(_config.cellCountY - 1, _editMaxY + maxOffset);
+    for (const auto& [chunkId, rect] : _editDirtyRects) {
+        _queueCellsForRefresh(rect.startX - maxOffset,
+                              rect.startY - maxOffset,
+                              rect.endX + maxOffset,
+                              rect.endY + maxOffset);
+    }
+    _editDirtyRects.clear();
+
+    _editStats.cellsRefreshed += _refreshQueuedCells();
+}
 
-    for (hg::PZInteger y = startY; y <= endY; y += 1) {
-        for (hg::PZInteger x = startX; x <= endX; x += 1) {
-            _refreshCellAtUnchecked(x, y);
-        }
+void World::_addCellToEditRects(std::unordered_map<ChunkId, CellRect>& aRects,
+                                hg::PZInteger                          aX,
+                                hg::PZInteger                          aY) {
+    const ChunkId chunkId{aX / _config.cellsPerChunkX, aY / _config.cellsPerChunkY};
+
+    const auto [iter, inserted] = aRects.try_emplace(chunkId, CellRect{aX, aY, aX, aY});
+    if (!inserted) {
+        auto& rect  = iter->second;
+        rect.startX = std::min(rect.startX, aX);
+        rect.startY = std::min(rect.startY, aY);
+        rect.endX   = std::max(rect.endX, aX);
+        rect.endY   = std::max(rect.endY, aY);
     }
 }
 
-namespace {
-bool IsCellSolid(const CellModel* aCell) {
-    return (aCell == nullptr || aCell->isWallInitialized());
+void World::_queueCellsForRefresh(hg::PZInteger aStartX,
+                                  hg::PZInteger aStartY,
+                                  hg::PZInteger aEndX,
+                                  hg::PZInteger aEndY) {
+    aStartX = std::max<hg::PZInteger>(0, aStartX);
+    aStartY = std::max<hg::PZInteger>(0, aStartY);
+    aEndX   = std::min<hg::PZInteger>(_config.cellCountX - 1, aEndX);
+    aEndY   = std::min<hg::PZInteger>(_config.cellCountY - 1, aEndY);
+
+    if (aStartX > aEndX || aStartY > aEndY) {
+        return;
+    }
+
+    const auto firstChunkX = aStartX / _config.cellsPerChunkX;
+    const auto firstChunkY = aStartY / _config.cellsPerChunkY;
+    const auto lastChunkX  = aEndX / _config.cellsPerChunkX;
+    const auto lastChunkY  = aEndY / _config.cellsPerChunkY;
+
+    for (hg::PZInteger chunkY = firstChunkY; chunkY <= lastChunkY; chunkY += 1) {
+        for (hg::PZInteger chunkX = firstChunkX; chunkX <= lastChunkX; chunkX += 1) {
+            const ChunkId chunkId{chunkX, chunkY};
+            if (_chunkStorage.getChunkAtIdUnchecked(chunkId) == nullptr) {
+                continue;
+            }
+
+            const CellRect rect{std::max(aStartX, chunkX * _config.cellsPerChunkX),
+                                std::max(aStartY, chunkY * _config.cellsPerChunkY),
+                                std::min(aEndX, (chunkX + 1) * _config.cellsPerChunkX - 1),
+                                std::min(aEndY, (chunkY + 1) * _config.cellsPerChunkY - 1)};
+
+            const auto iter = _refreshTaskIndices.find(chunkId);
+            if (iter != _refreshTaskIndices.end()) {
+                auto& queuedRect  = _refreshTasks[hg::pztos(iter->second)].rect;
+                queuedRect.startX = std::min(queuedRect.startX, rect.startX);
+                queuedRect.startY = std::min(queuedRect.startY, rect.startY);
+                queuedRect.endX   = std::max(queuedRect.endX, rect.endX);
+                queuedRect.endY   = std::max(queuedRect.endY, rect.endY);
+                continue;
+            }
+
+            if (hg::stopz(_refreshTasks.size()) == _refreshTaskCount) {
+                _refreshTasks.emplace_back();
+            }
+            _refreshTasks[hg::pztos(_refreshTaskCount)].rect = rect;
+            _refreshTaskIndices[chunkId]                     = _refreshTaskCount;
+            _refreshTaskCount += 1;
+        }
+    }
 }
-} // namespace
 
-void World::_refreshCellAtUnchecked(hg::PZInteger aX, hg::PZInteger aY) {
-    auto* cell = _chunkStorage.getCellAtUnchecked(aX, aY);
-    if (cell) {
-        const auto openness = _calcOpennessAt<false>(aX, aY);
-        // TODO: process top, left, right, bottom - for better cache performance
-        const auto obstruction = [this, aX, aY, openness]() -> std::uint16_t {
-            if (openness > 2) {
-                return 0;
+hg::PZInteger World::_refreshQueuedCells() {
+    // Openness calculation needs to look up to `maxCellOpenness / 2` cells away, and obstruction
+    // flags need to look 1 cell away, so for each task, copy the flags of its cells and the cells
+    // around them into contiguous planes first (unloaded cells and cells outside of the world count
+    // as solid); then all lookups can be done in the planes instead of going through the chunks.
+    const auto margin = std::max<hg::PZInteger>(1, _config.maxCellOpenness / 2);
+
+    const auto taskCount = _refreshTaskCount;
+    _refreshTaskCount    = 0;
+    _refreshTaskIndices.clear();
+
+    // Pass 1: calculate the new values into the planes. Each task reads cells of neighbouring
+    // chunks, so no cells may be written to until all of them are done.
+    _refreshWorkers.run(taskCount, [this, margin](hg::PZInteger aTaskIndex, hg::PZInteger aWorkerIndex) {
+        auto&       task = _refreshTasks[hg::pztos(aTaskIndex)];
+        const auto& rect = task.rect;
+        task.planes.reset(rect.endX - rect.startX + 1 + 2 * margin,
+                          rect.endY - rect.startY + 1 + 2 * margin,
+                          detail::CellPlanes::FLAGS | detail::CellPlanes::OPENNESS);
+        _chunkStorage.copyCellsToPlanes(rect.startX - margin,
+                                        rect.startY - margin,
+                                        task.planes,
+                                        CellModel::WALL_INITIALIZED);
+        detail::CalcOpennessInPlanes(task.planes,
+                                     margin,
+                                     _config.maxCellOpenness,
+                                     _refreshScratch[hg::pztos(aWorkerIndex)]);
+    });
+
+    // Pass 2: write the new values into the cells (each task only writes to its own chunk).
+    _refreshWorkers.run(taskCount, [this, margin](hg::PZInteger aTaskIndex, hg::PZInteger) {
+        const auto& task   = _refreshTasks[hg::pztos(aTaskIndex)];
+        const auto& rect   = task.rect;
+        const auto& planes = task.planes;
+
+        const auto isSolid = [](std::uint16_t aFlags) {
+            return (aFlags & CellModel::WALL_INITIALIZED) != 0;
+        };
+
+        for (hg::PZInteger y = rect.startY; y <= rect.endY; y += 1) {
+            const auto  row         = y - rect.startY + margin;
+            const auto* opennessRow = planes.getOpennessRow(row);
+            const auto* flagsAbove  = planes.getFlagsRow(row - 1);
+            const auto* flagsRow    = planes.getFlagsRow(row);
+            const auto* flagsBelow  = planes.getFlagsRow(row + 1);
+
+            for (hg::PZInteger x = rect.startX; x <= rect.endX; x += 1) {
+                const auto col = x - rect.startX + margin;
+
+                auto* cell = _chunkStorage.getCellForRefreshingAtUnchecked(x, y);
+                HG_ASSERT(cell != nullptr);
+
+                const auto openness = opennessRow[col];
+
+                std::uint16_t obstruction = 0;
+                if (openness <= 2) {
+                    // clang-format off
+                    obstruction |= isSolid(flagsRow[col + 1]) ? CellModel::RIGHT_EDGE_OBSTRUCTED  : 0;
+                    obstruction |= isSolid(flagsAbove[col])   ? CellModel::TOP_EDGE_OBSTRUCTED    : 0;
+                    obstruction |= isSolid(flagsRow[col - 1]) ? CellModel::LEFT_EDGE_OBSTRUCTED   : 0;
+                    obstruction |= isSolid(flagsBelow[col])   ? CellModel::BOTTOM_EDGE_OBSTRUCTED : 0;
+                    // clang-format on
+                }
+
+                cell->setOpenness(openness);
+                cell->setObstructionFlags(obstruction);
+
+                GetMutableExtensionData(*cell).refresh(nullptr, nullptr, nullptr, nullptr);
             }
-            std::uint16_t res = 0;
-            res |=
-                (aX >= getCellCountX() - 1 || IsCellSolid(_chunkStorage.getCellAtUnchecked(aX + 1, aY)))
-                    ? CellModel::RIGHT_EDGE_OBSTRUCTED
-                    : 0;
-            res |= (aY <= 0 || IsCellSolid(_chunkStorage.getCellAtUnchecked(aX, aY - 1)))
-                       ? CellModel::TOP_EDGE_OBSTRUCTED
-                       : 0;
-            res |= (aX <= 0 || IsCellSolid(_chunkStorage.getCellAtUnchecked(aX - 1, aY)))
-                       ? CellModel::LEFT_EDGE_OBSTRUCTED
-                       : 0;
-            res |=
-                (aY >= getCellCountY() - 1 || IsCellSolid(_chunkStorage.getCellAtUnchecked(aX, aY + 1)))
-                    ? CellModel::BOTTOM_EDGE_OBSTRUCTED
-                    : 0;
-            return res;
-        }();
-
-        cell->setOpenness(openness);
-        cell->setObstructionFlags(obstruction);
-
-        // GetMutableExtensionData(cell).refresh(
-        //     (aY <= 0) ? nullptr : std::addressof(_grid[aY - 1][aX]),
-        //     (aX <= 0) ? nullptr : std::addressof(_grid[aY][aX - 1]),
-        //     (aX >= getCellCountX() - 1) ? nullptr : std::addressof(_grid[aY][aX + 1]),
-        //     (aY >= getCellCountY() - 1) ? nullptr : std::addressof(_grid[aY + 1][aX]));
-        GetMutableExtensionData(*cell).refresh(nullptr, nullptr, nullptr, nullptr);
+        }
+    });
+
+    if (taskCount > 0) {
+        _cellGeneration += 1;
+    }
+
+    hg::PZInteger refreshedCount = 0;
+    for (hg::PZInteger i = 0; i < taskCount; i += 1) {
+        const auto& rect = _refreshTasks[hg::pztos(i)].rect;
+        refreshedCount += (rect.endX - rect.startX + 1) * (rect.endY - rect.startY + 1);
+        _recordCellChange(rect);
+    }
+    return refreshedCount;
+}
+
+void World::_recordCellChange(const CellRect& aRect) {
+    // Enough to cover a few frames' worth of edits and chunk loads
+    static constexpr std::size_t MAX_REMEMBERED_CELL_CHANGES = 256;
+
+    if (_cellChanges.size() == MAX_REMEMBERED_CELL_CHANGES) {
+        _cellChanges.pop_front();
     }
+    _cellChanges.push_back({_cellGeneration, aRect});
 }
 
 void World::_setFloorAt(hg::PZInteger                          aX,
@@ -640,7 +1013,12 @@ void World::_setFloorAt(hg::math::Vector2pz aCell, const std::optional<CellModel
 void World::_setFloorAtUnchecked(hg::PZInteger                          aX,
                                  hg::PZInteger                          aY,
                                  const std::optional<CellModel::Floor>& aFloorOpt) {
-    auto& cell = _chunkStorage.getCellAtUnchecked(aX, aY, detail::LOAD_IF_MISSING);
+    auto& cell = _chunkStorage.getCellForEditingAtUnchecked(aX, aY, detail::LOAD_IF_MISSING);
+    _editStats.cellsEdited += 1;
+    _addCellToEditRects(_editChangedRects, aX, aY);
+    if (_editJournal != nullptr) {
+        _journalEntries.push_back(MakeFloorJournalEntry(aX, aY, aFloorOpt));
+    }
     if (aFloorOpt) {
         cell.setFloor(*aFloorOpt);
     } else {
@@ -669,7 +1047,12 @@ void World::_setWallAt(hg::math::Vector2pz aCell, const std::optional<CellModel:
 void World::_setWallAtUnchecked(hg::PZInteger                         aX,
                                 hg::PZInteger                         aY,
                                 const std::optional<CellModel::Wall>& aWallOpt) {
-    auto& cell = _chunkStorage.getCellAtUnchecked(aX, aY, detail::LOAD_IF_MISSING);
+    auto& cell = _chunkStorage.getCellForEditingAtUnchecked(aX, aY, detail::LOAD_IF_MISSING);
+    _editStats.cellsEdited += 1;
+    _addCellToEditRects(_editChangedRects, aX, aY);
+    if (_editJournal != nullptr) {
+        _journalEntries.push_back(MakeWallJournalEntry(aX, aY, aWallOpt));
+    }
 
     if ((cell.isWallInitialized() == aWallOpt.has_value()) &&
         (!cell.isWallInitialized() || (cell.getWall().shape == aWallOpt->shape))) {
@@ -678,19 +1061,7 @@ void World::_setWallAtUnchecked(hg::PZInteger                         aX,
         goto SWAP_WALL;
     }
 
-    if (_editMinX == -1 || _editMaxX == -1) {
-        _editMinX = _editMaxX = aX;
-    } else {
-        _editMinX = std::min(_editMinX, aX);
-        _editMaxX = std::max(_editMaxX, aX);
-    }
-
-    if (_editMinY == -1 || _editMaxY == -1) {
-        _editMinY = _editMaxY = aY;
-    } else {
-        _editMinY = std::min(_editMinY, aY);
-        _editMaxY = std::max(_editMaxY, aY);
-    }
+    _addCellToEditRects(_editDirtyRects, aX, aY);
 
 SWAP_WALL:
     if (aWallOpt) {
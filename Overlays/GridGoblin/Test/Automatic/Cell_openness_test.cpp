@@ -0,0 +1,90 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Cell_openness.hpp>
+#include <GridGoblin/Private/Cell_planes.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+//! Fills the flags plane with walls placed pseudo-randomly, with roughly 1 in `aWallRarity`
+//! cells being walls, and with a solid border as wide as `aMargin` (as if it were the edge of
+//! the world).
+void FillPlanes(CellPlanes&   aPlanes,
+                hg::PZInteger aMargin,
+                std::uint32_t aWallRarity,
+                std::uint32_t aSeed) {
+    std::uint32_t state = aSeed;
+    for (hg::PZInteger y = 0; y < aPlanes.getHeight(); y += 1) {
+        auto* flags = aPlanes.getFlagsRow(y);
+        for (hg::PZInteger x = 0; x < aPlanes.getWidth(); x += 1) {
+            state = state * 1664525u + 1013904223u;
+
+            const bool isBorder = (x < aMargin || y < aMargin || x >= aPlanes.getWidth() - aMargin ||
+                                   y >= aPlanes.getHeight() - aMargin);
+            const bool isWall   = ((state >> 16) % aWallRarity) == 0;
+            flags[x] = (isBorder || isWall) ? CellModel::WALL_INITIALIZED : CellModel::FLOOR_INITIALIZED;
+        }
+    }
+}
+} // namespace
+
+TEST(CellOpennessTest, PlaneCalculationMatchesRings) {
+    CellPlanes                planes;
+    std::vector<std::uint8_t> scratch;
+
+    for (const std::uint8_t maxOpenness : {0, 1, 3, 5, 7, 9, 15}) {
+        for (const std::uint32_t wallRarity : {2u, 5u, 17u, 101u}) {
+            const auto margin = std::max<hg::PZInteger>(1, maxOpenness / 2);
+            planes.reset(61 + 2 * margin, 47 + 2 * margin, CellPlanes::FLAGS | CellPlanes::OPENNESS);
+            FillPlanes(planes, margin, wallRarity, maxOpenness * 1000u + wallRarity);
+
+            CalcOpennessInPlanes(planes, margin, maxOpenness, scratch);
+
+            // Outside of the planes is out of the world as well
+            const auto isCellSolid = [&planes](hg::PZInteger aX, hg::PZInteger aY) {
+                if (aX < 0 || aY < 0 || aX >= planes.getWidth() || aY >= planes.getHeight()) {
+                    return true;
+                }
+                return (planes.getFlagsRow(aY)[aX] & CellModel::WALL_INITIALIZED) != 0;
+            };
+
+            for (hg::PZInteger y = margin; y < planes.getHeight() - margin; y += 1) {
+                for (hg::PZInteger x = margin; x < planes.getWidth() - margin; x += 1) {
+                    ASSERT_EQ(planes.getOpennessRow(y)[x],
+                              CalcOpennessByRings(x, y, maxOpenness, isCellSolid))
+                        << "at (" << x << ", " << y << "), max openness " << int{maxOpenness}
+                        << ", wall rarity " << wallRarity;
+                }
+            }
+        }
+    }
+}
+
+TEST(CellOpennessTest, PlaneCalculationWithNoWalls) {
+    CellPlanes                planes;
+    std::vector<std::uint8_t> scratch;
+
+    // Margin larger than needed, and no solid cells at all
+    planes.reset(20, 20, CellPlanes::FLAGS | CellPlanes::OPENNESS);
+    for (hg::PZInteger y = 0; y < 20; y += 1) {
+        planes.fillRow(0, y, 20, 0);
+    }
+
+    CalcOpennessInPlanes(planes, 5, 7, scratch);
+
+    EXPECT_EQ(planes.getOpennessRow(10)[10], 7);
+    EXPECT_EQ(planes.getOpennessRow(5)[5], 7);
+    EXPECT_EQ(planes.getOpennessRow(4)[4], 0); // Margin
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,65 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Cell_grid.hpp>
+#include <GridGoblin/Private/Cell_planes.hpp>
+
+#include <gtest/gtest.h>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+TEST(CellPlanesTest, LoadRowCopiesSelectedPlanes) {
+    CellGrid grid{4, 1};
+    grid[0][1].setFloor({7});
+    grid[0][2].setWall({8, 9, Shape::FULL_SQUARE});
+    grid[0][2].setOpenness(3);
+
+    CellPlanes planes;
+    planes.reset(6, 2, CellPlanes::ALL);
+    planes.loadRow(1, 1, grid[0], 4);
+
+    const auto* flags = planes.getFlagsRow(1);
+    EXPECT_EQ(flags[1], 0);
+    EXPECT_EQ(flags[2], CellModel::FLOOR_INITIALIZED);
+    EXPECT_EQ(flags[3], CellModel::WALL_INITIALIZED);
+    EXPECT_EQ(flags[4], 0);
+
+    EXPECT_EQ(planes.getFloorRow(1)[2].spriteId, 7);
+    EXPECT_EQ(planes.getWallRow(1)[3].spriteId, 8);
+    EXPECT_EQ(planes.getWallRow(1)[3].spriteId_reduced, 9);
+    EXPECT_EQ(planes.getOpennessRow(1)[3], 3);
+
+    // Rows are laid out back to back
+    EXPECT_EQ(planes.getFlagsPlane() + 6, flags);
+}
+
+TEST(CellPlanesTest, FillRowWritesGivenFlags) {
+    CellPlanes planes;
+    planes.reset(5, 1, CellPlanes::FLAGS | CellPlanes::OPENNESS);
+    planes.fillRow(0, 0, 5, 0);
+    planes.fillRow(1, 0, 3, CellModel::WALL_INITIALIZED);
+
+    const auto* flags = planes.getFlagsPlane();
+    EXPECT_EQ(flags[0], 0);
+    EXPECT_EQ(flags[1], CellModel::WALL_INITIALIZED);
+    EXPECT_EQ(flags[3], CellModel::WALL_INITIALIZED);
+    EXPECT_EQ(flags[4], 0);
+    EXPECT_EQ(planes.getOpennessPlane()[2], 0);
+}
+
+TEST(CellPlanesTest, ResetReusesPlanes) {
+    CellPlanes planes;
+    planes.reset(8, 8, CellPlanes::FLAGS);
+    const auto* before = planes.getFlagsPlane();
+    planes.reset(4, 4, CellPlanes::FLAGS);
+    EXPECT_EQ(planes.getFlagsPlane(), before);
+    EXPECT_EQ(planes.getWidth(), 4);
+    EXPECT_EQ(planes.getHeight(), 4);
+    EXPECT_EQ(planes.getPlaneMask(), CellPlanes::FLAGS);
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
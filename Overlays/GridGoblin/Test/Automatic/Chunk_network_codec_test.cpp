@@ -0,0 +1,274 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/World/Chunk_network_codec.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+constexpr hg::PZInteger CELLS_PER_CHUNK = 16;
+
+//! Server-side binder which sends every chunk that becomes available in full.
+class StreamingBinder : public Binder {
+public:
+    StreamingBinder(const World& aWorld)
+        : _world{aWorld} {}
+
+    std::unordered_map<ChunkId, hg::util::Packet> packets;
+
+    void onChunkCreated(ChunkId aChunkId, const Chunk& aChunk) override {
+        _send(aChunkId, aChunk);
+    }
+
+    void onChunkLoaded(ChunkId aChunkId, const Chunk& aChunk) override {
+        _send(aChunkId, aChunk);
+    }
+
+private:
+    const World&        _world;
+    ChunkNetworkEncoder _encoder;
+
+    void _send(ChunkId aChunkId, const Chunk& aChunk) {
+        auto& packet = packets[aChunkId];
+        packet.clear();
+        _encoder.encodeFull(aChunkId, aChunk, _world.getCellGeneration(), packet);
+    }
+};
+} // namespace
+
+class ChunkNetworkCodecTest : public ::testing::Test {
+protected:
+    test::FakeDiskIoHandler _serverDiskIoHandler;
+    test::FakeDiskIoHandler _clientDiskIoHandler;
+
+    void SetUp() override {
+        for (auto* handler : {&_serverDiskIoHandler, &_clientDiskIoHandler}) {
+            handler->setRuntimeCacheDelay(std::chrono::milliseconds{0});
+            handler->setPersistentCacheDelay(std::chrono::milliseconds{0});
+        }
+    }
+
+    static WorldConfig _makeConfig() {
+        return {.chunkCountX                 = 4,
+                .chunkCountY                 = 4,
+                .cellsPerChunkX              = CELLS_PER_CHUNK,
+                .cellsPerChunkY              = CELLS_PER_CHUNK,
+                .cellResolution              = 32.f,
+                .maxCellOpenness             = 3,
+                .maxLoadedNonessentialChunks = 16};
+    }
+
+    static void _expectSameCells(const CellModel& aExpected, const CellModel& aActual) {
+        ASSERT_EQ(aExpected.isFloorInitialized(), aActual.isFloorInitialized());
+        if (aExpected.isFloorInitialized()) {
+            EXPECT_EQ(aExpected.getFloor(), aActual.getFloor());
+        }
+        ASSERT_EQ(aExpected.isWallInitialized(), aActual.isWallInitialized());
+        if (aExpected.isWallInitialized()) {
+            EXPECT_EQ(aExpected.getWall(), aActual.getWall());
+        }
+    }
+};
+
+TEST_F(ChunkNetworkCodecTest, FullEncodingRoundTrip) {
+    Chunk chunk{CELLS_PER_CHUNK, CELLS_PER_CHUNK};
+    for (hg::PZInteger y = 0; y < CELLS_PER_CHUNK; y += 1) {
+        for (hg::PZInteger x = 0; x < CELLS_PER_CHUNK; x += 1) {
+            auto& cell = chunk.getCellAtUnchecked(x, y);
+            if (x != 3) {
+                cell.setFloor({y < 8 ? 1 : 70000});
+            }
+            if ((x + y) % 5 == 0) {
+                cell.setWall({x % 2, 1000 + y, (x % 2) ? Shape::CIRCLE : Shape::FULL_SQUARE});
+            }
+        }
+    }
+
+    ChunkNetworkEncoder encoder;
+    hg::util::Packet    packet;
+    encoder.encodeFull({2, 3}, chunk, 42, packet);
+
+    Chunk decoded{CELLS_PER_CHUNK, CELLS_PER_CHUNK};
+    decoded.setAll(CellModel{});
+
+    ChunkNetworkDecoder decoder;
+    const auto          result = decoder.decode(packet, decoded);
+
+    EXPECT_EQ(result.chunkId, ChunkId(2, 3));
+    EXPECT_EQ(result.encoding, ChunkNetworkEncoder::Encoding::FULL);
+    EXPECT_EQ(result.version, 42u);
+    EXPECT_EQ(result.cellCount, CELLS_PER_CHUNK * CELLS_PER_CHUNK);
+    EXPECT_TRUE(packet.endOfPacket());
+
+    for (hg::PZInteger y = 0; y < CELLS_PER_CHUNK; y += 1) {
+        for (hg::PZInteger x = 0; x < CELLS_PER_CHUNK; x += 1) {
+            _expectSameCells(chunk.getCellAtUnchecked(x, y), decoded.getCellAtUnchecked(x, y));
+        }
+    }
+}
+
+TEST_F(ChunkNetworkCodecTest, UniformChunkIsCompact) {
+    Chunk     chunk{CELLS_PER_CHUNK, CELLS_PER_CHUNK};
+    CellModel cell;
+    cell.setFloor({5});
+    chunk.setAll(cell);
+
+    ChunkNetworkEncoder encoder;
+    hg::util::Packet    packet;
+    encoder.encodeFull({0, 0}, chunk, 0, packet);
+
+    // Header, plus a couple of bytes for each palette and its single run
+    EXPECT_LT(packet.getDataSize(), 48);
+}
+
+TEST_F(ChunkNetworkCodecTest, NegativeSpriteIdsRoundTrip) {
+    Chunk chunk{CELLS_PER_CHUNK, CELLS_PER_CHUNK};
+    for (hg::PZInteger y = 0; y < CELLS_PER_CHUNK; y += 1) {
+        for (hg::PZInteger x = 0; x < CELLS_PER_CHUNK; x += 1) {
+            auto& cell = chunk.getCellAtUnchecked(x, y);
+            // A floor with sprite ID -1 must not be confused with no floor
+            if (x % 3 == 0) {
+                cell.setFloor({-1});
+            } else if (x % 3 == 1) {
+                cell.setFloor({std::numeric_limits<SpriteId>::min()});
+            }
+            if (y == 4) {
+                cell.setWall({-1, std::numeric_limits<SpriteId>::max(), Shape::FULL_SQUARE});
+            }
+        }
+    }
+
+    ChunkNetworkEncoder encoder;
+    hg::util::Packet    packet;
+    encoder.encodeFull({0, 0}, chunk, 0, packet);
+
+    Chunk decoded{CELLS_PER_CHUNK, CELLS_PER_CHUNK};
+    decoded.setAll(CellModel{});
+
+    ChunkNetworkDecoder decoder;
+    decoder.decode(packet, decoded);
+
+    for (hg::PZInteger y = 0; y < CELLS_PER_CHUNK; y += 1) {
+        for (hg::PZInteger x = 0; x < CELLS_PER_CHUNK; x += 1) {
+            _expectSameCells(chunk.getCellAtUnchecked(x, y), decoded.getCellAtUnchecked(x, y));
+        }
+    }
+}
+
+TEST_F(ChunkNetworkCodecTest, DeltaContainsOnlyChangedCells) {
+    World server{_makeConfig(), &_serverDiskIoHandler};
+    World client{_makeConfig(), &_clientDiskIoHandler};
+
+    StreamingBinder binder{server};
+    server.attachBinder(&binder);
+
+    const auto serverPerm = server.getPermissionToEdit();
+    const auto clientPerm = client.getPermissionToEdit();
+
+    // The binder sends the chunk when it's created
+    (void)server.getChunkAtId(*serverPerm, {1, 1});
+    server.edit(*serverPerm, [](World::Editor& aEditor) {
+        for (hg::PZInteger y = 16; y < 32; y += 1) {
+            for (hg::PZInteger x = 16; x < 32; x += 1) {
+                aEditor.setFloorAt(x, y, CellModel::Floor{7});
+            }
+        }
+    });
+
+    ChunkNetworkDecoder decoder;
+    ASSERT_EQ(binder.packets.count({1, 1}), 1u);
+    client.edit(*clientPerm, [&](World::Editor& aEditor) {
+        const auto result = decoder.decode(binder.packets[{1, 1}], client, aEditor);
+        EXPECT_EQ(result.encoding, ChunkNetworkEncoder::Encoding::FULL);
+    });
+    server.detachBinder(&binder);
+
+    // Bring the client up to date, and acknowledge the version
+    ChunkNetworkEncoder encoder;
+    hg::util::Packet    packet;
+    EXPECT_EQ(encoder.encode(server, {1, 1}, std::nullopt, packet), ChunkNetworkEncoder::Encoding::FULL);
+    ChunkVersion acknowledgedVersion = 0;
+    client.edit(*clientPerm, [&](World::Editor& aEditor) {
+        acknowledgedVersion = decoder.decode(packet, client, aEditor).version;
+    });
+
+    server.edit(*serverPerm, [](World::Editor& aEditor) {
+        aEditor.setWallAt(20, 20, CellModel::Wall{3, 4, Shape::FULL_SQUARE});
+        aEditor.setWallAt(21, 20, CellModel::Wall{3, 4, Shape::FULL_SQUARE});
+        aEditor.setFloorAt(5, 5, CellModel::Floor{9}); // Different chunk
+    });
+
+    packet.clear();
+    EXPECT_EQ(encoder.encode(server, {1, 1}, acknowledgedVersion, packet),
+              ChunkNetworkEncoder::Encoding::DELTA);
+    client.edit(*clientPerm, [&](World::Editor& aEditor) {
+        const auto result = decoder.decode(packet, client, aEditor);
+        EXPECT_EQ(result.encoding, ChunkNetworkEncoder::Encoding::DELTA);
+        EXPECT_EQ(result.baseVersion, acknowledgedVersion);
+        EXPECT_EQ(result.version, server.getCellGeneration());
+        // The change records also cover the cells around the walls, as their openness changed
+        EXPECT_GE(result.cellCount, 2);
+        EXPECT_LT(result.cellCount, CELLS_PER_CHUNK * CELLS_PER_CHUNK / 8);
+    });
+
+    for (hg::PZInteger y = 16; y < 32; y += 1) {
+        for (hg::PZInteger x = 16; x < 32; x += 1) {
+            _expectSameCells(*server.getCellAtUnchecked(x, y), *client.getCellAtUnchecked(x, y));
+        }
+    }
+    EXPECT_EQ(client.getCellAtUnchecked(20, 20)->getOpenness(),
+              server.getCellAtUnchecked(20, 20)->getOpenness());
+
+    // Nothing changed since the latest version
+    packet.clear();
+    EXPECT_EQ(encoder.encode(server, {1, 1}, server.getCellGeneration(), packet),
+              ChunkNetworkEncoder::Encoding::DELTA);
+    Chunk scratch{CELLS_PER_CHUNK, CELLS_PER_CHUNK};
+    EXPECT_EQ(decoder.decode(packet, scratch).cellCount, 0);
+}
+
+TEST_F(ChunkNetworkCodecTest, InvalidDataIsRejected) {
+    Chunk chunk{CELLS_PER_CHUNK, CELLS_PER_CHUNK};
+    chunk.setAll(CellModel{});
+
+    ChunkNetworkEncoder encoder;
+    hg::util::Packet    packet;
+    encoder.encodeFull({0, 0}, chunk, 0, packet);
+
+    ChunkNetworkDecoder decoder;
+
+    // Wrong dimensions
+    {
+        hg::util::Packet copy = packet;
+        Chunk            smallChunk{CELLS_PER_CHUNK / 2, CELLS_PER_CHUNK};
+        EXPECT_THROW(decoder.decode(copy, smallChunk), ChunkCodecError);
+    }
+
+    // Truncated
+    {
+        hg::util::Packet truncated;
+        (void)truncated.write(packet.getData(), packet.getDataSize() - 1);
+        EXPECT_THROW(decoder.decode(truncated, chunk), ChunkCodecError);
+    }
+
+    // Corrupted palette index
+    {
+        hg::util::Packet copy = packet;
+        static_cast<char*>(copy.getMutableData())[packet.getDataSize() - 1] = 5;
+        EXPECT_THROW(decoder.decode(copy, chunk), ChunkCodecError);
+    }
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,189 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Chunk_runtime_cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+class ChunkRuntimeCacheTest : public ::testing::TestWithParam<bool> {
+protected:
+    std::map<ChunkId, std::string> _writtenEntries;
+
+    ChunkRuntimeCache::WriteHandler _writeHandler =
+        [this](ChunkId aChunkId, const void* aData, std::int64_t aByteCount) {
+            _writtenEntries[aChunkId] = std::string{static_cast<const char*>(aData),
+                                                    static_cast<std::size_t>(aByteCount)};
+        };
+
+    static std::string _makeData(char aFill, std::size_t aSize) {
+        std::string result(aSize, aFill);
+        // Add some variety so that the data isn't trivially compressible
+        for (std::size_t i = 0; i < aSize; i += 7) {
+            result[i] = static_cast<char>(i % 251);
+        }
+        return result;
+    }
+
+    void _store(ChunkRuntimeCache& aCache, ChunkId aChunkId, const std::string& aData) {
+        aCache.store(aChunkId, aData.data(), static_cast<std::int64_t>(aData.size()), _writeHandler);
+    }
+};
+
+TEST_P(ChunkRuntimeCacheTest, StoreAndTake) {
+    ChunkRuntimeCache cache{1024 * 1024, GetParam()};
+
+    const auto data = _makeData('a', 1000);
+    _store(cache, {1, 2}, data);
+
+    std::string result;
+    EXPECT_FALSE(cache.take({2, 1}, result));
+    ASSERT_TRUE(cache.take({1, 2}, result));
+    EXPECT_EQ(result, data);
+
+    // Once written out, the entry is removed by taking it
+    cache.flush(_writeHandler);
+    result.clear();
+    ASSERT_TRUE(cache.take({1, 2}, result));
+    EXPECT_EQ(result, data);
+    EXPECT_FALSE(cache.take({1, 2}, result));
+
+    const auto stats = cache.getStats();
+    EXPECT_EQ(stats.hitCount, 2);
+    EXPECT_EQ(stats.missCount, 2);
+    EXPECT_EQ(stats.entryCount, 0);
+    EXPECT_EQ(stats.byteCount, 0);
+    EXPECT_DOUBLE_EQ(stats.getHitRate(), 0.5);
+}
+
+TEST_P(ChunkRuntimeCacheTest, TakingUnwrittenEntryKeepsIt) {
+    ChunkRuntimeCache cache{1024 * 1024, GetParam()};
+
+    const auto data = _makeData('a', 1000);
+    _store(cache, {1, 2}, data);
+
+    std::string result;
+    bool        isUnwritten = false;
+    ASSERT_TRUE(cache.take({1, 2}, result, &isUnwritten));
+    EXPECT_EQ(result, data);
+    EXPECT_TRUE(isUnwritten);
+    EXPECT_EQ(cache.getStats().entryCount, 1);
+
+    // Taken again (e.g. because the first taker discarded the chunk)
+    result.clear();
+    ASSERT_TRUE(cache.take({1, 2}, result, &isUnwritten));
+    EXPECT_EQ(result, data);
+    EXPECT_TRUE(isUnwritten);
+
+    // The entry is still written out when flushed
+    cache.flush(_writeHandler);
+    ASSERT_EQ(_writtenEntries.size(), 1u);
+    EXPECT_EQ(_writtenEntries[ChunkId(1, 2)], data);
+
+    ASSERT_TRUE(cache.take({1, 2}, result, &isUnwritten));
+    EXPECT_FALSE(isUnwritten);
+    EXPECT_EQ(cache.getStats().entryCount, 0);
+}
+
+TEST_P(ChunkRuntimeCacheTest, LeastRecentlyStoredEntriesAreEvictedAndWritten) {
+    ChunkRuntimeCache cache{2500, false};
+
+    const auto data1 = _makeData('a', 1000);
+    const auto data2 = _makeData('b', 1000);
+    const auto data3 = _makeData('c', 1000);
+
+    _store(cache, {0, 0}, data1);
+    _store(cache, {1, 0}, data2);
+    EXPECT_TRUE(_writtenEntries.empty());
+
+    _store(cache, {2, 0}, data3);
+    ASSERT_EQ(_writtenEntries.size(), 1u);
+    EXPECT_EQ(_writtenEntries[ChunkId(0, 0)], data1);
+
+    std::string result;
+    EXPECT_FALSE(cache.take({0, 0}, result));
+    EXPECT_TRUE(cache.take({1, 0}, result));
+    EXPECT_EQ(result, data2);
+
+    EXPECT_EQ(cache.getStats().evictionCount, 1);
+}
+
+TEST_P(ChunkRuntimeCacheTest, ZeroByteLimitWritesImmediately) {
+    ChunkRuntimeCache cache{0, GetParam()};
+
+    const auto data = _makeData('a', 100);
+    _store(cache, {3, 3}, data);
+
+    ASSERT_EQ(_writtenEntries.size(), 1u);
+    EXPECT_EQ(_writtenEntries[ChunkId(3, 3)], data);
+    EXPECT_EQ(cache.getStats().entryCount, 0);
+}
+
+TEST_P(ChunkRuntimeCacheTest, FlushedEntriesAreNotWrittenAgain) {
+    ChunkRuntimeCache cache{1024 * 1024, GetParam()};
+
+    const auto data = _makeData('a', 5000);
+    _store(cache, {0, 0}, data);
+    _store(cache, {0, 1}, data);
+
+    cache.flush(_writeHandler);
+    EXPECT_EQ(_writtenEntries.size(), 2u);
+    EXPECT_EQ(_writtenEntries[ChunkId(0, 1)], data);
+    EXPECT_EQ(cache.getStats().entryCount, 2);
+
+    _writtenEntries.clear();
+    cache.flush(_writeHandler);
+    EXPECT_TRUE(_writtenEntries.empty());
+}
+
+TEST_P(ChunkRuntimeCacheTest, StoringReplacesPreviousEntry) {
+    ChunkRuntimeCache cache{1024 * 1024, GetParam()};
+
+    const auto data1 = _makeData('a', 500);
+    const auto data2 = _makeData('b', 700);
+
+    _store(cache, {0, 0}, data1);
+    _store(cache, {0, 0}, data2);
+    EXPECT_EQ(cache.getStats().entryCount, 1);
+    EXPECT_EQ(cache.getStats().rawByteCount, 700);
+
+    std::string result;
+    ASSERT_TRUE(cache.take({0, 0}, result));
+    EXPECT_EQ(result, data2);
+}
+
+TEST_F(ChunkRuntimeCacheTest, CompressionReducesSize) {
+    ChunkRuntimeCache cache{1024 * 1024, true};
+
+    // Mostly uniform data, like that of a typical chunk
+    std::string data(10'000, 'a');
+    for (std::size_t i = 0; i < data.size(); i += 100) {
+        data[i] = 'b';
+    }
+    _store(cache, {0, 0}, data);
+
+    const auto stats = cache.getStats();
+    EXPECT_EQ(stats.rawByteCount, 10'000);
+    EXPECT_LT(stats.byteCount, stats.rawByteCount / 10);
+
+    std::string result;
+    ASSERT_TRUE(cache.take({0, 0}, result));
+    EXPECT_EQ(result, data);
+}
+
+INSTANTIATE_TEST_SUITE_P(GridGoblinRuntimeCache,
+                         ChunkRuntimeCacheTest,
+                         ::testing::Values(false, true),
+                         [](const ::testing::TestParamInfo<bool>& aInfo) {
+                             return aInfo.param ? "Compressed" : "Uncompressed";
+                         });
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
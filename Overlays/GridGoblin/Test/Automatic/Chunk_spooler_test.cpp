@@ -0,0 +1,356 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Chunk_disk_io_handler_interface.hpp>
+#include <GridGoblin/Private/Chunk_spooler_default.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+using std::chrono::milliseconds;
+
+//! Disk I/O handler which records the order in which chunks were loaded and stored.
+//! Only remembers which chunks were stored, not their contents.
+class RecordingDiskIoHandler : public ChunkDiskIoHandlerInterface {
+public:
+    explicit RecordingDiskIoHandler(milliseconds aDelay)
+        : _delay{aDelay} {}
+
+    void setBinder(Binder*) override {}
+
+    std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId, bool& aIsUnsaved) override {
+        std::this_thread::sleep_for(_delay);
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        _events.push_back(fmt::format("L{}", aChunkId));
+        if (_runtimeCache.erase(aChunkId) == 0) {
+            return {};
+        }
+        aIsUnsaved = true;
+        return Chunk{1, 1};
+    }
+
+    void storeChunkInRuntimeCache(const Chunk&, ChunkId aChunkId) override {
+        std::this_thread::sleep_for(_delay);
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        _events.push_back(fmt::format("U{}", aChunkId));
+        _runtimeCache.insert(aChunkId);
+    }
+
+    std::optional<Chunk> loadChunkFromPersistentCache(ChunkId) override {
+        return {};
+    }
+
+    void storeChunkInPersistentCache(const Chunk&, ChunkId aChunkId) override {
+        std::this_thread::sleep_for(_delay);
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        _events.push_back(fmt::format("P{}", aChunkId));
+        _runtimeCache.erase(aChunkId);
+    }
+
+    void dumpRuntimeCache() override {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _events.push_back("D");
+        _runtimeCache.clear();
+    }
+
+    std::vector<std::string> getEvents() const {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _events;
+    }
+
+private:
+    mutable std::mutex          _mutex;
+    milliseconds                _delay;
+    std::vector<std::string>    _events;
+    std::unordered_set<ChunkId> _runtimeCache;
+};
+
+using HandleList = std::vector<std::shared_ptr<ChunkSpoolerInterface::RequestHandleInterface>>;
+
+void WaitUntilFinished(const HandleList& aHandles) {
+    for (const auto& handle : aHandles) {
+        while (!handle->isFinished()) {
+            std::this_thread::sleep_for(milliseconds{1});
+        }
+    }
+}
+} // namespace
+
+TEST(ChunkSpoolerTest, ZeroWorkersIsRejected) {
+    EXPECT_THROW(DefaultChunkSpooler{0}, hg::InvalidArgumentError);
+}
+
+TEST(ChunkSpoolerTest, LoadsAreProcessedInPriorityOrder) {
+    RecordingDiskIoHandler handler{milliseconds{0}};
+    DefaultChunkSpooler    spooler{1};
+    spooler.setDiskIoHandler(&handler);
+
+    spooler.pause();
+    auto handles = spooler.loadChunks({
+        {ChunkId{0, 0}, 5, {}},
+        {ChunkId{1, 0}, 1, {}},
+        {ChunkId{2, 0}, 3, {}},
+        {ChunkId{3, 0}, 4, {}},
+    });
+    EXPECT_EQ(handles[0]->trySwapPriority(0), std::optional<hg::PZInteger>{5});
+    EXPECT_EQ(handles[3]->tryBoostPriority(2), std::optional<hg::PZInteger>{4});
+    EXPECT_EQ(handles[2]->tryBoostPriority(10), std::nullopt); // Not an improvement
+    spooler.unpause();
+
+    WaitUntilFinished(handles);
+
+    const std::vector<std::string> expected = {"L[0,0]", "L[1,0]", "L[3,0]", "L[2,0]"};
+    EXPECT_EQ(handler.getEvents(), expected);
+}
+
+TEST(ChunkSpoolerTest, CancelledLoadIsNotProcessed) {
+    RecordingDiskIoHandler handler{milliseconds{0}};
+    DefaultChunkSpooler    spooler{2};
+    spooler.setDiskIoHandler(&handler);
+
+    spooler.pause();
+    auto handles = spooler.loadChunks({
+        {ChunkId{0, 0}, 0, {}},
+        {ChunkId{1, 0}, 0, {}},
+    });
+    handles[0]->cancel();
+    spooler.unpause();
+
+    WaitUntilFinished({handles[1]});
+    spooler.pause();
+
+    const std::vector<std::string> expected = {"L[1,0]"};
+    EXPECT_EQ(handler.getEvents(), expected);
+}
+
+TEST(ChunkSpoolerTest, WaitUntilFinishedBlocksUntilLoadIsDone) {
+    RecordingDiskIoHandler handler{milliseconds{20}};
+    DefaultChunkSpooler    spooler{1};
+    spooler.setDiskIoHandler(&handler);
+
+    spooler.pause();
+    auto handles = spooler.loadChunks({{ChunkId{0, 0}, 0, {}}});
+    EXPECT_FALSE(handles[0]->waitUntilFinished(milliseconds{10})); // Paused, so it times out
+    spooler.unpause();
+
+    EXPECT_TRUE(handles[0]->waitUntilFinished(milliseconds{5'000}));
+    EXPECT_TRUE(handles[0]->isFinished());
+}
+
+TEST(ChunkSpoolerTest, WaitUntilFinishedReturnsWhenCancelled) {
+    RecordingDiskIoHandler handler{milliseconds{0}};
+    DefaultChunkSpooler    spooler{1};
+    spooler.setDiskIoHandler(&handler);
+
+    spooler.pause();
+    auto handles = spooler.loadChunks({{ChunkId{0, 0}, 0, {}}});
+    handles[0]->cancel();
+    EXPECT_FALSE(handles[0]->waitUntilFinished(milliseconds{5'000}));
+    spooler.unpause();
+}
+
+TEST(ChunkSpoolerTest, CancellingLoadInProgressKeepsNewerRequestOfSameChunk) {
+    RecordingDiskIoHandler handler{milliseconds{50}};
+    DefaultChunkSpooler    spooler{1};
+    spooler.setDiskIoHandler(&handler);
+
+    const ChunkId chunkId{2, 5};
+    auto          oldHandles = spooler.loadChunks({{chunkId, 0, {}}});
+    std::this_thread::sleep_for(milliseconds{10}); // Let the worker pick up the load
+
+    auto newHandles = spooler.loadChunks({{chunkId, 0, {}}});
+    oldHandles[0]->cancel();
+
+    EXPECT_TRUE(newHandles[0]->waitUntilFinished(milliseconds{5'000}));
+}
+
+TEST(ChunkSpoolerTest, UnloadInProgressCompletesBeforeLoadOfSameChunk) {
+    RecordingDiskIoHandler handler{milliseconds{50}};
+    DefaultChunkSpooler    spooler{4};
+    spooler.setDiskIoHandler(&handler);
+
+    const ChunkId chunkId{7, 7};
+    spooler.unloadChunk(chunkId, Chunk{1, 1});
+    std::this_thread::sleep_for(milliseconds{10}); // Let a worker pick up the unload
+
+    // Idle workers must not start loading the chunk while it's still being stored
+    auto handles = spooler.loadChunks({{chunkId, 0, {}}});
+    WaitUntilFinished(handles);
+
+    const std::vector<std::string> expected = {"U[7,7]", "L[7,7]"};
+    EXPECT_EQ(handler.getEvents(), expected);
+    EXPECT_TRUE(handles[0]->takeChunk().has_value());
+}
+
+TEST(ChunkSpoolerTest, PendingUnloadResolvesLoadOfSameChunk) {
+    RecordingDiskIoHandler handler{milliseconds{0}};
+    DefaultChunkSpooler    spooler{2};
+    spooler.setDiskIoHandler(&handler);
+
+    const ChunkId chunkId{3, 4};
+    spooler.pause();
+    spooler.unloadChunk(chunkId, Chunk{1, 1});
+    auto handles = spooler.loadChunks({{chunkId, 0, {}}});
+
+    ASSERT_TRUE(handles[0]->isFinished());
+    EXPECT_TRUE(handles[0]->takeChunk().has_value());
+    EXPECT_TRUE(handler.getEvents().empty());
+    spooler.unpause();
+}
+
+TEST(ChunkSpoolerTest, WorkerStatsCountAllRequests) {
+    static constexpr hg::PZInteger WORKER_COUNT = 3;
+    static constexpr hg::PZInteger CHUNK_COUNT  = 12;
+
+    RecordingDiskIoHandler handler{milliseconds{5}};
+    DefaultChunkSpooler    spooler{WORKER_COUNT};
+    spooler.setDiskIoHandler(&handler);
+
+    std::vector<ChunkSpoolerInterface::LoadRequest> requests;
+    for (hg::PZInteger i = 0; i < CHUNK_COUNT; i += 1) {
+        requests.push_back({ChunkId{i, 0}, i, {}});
+    }
+    auto handles = spooler.loadChunks(requests);
+    WaitUntilFinished(handles);
+
+    for (hg::PZInteger i = 0; i < CHUNK_COUNT; i += 1) {
+        spooler.unloadChunk(ChunkId{i, 1}, Chunk{1, 1});
+    }
+    while (handler.getEvents().size() < hg::pztos(CHUNK_COUNT * 2)) {
+        std::this_thread::sleep_for(milliseconds{1});
+    }
+    spooler.pause(); // Blocks until the workers have updated their stats
+
+    const auto stats = spooler.getWorkerStats();
+    ASSERT_EQ(hg::stopz(stats.size()), WORKER_COUNT);
+
+    std::int64_t loadCount   = 0;
+    std::int64_t unloadCount = 0;
+    for (const auto& workerStats : stats) {
+        loadCount += workerStats.loadCount;
+        unloadCount += workerStats.unloadCount;
+        EXPECT_GE(workerStats.getUtilisation(), 0.0);
+        EXPECT_LE(workerStats.getUtilisation(), 1.0);
+    }
+    EXPECT_EQ(loadCount, CHUNK_COUNT);
+    EXPECT_EQ(unloadCount, CHUNK_COUNT);
+}
+
+TEST(ChunkSpoolerTest, SaveWritesSnapshotsBeforeDumpingRuntimeCache) {
+    RecordingDiskIoHandler handler{milliseconds{5}};
+    DefaultChunkSpooler    spooler{3};
+    spooler.setDiskIoHandler(&handler);
+
+    const Chunk                chunk{1, 1};
+    std::vector<ChunkSnapshot> snapshots;
+    for (hg::PZInteger i = 0; i < 4; i += 1) {
+        snapshots.emplace_back(ChunkId{i, 0}, chunk);
+    }
+    auto future = spooler.saveChunks(std::move(snapshots));
+    future.get();
+
+    auto events = handler.getEvents();
+    ASSERT_EQ(events.size(), 5);
+    EXPECT_EQ(events.back(), "D");
+    events.pop_back();
+    std::sort(events.begin(), events.end());
+    const std::vector<std::string> expected = {"P[0,0]", "P[1,0]", "P[2,0]", "P[3,0]"};
+    EXPECT_EQ(events, expected);
+}
+
+TEST(ChunkSpoolerTest, SaveWithNoSnapshotsOnlyDumpsRuntimeCache) {
+    RecordingDiskIoHandler handler{milliseconds{0}};
+    DefaultChunkSpooler    spooler{1};
+    spooler.setDiskIoHandler(&handler);
+
+    spooler.saveChunks({}).get();
+
+    const std::vector<std::string> expected = {"D"};
+    EXPECT_EQ(handler.getEvents(), expected);
+}
+
+TEST(ChunkSpoolerTest, UnloadSupersedesPendingSaveOfSameChunk) {
+    RecordingDiskIoHandler handler{milliseconds{0}};
+    DefaultChunkSpooler    spooler{2};
+    spooler.setDiskIoHandler(&handler);
+
+    const ChunkId chunkId{5, 1};
+
+    spooler.pause();
+    std::vector<ChunkSnapshot> snapshots;
+    snapshots.emplace_back(chunkId, Chunk{1, 1});
+    auto future = spooler.saveChunks(std::move(snapshots));
+    EXPECT_NO_THROW(spooler.unloadChunk(chunkId, Chunk{1, 1}));
+    spooler.unpause();
+    future.get();
+
+    // The chunk goes straight to the persistent cache, and only once
+    const std::vector<std::string> expected = {"P[5,1]", "D"};
+    EXPECT_EQ(handler.getEvents(), expected);
+}
+
+TEST(ChunkSpoolerTest, UnloadInProgressIsIncludedInSave) {
+    RecordingDiskIoHandler handler{milliseconds{50}};
+    DefaultChunkSpooler    spooler{2};
+    spooler.setDiskIoHandler(&handler);
+
+    const ChunkId chunkId{3, 3};
+    spooler.unloadChunk(chunkId, Chunk{1, 1});
+    std::this_thread::sleep_for(milliseconds{10}); // Let a worker pick up the unload
+
+    // The runtime cache must not be dumped before the chunk gets there
+    spooler.saveChunks({}).get();
+
+    const std::vector<std::string> expected = {"U[3,3]", "D"};
+    EXPECT_EQ(handler.getEvents(), expected);
+}
+
+TEST(ChunkSpoolerTest, PendingUnloadIsIncludedInSave) {
+    RecordingDiskIoHandler handler{milliseconds{0}};
+    DefaultChunkSpooler    spooler{2};
+    spooler.setDiskIoHandler(&handler);
+
+    const ChunkId unloadedChunkId{1, 1};
+    const ChunkId reloadedChunkId{2, 2};
+
+    spooler.pause();
+    spooler.unloadChunk(unloadedChunkId, Chunk{1, 1});
+    spooler.unloadChunk(reloadedChunkId, Chunk{1, 1});
+    auto future = spooler.saveChunks({});
+
+    // Taking the chunk back must not exclude it from the save
+    auto handles = spooler.loadChunks({{reloadedChunkId, 0, {}}});
+    ASSERT_TRUE(handles[0]->isFinished());
+    EXPECT_TRUE(handles[0]->takeChunk().has_value());
+
+    spooler.unpause();
+    future.get();
+
+    auto events = handler.getEvents();
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events.back(), "D");
+    events.pop_back();
+    std::sort(events.begin(), events.end());
+    const std::vector<std::string> expected = {"P[1,1]", "P[2,2]"};
+    EXPECT_EQ(events, expected);
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,314 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Edit_journal.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+namespace {
+//! Fake disk I/O handler which can hold up storing one of the chunks in the persistent cache.
+class StoreHoldingDiskIoHandler : public test::FakeDiskIoHandler {
+public:
+    StoreHoldingDiskIoHandler() {
+        setRuntimeCacheDelay(std::chrono::milliseconds{0});
+        setPersistentCacheDelay(std::chrono::milliseconds{0});
+    }
+
+    void holdStoresOf(std::optional<ChunkId> aChunkId) {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _heldChunkId = aChunkId;
+        }
+        _cv.notify_all();
+    }
+
+    void storeChunkInPersistentCache(const Chunk& aChunk, ChunkId aChunkId) override {
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _cv.wait(lock, [&]() {
+                return _heldChunkId != aChunkId;
+            });
+        }
+        test::FakeDiskIoHandler::storeChunkInPersistentCache(aChunk, aChunkId);
+    }
+
+private:
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    std::optional<ChunkId>  _heldChunkId;
+};
+} // namespace
+
+class EditJournalTest : public ::testing::Test {
+protected:
+    using Entry = EditJournal::Entry;
+
+    std::filesystem::path _directory =
+        std::filesystem::temp_directory_path() / "gridgoblin_edit_journal_test";
+
+    void SetUp() override {
+        std::filesystem::remove_all(_directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(_directory);
+    }
+
+    static WorldConfig _makeWorldConfig(const std::filesystem::path& aJournalPath) {
+        return {.chunkCountX                 = 4,
+                .chunkCountY                 = 4,
+                .cellsPerChunkX              = 8,
+                .cellsPerChunkY              = 8,
+                .cellResolution              = 32.f,
+                .maxCellOpenness             = 3,
+                .maxLoadedNonessentialChunks = 16,
+                .editJournalPath             = aJournalPath,
+                .editJournalCommitInterval   = std::chrono::milliseconds{1}};
+    }
+
+    static void _loadAllChunks(World& aWorld, const World::EditPermission& aEditPerm) {
+        for (hg::PZInteger y = 0; y < aWorld.getChunkCountY(); y += 1) {
+            for (hg::PZInteger x = 0; x < aWorld.getChunkCountX(); x += 1) {
+                (void)aWorld.getChunkAtId(aEditPerm, {x, y});
+            }
+        }
+    }
+};
+
+TEST_F(EditJournalTest, EntriesAreRecoveredAfterReopening) {
+    {
+        EditJournal journal{_directory, std::chrono::milliseconds{1}};
+        EXPECT_TRUE(journal.takeRecoveredEntries().empty());
+
+        const Entry entries[] = {
+            {.kind = Entry::SET_FLOOR, .x = 1, .y = 2, .spriteId = 7},
+            {.kind             = Entry::SET_WALL,
+             .x                = 3,
+             .y                = 4,
+             .spriteId         = 8,
+             .spriteId_reduced = 9,
+             .shape            = Shape::CIRCLE}
+        };
+        journal.submit(entries, 2);
+
+        const Entry reset = {.kind = Entry::RESET_WALL, .x = 3, .y = 4};
+        journal.submit(&reset, 1);
+    }
+
+    EditJournal journal{_directory, std::chrono::milliseconds{1}};
+    const auto  recovered = journal.takeRecoveredEntries();
+    ASSERT_EQ(recovered.size(), 3u);
+
+    EXPECT_EQ(recovered[0].kind, Entry::SET_FLOOR);
+    EXPECT_EQ(recovered[0].x, 1);
+    EXPECT_EQ(recovered[0].y, 2);
+    EXPECT_EQ(recovered[0].spriteId, 7);
+
+    EXPECT_EQ(recovered[1].kind, Entry::SET_WALL);
+    EXPECT_EQ(recovered[1].spriteId, 8);
+    EXPECT_EQ(recovered[1].spriteId_reduced, 9);
+    EXPECT_EQ(recovered[1].shape, Shape::CIRCLE);
+
+    EXPECT_EQ(recovered[2].kind, Entry::RESET_WALL);
+    EXPECT_EQ(recovered[2].x, 3);
+    EXPECT_EQ(recovered[2].y, 4);
+}
+
+TEST_F(EditJournalTest, TornBatchIsDiscarded) {
+    {
+        EditJournal journal{_directory, std::chrono::milliseconds{1}};
+        const Entry first  = {.kind = Entry::SET_FLOOR, .x = 1, .y = 1, .spriteId = 1};
+        const Entry second = {.kind = Entry::SET_FLOOR, .x = 2, .y = 2, .spriteId = 2};
+        journal.submit(&first, 1);
+        journal.flush();
+        journal.submit(&second, 1);
+        journal.flush();
+    }
+
+    // Simulate a crash in the middle of writing the second batch
+    std::filesystem::path segmentPath;
+    for (const auto& dirEntry : std::filesystem::directory_iterator{_directory}) {
+        if (std::filesystem::file_size(dirEntry.path()) > 0) {
+            segmentPath = dirEntry.path();
+        }
+    }
+    ASSERT_FALSE(segmentPath.empty());
+    std::filesystem::resize_file(segmentPath, std::filesystem::file_size(segmentPath) - 3);
+
+    EditJournal journal{_directory, std::chrono::milliseconds{1}};
+    const auto  recovered = journal.takeRecoveredEntries();
+    ASSERT_EQ(recovered.size(), 1u);
+    EXPECT_EQ(recovered[0].x, 1);
+    EXPECT_EQ(recovered[0].spriteId, 1);
+}
+
+TEST_F(EditJournalTest, WorldReplaysUnsavedEdits) {
+    {
+        test::FakeDiskIoHandler fakeDiskIoHandler;
+        World                   world{_makeWorldConfig(_directory), &fakeDiskIoHandler};
+
+        const auto editPerm = world.getPermissionToEdit();
+        _loadAllChunks(world, *editPerm);
+        world.edit(*editPerm, [](World::Editor& aEditor) {
+            aEditor.setFloorAt(3, 3, CellModel::Floor{5});
+            aEditor.setWallAt(20, 10, CellModel::Wall{6, 7, Shape::FULL_SQUARE});
+            aEditor.setWallAt(21, 10, CellModel::Wall{6, 7, Shape::FULL_SQUARE});
+        });
+        world.edit(*editPerm, [](World::Editor& aEditor) {
+            aEditor.setWallAt(21, 10, std::nullopt);
+        });
+        world.flushEditJournal();
+        // The world is never saved, so the edits only survive in the journal
+    }
+
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    World                   world{_makeWorldConfig(_directory), &fakeDiskIoHandler};
+
+    const auto editPerm = world.getPermissionToEdit();
+    _loadAllChunks(world, *editPerm);
+
+    const auto* floorCell = world.getCellAtUnchecked(3, 3);
+    ASSERT_NE(floorCell, nullptr);
+    ASSERT_TRUE(floorCell->isFloorInitialized());
+    EXPECT_EQ(floorCell->getFloor().spriteId, 5);
+
+    const auto* wallCell = world.getCellAtUnchecked(20, 10);
+    ASSERT_NE(wallCell, nullptr);
+    ASSERT_TRUE(wallCell->isWallInitialized());
+    EXPECT_EQ(wallCell->getWall().spriteId, 6);
+    EXPECT_EQ(wallCell->getWall().spriteId_reduced, 7);
+    EXPECT_EQ(wallCell->getWall().shape, Shape::FULL_SQUARE);
+
+    const auto* resetCell = world.getCellAtUnchecked(21, 10);
+    ASSERT_NE(resetCell, nullptr);
+    EXPECT_FALSE(resetCell->isWallInitialized());
+}
+
+TEST_F(EditJournalTest, SegmentsAreDiscardedAfterSave) {
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+    fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+    World world{_makeWorldConfig(_directory), &fakeDiskIoHandler};
+
+    const auto editPerm = world.getPermissionToEdit();
+    _loadAllChunks(world, *editPerm);
+    world.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setFloorAt(1, 1, CellModel::Floor{1});
+    });
+
+    world.saveAsync().wait();
+    world.update();
+
+    world.flushEditJournal();
+    std::size_t segmentFileCount = 0;
+    for (const auto& dirEntry : std::filesystem::directory_iterator{_directory}) {
+        (void)dirEntry;
+        segmentFileCount += 1;
+    }
+    EXPECT_EQ(segmentFileCount, 1u);
+
+    // The remaining (new) segment must not contain the saved edit
+    EditJournal journal{_directory, std::chrono::milliseconds{1}};
+    EXPECT_TRUE(journal.takeRecoveredEntries().empty());
+}
+
+TEST_F(EditJournalTest, SegmentsAreDiscardedWhenSavesFinishOutOfOrder) {
+    StoreHoldingDiskIoHandler diskIoHandler;
+
+    auto config                    = _makeWorldConfig(_directory);
+    config.chunkSpoolerWorkerCount = 2;
+    World world{config, &diskIoHandler};
+
+    const auto editPerm = world.getPermissionToEdit();
+    _loadAllChunks(world, *editPerm);
+
+    // The first save (of chunk 0, 0) is held up until the second one (of chunk 1, 0) finishes
+    diskIoHandler.holdStoresOf(ChunkId{0, 0});
+    world.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setFloorAt(1, 1, CellModel::Floor{1});
+    });
+    const auto firstSave = world.saveAsync();
+
+    world.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setFloorAt(9, 1, CellModel::Floor{2});
+    });
+    world.saveAsync().wait();
+    world.update();
+
+    diskIoHandler.holdStoresOf(std::nullopt);
+    firstSave.wait();
+    world.update();
+
+    // Only the segment started by the second save should remain
+    world.flushEditJournal();
+    std::size_t segmentFileCount = 0;
+    for (const auto& dirEntry : std::filesystem::directory_iterator{_directory}) {
+        (void)dirEntry;
+        segmentFileCount += 1;
+    }
+    EXPECT_EQ(segmentFileCount, 1u);
+}
+
+TEST_F(EditJournalTest, WriteFailureIsReportedAndSegmentsAreKept) {
+    EditJournal journal{_directory, std::chrono::milliseconds{1}};
+
+    const Entry entry{.kind = Entry::SET_FLOOR, .x = 1, .y = 2, .spriteId = 3};
+    journal.submit(&entry, 1);
+    const auto segment = journal.startNewSegment({});
+    ASSERT_EQ(journal.getSegmentCount(), 2);
+
+    // A directory in place of the next segment file makes starting it (and writing to it) fail
+    std::filesystem::create_directory(_directory / "edits_2.ggej");
+    journal.submit(&entry, 1);
+    EXPECT_THROW(journal.startNewSegment({}), EditJournalError);
+    EXPECT_TRUE(journal.hasFailed());
+
+    journal.submit(&entry, 1);
+    EXPECT_THROW(journal.flush(), EditJournalError);
+
+    journal.discardSegmentsBefore(segment);
+    EXPECT_EQ(journal.getSegmentCount(), 2);
+    EXPECT_TRUE(std::filesystem::exists(_directory / "edits_0.ggej"));
+}
+
+TEST_F(EditJournalTest, SegmentsAreKeptAfterSaveIfJournalFailed) {
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+    fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+    World world{_makeWorldConfig(_directory), &fakeDiskIoHandler};
+
+    const auto editPerm = world.getPermissionToEdit();
+    _loadAllChunks(world, *editPerm);
+    world.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setFloorAt(1, 1, CellModel::Floor{1});
+    });
+
+    std::filesystem::create_directory(_directory / "edits_1.ggej");
+
+    // The save itself still succeeds
+    EXPECT_NO_THROW(world.saveAsync().get());
+    world.update();
+
+    EXPECT_THROW(world.flushEditJournal(), EditJournalError);
+    EXPECT_TRUE(std::filesystem::exists(_directory / "edits_0.ggej"));
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,206 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Navigation/Hierarchical_pathfinder.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/Utility/Stream_buffer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+using hg::math::Vector2pz;
+
+class HierarchicalPathfinderTest : public ::testing::Test {
+protected:
+    static constexpr hg::PZInteger CHUNK_COUNT     = 4;
+    static constexpr hg::PZInteger CELLS_PER_CHUNK = 8;
+    static constexpr hg::PZInteger CELL_COUNT      = CHUNK_COUNT * CELLS_PER_CHUNK;
+
+    void SetUp() override {
+        _fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+        _fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+        _world = std::make_unique<World>(WorldConfig{.chunkCountX                 = CHUNK_COUNT,
+                                                     .chunkCountY                 = CHUNK_COUNT,
+                                                     .cellsPerChunkX              = CELLS_PER_CHUNK,
+                                                     .cellsPerChunkY              = CELLS_PER_CHUNK,
+                                                     .cellResolution              = 32.f,
+                                                     .maxCellOpenness             = 3,
+                                                     .maxLoadedNonessentialChunks = 16},
+                                         &_fakeDiskIoHandler);
+
+        const auto editPerm = _world->getPermissionToEdit();
+        for (hg::PZInteger y = 0; y < CHUNK_COUNT; y += 1) {
+            for (hg::PZInteger x = 0; x < CHUNK_COUNT; x += 1) {
+                (void)_world->getChunkAtId(*editPerm, {x, y});
+            }
+        }
+    }
+
+    //! Builds a vertical wall at column `aX`, from row `aStartY` to row `aEndY` (inclusive).
+    void _buildWall(hg::PZInteger aX, hg::PZInteger aStartY, hg::PZInteger aEndY) {
+        const auto editPerm = _world->getPermissionToEdit();
+        _world->edit(*editPerm, [=](World::Editor& aEditor) {
+            for (hg::PZInteger y = aStartY; y <= aEndY; y += 1) {
+                aEditor.setWallAt(aX, y, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+            }
+        });
+    }
+
+    //! Checks that the path goes from `aStart` to `aEnd` through adjacent free cells.
+    void _expectValidPath(const std::vector<Vector2pz>& aPath, Vector2pz aStart, Vector2pz aEnd) {
+        ASSERT_FALSE(aPath.empty());
+        EXPECT_EQ(aPath.front(), aStart);
+        EXPECT_EQ(aPath.back(), aEnd);
+        for (std::size_t i = 0; i < aPath.size(); i += 1) {
+            const auto* cell = _world->getCellAtUnchecked(aPath[i]);
+            ASSERT_NE(cell, nullptr);
+            EXPECT_FALSE(cell->isWallInitialized()) << "at " << aPath[i].x << ", " << aPath[i].y;
+            if (i > 0) {
+                EXPECT_LE(std::abs(aPath[i].x - aPath[i - 1].x), 1);
+                EXPECT_LE(std::abs(aPath[i].y - aPath[i - 1].y), 1);
+                EXPECT_NE(aPath[i], aPath[i - 1]);
+            }
+        }
+    }
+
+    test::FakeDiskIoHandler _fakeDiskIoHandler;
+    std::unique_ptr<World>  _world;
+};
+
+TEST_F(HierarchicalPathfinderTest, FindsPathsAcrossChunks) {
+    // Wall splitting the world, with a gap only at the very bottom
+    _buildWall(13, 0, CELL_COUNT - 2);
+
+    HierarchicalPathfinder pathfinder{*_world, {.maxObjectSize = 2, .workerThreadCount = 2}};
+
+    const auto id1 = pathfinder.requestPath({2, 2}, {28, 3}, 1);
+    const auto id2 = pathfinder.requestPath({2, 2}, {5, 6}, 1);
+    const auto id3 = pathfinder.requestPath({2, 2}, {28, 3}, 2); // Gap is too narrow
+    EXPECT_FALSE(pathfinder.isAnswered(id1));
+
+    pathfinder.update();
+    ASSERT_TRUE(pathfinder.isAnswered(id1));
+    ASSERT_TRUE(pathfinder.isAnswered(id2));
+    ASSERT_TRUE(pathfinder.isAnswered(id3));
+
+    const auto path1 = pathfinder.takePath(id1);
+    ASSERT_TRUE(path1.has_value());
+    _expectValidPath(*path1, {2, 2}, {28, 3});
+    EXPECT_GE(path1->size(), hg::pztos(2 * (CELL_COUNT - 4))); // Down to the gap and back up
+
+    const auto path2 = pathfinder.takePath(id2);
+    ASSERT_TRUE(path2.has_value());
+    _expectValidPath(*path2, {2, 2}, {5, 6});
+    EXPECT_EQ(path2->size(), 5u); // Straight diagonal line
+
+    EXPECT_FALSE(pathfinder.takePath(id3).has_value());
+    EXPECT_FALSE(pathfinder.isAnswered(id1));
+    EXPECT_EQ(pathfinder.getStats().builtGraphCount, CHUNK_COUNT * CHUNK_COUNT);
+    EXPECT_EQ(pathfinder.getStats().answeredRequestCount, 3);
+}
+
+TEST_F(HierarchicalPathfinderTest, GraphsOfEditedChunksAreRebuilt) {
+    HierarchicalPathfinder pathfinder{*_world};
+
+    auto path = pathfinder.findPath({2, 2}, {28, 3}, 1);
+    ASSERT_TRUE(path.has_value());
+    _expectValidPath(*path, {2, 2}, {28, 3});
+
+    // Close off the right part of the world
+    _buildWall(20, 0, CELL_COUNT - 1);
+
+    path = pathfinder.findPath({2, 2}, {28, 3}, 1);
+    EXPECT_FALSE(path.has_value());
+
+    const auto stats = pathfinder.getStats();
+    EXPECT_EQ(stats.invalidatedGraphCount, CHUNK_COUNT);
+    EXPECT_EQ(stats.builtGraphCount, CHUNK_COUNT * CHUNK_COUNT + CHUNK_COUNT);
+
+    // Open it up again
+    const auto editPerm = _world->getPermissionToEdit();
+    _world->edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setWallAt(20, 30, std::nullopt);
+    });
+
+    path = pathfinder.findPath({2, 2}, {28, 3}, 1);
+    ASSERT_TRUE(path.has_value());
+    _expectValidPath(*path, {2, 2}, {28, 3});
+}
+
+TEST_F(HierarchicalPathfinderTest, SavedGraphsAreReused) {
+    _buildWall(13, 0, CELL_COUNT - 2);
+
+    HierarchicalPathfinder pathfinder1{*_world, {.maxObjectSize = 2}};
+    const auto             path1 = pathfinder1.findPath({2, 2}, {28, 3}, 1);
+    ASSERT_TRUE(path1.has_value());
+
+    HierarchicalPathfinder pathfinder2{*_world, {.maxObjectSize = 2}};
+    for (hg::PZInteger y = 0; y < CHUNK_COUNT; y += 1) {
+        for (hg::PZInteger x = 0; x < CHUNK_COUNT; x += 1) {
+            hg::util::BufferStream buffer;
+            pathfinder1.saveChunkGraph({x, y}, buffer);
+            pathfinder2.loadChunkGraph({x, y}, buffer);
+        }
+    }
+
+    const auto path2 = pathfinder2.findPath({2, 2}, {28, 3}, 1);
+    ASSERT_TRUE(path2.has_value());
+    EXPECT_EQ(*path1, *path2);
+
+    EXPECT_EQ(pathfinder2.getStats().reusedGraphCount, CHUNK_COUNT * CHUNK_COUNT);
+    EXPECT_EQ(pathfinder2.getStats().builtGraphCount, 0);
+}
+
+TEST_F(HierarchicalPathfinderTest, CorruptedSavedGraphsAreRejected) {
+    _buildWall(13, 0, CELL_COUNT - 2);
+
+    HierarchicalPathfinder pathfinder1{*_world, {.maxObjectSize = 2}};
+    ASSERT_TRUE(pathfinder1.findPath({2, 2}, {28, 3}, 1).has_value());
+
+    hg::util::BufferStream saved;
+    pathfinder1.saveChunkGraph({1, 1}, saved);
+
+    // Data which isn't a chunk graph at all
+    {
+        HierarchicalPathfinder pathfinder2{*_world, {.maxObjectSize = 2}};
+        hg::util::BufferStream buffer;
+        buffer << std::uint32_t{12345} << std::uint16_t{1} << true;
+        EXPECT_THROW(pathfinder2.loadChunkGraph({1, 1}, buffer), hg::util::StreamReadError);
+    }
+
+    // Every byte of a saved graph corrupted in turn: the graph is either rejected when loaded, or
+    // (if only a cost or the fingerprint was affected) loaded, and then any path which is found
+    // must still be valid
+    int rejectedCount = 0;
+    for (std::int64_t i = 0; i < saved.getDataSize(); i += 1) {
+        hg::util::BufferStream buffer;
+        (void)buffer.write(saved.getData(), saved.getDataSize());
+        static_cast<std::uint8_t*>(buffer.getMutableData())[i] ^= 0xA5;
+
+        HierarchicalPathfinder pathfinder2{*_world, {.maxObjectSize = 2}};
+        try {
+            pathfinder2.loadChunkGraph({1, 1}, buffer);
+        } catch (const hg::util::StreamReadError&) {
+            rejectedCount += 1;
+            continue;
+        }
+        const auto path = pathfinder2.findPath({2, 2}, {28, 3}, 1);
+        if (path.has_value()) {
+            _expectValidPath(*path, {2, 2}, {28, 3});
+        }
+    }
+    EXPECT_GT(rejectedCount, 0);
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
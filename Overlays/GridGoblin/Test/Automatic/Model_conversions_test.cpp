@@ -1,15 +1,21 @@
 // Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
 // See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
 
+#include <GridGoblin/Model/Chunk_extension.hpp>
 #include <GridGoblin/Private/Model_conversions.hpp>
 
+#include <Hobgoblin/Utility/Stream.hpp>
+
 #include <rapidjson/document.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/stringbuffer.h>
 
 #include <gtest/gtest.h>
 
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -103,6 +109,146 @@ TEST_F(GridGoblinConversionsTest, ChunkConversionToJsonAndBack) {
     EXPECT_TRUE(AreCellsEqual(chunk, JsonStringToChunk(ChunkToJsonString(chunk))));
 }
 
+namespace {
+class BinaryTestExtension : public ChunkExtensionInterface {
+public:
+    std::string payload;
+
+    SerializationMethod getPreferredSerializationMethod() const override {
+        return SerializationMethod::BINARY_STREAM;
+    }
+
+    void serialize(hg::util::OutputStream& aOStream) const override {
+        aOStream << payload;
+    }
+
+    void deserialize(hg::util::InputStream& aIStream) override {
+        aIStream >> payload;
+    }
+
+    std::int64_t getUniqueIdentifier() const override {
+        return 0;
+    }
+
+    const std::type_info& getTypeInfo() const override {
+        return typeid(BinaryTestExtension);
+    }
+};
+} // namespace
+
+TEST_F(GridGoblinConversionsTest, ChunkConversionToBinaryAndBack) {
+    CellModel cell;
+    cell.setFloor({111});
+    cell.setWall({111, 222, Shape::FULL_SQUARE});
+
+    Chunk chunk{8, 5};
+    chunk.setAll(cell);
+
+    chunk.getCellAtUnchecked(2, 0).setFloor({333});
+    chunk.getCellAtUnchecked(3, 1).resetWall();
+    chunk.getCellAtUnchecked(1, 2).resetFloor();
+    chunk.getCellAtUnchecked(7, 4).resetFloor();
+    chunk.getCellAtUnchecked(7, 4).resetWall();
+    chunk.getCellAtUnchecked(4, 3).setOpenness(7);
+    chunk.getCellAtUnchecked(5, 3).setObstructionFlags(CellModel::TOP_EDGE_OBSTRUCTED |
+                                                       CellModel::LEFT_EDGE_OBSTRUCTED);
+
+    hg::util::BufferStream buffer;
+    ChunkToBinary(chunk, buffer);
+
+    ASSERT_TRUE(IsBinaryChunkData(buffer.getData(), buffer.getDataSize()));
+
+    const auto result = BinaryToChunk(buffer);
+    EXPECT_TRUE(AreCellsEqual(chunk, result));
+    EXPECT_EQ(result.getCellAtUnchecked(4, 3).getOpenness(), 7);
+    EXPECT_EQ(result.getCellAtUnchecked(5, 3).getFlags(), chunk.getCellAtUnchecked(5, 3).getFlags());
+    EXPECT_EQ(result.getExtension(), nullptr);
+}
+
+TEST_F(GridGoblinConversionsTest, ChunkWithLargeSpriteIdsConversionToBinaryAndBack) {
+    CellModel cell;
+    cell.setFloor({70'000});
+    cell.setWall({1'000'000, 2'000'000'000, Shape::CIRCLE});
+
+    Chunk chunk{4, 4};
+    chunk.setAll(cell);
+
+    hg::util::BufferStream buffer;
+    ChunkToBinary(chunk, buffer);
+
+    const auto result = BinaryToChunk(buffer);
+    EXPECT_TRUE(AreCellsEqual(chunk, result));
+    EXPECT_EQ(result.getCellAtUnchecked(3, 3).getFloor().spriteId, 70'000);
+    EXPECT_EQ(result.getCellAtUnchecked(3, 3).getWall().spriteId, 1'000'000);
+    EXPECT_EQ(result.getCellAtUnchecked(3, 3).getWall().spriteId_reduced, 2'000'000'000);
+}
+
+TEST_F(GridGoblinConversionsTest, ChunkWithExtensionConversionToBinaryAndBack) {
+    static constexpr auto PAYLOAD = "<<< binary extension payload >>>";
+
+    Chunk chunk{4, 4};
+    {
+        auto extension     = std::make_unique<BinaryTestExtension>();
+        extension->payload = PAYLOAD;
+        chunk.setExtension(std::move(extension));
+    }
+
+    ReusableConversionBuffers* rcb = NewReusableConversionBuffers();
+
+    hg::util::BufferStream buffer;
+    ChunkToBinary(chunk, buffer, rcb);
+
+    const auto result = BinaryToChunk(
+        buffer,
+        [](const Chunk&) {
+            return std::make_unique<BinaryTestExtension>();
+        },
+        rcb);
+
+    DeleteReusableConversionBuffers(rcb);
+
+    ASSERT_NE(result.getExtension(), nullptr);
+    EXPECT_EQ(static_cast<BinaryTestExtension*>(result.getExtension())->payload, PAYLOAD);
+}
+
+TEST_F(GridGoblinConversionsTest, ChunkConversionFromInvalidBinary) {
+    Chunk chunk{4, 4};
+
+    hg::util::BufferStream buffer;
+    ChunkToBinary(chunk, buffer);
+
+    const auto* data = static_cast<const char*>(buffer.getData());
+    const auto  size = buffer.getDataSize();
+
+    // Truncated
+    {
+        hg::util::ViewStream vstream{data, size - 1};
+        EXPECT_THROW(BinaryToChunk(vstream), BinaryParseError);
+    }
+    // Bad signature
+    {
+        std::string bytes{data, static_cast<std::size_t>(size)};
+        bytes[0] = 'X';
+        EXPECT_FALSE(IsBinaryChunkData(bytes.data(), size));
+
+        hg::util::ViewStream vstream{bytes.data(), size};
+        EXPECT_THROW(BinaryToChunk(vstream), BinaryParseError);
+    }
+    // Unsupported version
+    {
+        std::string bytes{data, static_cast<std::size_t>(size)};
+        bytes[4] = static_cast<char>(BINARY_CHUNK_FORMAT_VERSION + 1);
+
+        hg::util::ViewStream vstream{bytes.data(), size};
+        EXPECT_THROW(BinaryToChunk(vstream), BinaryParseError);
+    }
+    // JSON is not mistaken for binary
+    {
+        const auto json = ChunkToJsonString(chunk);
+        EXPECT_FALSE(IsBinaryChunkData(json.data(), hg::stopz(json.size())));
+    }
+}
+
 } // namespace detail
 } // namespace gridgoblin
 } // namespace jbatnozic
@@ -0,0 +1,99 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Mpsc_queue.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+TEST(MpscQueueTest, ValuesComeOutInPushOrder) {
+    MpscQueue<int> queue;
+    EXPECT_TRUE(queue.isEmpty());
+    EXPECT_EQ(queue.drain([](int) {}), 0u);
+
+    for (int i = 0; i < 10; i += 1) {
+        queue.push(i);
+    }
+    EXPECT_FALSE(queue.isEmpty());
+
+    std::vector<int> values;
+    EXPECT_EQ(queue.drain([&](int aValue) {
+        values.push_back(aValue);
+    }),
+              10u);
+    ASSERT_EQ(values.size(), 10u);
+    for (int i = 0; i < 10; i += 1) {
+        EXPECT_EQ(values[static_cast<std::size_t>(i)], i);
+    }
+    EXPECT_TRUE(queue.isEmpty());
+}
+
+TEST(MpscQueueTest, ValuesAreReturnedWhenCallbackThrows) {
+    MpscQueue<int> queue;
+    for (int i = 0; i < 5; i += 1) {
+        queue.push(i);
+    }
+
+    EXPECT_THROW(queue.drain([](int aValue) {
+        if (aValue == 1) {
+            throw std::runtime_error{"test"};
+        }
+    }),
+                 std::runtime_error);
+
+    std::vector<int> values;
+    queue.drain([&](int aValue) {
+        values.push_back(aValue);
+    });
+    EXPECT_EQ(values, (std::vector<int>{2, 3, 4}));
+}
+
+TEST(MpscQueueTest, ConcurrentProducers) {
+    static constexpr int PRODUCER_COUNT      = 4;
+    static constexpr int VALUES_PER_PRODUCER = 20'000;
+
+    MpscQueue<int>   queue;
+    std::atomic<int> finishedProducerCount{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCER_COUNT; p += 1) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < VALUES_PER_PRODUCER; i += 1) {
+                queue.push(p * VALUES_PER_PRODUCER + i);
+            }
+            finishedProducerCount += 1;
+        });
+    }
+
+    // Values of each producer must come out in order, and each exactly once
+    std::vector<int> nextExpected(PRODUCER_COUNT, 0);
+    int              receivedCount = 0;
+    const auto       consume       = [&](int aValue) {
+        const int producer = aValue / VALUES_PER_PRODUCER;
+        EXPECT_EQ(aValue % VALUES_PER_PRODUCER, nextExpected[static_cast<std::size_t>(producer)]);
+        nextExpected[static_cast<std::size_t>(producer)] += 1;
+        receivedCount += 1;
+    };
+    while (finishedProducerCount.load() < PRODUCER_COUNT) {
+        queue.drain(consume);
+    }
+    queue.drain(consume);
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(receivedCount, PRODUCER_COUNT * VALUES_PER_PRODUCER);
+    EXPECT_TRUE(queue.isEmpty());
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,135 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Region_file.hpp>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+class RegionFileTest : public ::testing::Test {
+protected:
+    std::filesystem::path _path = std::filesystem::temp_directory_path() / "gridgoblin_region_test";
+
+    void SetUp() override {
+        std::filesystem::remove(_path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(_path);
+    }
+
+    static std::string _read(RegionFile& aRegionFile, hg::PZInteger aX, hg::PZInteger aY) {
+        const auto chunkData = aRegionFile.readChunk(aX, aY);
+        if (chunkData.data == nullptr) {
+            return {};
+        }
+        return {static_cast<const char*>(chunkData.data),
+                static_cast<std::size_t>(chunkData.byteCount)};
+    }
+
+    static void _write(RegionFile&        aRegionFile,
+                       hg::PZInteger      aX,
+                       hg::PZInteger      aY,
+                       const std::string& aData) {
+        aRegionFile.writeChunk(aX, aY, aData.data(), static_cast<std::int64_t>(aData.size()));
+    }
+};
+
+TEST_F(RegionFileTest, NewRegionFileIsEmpty) {
+    RegionFile regionFile{_path, 4, 3};
+
+    for (hg::PZInteger y = 0; y < 3; y += 1) {
+        for (hg::PZInteger x = 0; x < 4; x += 1) {
+            EXPECT_EQ(regionFile.readChunk(x, y).data, nullptr);
+        }
+    }
+    EXPECT_EQ(regionFile.getGarbageByteCount(), 0);
+}
+
+TEST_F(RegionFileTest, WriteReadAndOverwrite) {
+    RegionFile regionFile{_path, 4, 4};
+
+    _write(regionFile, 0, 0, "first chunk");
+    _write(regionFile, 3, 2, "second chunk");
+    EXPECT_EQ(_read(regionFile, 0, 0), "first chunk");
+    EXPECT_EQ(_read(regionFile, 3, 2), "second chunk");
+    EXPECT_EQ(_read(regionFile, 2, 3), "");
+
+    _write(regionFile, 0, 0, "first chunk, updated");
+    EXPECT_EQ(_read(regionFile, 0, 0), "first chunk, updated");
+    EXPECT_EQ(regionFile.getGarbageByteCount(), 11);
+}
+
+TEST_F(RegionFileTest, ReadsAfterAppendsSeeTheNewData) {
+    RegionFile regionFile{_path, 8, 8};
+
+    // Every read of a freshly written chunk may need the file mapping to cover more of the file
+    for (hg::PZInteger i = 0; i < 64; i += 1) {
+        const std::string data(hg::pztos(100 + i * 37), static_cast<char>('a' + i % 26));
+        _write(regionFile, i % 8, i / 8, data);
+        EXPECT_EQ(_read(regionFile, i % 8, i / 8), data);
+    }
+    for (hg::PZInteger i = 0; i < 64; i += 1) {
+        EXPECT_EQ(_read(regionFile, i % 8, i / 8),
+                  std::string(hg::pztos(100 + i * 37), static_cast<char>('a' + i % 26)));
+    }
+}
+
+TEST_F(RegionFileTest, DataPersistsAfterReopening) {
+    {
+        RegionFile regionFile{_path, 2, 2};
+        _write(regionFile, 1, 1, "persisted");
+        _write(regionFile, 0, 1, "overwritten");
+        _write(regionFile, 0, 1, "also persisted");
+    }
+    {
+        RegionFile regionFile{_path, 2, 2};
+        EXPECT_EQ(_read(regionFile, 1, 1), "persisted");
+        EXPECT_EQ(_read(regionFile, 0, 1), "also persisted");
+        EXPECT_EQ(regionFile.getGarbageByteCount(), 11);
+    }
+}
+
+TEST_F(RegionFileTest, OpeningWithDifferentDimensionsFails) {
+    { RegionFile regionFile{_path, 2, 2}; }
+    EXPECT_THROW((RegionFile{_path, 4, 4}), RegionFileError);
+}
+
+TEST_F(RegionFileTest, CompactionReclaimsSpace) {
+    RegionFile regionFile{_path, 2, 2};
+
+    const std::string big(100'000, 'x');
+    for (int i = 0; i < 5; i += 1) {
+        _write(regionFile, 0, 0, big);
+    }
+    _write(regionFile, 1, 0, "small");
+    EXPECT_GT(regionFile.getGarbageByteCount(), 0);
+
+    regionFile.compact();
+    EXPECT_EQ(regionFile.getGarbageByteCount(), 0);
+    EXPECT_EQ(_read(regionFile, 0, 0), big);
+    EXPECT_EQ(_read(regionFile, 1, 0), "small");
+}
+
+TEST_F(RegionFileTest, CompactionHappensAutomatically) {
+    RegionFile regionFile{_path, 1, 1};
+
+    const std::string big(600'000, 'y');
+    for (int i = 0; i < 10; i += 1) {
+        _write(regionFile, 0, 0, big);
+    }
+
+    EXPECT_LE(regionFile.getGarbageByteCount(), static_cast<std::int64_t>(2 * big.size()));
+    EXPECT_EQ(_read(regionFile, 0, 0), big);
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
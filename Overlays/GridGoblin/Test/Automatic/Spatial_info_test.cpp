@@ -6,7 +6,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace jbatnozic {
 namespace gridgoblin {
@@ -94,5 +98,229 @@ TEST(GridGoblinSpatialInfoDrawingOrderTest, CircleOrbitingAnotherCircle) {
     }
 }
 
+TEST(GridGoblinSpatialInfoDrawingOrderTest, SortCellsForDrawing) {
+    static constexpr float CELL_RESOLUTION = 32.f;
+
+    // Floors everywhere and walls on some of the cells, in scrambled order
+    std::vector<SpatialInfo> infos;
+    std::uint32_t            state = 12345;
+    for (int y = 0; y < 24; y += 1) {
+        for (int x = 0; x < 24; x += 1) {
+            state = state * 1664525u + 1013904223u;
+            const bool hasWall = ((state >> 29) == 0);
+            infos.push_back(SpatialInfo::fromTopLeftAndSize({x * CELL_RESOLUTION, y * CELL_RESOLUTION},
+                                                            {CELL_RESOLUTION, CELL_RESOLUTION},
+                                                            hasWall ? Layer::WALL : Layer::FLOOR));
+        }
+    }
+
+    std::vector<const SpatialInfo*> cells;
+    for (const auto& info : infos) {
+        cells.push_back(&info);
+    }
+    for (std::size_t i = cells.size() - 1; i > 0; i -= 1) {
+        state = state * 1664525u + 1013904223u;
+        std::swap(cells[i], cells[(state >> 8) % (i + 1)]);
+    }
+
+    dimetric::CellSortBuffer<const SpatialInfo*> buffer;
+    dimetric::SortCellsForDrawing(
+        cells,
+        CELL_RESOLUTION,
+        [](const SpatialInfo* aInfo) -> const SpatialInfo& {
+            return *aInfo;
+        },
+        buffer);
+
+    ASSERT_EQ(cells.size(), infos.size());
+    for (std::size_t i = 0; i < cells.size(); i += 1) {
+        for (std::size_t t = i + 1; t < cells.size(); t += 1) {
+            ASSERT_NE(dimetric::CheckDrawingOrder(*cells[i], *cells[t]), dimetric::DRAW_RHS_FIRST)
+                << "i = " << i << ", t = " << t;
+        }
+    }
+}
+
+namespace {
+//! Counts the pairs which are drawn in the wrong order (not counting pairs of overlapping elements
+//! with equal `x - y`, for which `CheckDrawingOrder()` says to draw the other one first either way).
+std::size_t CountPairsInWrongDrawingOrder(const std::vector<const SpatialInfo*>& aInfos) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < aInfos.size(); i += 1) {
+        for (std::size_t t = i + 1; t < aInfos.size(); t += 1) {
+            if (dimetric::CheckDrawingOrder(*aInfos[i], *aInfos[t]) == dimetric::DRAW_RHS_FIRST &&
+                dimetric::CheckDrawingOrder(*aInfos[t], *aInfos[i]) == dimetric::DRAW_LHS_FIRST) {
+                count += 1;
+            }
+        }
+    }
+    return count;
+}
+} // namespace
+
+TEST(GridGoblinSpatialInfoDrawingOrderTest, MergeObjectsIntoSortedCells) {
+    static constexpr float CELL_RESOLUTION = 32.f;
+
+    // Floors everywhere and walls on some of the cells
+    std::vector<SpatialInfo> infos;
+    std::uint32_t            state = 12345;
+    for (int y = 0; y < 24; y += 1) {
+        for (int x = 0; x < 24; x += 1) {
+            state = state * 1664525u + 1013904223u;
+            const bool hasWall = ((state >> 29) == 0);
+            infos.push_back(SpatialInfo::fromTopLeftAndSize({x * CELL_RESOLUTION, y * CELL_RESOLUTION},
+                                                            {CELL_RESOLUTION, CELL_RESOLUTION},
+                                                            hasWall ? Layer::WALL : Layer::FLOOR));
+        }
+    }
+    const std::size_t cellCount = infos.size();
+
+    // Objects smaller than a cell scattered among the walls (some of them overlapping walls)
+    for (int i = 0; i < 60; i += 1) {
+        state         = state * 1664525u + 1013904223u;
+        const float x = static_cast<float>((state >> 8) % 750) + 9.f;
+        state         = state * 1664525u + 1013904223u;
+        const float y = static_cast<float>((state >> 8) % 750) + 9.f;
+        infos.push_back(SpatialInfo::fromCenterAndSize({x, y},
+                                                       {CELL_RESOLUTION / 2.f, CELL_RESOLUTION / 2.f},
+                                                       Layer::WALL));
+    }
+
+    const auto getSpatialInfo = [](const SpatialInfo* aInfo) -> const SpatialInfo& {
+        return *aInfo;
+    };
+
+    std::vector<const SpatialInfo*> elements;
+    for (const auto& info : infos) {
+        elements.push_back(&info);
+    }
+    dimetric::CellSortBuffer<const SpatialInfo*> buffer;
+    {
+        std::vector<const SpatialInfo*> cells{elements.begin(),
+                                              elements.begin() + static_cast<std::ptrdiff_t>(cellCount)};
+        dimetric::SortCellsForDrawing(cells, CELL_RESOLUTION, getSpatialInfo, buffer);
+        std::copy(cells.begin(), cells.end(), elements.begin());
+    }
+    dimetric::MergeObjectsIntoSortedCells(elements, cellCount, CELL_RESOLUTION, getSpatialInfo, buffer);
+
+    ASSERT_EQ(elements.size(), infos.size());
+    for (std::size_t i = 0; i < infos.size(); i += 1) {
+        EXPECT_EQ(std::count(elements.begin(), elements.end(), &infos[i]), 1) << "i = " << i;
+    }
+
+    // Reference: sorting everything at once, as was done before, with ties broken by address.
+    // (This is not a strict weak ordering, so the insertion sort below is used instead of std::sort)
+    const auto comesBefore = [](const SpatialInfo* aLhs, const SpatialInfo* aRhs) {
+        switch (dimetric::CheckDrawingOrder(*aLhs, *aRhs)) {
+        case dimetric::DRAW_LHS_FIRST:
+            return true;
+        case dimetric::DOES_NOT_MATTER:
+            return (aLhs < aRhs);
+        default:
+            return false;
+        }
+    };
+    std::vector<const SpatialInfo*> reference;
+    for (const auto& info : infos) {
+        const auto iter =
+            std::find_if(reference.begin(), reference.end(), [&](const SpatialInfo* aOther) {
+                return comesBefore(&info, aOther);
+            });
+        reference.insert(iter, &info);
+    }
+
+    EXPECT_EQ(CountPairsInWrongDrawingOrder(elements), 0u);
+    EXPECT_LE(CountPairsInWrongDrawingOrder(elements), CountPairsInWrongDrawingOrder(reference));
+}
+
+TEST(GridGoblinSpatialInfoDrawingOrderTest, MergeObjectsWhichAreNotSquareIntoSortedCells) {
+    static constexpr float CELL_RESOLUTION = 32.f;
+
+    const auto getSpatialInfo = [](const SpatialInfo* aInfo) -> const SpatialInfo& {
+        return *aInfo;
+    };
+
+    // A tall, thin object next to a cell which is to the right of it, but lower on the diagonal
+    {
+        const auto cell   = SpatialInfo::fromTopLeftAndSize({288.f, 288.f},
+                                                          {CELL_RESOLUTION, CELL_RESOLUTION},
+                                                          Layer::WALL);
+        const auto object = SpatialInfo::fromTopLeftAndSize({270.f, 0.f}, {10.f, 300.f}, Layer::WALL);
+        ASSERT_EQ(dimetric::CheckDrawingOrder(cell, object), dimetric::DRAW_LHS_FIRST);
+
+        std::vector<const SpatialInfo*>              elements = {&cell, &object};
+        dimetric::CellSortBuffer<const SpatialInfo*> buffer;
+        dimetric::MergeObjectsIntoSortedCells(elements, 1, CELL_RESOLUTION, getSpatialInfo, buffer);
+        EXPECT_EQ(elements[0], &cell);
+        EXPECT_EQ(elements[1], &object);
+    }
+
+    // Walls on some of the cells, and objects of all kinds of sizes and proportions among them.
+    // (Nothing overlaps, as overlapping elements can make the drawing order cyclic, in which case
+    // no order satisfies all the pairs)
+    std::vector<SpatialInfo> infos;
+    std::uint32_t            state = 54321;
+    for (int y = 0; y < 24; y += 1) {
+        for (int x = 0; x < 24; x += 1) {
+            state = state * 1664525u + 1013904223u;
+            if ((state >> 29) == 0) {
+                infos.push_back(
+                    SpatialInfo::fromTopLeftAndSize({x * CELL_RESOLUTION, y * CELL_RESOLUTION},
+                                                    {CELL_RESOLUTION, CELL_RESOLUTION},
+                                                    Layer::WALL));
+            }
+        }
+    }
+    const std::size_t cellCount = infos.size();
+
+    infos.reserve(infos.size() + 40);
+    while (infos.size() < cellCount + 40) {
+        const auto next = [&state](std::uint32_t aModulo) {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>((state >> 8) % aModulo);
+        };
+        const auto object = SpatialInfo::fromTopLeftAndSize({next(700), next(700)},
+                                                            {next(120) + 2.f, next(200) + 2.f},
+                                                            Layer::WALL);
+        const bool overlapsSomething = std::any_of(infos.begin(), infos.end(), [&](auto& aOther) {
+            return aOther.getBoundingBox().overlaps(object.getBoundingBox());
+        });
+        if (!overlapsSomething) {
+            infos.push_back(object);
+        }
+    }
+
+    std::vector<const SpatialInfo*> elements;
+    for (const auto& info : infos) {
+        elements.push_back(&info);
+    }
+    dimetric::CellSortBuffer<const SpatialInfo*> buffer;
+    {
+        std::vector<const SpatialInfo*> cells{elements.begin(),
+                                              elements.begin() + static_cast<std::ptrdiff_t>(cellCount)};
+        dimetric::SortCellsForDrawing(cells, CELL_RESOLUTION, getSpatialInfo, buffer);
+        std::copy(cells.begin(), cells.end(), elements.begin());
+    }
+    dimetric::MergeObjectsIntoSortedCells(elements, cellCount, CELL_RESOLUTION, getSpatialInfo, buffer);
+
+    ASSERT_EQ(elements.size(), infos.size());
+    for (std::size_t i = 0; i < infos.size(); i += 1) {
+        EXPECT_EQ(std::count(elements.begin(), elements.end(), &infos[i]), 1) << "i = " << i;
+    }
+
+    // Reference: sorting everything at once with `CheckDrawingOrder()` (as in the test above)
+    std::vector<const SpatialInfo*> reference;
+    for (const auto& info : infos) {
+        const auto iter =
+            std::find_if(reference.begin(), reference.end(), [&](const SpatialInfo* aOther) {
+                return dimetric::CheckDrawingOrder(info, *aOther) == dimetric::DRAW_LHS_FIRST;
+            });
+        reference.insert(iter, &info);
+    }
+
+    EXPECT_EQ(CountPairsInWrongDrawingOrder(elements), 0u);
+    EXPECT_LE(CountPairsInWrongDrawingOrder(elements), CountPairsInWrongDrawingOrder(reference));
+}
+
 } // namespace gridgoblin
 } // namespace jbatnozic
@@ -0,0 +1,65 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Rendering/Top_down_los_cpu_renderer.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <gtest/gtest.h>
+
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+TEST(TopDownLineOfSightCpuRendererTest, WallsCastShadowsAwayFromPointOfView) {
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+    fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+    World world{WorldConfig{.chunkCountX                 = 2,
+                            .chunkCountY                 = 2,
+                            .cellsPerChunkX              = 8,
+                            .cellsPerChunkY              = 8,
+                            .cellResolution              = 32.f,
+                            .maxCellOpenness             = 5,
+                            .maxLoadedNonessentialChunks = 4},
+                &fakeDiskIoHandler};
+
+    const auto editPerm = world.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < world.getChunkCountY(); y += 1) {
+        for (hg::PZInteger x = 0; x < world.getChunkCountX(); x += 1) {
+            (void)world.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+    world.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setWallAt(8, 8, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+    });
+
+    TopDownLineOfSightCpuRenderer renderer{world, 256, TopDownLineOfSightCpuRenderer::FOR_TOPDOWN};
+    renderer.start(PositionInWorld{256.f, 256.f}, {512.f, 512.f}, PositionInWorld{144.f, 272.f}, 0.f);
+
+    // Nothing is occluded before the first render
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{400.f, 272.f}), true);
+
+    renderer.render();
+
+    // Results are available in the same frame
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{144.f, 272.f}), true);  // Point of view
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{240.f, 272.f}), true);  // In front of wall
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{272.f, 272.f}), false); // Wall itself
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{400.f, 272.f}), false); // Behind wall
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{500.f, 300.f}), false); // Behind wall
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{400.f, 100.f}), true);  // Beside shadow
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{400.f, 440.f}), true);  // Beside shadow
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{-100.f, 0.f}), std::nullopt);
+
+    // Point of view on the other side of the wall
+    renderer.start(PositionInWorld{256.f, 256.f}, {512.f, 512.f}, PositionInWorld{400.f, 272.f}, 0.f);
+    renderer.render();
+
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{400.f, 272.f}), true);
+    EXPECT_EQ(renderer.testVisibilityAt(PositionInWorld{144.f, 272.f}), false);
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
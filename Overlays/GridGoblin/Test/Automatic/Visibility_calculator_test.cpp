@@ -0,0 +1,126 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Rendering/Visibility_calculator.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+class VisibilityCalculatorTest : public ::testing::Test {
+protected:
+    static constexpr float CELL_RESOLUTION = 32.f;
+
+    test::FakeDiskIoHandler _fakeDiskIoHandler;
+    std::optional<World>    _world;
+
+    void SetUp() override {
+        _fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+        _fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+        _world.emplace(WorldConfig{.chunkCountX                 = 4,
+                                   .chunkCountY                 = 4,
+                                   .cellsPerChunkX              = 8,
+                                   .cellsPerChunkY              = 8,
+                                   .cellResolution              = CELL_RESOLUTION,
+                                   .maxCellOpenness             = 5,
+                                   .maxLoadedNonessentialChunks = 16},
+                       &_fakeDiskIoHandler);
+
+        const auto editPerm = _world->getPermissionToEdit();
+        for (hg::PZInteger y = 0; y < _world->getChunkCountY(); y += 1) {
+            for (hg::PZInteger x = 0; x < _world->getChunkCountX(); x += 1) {
+                (void)_world->getChunkAtId(*editPerm, {x, y});
+            }
+        }
+
+        // Scattered walls (roughly 1 in 8 cells), away from the point of view
+        _world->edit(*editPerm, [](World::Editor& aEditor) {
+            std::uint32_t state = 12345;
+            for (hg::PZInteger y = 0; y < 32; y += 1) {
+                for (hg::PZInteger x = 0; x < 32; x += 1) {
+                    state = state * 1664525u + 1013904223u;
+                    if ((state >> 29) == 0 && (x < 14 || x > 16 || y < 14 || y > 16)) {
+                        aEditor.setWallAt(x, y, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+                    }
+                }
+            }
+        });
+    }
+
+    void _calc(VisibilityCalculator& aCalculator, hg::math::Vector2f aPointOfView) {
+        aCalculator.calc(PositionInWorld{512.f, 512.f},
+                         {1024.f, 1024.f},
+                         PositionInWorld{aPointOfView});
+    }
+
+    static void _expectSameVisibility(const VisibilityCalculator& aCalculator1,
+                                      const VisibilityCalculator& aCalculator2) {
+        for (float y = 4.f; y < 1024.f; y += 8.f) {
+            for (float x = 4.f; x < 1024.f; x += 8.f) {
+                ASSERT_EQ(aCalculator1.testVisibilityAt(PositionInWorld{x, y}),
+                          aCalculator2.testVisibilityAt(PositionInWorld{x, y}))
+                    << "at (" << x << ", " << y << ")";
+            }
+        }
+    }
+};
+
+TEST_F(VisibilityCalculatorTest, IncrementalModeGivesSameResultsAsFullCalculation) {
+    const VisibilityCalculatorConfig fullConfig{.minRingsBeforeRaycasting = 0};
+    const VisibilityCalculatorConfig incrementalConfig{.minRingsBeforeRaycasting = 0,
+                                                       .incremental              = true};
+
+    VisibilityCalculator full{*_world, fullConfig};
+    VisibilityCalculator incremental{*_world, incrementalConfig};
+
+    // First calculation: nothing to reuse
+    _calc(full, {490.f, 490.f});
+    _calc(incremental, {490.f, 490.f});
+    EXPECT_EQ(incremental.getStats().reusedRingCount, 0);
+    EXPECT_FALSE(incremental.getStats().reusedPreviousResult);
+    _expectSameVisibility(full, incremental);
+
+    // Same inputs: previous result is kept
+    _calc(incremental, {490.f, 490.f});
+    EXPECT_TRUE(incremental.getStats().reusedPreviousResult);
+    _expectSameVisibility(full, incremental);
+
+    // Moved within the same cell: all rings are reused (ring 0 is never processed)
+    _calc(full, {500.f, 485.f});
+    _calc(incremental, {500.f, 485.f});
+    EXPECT_FALSE(incremental.getStats().reusedPreviousResult);
+    EXPECT_GT(incremental.getStats().reusedOccluderCount, 0);
+    EXPECT_EQ(incremental.getStats().reusedRingCount, incremental.getStats().highDetailRingCount);
+    _expectSameVisibility(full, incremental);
+
+    // Moved to another cell: nothing is reused
+    _calc(full, {530.f, 485.f});
+    _calc(incremental, {530.f, 485.f});
+    EXPECT_EQ(incremental.getStats().reusedRingCount, 0);
+    _expectSameVisibility(full, incremental);
+
+    // Edited a cell 3 rings away: only the rings around it have to be recalculated
+    {
+        const auto editPerm = _world->getPermissionToEdit();
+        _world->edit(*editPerm, [](World::Editor& aEditor) {
+            aEditor.setWallAt(19, 15, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+        });
+    }
+    _calc(full, {530.f, 485.f});
+    _calc(incremental, {530.f, 485.f});
+    EXPECT_FALSE(incremental.getStats().reusedPreviousResult);
+    EXPECT_GT(incremental.getStats().reusedRingCount, 0);
+    EXPECT_LT(incremental.getStats().reusedRingCount, incremental.getStats().highDetailRingCount);
+    _expectSameVisibility(full, incremental);
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
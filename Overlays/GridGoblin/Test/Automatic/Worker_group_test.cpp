@@ -0,0 +1,67 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Worker_group.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace jbatnozic {
+namespace gridgoblin {
+namespace detail {
+
+TEST(WorkerGroupTest, EveryTaskIsExecutedOnce) {
+    for (const hg::PZInteger threadCount : {0, 1, 3}) {
+        WorkerGroup group{threadCount};
+        ASSERT_EQ(group.getWorkerCount(), threadCount + 1);
+
+        for (int batch = 0; batch < 20; batch += 1) {
+            std::vector<std::atomic<int>> counters(37);
+            std::vector<std::atomic<int>> workerUsage(hg::pztos(group.getWorkerCount()));
+
+            group.run(37, [&](hg::PZInteger aTaskIndex, hg::PZInteger aWorkerIndex) {
+                ASSERT_GE(aWorkerIndex, 0);
+                ASSERT_LT(aWorkerIndex, group.getWorkerCount());
+                // No two tasks may use the same worker index at the same time
+                EXPECT_EQ(workerUsage[hg::pztos(aWorkerIndex)].fetch_add(1), 0);
+                counters[hg::pztos(aTaskIndex)] += 1;
+                workerUsage[hg::pztos(aWorkerIndex)].fetch_sub(1);
+            });
+
+            for (const auto& counter : counters) {
+                EXPECT_EQ(counter.load(), 1);
+            }
+        }
+    }
+}
+
+TEST(WorkerGroupTest, ExceptionIsRethrownAfterAllTasksFinish) {
+    WorkerGroup      group{2};
+    std::atomic<int> finishedCount{0};
+
+    EXPECT_THROW(group.run(10,
+                           [&](hg::PZInteger aTaskIndex, hg::PZInteger) {
+                               if (aTaskIndex == 3) {
+                                   throw std::runtime_error{"task failed"};
+                               }
+                               finishedCount += 1;
+                           }),
+                 std::runtime_error);
+    EXPECT_EQ(finishedCount.load(), 9);
+
+    // The group is still usable afterwards
+    finishedCount = 0;
+    group.run(4, [&](hg::PZInteger, hg::PZInteger) {
+        finishedCount += 1;
+    });
+    EXPECT_EQ(finishedCount.load(), 4);
+}
+
+} // namespace detail
+} // namespace gridgoblin
+} // namespace jbatnozic
@@ -0,0 +1,133 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Navigation/World_cost_provider.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/Utility/Flow_field_spooler.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+using hg::util::COST_IMPASSABLE;
+
+class WorldCostProviderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        _fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+        _fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+        // Chunk (1, 1) is not loaded
+        const auto editPerm = _world.getPermissionToEdit();
+        (void)_world.getChunkAtId(*editPerm, {0, 0});
+        (void)_world.getChunkAtId(*editPerm, {1, 0});
+        (void)_world.getChunkAtId(*editPerm, {0, 1});
+    }
+
+    void _setWallAt(hg::PZInteger aX, hg::PZInteger aY, bool aWall) {
+        const auto editPerm = _world.getPermissionToEdit();
+        _world.edit(*editPerm, [=](World::Editor& aEditor) {
+            if (aWall) {
+                aEditor.setWallAt(aX, aY, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+            } else {
+                aEditor.setWallAt(aX, aY, std::nullopt);
+            }
+        });
+    }
+
+    test::FakeDiskIoHandler _fakeDiskIoHandler;
+
+    World _world{WorldConfig{.chunkCountX                 = 2,
+                             .chunkCountY                 = 2,
+                             .cellsPerChunkX              = 8,
+                             .cellsPerChunkY              = 8,
+                             .cellResolution              = 32.f,
+                             .maxCellOpenness             = 3,
+                             .maxLoadedNonessentialChunks = 4},
+                 &_fakeDiskIoHandler};
+};
+
+TEST_F(WorldCostProviderTest, CostsFollowTheCells) {
+    _setWallAt(4, 4, true);
+
+    WorldCostProvider provider{_world, {.baseCost = 2, .obstructedEdgeCost = 10}};
+
+    EXPECT_EQ(provider.getCostAt({1, 1}), 2);
+    EXPECT_EQ(provider.getCostAt({4, 4}), COST_IMPASSABLE);   // Wall
+    EXPECT_EQ(provider.getCostAt({3, 4}), 12);                // Next to wall
+    EXPECT_EQ(provider.getCostAt({12, 3}), 2);                // Other chunk
+    EXPECT_EQ(provider.getCostAt({12, 12}), COST_IMPASSABLE); // Unloaded chunk
+    EXPECT_EQ(provider.getCostAt({16, 3}), COST_IMPASSABLE);  // Outside of the world
+
+    // Costs don't change until refreshed
+    _setWallAt(1, 1, true);
+    EXPECT_EQ(provider.getCostAt({1, 1}), 2);
+
+    std::vector<WorldCostProvider::CellRect> changedRects;
+    EXPECT_EQ(provider.refresh([&](const auto& aRect) {
+        changedRects.push_back(aRect);
+    }),
+              1);
+    EXPECT_EQ(provider.getCostAt({1, 1}), COST_IMPASSABLE);
+    ASSERT_FALSE(changedRects.empty());
+    for (const auto& rect : changedRects) {
+        EXPECT_TRUE(rect.overlaps({1, 1, 1, 1}));
+    }
+
+    // Nothing changed since
+    EXPECT_EQ(provider.refresh(), 0);
+}
+
+TEST_F(WorldCostProviderTest, ObjectSizeIsTakenIntoAccount) {
+    _setWallAt(4, 4, true);
+
+    WorldCostProvider provider{_world, {.objectSize = 3}};
+
+    EXPECT_EQ(provider.getCostAt({4, 4}), COST_IMPASSABLE);
+    EXPECT_EQ(provider.getCostAt({3, 3}), COST_IMPASSABLE); // 3x3 square around it has the wall
+    EXPECT_EQ(provider.getCostAt({2, 2}), 1);
+}
+
+TEST_F(WorldCostProviderTest, WorksWithFlowFieldSpooler) {
+    // Wall between columns 0-2 and 4-7 of the top chunk, except at row 7
+    for (hg::PZInteger y = 0; y < 7; y += 1) {
+        _setWallAt(3, y, true);
+    }
+
+    WorldCostProvider                             provider{_world};
+    hg::util::FlowFieldSpooler<WorldCostProvider> spooler{{{0, &provider}}, 1};
+
+    auto id = spooler.addRequest({0, 0}, {16, 16}, {0, 0}, 0, 1);
+    spooler.tick();
+    auto result = spooler.collectResult(id);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_TRUE(result->flowField.at(0, 6).hasValue());    // Reachable around the wall
+    EXPECT_FALSE(result->flowField.at(0, 3).hasValue());   // Wall
+    EXPECT_FALSE(result->flowField.at(12, 12).hasValue()); // Unloaded chunk
+
+    // Close the gap (all the way down)
+    spooler.pause();
+    for (hg::PZInteger y = 7; y < 16; y += 1) {
+        _setWallAt(3, y, true);
+    }
+    EXPECT_EQ(provider.refresh(), 2);
+    spooler.unpause();
+
+    id = spooler.addRequest({0, 0}, {16, 16}, {0, 0}, 0, 1);
+    spooler.tick();
+    result = spooler.collectResult(id);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_FALSE(result->flowField.at(0, 6).hasValue()); // Not reachable anymore
+    EXPECT_TRUE(result->flowField.at(9, 1).hasValue());  // Same side of the wall
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
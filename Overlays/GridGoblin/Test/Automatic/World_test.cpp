@@ -1,6 +1,8 @@
 // Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
 // See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
 
+#include <GridGoblin/Private/Cell_openness.hpp>
+#include <GridGoblin/Private/Chunk_disk_io_handler_default.hpp>
 #include <GridGoblin/World/World.hpp>
 
 #include <Hobgoblin/Utility/Semaphore.hpp>
@@ -8,7 +10,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 
 #include "Fake_disk_io_handler.hpp"
@@ -24,6 +31,18 @@ protected:
     test::FakeDiskIoHandler _fakeDiskIoHandler;
     std::optional<World>    _world;
 
+    std::filesystem::path _chunkDirectory =
+        std::filesystem::temp_directory_path() / "gridgoblin_world_test";
+
+    void SetUp() override {
+        std::filesystem::remove_all(_chunkDirectory);
+    }
+
+    void TearDown() override {
+        _world.reset();
+        std::filesystem::remove_all(_chunkDirectory);
+    }
+
     World& _createWorld(const WorldConfig& aConfig) {
         _world.emplace(aConfig, &_fakeDiskIoHandler);
         return *_world;
@@ -38,6 +57,27 @@ protected:
                 .maxCellOpenness             = 5,
                 .maxLoadedNonessentialChunks = 1};
     }
+
+    //! Makes the fake disk I/O handler complete all operations without delay and returns the
+    //! default config, adjusted so that all of the World's chunks can stay loaded.
+    WorldConfig _makeInstantLoadingConfig() {
+        _fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+        _fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+        auto config                        = _makeDefaultConfig();
+        config.maxLoadedNonessentialChunks = 64;
+        return config;
+    }
+
+    //! Returns the default config, adjusted to store chunks in an empty directory which is
+    //! removed after the test (for tests which use a real disk I/O handler).
+    WorldConfig _makeOnDiskConfig() {
+        std::filesystem::create_directories(_chunkDirectory);
+
+        auto config               = _makeDefaultConfig();
+        config.chunkDirectoryPath = _chunkDirectory;
+        return config;
+    }
 };
 
 TEST_F(WorldTest, ChunkGetters) {
@@ -72,6 +112,348 @@ TEST_F(WorldTest, ChunkGetters) {
     w.prune();
 }
 
+TEST_F(WorldTest, PruneRespectsByteBudget) {
+    const auto chunkSize = static_cast<std::int64_t>(Chunk{8, 8}.getResidentSize());
+
+    auto config                  = _makeInstantLoadingConfig();
+    config.loadedChunkByteBudget = 3 * chunkSize + chunkSize / 2;
+
+    auto& w = _createWorld(config);
+    EXPECT_EQ(w.getResidentChunkByteCount(), 0);
+
+    const auto editPerm = w.getPermissionToEdit();
+    for (hg::PZInteger x = 0; x < 5; x += 1) {
+        (void)w.getChunkAtId(*editPerm, {x, 0});
+    }
+    EXPECT_EQ(w.getResidentChunkByteCount(), 5 * chunkSize);
+
+    // The least recently used chunks are unloaded first
+    w.prune();
+    EXPECT_EQ(w.getResidentChunkByteCount(), 3 * chunkSize);
+    EXPECT_EQ(w.getChunkAtId({0, 0}), nullptr);
+    EXPECT_EQ(w.getChunkAtId({1, 0}), nullptr);
+    EXPECT_NE(w.getChunkAtId({2, 0}), nullptr);
+    EXPECT_NE(w.getChunkAtId({3, 0}), nullptr);
+    EXPECT_NE(w.getChunkAtId({4, 0}), nullptr);
+}
+
+TEST_F(WorldTest, ActiveAreaPrefetch) {
+    auto config = _makeInstantLoadingConfig();
+
+    auto& w    = _createWorld(config);
+    auto  area = w.createActiveArea();
+
+    const auto waitUntilLoaded = [&](ChunkId aChunkId) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+        while (w.getChunkAtId(aChunkId) == nullptr && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            w.update();
+        }
+        ASSERT_NE(w.getChunkAtId(aChunkId), nullptr);
+    };
+
+    // Moving to the right
+    area.setToChunkRingSquareWithPrefetch({1, 1}, 0, {3, 1});
+    EXPECT_THAT(area.getChunkList(), testing::UnorderedElementsAre(ChunkId{1, 1}, ChunkId{3, 1}));
+    EXPECT_EQ(area.getPrefetchStats().requestCount, 1);
+    waitUntilLoaded({3, 1});
+
+    // Arrived where predicted; still moving to the right
+    area.setToChunkRingSquareWithPrefetch({3, 1}, 0, {5, 1});
+    EXPECT_THAT(area.getChunkList(), testing::UnorderedElementsAre(ChunkId{3, 1}, ChunkId{5, 1}));
+    EXPECT_EQ(area.getPrefetchStats().requestCount, 2);
+    EXPECT_EQ(area.getPrefetchStats().hitCount, 1);
+
+    // Turned around (chunk (1, 1) is still loaded, so it doesn't need to be requested)
+    area.setToChunkRingSquareWithPrefetch({3, 1}, 0, {1, 1});
+    EXPECT_THAT(area.getChunkList(), testing::UnorderedElementsAre(ChunkId{3, 1}, ChunkId{1, 1}));
+
+    // Arrived back; chunk (1, 1) wasn't loaded by the prefetch, so it's not a hit
+    area.setToChunkRingSquareWithPrefetch({1, 1}, 0, {1, 1});
+    EXPECT_THAT(area.getChunkList(), testing::UnorderedElementsAre(ChunkId{1, 1}));
+
+    const auto stats = area.getPrefetchStats();
+    EXPECT_EQ(stats.requestCount, 2);
+    EXPECT_EQ(stats.hitCount, 1);
+    EXPECT_EQ(stats.lateCount, 0);
+    EXPECT_EQ(stats.discardedCount, 1);
+}
+
+TEST_F(WorldTest, OpennessAndObstructionAreRefreshedAfterEdit) {
+    auto config                        = _makeInstantLoadingConfig();
+    config.chunkCountX                 = 3;
+    config.chunkCountY                 = 3;
+    config.maxLoadedNonessentialChunks = 9;
+
+    auto& w = _createWorld(config);
+
+    const auto editPerm = w.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < w.getChunkCountY(); y += 1) {
+        for (hg::PZInteger x = 0; x < w.getChunkCountX(); x += 1) {
+            (void)w.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setWallAt(12, 12, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+    });
+
+    static constexpr std::uint16_t OBSTRUCTION_FLAGS =
+        CellModel::RIGHT_EDGE_OBSTRUCTED | CellModel::TOP_EDGE_OBSTRUCTED |
+        CellModel::LEFT_EDGE_OBSTRUCTED | CellModel::BOTTOM_EDGE_OBSTRUCTED;
+
+    const auto checkCell = [&](hg::PZInteger aX,
+                               hg::PZInteger aY,
+                               std::uint8_t  aExpectedOpenness,
+                               std::uint16_t aExpectedObstruction) {
+        const auto& cell = w.getCellAt(*editPerm, aX, aY);
+        EXPECT_EQ(cell.getOpenness(), aExpectedOpenness) << "at (" << aX << ", " << aY << ")";
+        EXPECT_EQ(cell.getFlags() & OBSTRUCTION_FLAGS, aExpectedObstruction)
+            << "at (" << aX << ", " << aY << ")";
+    };
+
+    // Around the wall
+    checkCell(12, 12, 0, 0);
+    checkCell(13, 12, 2, CellModel::LEFT_EDGE_OBSTRUCTED);
+    checkCell(11, 12, 2, CellModel::RIGHT_EDGE_OBSTRUCTED);
+    checkCell(12, 11, 2, CellModel::BOTTOM_EDGE_OBSTRUCTED);
+    checkCell(13, 13, 2, 0);
+    checkCell(14, 12, 4, 0);
+    checkCell(15, 12, 5, 0);
+
+    // Near the edge of the world
+    checkCell(0, 5, 2, CellModel::LEFT_EDGE_OBSTRUCTED);
+    checkCell(1, 5, 4, 0);
+    checkCell(2, 5, 5, 0);
+    checkCell(0, 0, 2, CellModel::LEFT_EDGE_OBSTRUCTED | CellModel::TOP_EDGE_OBSTRUCTED);
+}
+
+TEST_F(WorldTest, OpennessIsRefreshedCorrectlyByWorkerThreads) {
+    auto config                        = _makeInstantLoadingConfig();
+    config.chunkCountX                 = 4;
+    config.chunkCountY                 = 4;
+    config.maxCellOpenness             = 7;
+    config.maxLoadedNonessentialChunks = 16;
+    config.cellRefreshWorkerCount      = 3;
+
+    auto& w = _createWorld(config);
+
+    const auto editPerm = w.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < w.getChunkCountY(); y += 1) {
+        for (hg::PZInteger x = 0; x < w.getChunkCountX(); x += 1) {
+            (void)w.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+
+    // Walls around chunk corners and edges, so that the refreshed areas span several chunks
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        for (const auto& [x, y] : std::vector<std::pair<int, int>>{
+                 {7, 7}, {8, 8}, {15, 16}, {16, 13}, {23, 24}, {20, 3}, {3, 28}, {30, 30}, {9, 22}}) {
+            aEditor.setWallAt(x, y, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+        }
+    });
+
+    const auto isCellSolid = [&](hg::PZInteger aX, hg::PZInteger aY) {
+        if (aX < 0 || aY < 0 || aX >= w.getCellCountX() || aY >= w.getCellCountY()) {
+            return true;
+        }
+        return w.getCellAt(*editPerm, aX, aY).isWallInitialized();
+    };
+
+    for (hg::PZInteger y = 0; y < w.getCellCountY(); y += 1) {
+        for (hg::PZInteger x = 0; x < w.getCellCountX(); x += 1) {
+            EXPECT_EQ(w.getCellAt(*editPerm, x, y).getOpenness(),
+                      detail::CalcOpennessByRings(x, y, config.maxCellOpenness, isCellSolid))
+                << "at (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST_F(WorldTest, DistantEditsOnlyRefreshCellsAroundThem) {
+    auto config = _makeInstantLoadingConfig();
+
+    auto& w = _createWorld(config);
+
+    const auto editPerm = w.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < w.getChunkCountY(); y += 1) {
+        for (hg::PZInteger x = 0; x < w.getChunkCountX(); x += 1) {
+            (void)w.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+
+    // Opposite corners of the world (maxCellOpenness is 5, so each edit affects the cells up to
+    // 2 cells away from it; 3x3 cells for each corner)
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setWallAt(0, 0, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+        aEditor.setWallAt(63, 63, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+        aEditor.setFloorAt(30, 30, CellModel::Floor{1}); // Floors don't affect openness
+    });
+
+    auto stats = w.getEditStats();
+    EXPECT_EQ(stats.editCount, 1);
+    EXPECT_EQ(stats.cellsEdited, 3);
+    EXPECT_EQ(stats.cellsRefreshed, 18);
+
+    EXPECT_EQ(w.getCellAt(*editPerm, 0, 0).getOpenness(), 0);
+    EXPECT_EQ(w.getCellAt(*editPerm, 63, 63).getOpenness(), 0);
+    EXPECT_EQ(w.getCellAt(*editPerm, 62, 62).getOpenness(), 2);
+
+    // Edits across a chunk boundary are split between 4 chunks: cells 6..10 x 6..10
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setWallAt(8, 8, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+    });
+
+    stats = w.getEditStats();
+    EXPECT_EQ(stats.editCount, 2);
+    EXPECT_EQ(stats.cellsEdited, 4);
+    EXPECT_EQ(stats.cellsRefreshed, 18 + 25);
+    EXPECT_EQ(w.getCellAt(*editPerm, 7, 7).getOpenness(), 2);
+    EXPECT_EQ(w.getCellAt(*editPerm, 10, 10).getOpenness(), 4);
+}
+
+TEST_F(WorldTest, FloorEditsAreRecordedAsCellChanges) {
+    auto config = _makeInstantLoadingConfig();
+
+    auto& w = _createWorld(config);
+
+    const auto editPerm = w.getPermissionToEdit();
+    (void)w.getChunkAtId(*editPerm, {1, 1});
+
+    const auto generation = w.getCellGeneration();
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setFloorAt(9, 10, CellModel::Floor{1});
+        aEditor.setFloorAt(12, 11, CellModel::Floor{1});
+    });
+
+    // Nothing needed to be refreshed, but the change must still be visible to the observers
+    EXPECT_EQ(w.getEditStats().cellsRefreshed, 0);
+    EXPECT_GT(w.getCellGeneration(), generation);
+
+    std::vector<hg::math::Rectangle<hg::PZInteger>> changes;
+    EXPECT_TRUE(w.forEachCellChangeSince(generation,
+                                         [&changes](const hg::math::Rectangle<hg::PZInteger>& aRect) {
+                                             changes.push_back(aRect);
+                                         }));
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].x, 9);
+    EXPECT_EQ(changes[0].y, 10);
+    EXPECT_EQ(changes[0].w, 4);
+    EXPECT_EQ(changes[0].h, 2);
+}
+
+TEST_F(WorldTest, CastRay) {
+    auto config = _makeInstantLoadingConfig();
+
+    auto& w = _createWorld(config);
+
+    // Only the top row of chunks is loaded
+    const auto editPerm = w.getPermissionToEdit();
+    for (hg::PZInteger x = 0; x < 8; x += 1) {
+        (void)w.getChunkAtId(*editPerm, {x, 0});
+    }
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setWallAt(10, 3, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+        aEditor.setWallAt(4, 6, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+    });
+
+    const auto expectResult = [&w](Ray                    aRay,
+                                   RaycastResult::Outcome aOutcome,
+                                   hg::math::Vector2pz    aCell,
+                                   RaycastResult::Edge    aEdge,
+                                   hg::math::Vector2f     aPosition) {
+        const auto result = w.castRay(aRay);
+        EXPECT_EQ(static_cast<int>(result.outcome), static_cast<int>(aOutcome));
+        EXPECT_EQ(result.cell, aCell);
+        EXPECT_EQ(static_cast<int>(result.edge), static_cast<int>(aEdge));
+        EXPECT_NEAR(result.position->x, aPosition.x, 0.01f);
+        EXPECT_NEAR(result.position->y, aPosition.y, 0.01f);
+    };
+
+    // Walls, from both sides
+    expectResult({{80.f, 112.f}, {400.f, 112.f}},
+                 RaycastResult::HIT_WALL,
+                 {10, 3},
+                 RaycastResult::LEFT_EDGE,
+                 {320.f, 112.f});
+    expectResult({{400.f, 112.f}, {80.f, 112.f}},
+                 RaycastResult::HIT_WALL,
+                 {10, 3},
+                 RaycastResult::RIGHT_EDGE,
+                 {352.f, 112.f});
+    expectResult({{144.f, 16.f}, {144.f, 240.f}},
+                 RaycastResult::HIT_WALL,
+                 {4, 6},
+                 RaycastResult::TOP_EDGE,
+                 {144.f, 192.f});
+    expectResult({{336.f, 100.f}, {400.f, 112.f}},
+                 RaycastResult::HIT_WALL,
+                 {10, 3},
+                 RaycastResult::NO_EDGE,
+                 {336.f, 100.f});
+
+    // Nothing in the way (across a chunk boundary)
+    expectResult({{80.f, 40.f}, {500.f, 40.f}},
+                 RaycastResult::REACHED_TARGET,
+                 {15, 1},
+                 RaycastResult::LEFT_EDGE,
+                 {500.f, 40.f});
+    EXPECT_FALSE(w.castRay({{80.f, 112.f}, {500.f, 40.f}}).isBlocked());
+
+    // Unloaded chunk
+    expectResult({{80.f, 112.f}, {80.f, 400.f}},
+                 RaycastResult::HIT_UNLOADED_CHUNK,
+                 {2, 8},
+                 RaycastResult::TOP_EDGE,
+                 {80.f, 256.f});
+
+    // Out of the world
+    expectResult({{80.f, 112.f}, {80.f, -50.f}},
+                 RaycastResult::LEFT_WORLD,
+                 {2, 0},
+                 RaycastResult::TOP_EDGE,
+                 {80.f, 0.f});
+}
+
+TEST_F(WorldTest, CastRaysGivesSameResultsAsCastRay) {
+    auto config = _makeInstantLoadingConfig();
+    config.raycastWorkerCount          = 3;
+
+    auto& w = _createWorld(config);
+
+    const auto editPerm = w.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < 6; y += 1) {
+        for (hg::PZInteger x = 0; x < 8; x += 1) {
+            (void)w.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        for (hg::PZInteger i = 0; i < 64; i += 1) {
+            aEditor.setWallAt((i * 7) % 64, (i * 13) % 64, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+        }
+    });
+
+    std::vector<Ray> rays;
+    for (hg::PZInteger i = 0; i < 1000; i += 1) {
+        const float angle = static_cast<float>(i) * 0.0063f;
+        rays.push_back({{1024.f, 1024.f},
+                        {1024.f + std::cos(angle) * 1500.f, 1024.f + std::sin(angle) * 1500.f}});
+    }
+
+    std::vector<RaycastResult> results;
+    w.castRays(rays, results);
+    ASSERT_EQ(results.size(), rays.size());
+
+    hg::PZInteger blockedCount = 0;
+    for (std::size_t i = 0; i < rays.size(); i += 1) {
+        const auto expected = w.castRay(rays[i]);
+        EXPECT_EQ(results[i].outcome, expected.outcome);
+        EXPECT_EQ(results[i].cell, expected.cell);
+        EXPECT_EQ(results[i].edge, expected.edge);
+        blockedCount += results[i].isBlocked() ? 1 : 0;
+    }
+    EXPECT_GT(blockedCount, 0);
+}
+
 TEST_F(WorldTest, AvailableChunkIterations) {
     _fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{5});
     _fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{5});
@@ -171,5 +553,178 @@ TEST_F(WorldTest, AvailableChunkIterations) {
     // clang-format on
 }
 
+namespace {
+//! Disk I/O handler which forwards everything to the default one, but can hold loads from the
+//! runtime cache (after the chunk was already taken from the cache) until they are released.
+class HoldingDiskIoHandler : public detail::ChunkDiskIoHandlerInterface {
+public:
+    explicit HoldingDiskIoHandler(const WorldConfig& aConfig)
+        : _handler{aConfig} {}
+
+    void setHoldLoads(bool aHoldLoads) {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _holdLoads = aHoldLoads;
+        }
+        _cv.notify_all();
+    }
+
+    void waitUntilLoadsHeld(int aCount) {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _cv.wait(lock, [&]() {
+            return _heldLoadCount >= aCount;
+        });
+    }
+
+    void waitUntilStored(int aCount) {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _cv.wait(lock, [&]() {
+            return _storeCount >= aCount;
+        });
+    }
+
+    void setBinder(Binder* aBinder) override {
+        _handler.setBinder(aBinder);
+    }
+
+    std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId, bool& aIsUnsaved) override {
+        auto result = _handler.loadChunkFromRuntimeCache(aChunkId, aIsUnsaved);
+
+        std::unique_lock<std::mutex> lock{_mutex};
+        if (_holdLoads) {
+            _heldLoadCount += 1;
+            _cv.notify_all();
+            _cv.wait(lock, [this]() {
+                return !_holdLoads;
+            });
+        }
+        return result;
+    }
+
+    void storeChunkInRuntimeCache(const Chunk& aChunk, ChunkId aChunkId) override {
+        _handler.storeChunkInRuntimeCache(aChunk, aChunkId);
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _storeCount += 1;
+        }
+        _cv.notify_all();
+    }
+
+    std::optional<Chunk> loadChunkFromPersistentCache(ChunkId aChunkId) override {
+        return _handler.loadChunkFromPersistentCache(aChunkId);
+    }
+
+    void storeChunkInPersistentCache(const Chunk& aChunk, ChunkId aChunkId) override {
+        _handler.storeChunkInPersistentCache(aChunk, aChunkId);
+        _persistentStoreCount += 1;
+    }
+
+    //! Returns the number of chunks stored in the persistent cache directly (not by dumping the
+    //! runtime cache).
+    int getPersistentStoreCount() const {
+        return _persistentStoreCount.load();
+    }
+
+    void dumpRuntimeCache() override {
+        _handler.dumpRuntimeCache();
+    }
+
+private:
+    detail::DefaultChunkDiskIoHandler _handler;
+
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    bool                    _holdLoads     = false;
+    int                     _heldLoadCount = 0;
+    int                     _storeCount    = 0;
+
+    std::atomic<int> _persistentStoreCount{0};
+};
+} // namespace
+
+TEST_F(WorldTest, UnsavedEditsSurviveCancelledReload) {
+    auto config                        = _makeOnDiskConfig();
+    config.maxLoadedNonessentialChunks = 0;
+
+    HoldingDiskIoHandler handler{config};
+    World                w{config, &handler};
+
+    const auto editPerm = w.getPermissionToEdit();
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setFloorAt(1, 1, CellModel::Floor{123});
+    });
+
+    // Edited chunk goes to the runtime cache, without being written to disk
+    w.prune();
+    ASSERT_EQ(w.getChunkAtId({0, 0}), nullptr);
+    handler.waitUntilStored(1);
+
+    // Reload is cancelled after the chunk was already taken from the runtime cache
+    handler.setHoldLoads(true);
+    auto area = w.createActiveArea();
+    area.setToChunkList({ChunkId{0, 0}});
+    handler.waitUntilLoadsHeld(1);
+    area.setToNone();
+    handler.setHoldLoads(false);
+    w.update();
+    EXPECT_EQ(w.getChunkAtId({0, 0}), nullptr);
+
+    // Reload
+    const auto& cell = w.getCellAt(*editPerm, 1, 1);
+    ASSERT_TRUE(cell.isFloorInitialized());
+    EXPECT_EQ(cell.getFloor().spriteId, 123);
+}
+
+TEST_F(WorldTest, ChunkReloadedWithUnsavedEditsIsSaved) {
+    auto config                        = _makeOnDiskConfig();
+    config.maxLoadedNonessentialChunks = 0;
+
+    HoldingDiskIoHandler handler{config};
+    World                w{config, &handler};
+
+    const auto editPerm = w.getPermissionToEdit();
+    w.edit(*editPerm, [](World::Editor& aEditor) {
+        aEditor.setFloorAt(1, 1, CellModel::Floor{123});
+    });
+
+    // Edited chunk goes to the runtime cache, without being written to disk
+    w.prune();
+    handler.waitUntilStored(1);
+
+    // Reloaded chunk is still considered modified, so it's saved like any other
+    (void)w.getChunkAtId(*editPerm, {0, 0});
+    w.saveAsync().get();
+    EXPECT_EQ(handler.getPersistentStoreCount(), 1);
+
+    // Once saved, it's not saved again
+    w.saveAsync().get();
+    EXPECT_EQ(handler.getPersistentStoreCount(), 1);
+}
+
+TEST_F(WorldTest, ImmediateLoadCanBeRetriedAfterTimeout) {
+    auto config                      = _makeOnDiskConfig();
+    config.immediateChunkLoadTimeout = std::chrono::milliseconds{20};
+
+    HoldingDiskIoHandler handler{config};
+    World                w{config, &handler};
+
+    // Keep the (only) spooler worker busy
+    handler.setHoldLoads(true);
+    auto area = w.createActiveArea();
+    area.setToChunkList({ChunkId{0, 0}});
+    handler.waitUntilLoadsHeld(1);
+
+    const auto editPerm = w.getPermissionToEdit();
+    EXPECT_THROW((void)w.getChunkAtId(*editPerm, {1, 0}), hg::TracedRuntimeError);
+
+    // Times out again (instead of the spooler rejecting a duplicate request)
+    EXPECT_THROW((void)w.getChunkAtId(*editPerm, {1, 0}), hg::TracedRuntimeError);
+    EXPECT_EQ(w.getChunkAtId({1, 0}), nullptr);
+
+    handler.setHoldLoads(false);
+    EXPECT_NO_THROW((void)w.getChunkAtId(*editPerm, {1, 0}));
+    EXPECT_NE(w.getChunkAtId({1, 0}), nullptr);
+}
+
 } // namespace gridgoblin
 } // namespace jbatnozic
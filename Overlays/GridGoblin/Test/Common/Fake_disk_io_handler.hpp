@@ -8,6 +8,9 @@
 #include <GridGoblin/Model/Chunk.hpp>
 #include <GridGoblin/Private/Model_conversions.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <thread>
@@ -17,6 +20,10 @@ namespace jbatnozic {
 namespace gridgoblin {
 namespace test {
 
+//! In-memory disk I/O handler which keeps chunks as JSON strings.
+//!
+//! All methods are thread-safe (as required by `ChunkDiskIoHandlerInterface`); the delays are
+//! only meant to be set before the handler is in use.
 class FakeDiskIoHandler : public detail::ChunkDiskIoHandlerInterface {
 public:
     void setRuntimeCacheDelay(std::chrono::milliseconds aDelay) {
@@ -27,27 +34,37 @@ public:
         _persistentCacheDelay = aDelay;
     }
 
+    //! Returns the total number of bytes passed to the runtime and persistent caches so far (as
+    //! JSON strings, so this is not comparable to what a real handler would write).
+    std::int64_t getWrittenByteCount() const {
+        return _writtenByteCount.load();
+    }
+
     void setBinder(Binder*) override {}
 
-    std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId) override {
+    std::optional<Chunk> loadChunkFromRuntimeCache(ChunkId aChunkId, bool& aIsUnsaved) override {
         std::this_thread::sleep_for(std::chrono::milliseconds{_runtimeCacheDelay});
 
-        const auto iter = _runtimeCache.find(aChunkId);
+        std::lock_guard<std::mutex> lock{_mutex};
+        const auto                  iter = _runtimeCache.find(aChunkId);
         if (iter == _runtimeCache.end()) {
             return {};
         }
+        // Entries only get to the persistent cache when the runtime cache is dumped
+        aIsUnsaved = true;
         return detail::JsonStringToChunk(iter->second);
     }
 
     void storeChunkInRuntimeCache(const Chunk& aChunk, ChunkId aChunkId) override {
         std::this_thread::sleep_for(std::chrono::milliseconds{_runtimeCacheDelay});
-        _runtimeCache[aChunkId] = detail::ChunkToJsonString(aChunk);
+        _store(_runtimeCache, aChunk, aChunkId);
     }
 
     std::optional<Chunk> loadChunkFromPersistentCache(ChunkId aChunkId) override {
         std::this_thread::sleep_for(std::chrono::milliseconds{_persistentCacheDelay});
 
-        const auto iter = _persistentCache.find(aChunkId);
+        std::lock_guard<std::mutex> lock{_mutex};
+        const auto                  iter = _persistentCache.find(aChunkId);
         if (iter == _persistentCache.end()) {
             return {};
         }
@@ -56,10 +73,11 @@ public:
 
     void storeChunkInPersistentCache(const Chunk& aChunk, ChunkId aChunkId) override {
         std::this_thread::sleep_for(std::chrono::milliseconds{_persistentCacheDelay});
-        _persistentCache[aChunkId] = detail::ChunkToJsonString(aChunk);
+        _store(_persistentCache, aChunk, aChunkId);
     }
 
     void dumpRuntimeCache() override {
+        std::lock_guard<std::mutex> lock{_mutex};
         for (auto& [key, value] : _runtimeCache) {
             _persistentCache[key] = std::move(value);
         }
@@ -67,11 +85,26 @@ public:
     }
 
 private:
+    // The spooler can have several workers calling into the handler at the same time
+    std::mutex _mutex;
+
     std::unordered_map<ChunkId, std::string> _runtimeCache;
     std::unordered_map<ChunkId, std::string> _persistentCache;
 
     std::chrono::milliseconds _runtimeCacheDelay    = std::chrono::milliseconds{50};
     std::chrono::milliseconds _persistentCacheDelay = std::chrono::milliseconds{50};
+
+    std::atomic<std::int64_t> _writtenByteCount{0};
+
+    void _store(std::unordered_map<ChunkId, std::string>& aCache,
+                const Chunk&                              aChunk,
+                ChunkId                                   aChunkId) {
+        auto string = detail::ChunkToJsonString(aChunk);
+        _writtenByteCount += static_cast<std::int64_t>(string.size());
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        aCache[aChunkId] = std::move(string);
+    }
 };
 
 } // namespace test
@@ -0,0 +1,13 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#pragma once
+
+void RunCellLayoutBenchmark();
+void RunCellOpennessBenchmark();
+void RunChunkConversionsBenchmark();
+void RunDimetricRendererBenchmark();
+void RunDrawingOrderBenchmark();
+void RunRaycastBenchmark();
+void RunStreamingBenchmark();
+void RunVisibilityCalculatorBenchmark();
@@ -0,0 +1,127 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Cell_grid.hpp>
+#include <GridGoblin/Private/Cell_openness.hpp>
+#include <GridGoblin/Private/Cell_planes.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/Utility/Time_utils.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Benchmark_list.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin.PerformanceTest";
+
+constexpr hg::PZInteger WORLD_WIDTH       = 1024;
+constexpr hg::PZInteger WORLD_HEIGHT      = 1024;
+constexpr std::uint8_t  MAX_CELL_OPENNESS = 7;
+
+detail::CellGrid MakeBenchmarkGrid() {
+    detail::CellGrid grid{WORLD_WIDTH, WORLD_HEIGHT};
+
+    // Scattered walls (roughly 1 in 16 cells), so that openness values are varied
+    std::uint32_t state = 12345;
+    for (hg::PZInteger y = 0; y < WORLD_HEIGHT; y += 1) {
+        for (hg::PZInteger x = 0; x < WORLD_WIDTH; x += 1) {
+            state = state * 1664525u + 1013904223u;
+            grid[y][x].setFloor({1});
+            if ((state >> 28) == 0) {
+                grid[y][x].setWall({2, 3, Shape::FULL_SQUARE});
+            }
+        }
+    }
+
+    return grid;
+}
+
+template <class taIsCellSolid>
+std::uint64_t RunOpennessPass(taIsCellSolid&& aIsCellSolid) {
+    std::uint64_t checksum = 0;
+    for (hg::PZInteger y = 0; y < WORLD_HEIGHT; y += 1) {
+        for (hg::PZInteger x = 0; x < WORLD_WIDTH; x += 1) {
+            checksum += detail::CalcOpennessByRings(x, y, MAX_CELL_OPENNESS, aIsCellSolid);
+        }
+    }
+    return checksum;
+}
+} // namespace
+
+void RunCellLayoutBenchmarkImpl() {
+    using std::chrono::microseconds;
+
+    const auto grid = MakeBenchmarkGrid();
+
+    HG_LOG_INFO(LOG_ID,
+                "Cell layout benchmark (full openness pass over {}x{} cells, max openness {}):",
+                WORLD_WIDTH,
+                WORLD_HEIGHT,
+                MAX_CELL_OPENNESS);
+
+    // Array of structures: every lookup touches a whole cell
+    std::uint64_t aosChecksum;
+    {
+        const auto isCellSolid = [&grid](hg::PZInteger aX, hg::PZInteger aY) -> bool {
+            if (aX < 0 || aX >= WORLD_WIDTH || aY < 0 || aY >= WORLD_HEIGHT) {
+                return true;
+            }
+            return grid[aY][aX].isWallInitialized();
+        };
+
+        hg::util::Stopwatch stopwatch;
+        aosChecksum     = RunOpennessPass(isCellSolid);
+        const auto time = stopwatch.getElapsedTime<microseconds>();
+
+        HG_LOG_INFO(LOG_ID,
+                    "AoS    | pass: {:>8.2f}ms | bytes per cell scanned: {}",
+                    static_cast<double>(time.count()) / 1000.0,
+                    sizeof(detail::CellModelExt));
+    }
+
+    // Structure of arrays: lookups only touch the flags plane
+    std::uint64_t soaChecksum;
+    {
+        detail::CellPlanes  planes;
+        hg::util::Stopwatch stopwatch;
+
+        planes.reset(WORLD_WIDTH, WORLD_HEIGHT, detail::CellPlanes::FLAGS);
+        for (hg::PZInteger y = 0; y < WORLD_HEIGHT; y += 1) {
+            planes.loadRow(0, y, grid[y], WORLD_WIDTH);
+        }
+        const auto extractionTime = stopwatch.restart<microseconds>();
+
+        const auto* flags       = planes.getFlagsPlane();
+        const auto  isCellSolid = [flags](hg::PZInteger aX, hg::PZInteger aY) -> bool {
+            if (aX < 0 || aX >= WORLD_WIDTH || aY < 0 || aY >= WORLD_HEIGHT) {
+                return true;
+            }
+            return (flags[aY * WORLD_WIDTH + aX] & CellModel::WALL_INITIALIZED) != 0;
+        };
+
+        soaChecksum     = RunOpennessPass(isCellSolid);
+        const auto time = stopwatch.getElapsedTime<microseconds>();
+
+        HG_LOG_INFO(LOG_ID,
+                    "SoA    | pass: {:>8.2f}ms | bytes per cell scanned: {} (+{:.2f}ms extraction)",
+                    static_cast<double>(time.count()) / 1000.0,
+                    sizeof(std::uint16_t),
+                    static_cast<double>(extractionTime.count()) / 1000.0);
+    }
+
+    HG_HARD_ASSERT(aosChecksum == soaChecksum);
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
+
+void RunCellLayoutBenchmark() {
+    jbatnozic::gridgoblin::RunCellLayoutBenchmarkImpl();
+}
@@ -0,0 +1,117 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Private/Cell_openness.hpp>
+#include <GridGoblin/Private/Cell_planes.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/Utility/Time_utils.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Benchmark_list.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin.PerformanceTest";
+
+constexpr hg::PZInteger WORLD_WIDTH  = 1024;
+constexpr hg::PZInteger WORLD_HEIGHT = 1024;
+
+//! Planes holding the whole world plus a solid margin around it, with scattered walls (roughly
+//! 1 in 16 cells) so that openness values are varied.
+detail::CellPlanes MakeBenchmarkPlanes(hg::PZInteger aMargin) {
+    detail::CellPlanes planes;
+    planes.reset(WORLD_WIDTH + 2 * aMargin,
+                 WORLD_HEIGHT + 2 * aMargin,
+                 detail::CellPlanes::FLAGS | detail::CellPlanes::OPENNESS);
+
+    std::uint32_t state = 12345;
+    for (hg::PZInteger y = 0; y < planes.getHeight(); y += 1) {
+        auto* flags = planes.getFlagsRow(y);
+        for (hg::PZInteger x = 0; x < planes.getWidth(); x += 1) {
+            state = state * 1664525u + 1013904223u;
+
+            const bool inWorld = (x >= aMargin && y >= aMargin && x < WORLD_WIDTH + aMargin &&
+                                  y < WORLD_HEIGHT + aMargin);
+            const bool isWall  = !inWorld || (state >> 28) == 0;
+            flags[x] = isWall ? CellModel::WALL_INITIALIZED : CellModel::FLOOR_INITIALIZED;
+        }
+    }
+
+    return planes;
+}
+
+void RunOpennessComparison(std::uint8_t aMaxCellOpenness) {
+    using std::chrono::microseconds;
+
+    const auto margin = std::max<hg::PZInteger>(1, aMaxCellOpenness / 2);
+    auto       planes = MakeBenchmarkPlanes(margin);
+
+    // Ring check (one cell at a time)
+    std::vector<std::uint8_t> ringResults(hg::pztos(WORLD_WIDTH * WORLD_HEIGHT));
+    microseconds              ringTime;
+    {
+        const auto* flags       = planes.getFlagsPlane();
+        const auto  planesWidth = planes.getWidth();
+        const auto  isCellSolid = [=](hg::PZInteger aX, hg::PZInteger aY) -> bool {
+            const auto index = (aY + margin) * planesWidth + (aX + margin);
+            return (flags[index] & CellModel::WALL_INITIALIZED) != 0;
+        };
+
+        hg::util::Stopwatch stopwatch;
+        for (hg::PZInteger y = 0; y < WORLD_HEIGHT; y += 1) {
+            for (hg::PZInteger x = 0; x < WORLD_WIDTH; x += 1) {
+                ringResults[hg::pztos(y * WORLD_WIDTH + x)] =
+                    detail::CalcOpennessByRings(x, y, aMaxCellOpenness, isCellSolid);
+            }
+        }
+        ringTime = stopwatch.getElapsedTime<microseconds>();
+    }
+
+    // Free square transform (whole plane at once)
+    microseconds planeTime;
+    {
+        std::vector<std::uint8_t> scratch;
+        hg::util::Stopwatch       stopwatch;
+        detail::CalcOpennessInPlanes(planes, margin, aMaxCellOpenness, scratch);
+        planeTime = stopwatch.getElapsedTime<microseconds>();
+    }
+
+    for (hg::PZInteger y = 0; y < WORLD_HEIGHT; y += 1) {
+        const auto* row = planes.getOpennessRow(y + margin) + margin;
+        HG_HARD_ASSERT(std::equal(row, row + WORLD_WIDTH, ringResults.data() + (y * WORLD_WIDTH)));
+    }
+
+    HG_LOG_INFO(LOG_ID,
+                "max openness {:>2} | rings: {:>8.2f}ms | planes: {:>8.2f}ms | speedup: {:.1f}x",
+                aMaxCellOpenness,
+                static_cast<double>(ringTime.count()) / 1000.0,
+                static_cast<double>(planeTime.count()) / 1000.0,
+                static_cast<double>(ringTime.count()) / std::max<double>(1.0, planeTime.count()));
+}
+} // namespace
+
+void RunCellOpennessBenchmarkImpl() {
+    HG_LOG_INFO(LOG_ID,
+                "Cell openness benchmark (full openness pass over {}x{} cells):",
+                WORLD_WIDTH,
+                WORLD_HEIGHT);
+
+    for (const std::uint8_t maxCellOpenness : {3, 7, 15}) {
+        RunOpennessComparison(maxCellOpenness);
+    }
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
+
+void RunCellOpennessBenchmark() {
+    jbatnozic::gridgoblin::RunCellOpennessBenchmarkImpl();
+}
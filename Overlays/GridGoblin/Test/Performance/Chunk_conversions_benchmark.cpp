@@ -0,0 +1,148 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Model/Chunk.hpp>
+#include <GridGoblin/Model/Chunk_extension.hpp>
+#include <GridGoblin/Private/Model_conversions.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/Utility/Stream.hpp>
+#include <Hobgoblin/Utility/Time_utils.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Benchmark_list.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin.PerformanceTest";
+
+constexpr hg::PZInteger CHUNK_WIDTH     = 64;
+constexpr hg::PZInteger CHUNK_HEIGHT    = 64;
+constexpr int           ITERATION_COUNT = 200;
+
+class BenchmarkChunkExtension : public ChunkExtensionInterface {
+public:
+    std::string payload;
+
+    SerializationMethod getPreferredSerializationMethod() const override {
+        return SerializationMethod::BINARY_STREAM;
+    }
+
+    void serialize(hg::util::OutputStream& aOStream) const override {
+        aOStream << payload;
+    }
+
+    void deserialize(hg::util::InputStream& aIStream) override {
+        aIStream >> payload;
+    }
+
+    std::int64_t getUniqueIdentifier() const override {
+        return 0;
+    }
+
+    const std::type_info& getTypeInfo() const override {
+        return typeid(BenchmarkChunkExtension);
+    }
+};
+
+std::unique_ptr<ChunkExtensionInterface> CreateExtension(const Chunk&) {
+    return std::make_unique<BenchmarkChunkExtension>();
+}
+
+Chunk MakeBenchmarkChunk() {
+    Chunk chunk{CHUNK_WIDTH, CHUNK_HEIGHT};
+
+    for (hg::PZInteger y = 0; y < CHUNK_HEIGHT; y += 1) {
+        for (hg::PZInteger x = 0; x < CHUNK_WIDTH; x += 1) {
+            auto& cell = chunk.getCellAtUnchecked(x, y);
+            cell.setFloor({static_cast<SpriteId>((x * 7 + y) % 100)});
+            if ((x + y * 3) % 5 == 0) {
+                cell.setWall({static_cast<SpriteId>(100 + x % 10), 200, Shape::FULL_SQUARE});
+            }
+            cell.setOpenness(static_cast<std::uint8_t>((x + y) % 4));
+        }
+    }
+
+    auto extension     = std::make_unique<BenchmarkChunkExtension>();
+    extension->payload = std::string(1024, 'x');
+    chunk.setExtension(std::move(extension));
+
+    return chunk;
+}
+
+void ReportResult(const char*               aFormat,
+                  std::chrono::microseconds aStoreTime,
+                  std::chrono::microseconds aLoadTime,
+                  std::size_t               aByteCount) {
+    HG_LOG_INFO(LOG_ID,
+                "{:<6} | store: {:>8.2f}us/chunk | load: {:>8.2f}us/chunk | size: {:>8} bytes",
+                aFormat,
+                static_cast<double>(aStoreTime.count()) / ITERATION_COUNT,
+                static_cast<double>(aLoadTime.count()) / ITERATION_COUNT,
+                aByteCount);
+}
+} // namespace
+
+void RunChunkConversionsBenchmarkImpl() {
+    using namespace detail;
+    using std::chrono::microseconds;
+
+    const auto                 chunk = MakeBenchmarkChunk();
+    ReusableConversionBuffers* rcb   = NewReusableConversionBuffers();
+
+    HG_LOG_INFO(LOG_ID,
+                "Chunk conversions benchmark ({}x{} cells, {} iterations):",
+                CHUNK_WIDTH,
+                CHUNK_HEIGHT,
+                ITERATION_COUNT);
+
+    // JSON
+    {
+        std::string         json;
+        hg::util::Stopwatch stopwatch;
+        for (int i = 0; i < ITERATION_COUNT; i += 1) {
+            json = ChunkToJsonString(chunk, rcb);
+        }
+        const auto storeTime = stopwatch.restart<microseconds>();
+        for (int i = 0; i < ITERATION_COUNT; i += 1) {
+            const auto result = JsonStringToChunk(json, CreateExtension, rcb);
+            HG_HARD_ASSERT(result.getCellCountX() == CHUNK_WIDTH);
+        }
+        const auto loadTime = stopwatch.getElapsedTime<microseconds>();
+        ReportResult("JSON", storeTime, loadTime, json.size());
+    }
+
+    // Binary
+    {
+        hg::util::BufferStream buffer;
+        hg::util::Stopwatch    stopwatch;
+        for (int i = 0; i < ITERATION_COUNT; i += 1) {
+            buffer.clear();
+            ChunkToBinary(chunk, buffer, rcb);
+        }
+        const auto storeTime = stopwatch.restart<microseconds>();
+        for (int i = 0; i < ITERATION_COUNT; i += 1) {
+            hg::util::ViewStream vstream{buffer.getData(), buffer.getDataSize()};
+            const auto           result = BinaryToChunk(vstream, CreateExtension, rcb);
+            HG_HARD_ASSERT(result.getCellCountX() == CHUNK_WIDTH);
+        }
+        const auto loadTime = stopwatch.getElapsedTime<microseconds>();
+        ReportResult("Binary", storeTime, loadTime, hg::pztos(buffer.getDataSize()));
+    }
+
+    DeleteReusableConversionBuffers(rcb);
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
+
+void RunChunkConversionsBenchmark() {
+    jbatnozic::gridgoblin::RunChunkConversionsBenchmarkImpl();
+}
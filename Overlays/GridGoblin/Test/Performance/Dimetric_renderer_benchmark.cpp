@@ -0,0 +1,165 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Rendering/Dimetric_renderer.hpp>
+#include <GridGoblin/Spatial/Position_conversions.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/Graphics.hpp>
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/Utility/Time_utils.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+#include "Benchmark_list.hpp"
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin.PerformanceTest";
+
+constexpr hg::PZInteger CHUNK_COUNT     = 16;
+constexpr hg::PZInteger CELLS_PER_CHUNK = 16;
+constexpr hg::PZInteger CELL_COUNT      = CHUNK_COUNT * CELLS_PER_CHUNK;
+constexpr float         CELL_RESOLUTION = 32.f;
+constexpr hg::PZInteger FRAMES          = 200;
+constexpr hg::PZInteger EDIT_PERIOD     = 20; //!< A single floor is edited every this many frames
+
+#define SPR_STONE_TILE 0
+#define SPR_WALL       1
+#define SPR_WALL_SHORT 2
+
+//! Covers the whole world with floors, and puts walls on roughly 1 in 8 cells.
+void FillWorld(World& aWorld) {
+    const auto editPerm = aWorld.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < CHUNK_COUNT; y += 1) {
+        for (hg::PZInteger x = 0; x < CHUNK_COUNT; x += 1) {
+            (void)aWorld.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+
+    aWorld.edit(*editPerm, [](World::Editor& aEditor) {
+        std::uint32_t state = 12345;
+        for (hg::PZInteger y = 0; y < CELL_COUNT; y += 1) {
+            for (hg::PZInteger x = 0; x < CELL_COUNT; x += 1) {
+                aEditor.setFloorAt(x, y, CellModel::Floor{SPR_STONE_TILE});
+
+                state = state * 1664525u + 1013904223u;
+                if ((state >> 29) == 0) {
+                    aEditor.setWallAt(x,
+                                      y,
+                                      CellModel::Wall{SPR_WALL, SPR_WALL_SHORT, Shape::FULL_SQUARE});
+                }
+            }
+        }
+    });
+}
+
+struct BenchmarkResult {
+    std::chrono::microseconds time{0};
+    std::int64_t              cellObjectCount      = 0;
+    std::int64_t              generatedVertexCount = 0;
+    std::int64_t              cachedVertexCount    = 0;
+    std::int64_t              rebuiltChunkCount    = 0;
+};
+
+//! Prepares `FRAMES` frames (without drawing them, so no window is needed) with the view slowly
+//! panning across the world and an occasional edit, as a typical game would.
+BenchmarkResult RunFrames(World& aWorld, const hg::gr::SpriteLoader& aLoader, bool aCacheChunkGeometry) {
+    DimetricRenderer renderer{aWorld, aLoader, {.cacheChunkGeometry = aCacheChunkGeometry}};
+
+    const float worldSize = CELL_COUNT * CELL_RESOLUTION;
+
+    BenchmarkResult result;
+    for (hg::PZInteger i = 0; i < FRAMES; i += 1) {
+        if (i % EDIT_PERIOD == EDIT_PERIOD - 1) {
+            const auto editPerm = aWorld.getPermissionToEdit();
+            aWorld.edit(*editPerm, [i](World::Editor& aEditor) {
+                aEditor.setFloorAt(CELL_COUNT / 2 + (i % 7),
+                                   CELL_COUNT / 2,
+                                   CellModel::Floor{SPR_STONE_TILE});
+            });
+        }
+
+        const PositionInWorld center{worldSize / 2.f + i * 2.f, worldSize / 2.f - i * 1.f};
+        const hg::gr::View    view{*dimetric::ToPositionInView(center), {1280.f, 950.f}};
+
+        hg::util::Stopwatch stopwatch;
+        renderer.startPrepareToRender(view,
+                                      {.top = 32.f, .bottom = 256.f, .left = 32.f, .right = 32.f},
+                                      center,
+                                      DimetricRenderer::REDUCE_WALLS_BASED_ON_POSITION,
+                                      nullptr);
+        renderer.endPrepareToRender();
+        result.time += stopwatch.getElapsedTime<std::chrono::microseconds>();
+
+        const auto& stats = renderer.getFrameStats();
+        result.cellObjectCount += stats.cellObjectCount;
+        result.generatedVertexCount += stats.generatedVertexCount;
+        result.cachedVertexCount += stats.cachedVertexCount;
+        result.rebuiltChunkCount += stats.rebuiltChunkCount;
+    }
+
+    return result;
+}
+
+void LogResult(const char* aName, const BenchmarkResult& aResult) {
+    HG_LOG_INFO(LOG_ID,
+                "{:<9} | total: {:>8.2f}ms | objects/frame: {:>6} | generated vertices/frame: {:>6} | "
+                "cached vertices/frame: {:>6} | rebuilt chunks: {}",
+                aName,
+                static_cast<double>(aResult.time.count()) / 1000.0,
+                aResult.cellObjectCount / FRAMES,
+                aResult.generatedVertexCount / FRAMES,
+                aResult.cachedVertexCount / FRAMES,
+                aResult.rebuiltChunkCount);
+}
+} // namespace
+
+void RunDimetricRendererBenchmarkImpl() {
+    hg::gr::SpriteLoader loader;
+    loader.startTexture(1024, 1024)
+        ->addSprite(SPR_STONE_TILE, (HG_TEST_ASSET_DIR "/isometric-stone-tile.png"))
+        ->addSprite(SPR_WALL, (HG_TEST_ASSET_DIR "/isometric-wall.png"))
+        ->addSprite(SPR_WALL_SHORT, (HG_TEST_ASSET_DIR "/isometric-wall-short.png"))
+        ->finalize(hg::gr::TexturePackingHeuristic::BestAreaFit);
+
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+    fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+    World world{WorldConfig{.chunkCountX                 = CHUNK_COUNT,
+                            .chunkCountY                 = CHUNK_COUNT,
+                            .cellsPerChunkX              = CELLS_PER_CHUNK,
+                            .cellsPerChunkY              = CELLS_PER_CHUNK,
+                            .cellResolution              = CELL_RESOLUTION,
+                            .maxCellOpenness             = 3,
+                            .maxLoadedNonessentialChunks = CHUNK_COUNT * CHUNK_COUNT},
+                &fakeDiskIoHandler};
+    FillWorld(world);
+
+    HG_LOG_INFO(LOG_ID,
+                "Dimetric renderer benchmark ({} frames over {}x{} cells, no drawing):",
+                FRAMES,
+                CELL_COUNT,
+                CELL_COUNT);
+
+    const auto uncached = RunFrames(world, loader, false);
+    LogResult("uncached", uncached);
+
+    const auto cached = RunFrames(world, loader, true);
+    LogResult("cached", cached);
+
+    HG_HARD_ASSERT(cached.cellObjectCount < uncached.cellObjectCount);
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
+
+void RunDimetricRendererBenchmark() {
+    jbatnozic::gridgoblin::RunDimetricRendererBenchmarkImpl();
+}
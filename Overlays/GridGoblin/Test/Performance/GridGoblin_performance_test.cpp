@@ -0,0 +1,32 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+
+#include <iostream>
+#include <stdexcept>
+
+#include "Benchmark_list.hpp"
+
+namespace hg = jbatnozic::hobgoblin;
+
+int main() try {
+    hg::log::SetMinimalLogSeverity(hg::log::Severity::Info);
+
+    RunChunkConversionsBenchmark();
+    RunCellLayoutBenchmark();
+    RunCellOpennessBenchmark();
+    RunVisibilityCalculatorBenchmark();
+    RunDrawingOrderBenchmark();
+    RunDimetricRendererBenchmark();
+    RunRaycastBenchmark();
+    RunStreamingBenchmark();
+
+} catch (const hg::TracedException& ex) {
+    std::cout << "Traced exception caught: " << ex.getFullFormattedDescription() << '\n';
+    return 1;
+} catch (const std::exception& ex) {
+    std::cout << "Exception caught: " << ex.what() << '\n';
+    return 1;
+}
@@ -0,0 +1,182 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/Utility/Time_utils.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "Benchmark_list.hpp"
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin.PerformanceTest";
+
+constexpr hg::PZInteger CHUNK_COUNT     = 16;
+constexpr hg::PZInteger CELLS_PER_CHUNK = 16;
+constexpr hg::PZInteger CELL_COUNT      = CHUNK_COUNT * CELLS_PER_CHUNK;
+constexpr float         CELL_RESOLUTION = 32.f;
+constexpr hg::PZInteger RAY_COUNT       = 100'000;
+
+//! Loads all chunks and fills them with scattered walls (roughly 1 in 40 cells), so that rays
+//! go through a couple dozen cells on average before they hit something.
+void FillWorld(World& aWorld) {
+    const auto editPerm = aWorld.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < CHUNK_COUNT; y += 1) {
+        for (hg::PZInteger x = 0; x < CHUNK_COUNT; x += 1) {
+            (void)aWorld.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+
+    aWorld.edit(*editPerm, [](World::Editor& aEditor) {
+        std::uint32_t state = 12345;
+        for (hg::PZInteger y = 0; y < CELL_COUNT; y += 1) {
+            for (hg::PZInteger x = 0; x < CELL_COUNT; x += 1) {
+                state = state * 1664525u + 1013904223u;
+                if ((state >> 24) % 40 == 0) {
+                    aEditor.setWallAt(x, y, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+                }
+            }
+        }
+    });
+}
+
+std::vector<Ray> MakeRays() {
+    std::vector<Ray> rays;
+    rays.reserve(hg::pztos(RAY_COUNT));
+
+    const float   worldSize = CELL_COUNT * CELL_RESOLUTION;
+    std::uint32_t state     = 54321;
+    const auto    next      = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+    };
+    for (hg::PZInteger i = 0; i < RAY_COUNT; i += 1) {
+        const float x      = next() * worldSize;
+        const float y      = next() * worldSize;
+        const float angle  = next() * 6.2831853f;
+        const float length = next() * 40.f * CELL_RESOLUTION;
+        rays.push_back({{x, y}, {x + std::cos(angle) * length, y + std::sin(angle) * length}});
+    }
+    return rays;
+}
+
+//! The way it's done without `World::castRay()`: sampling the cells along the ray with
+//! `World::getCellAt()` (a few samples per cell so that no cell is skipped, except at corners).
+bool IsBlockedBySampling(const World& aWorld, const Ray& aRay) {
+    const float dx     = aRay.to->x - aRay.from->x;
+    const float dy     = aRay.to->y - aRay.from->y;
+    const auto  steps  = static_cast<int>(std::hypot(dx, dy) / (CELL_RESOLUTION / 4.f)) + 1;
+    const float worldW = aWorld.getCellCountX() * CELL_RESOLUTION;
+    const float worldH = aWorld.getCellCountY() * CELL_RESOLUTION;
+
+    for (int i = 0; i <= steps; i += 1) {
+        const float x = aRay.from->x + dx * i / steps;
+        const float y = aRay.from->y + dy * i / steps;
+        if (x < 0.f || x >= worldW || y < 0.f || y >= worldH) {
+            return false;
+        }
+        const auto* cell = aWorld.getCellAt(aWorld.posToCell(x, y));
+        if (cell == nullptr || cell->isWallInitialized()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double ToMs(std::chrono::microseconds aTime) {
+    return static_cast<double>(aTime.count()) / 1000.0;
+}
+} // namespace
+
+void RunRaycastBenchmarkImpl() {
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+    fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+    const auto makeWorldConfig = [](hg::PZInteger aRaycastWorkerCount) {
+        return WorldConfig{.chunkCountX                 = CHUNK_COUNT,
+                           .chunkCountY                 = CHUNK_COUNT,
+                           .cellsPerChunkX              = CELLS_PER_CHUNK,
+                           .cellsPerChunkY              = CELLS_PER_CHUNK,
+                           .cellResolution              = CELL_RESOLUTION,
+                           .maxCellOpenness             = 5,
+                           .maxLoadedNonessentialChunks = CHUNK_COUNT * CHUNK_COUNT,
+                           .raycastWorkerCount          = aRaycastWorkerCount};
+    };
+
+    World world{makeWorldConfig(0), &fakeDiskIoHandler};
+    FillWorld(world);
+
+    const auto rays = MakeRays();
+
+    HG_LOG_INFO(LOG_ID,
+                "Raycast benchmark ({} rays over {}x{} cells, {} hw threads):",
+                RAY_COUNT,
+                CELL_COUNT,
+                CELL_COUNT,
+                std::thread::hardware_concurrency());
+
+    hg::PZInteger sampledBlockedCount = 0;
+    {
+        hg::util::Stopwatch stopwatch;
+        for (const auto& ray : rays) {
+            sampledBlockedCount += IsBlockedBySampling(world, ray) ? 1 : 0;
+        }
+        const auto time = stopwatch.getElapsedTime<std::chrono::microseconds>();
+        HG_LOG_INFO(LOG_ID,
+                    "getCellAt() sampling   | total: {:>8.2f}ms | blocked: {}",
+                    ToMs(time),
+                    sampledBlockedCount);
+    }
+
+    std::vector<RaycastResult> serialResults(rays.size());
+    {
+        hg::util::Stopwatch stopwatch;
+        for (std::size_t i = 0; i < rays.size(); i += 1) {
+            serialResults[i] = world.castRay(rays[i]);
+        }
+        const auto time = stopwatch.getElapsedTime<std::chrono::microseconds>();
+
+        hg::PZInteger blockedCount = 0;
+        for (const auto& result : serialResults) {
+            blockedCount += result.isBlocked() ? 1 : 0;
+        }
+        HG_LOG_INFO(LOG_ID,
+                    "castRay() one by one   | total: {:>8.2f}ms | blocked: {}",
+                    ToMs(time),
+                    blockedCount);
+    }
+
+    for (const hg::PZInteger workerCount : {0, 1, 3}) {
+        World batchWorld{makeWorldConfig(workerCount), &fakeDiskIoHandler};
+        FillWorld(batchWorld);
+
+        std::vector<RaycastResult> results;
+        hg::util::Stopwatch        stopwatch;
+        batchWorld.castRays(rays, results);
+        const auto time = stopwatch.getElapsedTime<std::chrono::microseconds>();
+
+        for (std::size_t i = 0; i < rays.size(); i += 1) {
+            HG_HARD_ASSERT(results[i].outcome == serialResults[i].outcome);
+        }
+        HG_LOG_INFO(LOG_ID, "castRays(), {} workers | total: {:>8.2f}ms", workerCount, ToMs(time));
+    }
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
+
+void RunRaycastBenchmark() {
+    jbatnozic::gridgoblin::RunRaycastBenchmarkImpl();
+}
@@ -0,0 +1,413 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/Utility/Time_utils.hpp>
+
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Benchmark_list.hpp"
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+namespace json = rapidjson;
+
+constexpr auto LOG_ID = "GridGoblin.PerformanceTest";
+
+constexpr auto RESULTS_FILE_NAME = "GridGoblin_streaming_benchmark.json";
+
+constexpr hg::PZInteger CHUNK_COUNT       = 64;
+constexpr hg::PZInteger CELLS_PER_CHUNK   = 16;
+constexpr hg::PZInteger AREA_COUNT        = 4;
+constexpr hg::PZInteger AREA_RING_COUNT   = 2;
+constexpr hg::PZInteger FRAME_COUNT       = 600;
+constexpr auto          FRAME_DURATION    = std::chrono::milliseconds{10};
+constexpr hg::PZInteger EDITS_PER_AREA    = 8;
+constexpr hg::PZInteger SPOOLER_WORKERS   = 2;
+constexpr hg::PZInteger NONESSENTIAL_MAX  = 64;
+constexpr auto          DISK_ACCESS_DELAY = std::chrono::milliseconds{1};
+
+//! Distance (in chunks) that an active area travels in one frame.
+constexpr double AREA_SPEED = 0.15;
+
+using Clock = std::chrono::steady_clock;
+
+//! Measures the time between a chunk being requested by an active area and it becoming
+//! available (created or loaded during `World::update()`).
+class LoadLatencyTracker : public Binder {
+public:
+    void onChunkCreated(ChunkId aChunkId, const Chunk&) override {
+        _onAvailable(aChunkId);
+        createdChunks.push_back(aChunkId);
+    }
+
+    void onChunkLoaded(ChunkId aChunkId, const Chunk&) override {
+        _onAvailable(aChunkId);
+    }
+
+    //! Starts the clock for the chunks in `aRequestedChunks` which are not loaded yet, and stops
+    //! it (without recording anything) for those which are no longer requested, as their loads
+    //! were cancelled.
+    void onAreasChanged(const World& aWorld, const std::unordered_set<ChunkId>& aRequestedChunks) {
+        const auto now = Clock::now();
+        for (const auto& chunkId : aRequestedChunks) {
+            if (aWorld.getChunkAtIdUnchecked(chunkId) == nullptr) {
+                _requestTimes.emplace(chunkId, now);
+            }
+        }
+        std::erase_if(_requestTimes, [&](const auto& aPair) {
+            return aRequestedChunks.count(aPair.first) == 0;
+        });
+    }
+
+    std::vector<double>  latencies; //!< In milliseconds.
+    std::vector<ChunkId> createdChunks;
+
+private:
+    std::unordered_map<ChunkId, Clock::time_point> _requestTimes;
+
+    void _onAvailable(ChunkId aChunkId) {
+        const auto iter = _requestTimes.find(aChunkId);
+        if (iter == _requestTimes.end()) {
+            return;
+        }
+        const auto latency = std::chrono::duration<double, std::milli>(Clock::now() - iter->second);
+        latencies.push_back(latency.count());
+        _requestTimes.erase(iter);
+    }
+};
+
+//! Deterministic pseudo-random numbers, so that every run streams the same chunks.
+class Random {
+public:
+    std::uint32_t next() {
+        _state = _state * 1664525u + 1013904223u;
+        return _state >> 8;
+    }
+
+    hg::PZInteger nextInRange(hg::PZInteger aMin, hg::PZInteger aMax) {
+        return aMin + static_cast<hg::PZInteger>(next() % static_cast<std::uint32_t>(aMax - aMin + 1));
+    }
+
+private:
+    std::uint32_t _state = 24680;
+};
+
+//! Puts scattered walls into a freshly created chunk, roughly like a world generator would.
+void GenerateChunk(World::Editor& aEditor, ChunkId aChunkId, Random& aRandom) {
+    const auto startX = aChunkId.x * CELLS_PER_CHUNK;
+    const auto startY = aChunkId.y * CELLS_PER_CHUNK;
+    for (hg::PZInteger y = startY; y < startY + CELLS_PER_CHUNK; y += 1) {
+        for (hg::PZInteger x = startX; x < startX + CELLS_PER_CHUNK; x += 1) {
+            if (aRandom.next() % 24 == 0) {
+                aEditor.setWallAt(x, y, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+            }
+        }
+    }
+}
+
+//! Toggles a few walls (`EDITS_PER_AREA`) in and around chunk `aChunkId`, like gameplay would.
+void ToggleWallsAround(const World& aWorld, World::Editor& aEditor, ChunkId aChunkId, Random& aRandom) {
+    const auto centreX = aChunkId.x * CELLS_PER_CHUNK + CELLS_PER_CHUNK / 2;
+    const auto centreY = aChunkId.y * CELLS_PER_CHUNK + CELLS_PER_CHUNK / 2;
+    for (hg::PZInteger i = 0; i < EDITS_PER_AREA; i += 1) {
+        const auto x = aRandom.nextInRange(centreX - CELLS_PER_CHUNK, centreX + CELLS_PER_CHUNK);
+        const auto y = aRandom.nextInRange(centreY - CELLS_PER_CHUNK, centreY + CELLS_PER_CHUNK);
+        if (x < 0 || x >= aWorld.getCellCountX() || y < 0 || y >= aWorld.getCellCountY()) {
+            continue;
+        }
+        // Cells in chunks which are still loading are skipped, as editing them would block until
+        // they're loaded
+        const auto* cell = aWorld.getCellAtUnchecked(x, y);
+        if (cell == nullptr) {
+            continue;
+        }
+        if (cell->isWallInitialized()) {
+            aEditor.setWallAt(x, y, std::nullopt);
+        } else {
+            aEditor.setWallAt(x, y, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+        }
+    }
+}
+
+//! Position (in chunks) of the centre of active area number `aAreaIndex` at frame `aFrame`. The
+//! areas move around circles of different sizes, in opposite directions, so some of them come back
+//! to chunks which were unloaded in the meantime.
+void GetAreaPosition(hg::PZInteger aAreaIndex, hg::PZInteger aFrame, double& aX, double& aY) {
+    const double radius    = 8.0 + 6.0 * aAreaIndex;
+    const double direction = (aAreaIndex % 2 == 0) ? 1.0 : -1.0;
+    const double angle     = direction * (aFrame * AREA_SPEED / radius) + aAreaIndex * 1.57;
+    aX                     = CHUNK_COUNT / 2.0 + radius * std::cos(angle);
+    aY                     = CHUNK_COUNT / 2.0 + radius * std::sin(angle);
+}
+
+struct Percentiles {
+    double p50  = 0.0;
+    double p90  = 0.0;
+    double p99  = 0.0;
+    double max  = 0.0;
+    double mean = 0.0;
+};
+
+Percentiles CalculatePercentiles(std::vector<double> aValues) {
+    if (aValues.empty()) {
+        return {};
+    }
+    std::sort(aValues.begin(), aValues.end());
+    // Nearest-rank method
+    const auto at = [&](double aPercentile) {
+        const auto rank = static_cast<std::size_t>(std::ceil(aPercentile * aValues.size()));
+        return aValues[std::max<std::size_t>(rank, 1) - 1];
+    };
+    return {.p50  = at(0.50),
+            .p90  = at(0.90),
+            .p99  = at(0.99),
+            .max  = aValues.back(),
+            .mean = std::accumulate(aValues.begin(), aValues.end(), 0.0) / aValues.size()};
+}
+
+template <class taWriter>
+void WritePercentiles(taWriter& aWriter, const char* aName, const Percentiles& aPercentiles) {
+    aWriter.Key(aName);
+    aWriter.StartObject();
+    aWriter.Key("p50");
+    aWriter.Double(aPercentiles.p50);
+    aWriter.Key("p90");
+    aWriter.Double(aPercentiles.p90);
+    aWriter.Key("p99");
+    aWriter.Double(aPercentiles.p99);
+    aWriter.Key("max");
+    aWriter.Double(aPercentiles.max);
+    aWriter.Key("mean");
+    aWriter.Double(aPercentiles.mean);
+    aWriter.EndObject();
+}
+
+void LogPercentiles(const char* aName, const Percentiles& aPercentiles) {
+    HG_LOG_INFO(LOG_ID,
+                "{:<22} | p50: {:>8.3f} | p90: {:>8.3f} | p99: {:>8.3f} | max: {:>8.3f}",
+                aName,
+                aPercentiles.p50,
+                aPercentiles.p90,
+                aPercentiles.p99,
+                aPercentiles.max);
+}
+
+double ToMs(std::chrono::microseconds aTime) {
+    return static_cast<double>(aTime.count()) / 1000.0;
+}
+} // namespace
+
+void RunStreamingBenchmarkImpl() {
+    LoadLatencyTracker      latencyTracker;
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    fakeDiskIoHandler.setRuntimeCacheDelay(DISK_ACCESS_DELAY);
+    fakeDiskIoHandler.setPersistentCacheDelay(DISK_ACCESS_DELAY);
+
+    World world{WorldConfig{.chunkCountX                 = CHUNK_COUNT,
+                            .chunkCountY                 = CHUNK_COUNT,
+                            .cellsPerChunkX              = CELLS_PER_CHUNK,
+                            .cellsPerChunkY              = CELLS_PER_CHUNK,
+                            .cellResolution              = 32.f,
+                            .maxCellOpenness             = 3,
+                            .maxLoadedNonessentialChunks = NONESSENTIAL_MAX,
+                            .chunkSpoolerWorkerCount     = SPOOLER_WORKERS},
+                &fakeDiskIoHandler};
+    world.attachBinder(&latencyTracker);
+
+    std::vector<ActiveArea> areas;
+    std::vector<ChunkId>    areaCentres(hg::pztos(AREA_COUNT), ChunkId{0xFFFF, 0xFFFF});
+    areas.reserve(hg::pztos(AREA_COUNT)); // Active areas must not be copied once they're set
+    for (hg::PZInteger i = 0; i < AREA_COUNT; i += 1) {
+        areas.push_back(world.createActiveArea());
+    }
+
+    std::vector<double> updateTimes;
+    std::vector<double> pruneTimes;
+    std::vector<double> editTimes;
+    std::vector<double> queueDepths;
+    std::int64_t        gameplayCellsRefreshed = 0;
+
+    Random     random;
+    const auto editPerm = world.getPermissionToEdit();
+
+    HG_LOG_INFO(LOG_ID,
+                "Streaming benchmark ({} areas over {}x{} chunks, {} frames):",
+                AREA_COUNT,
+                CHUNK_COUNT,
+                CHUNK_COUNT,
+                FRAME_COUNT);
+
+    auto nextFrameStart = Clock::now();
+    for (hg::PZInteger frame = 0; frame < FRAME_COUNT; frame += 1) {
+        // Move the areas
+        bool areasChanged = false;
+        for (hg::PZInteger i = 0; i < AREA_COUNT; i += 1) {
+            double x, y;
+            GetAreaPosition(i, frame, x, y);
+            const ChunkId centre{static_cast<hg::PZInteger>(x), static_cast<hg::PZInteger>(y)};
+            if (centre == areaCentres[hg::pztos(i)]) {
+                continue;
+            }
+            areaCentres[hg::pztos(i)] = centre;
+            areas[hg::pztos(i)].setToChunkRingSquare(centre, AREA_RING_COUNT);
+            areasChanged = true;
+        }
+        if (areasChanged) {
+            std::unordered_set<ChunkId> requestedChunks;
+            for (const auto& area : areas) {
+                const auto& chunkList = area.getChunkList();
+                requestedChunks.insert(chunkList.begin(), chunkList.end());
+            }
+            latencyTracker.onAreasChanged(world, requestedChunks);
+        }
+
+        const auto queueStats = world.getSpoolerQueueStats();
+        queueDepths.push_back(static_cast<double>(queueStats.loadCount + queueStats.unloadCount));
+
+        // Update
+        {
+            hg::util::Stopwatch stopwatch;
+            world.update();
+            updateTimes.push_back(ToMs(stopwatch.getElapsedTime<std::chrono::microseconds>()));
+        }
+
+        // Generate the chunks which were created during the update (not counted as gameplay edits)
+        if (!latencyTracker.createdChunks.empty()) {
+            world.edit(*editPerm, [&](World::Editor& aEditor) {
+                for (const auto chunkId : latencyTracker.createdChunks) {
+                    GenerateChunk(aEditor, chunkId, random);
+                }
+            });
+            latencyTracker.createdChunks.clear();
+        }
+
+        // Gameplay edits: toggle a few walls around the centre of each area
+        {
+            const auto          statsBefore = world.getEditStats();
+            hg::util::Stopwatch stopwatch;
+            world.edit(*editPerm, [&](World::Editor& aEditor) {
+                for (const auto centre : areaCentres) {
+                    ToggleWallsAround(world, aEditor, centre, random);
+                }
+            });
+            editTimes.push_back(ToMs(stopwatch.getElapsedTime<std::chrono::microseconds>()));
+            gameplayCellsRefreshed += world.getEditStats().cellsRefreshed - statsBefore.cellsRefreshed;
+        }
+
+        // Prune
+        {
+            hg::util::Stopwatch stopwatch;
+            world.prune();
+            pruneTimes.push_back(ToMs(stopwatch.getElapsedTime<std::chrono::microseconds>()));
+        }
+
+        nextFrameStart += FRAME_DURATION;
+        std::this_thread::sleep_until(nextFrameStart);
+    }
+
+    const auto latency        = CalculatePercentiles(latencyTracker.latencies);
+    const auto queueDepth     = CalculatePercentiles(queueDepths);
+    const auto updateTime     = CalculatePercentiles(updateTimes);
+    const auto pruneTime      = CalculatePercentiles(pruneTimes);
+    const auto editTime       = CalculatePercentiles(editTimes);
+    const auto editStats      = world.getEditStats();
+    const auto immediateLoads = world.getImmediateLoadStats();
+    const auto totalEditTime  = editTime.mean * static_cast<double>(editTimes.size());
+    const auto usPerCell      = (gameplayCellsRefreshed > 0)
+                                    ? (totalEditTime * 1000.0 / gameplayCellsRefreshed)
+                                    : 0.0;
+
+    // The fake handler keeps chunks as JSON, so this is not what the real one would write
+    const auto fakeBytesWritten = fakeDiskIoHandler.getWrittenByteCount();
+
+    LogPercentiles("chunk load latency ms", latency);
+    LogPercentiles("spooler queue depth", queueDepth);
+    LogPercentiles("World::update() ms", updateTime);
+    LogPercentiles("World::prune() ms", pruneTime);
+    LogPercentiles("gameplay edit ms", editTime);
+    HG_LOG_INFO(LOG_ID,
+                "{} chunk loads, {} immediate loads, {:.3f}us per refreshed cell, {} bytes written "
+                "(as JSON, by the fake disk I/O handler)",
+                latencyTracker.latencies.size(),
+                immediateLoads.loadCount,
+                usPerCell,
+                fakeBytesWritten);
+
+    json::StringBuffer                     stringBuffer;
+    json::PrettyWriter<json::StringBuffer> writer{stringBuffer};
+    writer.StartObject();
+    writer.Key("benchmark");
+    writer.String("streaming");
+    writer.Key("config");
+    writer.StartObject();
+    writer.Key("chunk_count");
+    writer.Int(CHUNK_COUNT);
+    writer.Key("cells_per_chunk");
+    writer.Int(CELLS_PER_CHUNK);
+    writer.Key("area_count");
+    writer.Int(AREA_COUNT);
+    writer.Key("area_ring_count");
+    writer.Int(AREA_RING_COUNT);
+    writer.Key("frame_count");
+    writer.Int(FRAME_COUNT);
+    writer.Key("frame_duration_ms");
+    writer.Int64(FRAME_DURATION.count());
+    writer.Key("spooler_worker_count");
+    writer.Int(SPOOLER_WORKERS);
+    writer.Key("disk_access_delay_ms");
+    writer.Int64(DISK_ACCESS_DELAY.count());
+    writer.EndObject();
+    writer.Key("chunk_load_count");
+    writer.Int64(static_cast<std::int64_t>(latencyTracker.latencies.size()));
+    writer.Key("immediate_load_count");
+    writer.Int64(immediateLoads.loadCount);
+    WritePercentiles(writer, "chunk_load_latency_ms", latency);
+    WritePercentiles(writer, "spooler_queue_depth", queueDepth);
+    WritePercentiles(writer, "update_time_ms", updateTime);
+    WritePercentiles(writer, "prune_time_ms", pruneTime);
+    WritePercentiles(writer, "gameplay_edit_time_ms", editTime);
+    writer.Key("cells_edited");
+    writer.Int64(editStats.cellsEdited);
+    writer.Key("cells_refreshed");
+    writer.Int64(editStats.cellsRefreshed);
+    writer.Key("gameplay_edit_us_per_refreshed_cell");
+    writer.Double(usPerCell);
+    writer.Key("fake_bytes_written");
+    writer.Int64(fakeBytesWritten);
+    writer.EndObject();
+
+    std::ofstream file{RESULTS_FILE_NAME, std::ios::out | std::ios::trunc};
+    file << stringBuffer.GetString() << '\n';
+    if (!file) {
+        HG_THROW_TRACED(hg::TracedRuntimeError, 0, "Could not write '{}'.", RESULTS_FILE_NAME);
+    }
+    HG_LOG_INFO(LOG_ID, "Results written to '{}'.", RESULTS_FILE_NAME);
+
+    world.detachBinder(&latencyTracker);
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
+
+void RunStreamingBenchmark() {
+    jbatnozic::gridgoblin::RunStreamingBenchmarkImpl();
+}
@@ -0,0 +1,136 @@
+// Copyright 2024 Jovan Batnozic. Released under MS-PL licence in Serbia.
+// See https://github.com/jbatnozic/Hobgoblin?tab=readme-ov-file#licence
+
+#include <GridGoblin/Rendering/Visibility_calculator.hpp>
+#include <GridGoblin/World/World.hpp>
+
+#include <Hobgoblin/HGExcept.hpp>
+#include <Hobgoblin/Logging.hpp>
+#include <Hobgoblin/Utility/Time_utils.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#include "Benchmark_list.hpp"
+#include "Fake_disk_io_handler.hpp"
+
+namespace jbatnozic {
+namespace gridgoblin {
+
+namespace {
+constexpr auto LOG_ID = "GridGoblin.PerformanceTest";
+
+constexpr hg::PZInteger CHUNK_COUNT     = 16;
+constexpr hg::PZInteger CELLS_PER_CHUNK = 16;
+constexpr hg::PZInteger CELL_COUNT      = CHUNK_COUNT * CELLS_PER_CHUNK;
+constexpr float         CELL_RESOLUTION = 32.f;
+constexpr hg::PZInteger ITERATIONS      = 50;
+
+//! Fills the world with scattered walls (roughly 1 in 12 cells), which is dense enough that most
+//! rays are blocked within a few cells of the high detail rings, but not right away.
+void FillWorld(World& aWorld) {
+    const auto editPerm = aWorld.getPermissionToEdit();
+    for (hg::PZInteger y = 0; y < CHUNK_COUNT; y += 1) {
+        for (hg::PZInteger x = 0; x < CHUNK_COUNT; x += 1) {
+            (void)aWorld.getChunkAtId(*editPerm, {x, y});
+        }
+    }
+
+    aWorld.edit(*editPerm, [](World::Editor& aEditor) {
+        std::uint32_t state = 12345;
+        for (hg::PZInteger y = 0; y < CELL_COUNT; y += 1) {
+            for (hg::PZInteger x = 0; x < CELL_COUNT; x += 1) {
+                state = state * 1664525u + 1013904223u;
+                if ((state >> 24) % 12 == 0) {
+                    aEditor.setWallAt(x, y, CellModel::Wall{0, 0, Shape::FULL_SQUARE});
+                }
+            }
+        }
+    });
+}
+
+//! Runs `ITERATIONS` calculations with the point of view moving diagonally across the middle of
+//! the world, and returns the total time along with a checksum of the visibility results.
+std::pair<std::chrono::microseconds, std::uint64_t> RunCalculations(const World&  aWorld,
+                                                                    hg::PZInteger aRayWorkerCount) {
+    VisibilityCalculator calculator{aWorld,
+                                    {.minRingsBeforeRaycasting     = 4,
+                                     .minTrianglesBeforeRaycasting = 0,
+                                     .rayCount                     = 2048,
+                                     .rayPointsPerCell             = 6,
+                                     .rayWorkerCount               = aRayWorkerCount}};
+
+    const float           worldSize = CELL_COUNT * CELL_RESOLUTION;
+    const PositionInWorld viewCenter{worldSize / 2.f, worldSize / 2.f};
+
+    std::chrono::microseconds time{0};
+    std::uint64_t             checksum = 0;
+
+    for (hg::PZInteger i = 0; i < ITERATIONS; i += 1) {
+        const float offset = (i - ITERATIONS / 2) * 3.7f;
+
+        hg::util::Stopwatch stopwatch;
+        calculator.calc(viewCenter,
+                        {worldSize, worldSize},
+                        PositionInWorld{worldSize / 2.f + offset, worldSize / 2.f + offset});
+        time += stopwatch.getElapsedTime<std::chrono::microseconds>();
+
+        for (float y = 8.f; y < worldSize; y += 64.f) {
+            for (float x = 8.f; x < worldSize; x += 64.f) {
+                checksum = checksum * 3 + calculator.testVisibilityAt(PositionInWorld{x, y}).value();
+            }
+        }
+    }
+
+    return {time, checksum};
+}
+} // namespace
+
+void RunVisibilityCalculatorBenchmarkImpl() {
+    test::FakeDiskIoHandler fakeDiskIoHandler;
+    fakeDiskIoHandler.setRuntimeCacheDelay(std::chrono::milliseconds{0});
+    fakeDiskIoHandler.setPersistentCacheDelay(std::chrono::milliseconds{0});
+
+    World world{WorldConfig{.chunkCountX                 = CHUNK_COUNT,
+                            .chunkCountY                 = CHUNK_COUNT,
+                            .cellsPerChunkX              = CELLS_PER_CHUNK,
+                            .cellsPerChunkY              = CELLS_PER_CHUNK,
+                            .cellResolution              = CELL_RESOLUTION,
+                            .maxCellOpenness             = 5,
+                            .maxLoadedNonessentialChunks = CHUNK_COUNT * CHUNK_COUNT},
+                &fakeDiskIoHandler};
+    FillWorld(world);
+
+    HG_LOG_INFO(LOG_ID,
+                "Visibility calculator benchmark ({} calculations over {}x{} cells, {} hw threads):",
+                ITERATIONS,
+                CELL_COUNT,
+                CELL_COUNT,
+                std::thread::hardware_concurrency());
+
+    const auto [serialTime, serialChecksum] = RunCalculations(world, 0);
+    HG_LOG_INFO(LOG_ID,
+                "ray workers: 0 | total: {:>8.2f}ms",
+                static_cast<double>(serialTime.count()) / 1000.0);
+
+    for (const hg::PZInteger workerCount : {1, 3, 7}) {
+        const auto [time, checksum] = RunCalculations(world, workerCount);
+        HG_HARD_ASSERT(checksum == serialChecksum);
+
+        HG_LOG_INFO(LOG_ID,
+                    "ray workers: {} | total: {:>8.2f}ms | speedup: {:.2f}x",
+                    workerCount,
+                    static_cast<double>(time.count()) / 1000.0,
+                    static_cast<double>(serialTime.count()) / std::max<double>(1.0, time.count()));
+    }
+}
+
+} // namespace gridgoblin
+} // namespace jbatnozic
+
+void RunVisibilityCalculatorBenchmark() {
+    jbatnozic::gridgoblin::RunVisibilityCalculatorBenchmarkImpl();
+}